@@ -8,18 +8,29 @@
 #include "catalog/posthog_catalog.hpp"
 #include "catalog/posthog_schema_entry.hpp"
 #include "catalog/posthog_table_entry.hpp"
+#include "catalog/remote_query.hpp"
+#include "catalog/remote_scan.hpp"
 #include "duckdb/common/exception/catalog_exception.hpp"
+#include "duckdb/execution/operator/scan/physical_table_scan.hpp"
 #include "duckdb/execution/physical_operator.hpp"
 #include "duckdb/execution/physical_plan_generator.hpp"
 #include "duckdb/main/client_context.hpp"
+#include "duckdb/storage/buffer_manager.hpp"
 #include "execution/posthog_create_table_as.hpp"
 #include "execution/posthog_delete.hpp"
 #include "execution/posthog_dml_rewriter.hpp"
+#include "execution/posthog_hybrid_dml.hpp"
 #include "execution/posthog_insert.hpp"
 #include "execution/posthog_merge.hpp"
+#include "execution/posthog_remote_create_table_as.hpp"
+#include "execution/posthog_sql_utils.hpp"
+#include "execution/posthog_temp_table.hpp"
 #include "execution/posthog_update.hpp"
+#include "flight/flight_client_registry.hpp"
+#include "optimizer/remote_query_builder.hpp"
 #include "storage/posthog_transaction.hpp"
 #include "utils/posthog_logger.hpp"
+#include "utils/posthog_tracer.hpp"
 #include "duckdb/parser/parsed_data/create_schema_info.hpp"
 #include "duckdb/parser/parsed_data/drop_info.hpp"
 #include "duckdb/planner/operator/logical_create_table.hpp"
@@ -27,12 +38,17 @@
 #include "duckdb/planner/operator/logical_delete.hpp"
 #include "duckdb/planner/operator/logical_merge_into.hpp"
 #include "duckdb/planner/operator/logical_update.hpp"
+#include "duckdb/planner/logical_operator_visitor.hpp"
 #include "duckdb/storage/database_size.hpp"
 #include "duckdb/common/unordered_set.hpp"
 #include "duckdb/parser/keyword_helper.hpp"
 
+#include <arrow/api.h>
+#include <arrow/type_traits.h>
+
 #include <cctype>
 #include <algorithm>
+#include <atomic>
 
 namespace duckdb {
 
@@ -49,11 +65,124 @@ bool IsConnectionFailureMessage(const std::string &message) {
 	       lower.find("timed out") != std::string::npos;
 }
 
+// True when plan reads only remote tables of catalog (directly, or through the remote query of
+// a pushdown) and otherwise consists of relational operators the server evaluates identically.
+// Their expressions are checked separately by ExpressionsAreRemote.
+bool IsRemoteOnlyPlan(PhysicalOperator &plan, PostHogCatalog &catalog, bool &has_remote_scan) {
+	switch (plan.type) {
+	case PhysicalOperatorType::TABLE_SCAN: {
+		auto &scan = plan.Cast<PhysicalTableScan>();
+		if (!scan.bind_data) {
+			return false;
+		}
+		if (scan.function.name == "posthog_remote_scan") {
+			if (&scan.bind_data->Cast<PostHogRemoteScanBindData>().catalog != &catalog) {
+				return false;
+			}
+		} else if (scan.function.name == PostHogRemoteQuery::NAME) {
+			if (&scan.bind_data->Cast<PostHogRemoteQueryBindData>().catalog != &catalog) {
+				return false;
+			}
+		} else {
+			return false;
+		}
+		has_remote_scan = true;
+		break;
+	}
+	case PhysicalOperatorType::PROJECTION:
+	case PhysicalOperatorType::FILTER:
+	case PhysicalOperatorType::HASH_GROUP_BY:
+	case PhysicalOperatorType::PERFECT_HASH_GROUP_BY:
+	case PhysicalOperatorType::UNGROUPED_AGGREGATE:
+	case PhysicalOperatorType::WINDOW:
+	case PhysicalOperatorType::STREAMING_WINDOW:
+	case PhysicalOperatorType::ORDER_BY:
+	case PhysicalOperatorType::TOP_N:
+	case PhysicalOperatorType::LIMIT:
+	case PhysicalOperatorType::STREAMING_LIMIT:
+	case PhysicalOperatorType::HASH_JOIN:
+	case PhysicalOperatorType::NESTED_LOOP_JOIN:
+	case PhysicalOperatorType::PIECEWISE_MERGE_JOIN:
+	case PhysicalOperatorType::CROSS_PRODUCT:
+	case PhysicalOperatorType::LEFT_DELIM_JOIN:
+	case PhysicalOperatorType::RIGHT_DELIM_JOIN:
+	case PhysicalOperatorType::DELIM_SCAN:
+	case PhysicalOperatorType::UNION:
+	case PhysicalOperatorType::CTE:
+	case PhysicalOperatorType::CTE_SCAN:
+	case PhysicalOperatorType::UNNEST:
+	case PhysicalOperatorType::EMPTY_RESULT:
+		break;
+	default:
+		return false;
+	}
+	for (auto &child : plan.children) {
+		if (!IsRemoteOnlyPlan(child.get(), catalog, has_remote_scan)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// True when every expression of the logical plan is in the subset the remote query builder
+// pushes down, so it evaluates identically on the server: no UDFs, no window functions, nothing
+// that depends on the TimeZone setting.
+bool ExpressionsAreRemote(LogicalOperator &plan) {
+	bool remote = true;
+	LogicalOperatorVisitor::EnumerateExpressions(plan, [&](unique_ptr<Expression> *expr) {
+		if (remote && *expr && !PostHogRemoteQueryBuilder::IsRemotelyEvaluable(**expr)) {
+			remote = false;
+		}
+	});
+	for (auto &child : plan.children) {
+		if (!remote) {
+			break;
+		}
+		remote = ExpressionsAreRemote(*child);
+	}
+	return remote;
+}
+
+// Schemas created or dropped after from_snapshot_id (rows with a NULL table_name), and tables and views
+// created, dropped, renamed or with columns changed after it, with their schema.
+string BuildCatalogChangesQuery(const string &remote_catalog, int64_t from_snapshot_id) {
+	auto meta = QuoteIdent("__ducklake_metadata_" + remote_catalog);
+	auto since = std::to_string(from_snapshot_id);
+	auto changed = [&since](const string &alias) {
+		return "(" + alias + ".begin_snapshot > " + since + " OR " + alias + ".end_snapshot > " + since + ")";
+	};
+	auto schemas = "SELECT s.schema_name, NULL::VARCHAR AS table_name FROM " + meta + ".ducklake_schema s WHERE " +
+	               changed("s");
+	// Versions of a table that ended before from_snapshot_id name it under an earlier name.
+	auto tables = "SELECT s.schema_name, t.table_name FROM " + meta + ".ducklake_table t JOIN " + meta +
+	              ".ducklake_schema s ON s.schema_id = t.schema_id WHERE (t.end_snapshot IS NULL OR t.end_snapshot > " +
+	              since + ") AND (" + changed("t") + " OR t.table_id IN (SELECT c.table_id FROM " + meta +
+	              ".ducklake_column c WHERE " + changed("c") + "))";
+	auto views = "SELECT s.schema_name, v.view_name FROM " + meta + ".ducklake_view v JOIN " + meta +
+	             ".ducklake_schema s ON s.schema_id = v.schema_id WHERE " + changed("v");
+	return schemas + " UNION ALL " + tables + " UNION ALL " + views;
+}
+
+std::optional<string> StringAt(const arrow::ChunkedArray &column, int64_t row) {
+	auto scalar_result = column.GetScalar(row);
+	if (!scalar_result.ok() || !(*scalar_result)->is_valid ||
+	    !arrow::is_base_binary_like((*scalar_result)->type->id())) {
+		return std::nullopt;
+	}
+	return string(std::static_pointer_cast<arrow::BaseBinaryScalar>(*scalar_result)->view());
+}
+
 } // namespace
 
 PostHogCatalog::PostHogCatalog(AttachedDatabase &db, const string &name, PostHogConnectionConfig config,
                                const string &remote_catalog)
     : Catalog(db), database_name_(name), remote_catalog_(remote_catalog), config_(std::move(config)) {
+	if (config_.track_memory) {
+		memory_pool_ = make_uniq<PostHogMemoryPool>(BufferManager::GetBufferManager(db.GetDatabase()));
+	}
+	if (config_.result_cache_bytes > 0) {
+		result_cache_ = make_uniq<PostHogResultCache>(config_.result_cache_bytes);
+	}
 }
 
 PostHogCatalog::~PostHogCatalog() = default;
@@ -69,15 +198,18 @@ void PostHogCatalog::Initialize(bool load_builtin) {
 
 	// Create the Flight SQL client (Milestone 3)
 	try {
-		flight_client_ = make_uniq<PostHogFlightClient>(config_.flight_server, config_.user, config_.password,
-		                                                config_.tls_skip_verify);
-		flight_client_->Authenticate();
+		// Catalogs attached to the same server with the same credentials share one client.
+		flight_client_ = PostHogFlightClientRegistry::Instance().Acquire(config_);
 		POSTHOG_LOG_INFO("Initialized Flight SQL client");
 		auto ping_status = flight_client_->Ping();
 		if (ping_status.ok()) {
 			POSTHOG_LOG_INFO("Flight server is reachable");
-			if (!remote_catalog_.empty()) {
-				flight_client_->ListDbSchemas(remote_catalog_);
+			if (!InitializeMetadataCache() && !remote_catalog_.empty()) {
+				if (config_.prefetch_metadata) {
+					StartMetadataPrefetch();
+				} else {
+					flight_client_->ListDbSchemas(remote_catalog_);
+				}
 			}
 		} else {
 			POSTHOG_LOG_WARN("Flight server not reachable yet: %s", ping_status.ToString().c_str());
@@ -101,7 +233,9 @@ optional_ptr<CatalogEntry> PostHogCatalog::CreateSchema(CatalogTransaction trans
 
 	std::optional<TransactionId> remote_txn_id;
 	if (transaction.HasContext()) {
-		remote_txn_id = PostHogTransaction::Get(transaction.GetContext(), *this).remote_txn_id;
+		auto &posthog_transaction = PostHogTransaction::Get(transaction.GetContext(), *this);
+		posthog_transaction.RecordSchemaListChange();
+		remote_txn_id = posthog_transaction.RemoteTransactionForWrite();
 	}
 
 	auto copied = info.Copy();
@@ -126,18 +260,262 @@ optional_ptr<CatalogEntry> PostHogCatalog::CreateSchema(CatalogTransaction trans
 // Schema Loading (Lazy)
 //===----------------------------------------------------------------------===//
 
+std::optional<int64_t> PostHogCatalog::ReadSnapshotId(const std::optional<TransactionId> &txn_id) {
+	if (remote_catalog_.empty() || !IsConnected()) {
+		return std::nullopt;
+	}
+	try {
+		auto table = flight_client_->ExecuteQuery("SELECT CAST(max(snapshot_id) AS BIGINT) AS snapshot_id FROM " +
+		                                              QuoteIdent("__ducklake_metadata_" + remote_catalog_) +
+		                                              ".ducklake_snapshot",
+		                                          txn_id, memory_pool_.get());
+		if (!table || table->num_rows() != 1 || table->num_columns() != 1) {
+			return std::nullopt;
+		}
+		auto scalar_result = table->column(0)->GetScalar(0);
+		if (!scalar_result.ok() || !(*scalar_result)->is_valid || (*scalar_result)->type->id() != arrow::Type::INT64) {
+			return std::nullopt;
+		}
+		return std::static_pointer_cast<arrow::Int64Scalar>(*scalar_result)->value;
+	} catch (const std::exception &e) {
+		POSTHOG_LOG_DEBUG("Snapshot id unavailable for '%s': %s", remote_catalog_.c_str(), e.what());
+		return std::nullopt;
+	}
+}
+
+std::optional<int64_t> PostHogCatalog::CurrentSnapshotId() {
+	std::lock_guard<std::mutex> lock(snapshot_mutex_);
+	auto now = std::chrono::steady_clock::now();
+	auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - snapshot_read_at_).count();
+	if (current_snapshot_id_.has_value() && elapsed < static_cast<int64_t>(config_.metadata_cache_ttl)) {
+		return current_snapshot_id_;
+	}
+	current_snapshot_id_ = ReadSnapshotId();
+	snapshot_read_at_ = now;
+	return current_snapshot_id_;
+}
+
+std::shared_ptr<const PostHogCatalogChanges> PostHogCatalog::ReadCatalogChanges(int64_t from_snapshot_id,
+                                                                                int64_t to_snapshot_id) {
+	std::lock_guard<std::mutex> lock(snapshot_mutex_);
+	if (changes_ && changes_from_ == from_snapshot_id && changes_to_ == to_snapshot_id) {
+		return changes_;
+	}
+	if (remote_catalog_.empty() || !IsConnected()) {
+		return nullptr;
+	}
+	try {
+		PostHogTraceScope trace("ReadCatalogChanges", remote_catalog_);
+		auto table = flight_client_->ExecuteQuery(BuildCatalogChangesQuery(remote_catalog_, from_snapshot_id),
+		                                          std::nullopt, memory_pool_.get());
+		if (!table || table->num_columns() != 2) {
+			return nullptr;
+		}
+		auto changes = std::make_shared<PostHogCatalogChanges>();
+		for (int64_t row = 0; row < table->num_rows(); row++) {
+			auto schema_name = StringAt(*table->column(0), row);
+			if (!schema_name) {
+				return nullptr;
+			}
+			auto table_name = StringAt(*table->column(1), row);
+			if (table_name) {
+				changes->tables[*schema_name].insert(*table_name);
+			} else {
+				changes->schemas_changed = true;
+			}
+		}
+		POSTHOG_LOG_DEBUG("Catalog '%s' changed from snapshot %lld to %lld: %zu schemas with changed tables%s",
+		                  remote_catalog_.c_str(), static_cast<long long>(from_snapshot_id),
+		                  static_cast<long long>(to_snapshot_id), changes->tables.size(),
+		                  changes->schemas_changed ? ", schema list changed" : "");
+		changes_from_ = from_snapshot_id;
+		changes_to_ = to_snapshot_id;
+		changes_ = std::move(changes);
+		return changes_;
+	} catch (const std::exception &e) {
+		POSTHOG_LOG_DEBUG("Catalog changes unavailable for '%s': %s", remote_catalog_.c_str(), e.what());
+		return nullptr;
+	}
+}
+
+bool PostHogCatalog::InitializeMetadataCache() {
+	if (config_.metadata_cache_dir.empty()) {
+		return false;
+	}
+	// Without a snapshot id there is no way to tell whether a cache file is still current.
+	auto snapshot_id = ReadSnapshotId();
+	if (!snapshot_id.has_value()) {
+		POSTHOG_LOG_DEBUG("Metadata cache disabled for '%s': no DuckLake snapshot id", remote_catalog_.c_str());
+		return false;
+	}
+	metadata_cache_ =
+	    make_uniq<PostHogMetadataCache>(config_.metadata_cache_dir, config_, remote_catalog_, *snapshot_id);
+	if (!metadata_cache_->Load()) {
+		return false;
+	}
+	auto schema_names = metadata_cache_->GetSchemas();
+	if (!schema_names) {
+		return false;
+	}
+	// Start warm: the schema listing the cache was written with is still current.
+	std::vector<PostHogDbSchemaInfo> schema_infos;
+	for (auto &schema_name : *schema_names) {
+		schema_infos.push_back(PostHogDbSchemaInfo {remote_catalog_, schema_name});
+	}
+	if (config_.snapshot_invalidation) {
+		// The id was just read: later schemas revalidate against it instead of reading it again.
+		std::lock_guard<std::mutex> lock(snapshot_mutex_);
+		current_snapshot_id_ = snapshot_id;
+		snapshot_read_at_ = std::chrono::steady_clock::now();
+	}
+	std::lock_guard<std::mutex> lock(schemas_mutex_);
+	ApplyRemoteSchemas(schema_infos);
+	if (config_.snapshot_invalidation) {
+		schemas_snapshot_id_ = snapshot_id;
+	}
+	return true;
+}
+
+void PostHogCatalog::StoreSchemasInMetadataCache(const std::vector<PostHogDbSchemaInfo> &schema_infos) {
+	if (!metadata_cache_) {
+		return;
+	}
+	vector<string> schema_names;
+	for (auto &schema_info : schema_infos) {
+		schema_names.push_back(schema_info.schema_name);
+	}
+	metadata_cache_->StoreSchemas(schema_names);
+}
+
+void PostHogCatalog::StartMetadataPrefetch() {
+	POSTHOG_LOG_DEBUG("Prefetching metadata of remote catalog '%s'", remote_catalog_.c_str());
+	auto schemas_promise = std::make_shared<std::promise<std::vector<PostHogDbSchemaInfo>>>();
+	{
+		std::lock_guard<std::mutex> lock(schemas_mutex_);
+		pending_schemas_ = schemas_promise->get_future();
+	}
+	prefetch_job_ = std::async(std::launch::async, [this, client = flight_client_, schemas_promise]() {
+		// Read first: every prefetched listing is then at least as recent as the snapshot it is recorded with.
+		std::optional<int64_t> snapshot_id;
+		if (config_.snapshot_invalidation) {
+			snapshot_id = CurrentSnapshotId();
+		}
+		pending_schemas_snapshot_id_ = snapshot_id;
+		std::vector<PostHogDbSchemaInfo> schema_infos;
+		try {
+			PostHogTraceScope trace("PrefetchSchemas", remote_catalog_);
+			schema_infos = client->ListDbSchemas(remote_catalog_);
+		} catch (...) {
+			schemas_promise->set_exception(std::current_exception());
+			return;
+		}
+
+		// Registered before the schema list is published, so every entry built from it finds its listing.
+		std::vector<std::promise<std::vector<PostHogTableInfo>>> table_promises(schema_infos.size());
+		{
+			std::lock_guard<std::mutex> lock(prefetch_mutex_);
+			prefetch_snapshot_id_ = snapshot_id;
+			for (size_t i = 0; i < schema_infos.size(); i++) {
+				prefetched_tables_[schema_infos[i].schema_name] = table_promises[i].get_future();
+			}
+		}
+		schemas_promise->set_value(schema_infos);
+
+		std::atomic<size_t> next_schema {0};
+		auto list_tables = [&]() {
+			for (auto i = next_schema++; i < schema_infos.size(); i = next_schema++) {
+				try {
+					PostHogTraceScope trace("PrefetchTables", schema_infos[i].schema_name);
+					table_promises[i].set_value(ListRemoteTables(*client, schema_infos[i].schema_name));
+				} catch (...) {
+					table_promises[i].set_exception(std::current_exception());
+				}
+			}
+		};
+		// gRPC multiplexes concurrent calls over each channel, so this is not bounded by pool_size.
+		std::vector<std::future<void>> workers;
+		for (size_t i = 1; i < std::min(config_.metadata_concurrency, schema_infos.size()); i++) {
+			workers.push_back(std::async(std::launch::async, list_tables));
+		}
+		list_tables();
+		for (auto &worker : workers) {
+			worker.wait();
+		}
+	});
+}
+
+std::vector<PostHogTableInfo> PostHogCatalog::ListRemoteTables(PostHogFlightClient &client,
+                                                               const string &schema_name) const {
+	if (!config_.lazy_table_schemas) {
+		return client.ListTablesWithSchemas(remote_catalog_, schema_name);
+	}
+	std::vector<PostHogTableInfo> tables;
+	for (auto &table_name : client.ListTables(remote_catalog_, schema_name)) {
+		tables.push_back({std::move(table_name), nullptr});
+	}
+	return tables;
+}
+
+std::future<std::vector<PostHogTableInfo>> PostHogCatalog::TakePrefetchedTables(const string &schema_name,
+                                                                                std::optional<int64_t> &snapshot_id) {
+	std::lock_guard<std::mutex> lock(prefetch_mutex_);
+	auto it = prefetched_tables_.find(schema_name);
+	if (it == prefetched_tables_.end()) {
+		return {};
+	}
+	snapshot_id = prefetch_snapshot_id_;
+	auto tables = std::move(it->second);
+	prefetched_tables_.erase(it);
+	return tables;
+}
+
 void PostHogCatalog::LoadSchemasIfNeeded() {
 	bool should_load = false;
 	{
 		std::lock_guard<std::mutex> lock(schemas_mutex_);
 
+		// A background listing finished, or nothing is cached yet and one is in flight (prefetch_metadata):
+		// swap its result in, waiting for it in the latter case rather than issuing a second call.
+		if (pending_schemas_.valid() &&
+		    (!schemas_loaded_ || pending_schemas_.wait_for(std::chrono::seconds(0)) == std::future_status::ready)) {
+			try {
+				auto schema_infos = pending_schemas_.get();
+				StoreSchemasInMetadataCache(schema_infos);
+				ApplyRemoteSchemas(schema_infos);
+				schemas_snapshot_id_ = pending_schemas_snapshot_id_;
+				return;
+			} catch (const std::exception &e) {
+				POSTHOG_LOG_WARN("Background schema listing failed: %s", e.what());
+				if (schemas_loaded_) {
+					// Keep serving the stale schemas; the next expired lookup retries.
+					return;
+				}
+			}
+		}
+
 		// Check if cache is still valid
 		if (schemas_loaded_) {
 			auto now = std::chrono::steady_clock::now();
 			auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - schemas_loaded_at_).count();
-			if (elapsed < CACHE_TTL_SECONDS) {
+			if (elapsed < static_cast<int64_t>(config_.metadata_cache_ttl)) {
 				return; // Cache is still valid
 			}
+			if (config_.snapshot_invalidation && SchemaListUnchanged()) {
+				schemas_loaded_at_ = now;
+				return;
+			}
+			if (config_.stale_while_revalidate && IsConnected()) {
+				// Serve the expired schemas and refresh off the query's critical path.
+				if (!pending_schemas_.valid()) {
+					POSTHOG_LOG_DEBUG("Schema cache expired, refreshing in the background...");
+					pending_schemas_ = std::async(std::launch::async, [this]() {
+						pending_schemas_snapshot_id_ =
+						    config_.snapshot_invalidation ? CurrentSnapshotId() : std::optional<int64_t>();
+						return flight_client_->ListDbSchemas(remote_catalog_);
+					});
+				}
+				return;
+			}
 			// Cache expired, need to refresh
 			POSTHOG_LOG_DEBUG("Schema cache expired, refreshing...");
 		}
@@ -153,8 +531,14 @@ void PostHogCatalog::LoadSchemasIfNeeded() {
 		return;
 	}
 
+	// Read first: the listing is then at least as recent as the snapshot it is recorded with.
+	std::optional<int64_t> snapshot_id;
+	if (config_.snapshot_invalidation) {
+		snapshot_id = CurrentSnapshotId();
+	}
 	std::vector<PostHogDbSchemaInfo> schema_infos;
 	try {
+		PostHogTraceScope trace("LoadSchemas", remote_catalog_);
 		POSTHOG_LOG_DEBUG("Loading schemas for remote catalog '%s'...", remote_catalog_.c_str());
 		// Query schemas only for this catalog's remote_catalog_
 		schema_infos = flight_client_->ListDbSchemas(remote_catalog_);
@@ -169,14 +553,37 @@ void PostHogCatalog::LoadSchemasIfNeeded() {
 		return;
 	}
 
+	StoreSchemasInMetadataCache(schema_infos);
+	std::lock_guard<std::mutex> lock(schemas_mutex_);
+	ApplyRemoteSchemas(schema_infos);
+	schemas_snapshot_id_ = snapshot_id;
+}
+
+bool PostHogCatalog::SchemaListUnchanged() {
+	// Note: Called with schemas_mutex_ held
+	auto current_snapshot_id = CurrentSnapshotId();
+	if (!current_snapshot_id || !schemas_snapshot_id_) {
+		return false;
+	}
+	if (*current_snapshot_id != *schemas_snapshot_id_) {
+		auto changes = ReadCatalogChanges(*schemas_snapshot_id_, *current_snapshot_id);
+		if (!changes || changes->schemas_changed) {
+			return false;
+		}
+		schemas_snapshot_id_ = current_snapshot_id;
+	}
+	POSTHOG_LOG_DEBUG("Schema list of '%s' unchanged at snapshot %lld", remote_catalog_.c_str(),
+	                  static_cast<long long>(*current_snapshot_id));
+	return true;
+}
+
+void PostHogCatalog::ApplyRemoteSchemas(const std::vector<PostHogDbSchemaInfo> &schema_infos) {
 	unordered_set<string> remote_schemas;
 	remote_schemas.reserve(schema_infos.size());
 	for (const auto &schema_info : schema_infos) {
 		remote_schemas.insert(schema_info.schema_name);
 	}
 
-	std::lock_guard<std::mutex> lock(schemas_mutex_);
-
 	// Prune schemas that no longer exist remotely.
 	size_t pruned_count = 0;
 	for (auto it = schema_cache_.begin(); it != schema_cache_.end();) {
@@ -252,6 +659,23 @@ void PostHogCatalog::RefreshSchemas() {
 	}
 }
 
+void PostHogCatalog::RefreshChangedSchemas(bool schema_list_changed, const unordered_set<string> &changed_schemas) {
+	if ((schema_list_changed || !changed_schemas.empty()) && flight_client_) {
+		// DDL may change the result schema of any cached query.
+		flight_client_->InvalidateQuerySchemas();
+	}
+	std::lock_guard<std::mutex> lock(schemas_mutex_);
+	if (schema_list_changed) {
+		schemas_loaded_ = false;
+	}
+	for (auto &schema_name : changed_schemas) {
+		auto entry = schema_cache_.find(schema_name);
+		if (entry != schema_cache_.end()) {
+			entry->second->RefreshTables();
+		}
+	}
+}
+
 //===----------------------------------------------------------------------===//
 // Schema Scanning and Lookup
 //===----------------------------------------------------------------------===//
@@ -378,9 +802,15 @@ PhysicalOperator &PostHogCatalog::PlanInsert(ClientContext &context, PhysicalPla
 		}
 	}
 
-	auto &insert = planner.Make<PhysicalPostHogInsert>(op.types, *this, table.GetSchemaName(), table.name,
-	                                                   std::move(column_names), on_conflict_do_nothing,
-	                                                   std::move(on_conflict_clause), op.estimated_cardinality);
+	// Without an explicit column list the child produces every physical column in table order,
+	// which is the shape Flight SQL bulk ingest appends; column subsets keep using SQL text so
+	// the remote side fills defaults.
+	auto bulk_ingest_eligible = op.column_index_map.empty() && !on_conflict_do_nothing;
+	// Like DuckDB's own INSERT, sink from every thread unless insertion order must be preserved.
+	auto parallel = !PhysicalPlanGenerator::PreserveInsertionOrder(context, *plan);
+	auto &insert = planner.Make<PhysicalPostHogInsert>(
+	    op.types, *this, table.GetSchemaName(), table.name, std::move(column_names), on_conflict_do_nothing,
+	    std::move(on_conflict_clause), bulk_ingest_eligible, parallel, op.estimated_cardinality);
 	insert.children.push_back(*plan);
 	return insert;
 }
@@ -393,6 +823,20 @@ PhysicalOperator &PostHogCatalog::PlanCreateTableAs(ClientContext &context, Phys
 
 	auto &bound_info = *op.info;
 	auto &base = bound_info.Base();
+	PostHogTransaction::Get(context, *this).RecordTableChange(base.schema);
+
+	// When the SELECT only reads tables of this catalog, and both its bound expressions and the
+	// functions written in its text evaluate identically on the server, send the whole statement
+	// to the server instead of streaming the rows here and back.
+	bool has_remote_scan = false;
+	string remote_ctas_sql;
+	if (IsRemoteOnlyPlan(plan, *this, has_remote_scan) && has_remote_scan && op.children.size() == 1 && op.children[0] &&
+	    ExpressionsAreRemote(*op.children[0]) &&
+	    TryRewriteRemoteCreateTableAsSQL(context, base, database_name_, remote_catalog_, remote_ctas_sql)) {
+		POSTHOG_LOG_DEBUG("Running CREATE TABLE AS on remote server: %s", remote_ctas_sql.c_str());
+		return planner.Make<PhysicalPostHogRemoteCreateTableAs>(op.types, *this, std::move(remote_ctas_sql),
+		                                                        op.estimated_cardinality);
+	}
 
 	// Copy the CreateTableInfo and rewrite the catalog for the remote side.
 	auto copied = unique_ptr_cast<CreateInfo, CreateTableInfo>(base.Copy());
@@ -408,39 +852,66 @@ PhysicalOperator &PostHogCatalog::PlanCreateTableAs(ClientContext &context, Phys
 
 	auto remote_schema = copied->schema;
 	auto remote_table = copied->table;
+	auto parallel = !PhysicalPlanGenerator::PreserveInsertionOrder(context, plan);
 	auto &ctas = planner.Make<PhysicalPostHogCreateTableAs>(op.types, *this, std::move(copied),
 	                                                        std::move(remote_schema), std::move(remote_table),
-	                                                        std::move(column_names), op.estimated_cardinality);
+	                                                        std::move(column_names), parallel,
+	                                                        op.estimated_cardinality);
 	ctas.children.push_back(plan);
 	return ctas;
 }
 
-PhysicalOperator &PostHogCatalog::PlanDelete(ClientContext &context, PhysicalPlanGenerator &planner, LogicalDelete &op,
-                                             PhysicalOperator &plan) {
-	(void)plan;
-	return PlanDelete(context, planner, op);
+PostHogHybridDMLSource PostHogCatalog::MakeHybridDMLSource(ClientContext &context) {
+	PostHogHybridDMLSource hybrid;
+	hybrid.temp_table = PostHogRemoteTempTable::NewName();
+	// An unqualified table is local when the search path resolves it to a table of another catalog.
+	hybrid.is_local = [this, &context](const string &schema, const string &table) {
+		try {
+			auto entry = Catalog::GetEntry<TableCatalogEntry>(context, INVALID_CATALOG,
+			                                                  schema.empty() ? INVALID_SCHEMA : schema, table,
+			                                                  OnEntryNotFound::RETURN_NULL);
+			return entry && &entry->ParentCatalog() != this;
+		} catch (const std::exception &) {
+			return false;
+		}
+	};
+	return hybrid;
 }
 
 PhysicalOperator &PostHogCatalog::PlanDelete(ClientContext &context, PhysicalPlanGenerator &planner,
                                              LogicalDelete &op) {
+	return PlanDelete(context, planner, op, planner.CreatePlan(*op.children[0]));
+}
+
+PhysicalOperator &PostHogCatalog::PlanDelete(ClientContext &context, PhysicalPlanGenerator &planner, LogicalDelete &op,
+                                             PhysicalOperator &plan) {
 	if (!IsConnected()) {
 		throw CatalogException("PostHog: Not connected to remote server");
 	}
 
-	auto rewritten = RewriteRemoteDeleteSQL(context, database_name_, remote_catalog_);
+	auto hybrid = MakeHybridDMLSource(context);
+	auto rewritten =
+	    RewriteRemoteDeleteSQL(context, database_name_, remote_catalog_, config_.hybrid_dml ? &hybrid : nullptr);
+	if (hybrid.Found()) {
+		if (op.return_chunk) {
+			throw NotImplementedException("PostHog: DELETE ... RETURNING is not supported with a local USING table");
+		}
+		return PhysicalPostHogHybridDML::Plan(context, planner, *this, "POSTHOG_DELETE", op.types,
+		                                      std::move(rewritten.non_returning_sql), hybrid, plan,
+		                                      op.estimated_cardinality);
+	}
 	return planner.Make<PhysicalPostHogDelete>(op.types, *this, std::move(rewritten.non_returning_sql),
 	                                           std::move(rewritten.returning_sql), op.return_chunk,
 	                                           op.estimated_cardinality);
 }
 
-PhysicalOperator &PostHogCatalog::PlanUpdate(ClientContext &context, PhysicalPlanGenerator &planner, LogicalUpdate &op,
-                                             PhysicalOperator &plan) {
-	(void)plan;
-	return PlanUpdate(context, planner, op);
-}
-
 PhysicalOperator &PostHogCatalog::PlanUpdate(ClientContext &context, PhysicalPlanGenerator &planner,
                                              LogicalUpdate &op) {
+	return PlanUpdate(context, planner, op, planner.CreatePlan(*op.children[0]));
+}
+
+PhysicalOperator &PostHogCatalog::PlanUpdate(ClientContext &context, PhysicalPlanGenerator &planner, LogicalUpdate &op,
+                                             PhysicalOperator &plan) {
 	if (!IsConnected()) {
 		throw CatalogException("PostHog: Not connected to remote server.");
 	}
@@ -449,7 +920,14 @@ PhysicalOperator &PostHogCatalog::PlanUpdate(ClientContext &context, PhysicalPla
 		throw NotImplementedException("PostHog: UPDATE ... RETURNING is not yet supported");
 	}
 
-	auto rewritten = RewriteRemoteUpdateSQL(context, database_name_, remote_catalog_);
+	auto hybrid = MakeHybridDMLSource(context);
+	auto rewritten =
+	    RewriteRemoteUpdateSQL(context, database_name_, remote_catalog_, config_.hybrid_dml ? &hybrid : nullptr);
+	if (hybrid.Found()) {
+		return PhysicalPostHogHybridDML::Plan(context, planner, *this, "POSTHOG_UPDATE", op.types,
+		                                      std::move(rewritten.non_returning_sql), hybrid, plan,
+		                                      op.estimated_cardinality);
+	}
 	return planner.Make<PhysicalPostHogUpdate>(op.types, *this, std::move(rewritten.non_returning_sql),
 	                                           std::move(rewritten.returning_sql), op.return_chunk,
 	                                           op.estimated_cardinality);
@@ -457,7 +935,6 @@ PhysicalOperator &PostHogCatalog::PlanUpdate(ClientContext &context, PhysicalPla
 
 PhysicalOperator &PostHogCatalog::PlanMergeInto(ClientContext &context, PhysicalPlanGenerator &planner,
                                                 LogicalMergeInto &op, PhysicalOperator &plan) {
-	(void)plan;
 	if (!IsConnected()) {
 		throw CatalogException("PostHog: Not connected to remote server.");
 	}
@@ -467,7 +944,14 @@ PhysicalOperator &PostHogCatalog::PlanMergeInto(ClientContext &context, Physical
 		throw NotImplementedException("PostHog: MERGE ... RETURNING is not yet supported");
 	}
 
-	auto rewritten = RewriteRemoteMergeSQL(context, database_name_, remote_catalog_);
+	auto hybrid = MakeHybridDMLSource(context);
+	auto rewritten =
+	    RewriteRemoteMergeSQL(context, database_name_, remote_catalog_, config_.hybrid_dml ? &hybrid : nullptr);
+	if (hybrid.Found()) {
+		return PhysicalPostHogHybridDML::Plan(context, planner, *this, "POSTHOG_MERGE", op.types,
+		                                      std::move(rewritten.non_returning_sql), hybrid, plan,
+		                                      op.estimated_cardinality);
+	}
 	return planner.Make<PhysicalPostHogMerge>(op.types, *this, std::move(rewritten.non_returning_sql),
 	                                          std::move(rewritten.returning_sql), op.return_chunk,
 	                                          op.estimated_cardinality);
@@ -498,7 +982,9 @@ void PostHogCatalog::DropSchema(ClientContext &context, DropInfo &info) {
 		                       info.name.c_str());
 	}
 
-	auto remote_txn_id = PostHogTransaction::Get(context, *this).remote_txn_id;
+	auto &posthog_transaction = PostHogTransaction::Get(context, *this);
+	posthog_transaction.RecordSchemaListChange();
+	auto remote_txn_id = posthog_transaction.RemoteTransactionForWrite();
 
 	auto copied = info.Copy();
 	copied->catalog = remote_catalog_;
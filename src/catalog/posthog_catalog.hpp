@@ -8,20 +8,35 @@
 #pragma once
 
 #include "duckdb/catalog/catalog.hpp"
+#include "duckdb/common/unordered_set.hpp"
 #include "duckdb/execution/physical_operator.hpp"
 #include "duckdb/execution/physical_plan_generator.hpp"
+#include "catalog/posthog_metadata_cache.hpp"
+#include "execution/posthog_dml_rewriter.hpp"
 #include "utils/connection_string.hpp"
 #include "flight/flight_client.hpp"
+#include "flight/memory_pool.hpp"
+#include "flight/result_cache.hpp"
+#include "storage/posthog_interrupt_monitor.hpp"
 
 #include <memory>
 #include <unordered_map>
 #include <mutex>
 #include <chrono>
+#include <future>
 
 namespace duckdb {
 
 class PostHogSchemaEntry;
 
+// Catalog objects that DuckLake snapshots after some snapshot id created, dropped, renamed or altered.
+struct PostHogCatalogChanges {
+	// A schema was created or dropped.
+	bool schemas_changed = false;
+	// Names of the changed tables and views (old and new names of renamed ones), by schema.
+	std::unordered_map<string, unordered_set<string>> tables;
+};
+
 class PostHogCatalog : public Catalog {
 public:
 	// Constructor for multi-catalog attach: each PostHogCatalog maps to exactly one remote catalog
@@ -91,6 +106,51 @@ public:
 
 	// Force refresh of schema cache
 	void RefreshSchemas();
+	// Reload only what a rolled-back transaction may have changed: the schema list when
+	// schema_list_changed, and the table lists of changed_schemas. Either drops the cached query schemas.
+	void RefreshChangedSchemas(bool schema_list_changed, const unordered_set<string> &changed_schemas);
+
+	// Current DuckLake snapshot id of the remote catalog, read from its metadata catalog (inside
+	// txn_id when given); nullopt when the server cannot tell (no catalog name, non-DuckLake, errors).
+	std::optional<int64_t> ReadSnapshotId(const std::optional<TransactionId> &txn_id = std::nullopt);
+
+	// snapshot_invalidation: ReadSnapshotId outside any transaction, reused for metadata_cache_ttl
+	// seconds so that the schemas expiring together issue one call.
+	std::optional<int64_t> CurrentSnapshotId();
+	// snapshot_invalidation: what changed in the snapshots after from_snapshot_id up to (at least)
+	// to_snapshot_id, read from the metadata catalog; null when unavailable.
+	std::shared_ptr<const PostHogCatalogChanges> ReadCatalogChanges(int64_t from_snapshot_id, int64_t to_snapshot_id);
+
+	// Cancels the Flight calls of interrupted queries, see PostHogTransaction::GetStopToken.
+	PostHogInterruptMonitor &GetInterruptMonitor() {
+		return interrupt_monitor_;
+	}
+
+	// Pool remote query results are allocated from and accounted to memory_limit with (track_memory);
+	// nullptr when disabled.
+	optional_ptr<PostHogMemoryPool> GetMemoryPool() {
+		return memory_pool_.get();
+	}
+
+	// Remote scan result cache (result_cache_bytes); nullptr when disabled.
+	optional_ptr<PostHogResultCache> GetResultCache() {
+		return result_cache_.get();
+	}
+
+	// On-disk metadata cache (metadata_cache_dir); nullptr when disabled or unusable for this attach.
+	optional_ptr<PostHogMetadataCache> GetMetadataCache() {
+		return metadata_cache_.get();
+	}
+
+	// The table listing of schema_name started at attach by prefetch_metadata; an invalid future when
+	// none was started or it was already taken. snapshot_id receives the snapshot id read before the
+	// prefetch listed anything (snapshot_invalidation).
+	std::future<std::vector<PostHogTableInfo>> TakePrefetchedTables(const string &schema_name,
+	                                                                std::optional<int64_t> &snapshot_id);
+
+	// The tables of a remote schema with their Arrow schemas, or with lazy_table_schemas only their
+	// names (one GetTables call without schemas); safe to call from background threads.
+	std::vector<PostHogTableInfo> ListRemoteTables(PostHogFlightClient &client, const string &schema_name) const;
 
 private:
 	void DropSchema(ClientContext &context, DropInfo &info) override;
@@ -98,26 +158,69 @@ private:
 	// Load schemas from remote server (lazy loading)
 	void LoadSchemasIfNeeded();
 
+	// snapshot_invalidation: true when no schema was created or dropped since the snapshot the
+	// cached schema list was loaded at.
+	bool SchemaListUnchanged();
+
+	// Replace the cached schema set with the remote listing. Called with schemas_mutex_ held.
+	void ApplyRemoteSchemas(const std::vector<PostHogDbSchemaInfo> &schema_infos);
+
+	// Open the metadata_cache_dir cache and, when it is current, populate the schema cache from it.
+	// Returns true if the schemas were loaded from disk.
+	bool InitializeMetadataCache();
+	void StoreSchemasInMetadataCache(const std::vector<PostHogDbSchemaInfo> &schema_infos);
+
+	// prefetch_metadata: list the schemas, then the tables of every schema, on background threads.
+	void StartMetadataPrefetch();
+
 	// Create a schema entry for a remote schema
 	void CreateSchemaEntry(const string &schema_name);
 
 	// Get or create a schema entry
 	optional_ptr<PostHogSchemaEntry> GetOrCreateSchema(const string &schema_name);
 
+	// hybrid_dml: names the temporary table a MERGE/UPDATE/DELETE rewrite may put in place of a local table.
+	PostHogHybridDMLSource MakeHybridDMLSource(ClientContext &context);
+
 private:
 	string database_name_;
 	string remote_catalog_; // The remote catalog this instance maps to
 	PostHogConnectionConfig config_;
-	unique_ptr<PostHogFlightClient> flight_client_;
+	// Declared before everything that can hold result batches, so it is destroyed after them.
+	unique_ptr<PostHogMemoryPool> memory_pool_;
+	// Possibly shared with other catalogs (PostHogFlightClientRegistry).
+	std::shared_ptr<PostHogFlightClient> flight_client_;
+	unique_ptr<PostHogMetadataCache> metadata_cache_;
+	unique_ptr<PostHogResultCache> result_cache_;
+	PostHogInterruptMonitor interrupt_monitor_;
 
 	// Schema cache (keyed by schema name only, since this catalog maps to one remote catalog)
 	mutable std::mutex schemas_mutex_;
 	bool schemas_loaded_ = false;
 	std::chrono::steady_clock::time_point schemas_loaded_at_;
 	std::unordered_map<string, unique_ptr<PostHogSchemaEntry>> schema_cache_;
-
-	// Cache TTL (5 minutes by default)
-	static constexpr int64_t CACHE_TTL_SECONDS = 300;
+	// Background ListDbSchemas started when stale_while_revalidate serves an expired cache
+	std::future<std::vector<PostHogDbSchemaInfo>> pending_schemas_;
+	// snapshot_invalidation: snapshot id read before the pending listing; written by the background job
+	// before its result is published, read after taking it.
+	std::optional<int64_t> pending_schemas_snapshot_id_;
+	// snapshot_invalidation: snapshot id read before the cached schema list was loaded.
+	std::optional<int64_t> schemas_snapshot_id_;
+
+	// snapshot_invalidation: the last snapshot id read and the last change set, shared by all schemas.
+	std::mutex snapshot_mutex_;
+	std::optional<int64_t> current_snapshot_id_;
+	std::chrono::steady_clock::time_point snapshot_read_at_;
+	int64_t changes_from_ = 0;
+	int64_t changes_to_ = 0;
+	std::shared_ptr<const PostHogCatalogChanges> changes_;
+
+	// Per-schema table listings registered by the prefetch job, taken by the schema entries.
+	std::mutex prefetch_mutex_;
+	std::unordered_map<string, std::future<std::vector<PostHogTableInfo>>> prefetched_tables_;
+	std::optional<int64_t> prefetch_snapshot_id_;
+	// Declared last, so destruction waits for the prefetch job before the members it fills go away.
+	std::future<void> prefetch_job_;
 };
 
 } // namespace duckdb
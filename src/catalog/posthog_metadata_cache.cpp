@@ -0,0 +1,217 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// catalog/posthog_metadata_cache.cpp
+//
+// Optional on-disk cache of schema/table listings, keyed by DuckLake snapshot
+//===----------------------------------------------------------------------===//
+
+#include "catalog/posthog_metadata_cache.hpp"
+
+#include "utils/connection_string.hpp"
+#include "utils/posthog_file_utils.hpp"
+#include "utils/posthog_logger.hpp"
+
+#include "duckdb/common/types/hash.hpp"
+
+#include <arrow/api.h>
+#include <arrow/io/memory.h>
+#include <arrow/ipc/dictionary.h>
+#include <arrow/ipc/reader.h>
+#include <arrow/ipc/writer.h>
+
+#include <cinttypes>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace duckdb {
+
+namespace {
+
+// Bump when the layout below changes; files with another header are ignored.
+constexpr const char *CACHE_FILE_HEADER = "duckhog-metadata-cache-v2";
+
+string CacheKey(const PostHogConnectionConfig &config, const string &remote_catalog) {
+	return config.flight_server + "\n" + config.user + "\n" + remote_catalog;
+}
+
+void WriteU64(std::ostream &out, uint64_t value) {
+	out.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+void WriteString(std::ostream &out, const std::string &value) {
+	WriteU64(out, value.size());
+	out.write(value.data(), static_cast<std::streamsize>(value.size()));
+}
+
+bool ReadU64(std::istream &in, uint64_t &value) {
+	return static_cast<bool>(in.read(reinterpret_cast<char *>(&value), sizeof(value)));
+}
+
+bool ReadString(std::istream &in, std::string &value) {
+	uint64_t size;
+	// Anything this large is a corrupt file, not a schema name or Arrow schema.
+	if (!ReadU64(in, size) || size > (64ULL << 20)) {
+		return false;
+	}
+	value.resize(size);
+	return static_cast<bool>(in.read(&value[0], static_cast<std::streamsize>(size)));
+}
+
+} // namespace
+
+PostHogMetadataCache::PostHogMetadataCache(const string &dir, const PostHogConnectionConfig &config,
+                                           const string &remote_catalog, int64_t snapshot_id_p)
+    : path_(CachePath(dir, config, remote_catalog)), key_(CacheKey(config, remote_catalog)),
+      snapshot_id_(snapshot_id_p) {
+}
+
+string PostHogMetadataCache::CachePath(const string &dir, const PostHogConnectionConfig &config,
+                                       const string &remote_catalog) {
+	auto key = CacheKey(config, remote_catalog);
+	char name[32];
+	snprintf(name, sizeof(name), "%016" PRIx64 ".cache", static_cast<uint64_t>(Hash(key.c_str())));
+	if (!dir.empty() && dir.back() == '/') {
+		return dir + name;
+	}
+	return dir + "/" + name;
+}
+
+bool PostHogMetadataCache::Load() {
+	std::lock_guard<std::mutex> guard(lock_);
+	std::ifstream in(path_, std::ios::binary);
+	if (!in) {
+		return false;
+	}
+
+	std::string header;
+	std::string key;
+	uint64_t snapshot_id;
+	if (!ReadString(in, header) || header != CACHE_FILE_HEADER || !ReadString(in, key) || !ReadU64(in, snapshot_id)) {
+		POSTHOG_LOG_DEBUG("Metadata cache: ignoring unreadable file %s", path_.c_str());
+		return false;
+	}
+	if (key != key_) {
+		// Another endpoint, user or catalog whose key hashes to the same file name.
+		POSTHOG_LOG_DEBUG("Metadata cache: %s belongs to another catalog", path_.c_str());
+		return false;
+	}
+	if (static_cast<int64_t>(snapshot_id) != snapshot_id_) {
+		POSTHOG_LOG_DEBUG("Metadata cache: %s was written at snapshot %lld, server is at %lld", path_.c_str(),
+		                  static_cast<long long>(snapshot_id), static_cast<long long>(snapshot_id_));
+		return false;
+	}
+
+	uint64_t schema_count;
+	if (!ReadU64(in, schema_count)) {
+		return false;
+	}
+	vector<string> schemas;
+	std::map<string, std::vector<PostHogTableInfo>> tables;
+	for (uint64_t i = 0; i < schema_count; i++) {
+		std::string schema_name;
+		uint64_t has_tables;
+		if (!ReadString(in, schema_name) || !ReadU64(in, has_tables)) {
+			return false;
+		}
+		schemas.push_back(schema_name);
+		if (!has_tables) {
+			continue;
+		}
+		uint64_t table_count;
+		if (!ReadU64(in, table_count)) {
+			return false;
+		}
+		auto &schema_tables = tables[schema_name];
+		for (uint64_t t = 0; t < table_count; t++) {
+			PostHogTableInfo table_info;
+			std::string schema_bytes;
+			if (!ReadString(in, table_info.table_name) || !ReadString(in, schema_bytes)) {
+				return false;
+			}
+			if (!schema_bytes.empty()) {
+				arrow::ipc::DictionaryMemo dict_memo;
+				arrow::io::BufferReader reader(arrow::Buffer::FromString(std::move(schema_bytes)));
+				auto schema_result = arrow::ipc::ReadSchema(&reader, &dict_memo);
+				if (!schema_result.ok()) {
+					return false;
+				}
+				table_info.schema = *schema_result;
+			}
+			schema_tables.push_back(std::move(table_info));
+		}
+	}
+
+	schemas_ = std::move(schemas);
+	tables_ = std::move(tables);
+	POSTHOG_LOG_INFO("Metadata cache: loaded %zu schemas (%zu with tables) at snapshot %lld", schemas_->size(),
+	                 tables_.size(), static_cast<long long>(snapshot_id_));
+	return true;
+}
+
+std::optional<vector<string>> PostHogMetadataCache::GetSchemas() const {
+	std::lock_guard<std::mutex> guard(lock_);
+	return schemas_;
+}
+
+std::optional<std::vector<PostHogTableInfo>> PostHogMetadataCache::TakeTables(const string &schema_name) {
+	std::lock_guard<std::mutex> guard(lock_);
+	auto it = tables_.find(schema_name);
+	if (it == tables_.end() || !taken_.insert(schema_name).second) {
+		return std::nullopt;
+	}
+	return it->second;
+}
+
+void PostHogMetadataCache::StoreSchemas(const vector<string> &schema_names) {
+	std::lock_guard<std::mutex> guard(lock_);
+	schemas_ = schema_names;
+	Write();
+}
+
+void PostHogMetadataCache::StoreTables(const string &schema_name, const std::vector<PostHogTableInfo> &tables) {
+	std::lock_guard<std::mutex> guard(lock_);
+	tables_[schema_name] = tables;
+	taken_.insert(schema_name);
+	Write();
+}
+
+void PostHogMetadataCache::Write() {
+	// Table listings are only useful together with the schema list they belong to.
+	if (!schemas_) {
+		return;
+	}
+	std::ostringstream out(std::ios::binary);
+	WriteString(out, CACHE_FILE_HEADER);
+	WriteString(out, key_);
+	WriteU64(out, static_cast<uint64_t>(snapshot_id_));
+	WriteU64(out, schemas_->size());
+	for (auto &schema_name : *schemas_) {
+		WriteString(out, schema_name);
+		auto it = tables_.find(schema_name);
+		WriteU64(out, it == tables_.end() ? 0 : 1);
+		if (it == tables_.end()) {
+			continue;
+		}
+		WriteU64(out, it->second.size());
+		for (auto &table : it->second) {
+			WriteString(out, table.table_name);
+			std::string schema_bytes;
+			if (table.schema) {
+				auto buffer_result = arrow::ipc::SerializeSchema(*table.schema);
+				if (buffer_result.ok()) {
+					schema_bytes = (*buffer_result)->ToString();
+				}
+			}
+			WriteString(out, schema_bytes);
+		}
+	}
+	// Processes sharing the directory each write their own scratch file and rename it over the
+	// cache, so none ever reads a half-written or interleaved file.
+	if (!PostHogWriteFileAtomically(path_, out.str(), false)) {
+		POSTHOG_LOG_DEBUG("Metadata cache: cannot write %s", path_.c_str());
+	}
+}
+
+} // namespace duckdb
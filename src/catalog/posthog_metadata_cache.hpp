@@ -0,0 +1,68 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// catalog/posthog_metadata_cache.hpp
+//
+// Optional on-disk cache of schema/table listings, keyed by DuckLake snapshot
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb/common/common.hpp"
+#include "flight/flight_client.hpp"
+
+#include <map>
+#include <set>
+#include <mutex>
+#include <optional>
+
+namespace duckdb {
+
+struct PostHogConnectionConfig;
+
+// Persists what a catalog learned about the remote metadata (schema names, and per schema the tables
+// with their Arrow schemas) together with the DuckLake snapshot id it was read at, so that a new
+// process attaching the same catalog starts warm. The cache is only used while the remote snapshot id
+// is unchanged; any write on the server advances the snapshot and the cache then starts over.
+// Every error is swallowed: the cache can only save round trips, never fail an attach.
+class PostHogMetadataCache {
+public:
+	PostHogMetadataCache(const string &dir, const PostHogConnectionConfig &config, const string &remote_catalog,
+	                     int64_t snapshot_id);
+
+	// One cache file per endpoint, user and remote catalog inside dir, named by a hash of that key.
+	static string CachePath(const string &dir, const PostHogConnectionConfig &config, const string &remote_catalog);
+
+	// Reads the cache file. Keeps nothing unless it was written for this cache's full key (not only
+	// one with the same hash) at this cache's snapshot id.
+	bool Load();
+
+	// The DuckLake snapshot id the cached listings are current at.
+	int64_t SnapshotId() const {
+		return snapshot_id_;
+	}
+
+	// Cached listings, if any. Table listings are handed out once, for the first load of a schema.
+	std::optional<vector<string>> GetSchemas() const;
+	std::optional<std::vector<PostHogTableInfo>> TakeTables(const string &schema_name);
+
+	// Record fresh listings and rewrite the cache file.
+	void StoreSchemas(const vector<string> &schema_names);
+	void StoreTables(const string &schema_name, const std::vector<PostHogTableInfo> &tables);
+
+private:
+	// Called with lock_ held.
+	void Write();
+
+	mutable std::mutex lock_;
+	string path_;
+	// Endpoint, user and remote catalog the file belongs to, stored in it.
+	string key_;
+	int64_t snapshot_id_;
+	std::optional<vector<string>> schemas_;
+	std::map<string, std::vector<PostHogTableInfo>> tables_;
+	// Schemas whose cached table listing was already handed out.
+	std::set<string> taken_;
+};
+
+} // namespace duckdb
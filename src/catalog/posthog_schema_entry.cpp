@@ -12,7 +12,9 @@
 #include "catalog/remote_table_function.hpp"
 #include "execution/posthog_dml_rewriter.hpp"
 #include "storage/posthog_transaction.hpp"
+#include "storage/posthog_transaction_manager.hpp"
 #include "utils/posthog_logger.hpp"
+#include "utils/posthog_tracer.hpp"
 #include "duckdb/catalog/catalog.hpp"
 #include "duckdb/catalog/entry_lookup_info.hpp"
 #include "duckdb/common/exception.hpp"
@@ -30,8 +32,8 @@
 
 #include <arrow/c/bridge.h>
 
+#include <algorithm>
 #include <cctype>
-#include <iostream>
 
 namespace duckdb {
 
@@ -233,7 +235,9 @@ optional_ptr<CatalogEntry> PostHogSchemaEntry::CreateTable(CatalogTransaction tr
 	}
 
 	auto &context = transaction.GetContext();
-	auto remote_txn_id = PostHogTransaction::Get(context, posthog_catalog_).remote_txn_id;
+	auto &posthog_transaction = PostHogTransaction::Get(context, posthog_catalog_);
+	posthog_transaction.RecordTableChange(name);
+	auto remote_txn_id = posthog_transaction.RemoteTransactionForWrite();
 
 	const auto &remote_catalog = posthog_catalog_.GetRemoteCatalog();
 	auto copied = info.Base().Copy();
@@ -285,7 +289,9 @@ optional_ptr<CatalogEntry> PostHogSchemaEntry::CreateView(CatalogTransaction tra
 	}
 
 	auto &context = transaction.GetContext();
-	auto remote_txn_id = PostHogTransaction::Get(context, posthog_catalog_).remote_txn_id;
+	auto &posthog_transaction = PostHogTransaction::Get(context, posthog_catalog_);
+	posthog_transaction.RecordTableChange(name);
+	auto remote_txn_id = posthog_transaction.RemoteTransactionForWrite();
 
 	auto sql = BuildRemoteCreateViewSQL(info, posthog_catalog_.GetDatabaseName(), posthog_catalog_.GetRemoteCatalog());
 
@@ -336,7 +342,9 @@ void PostHogSchemaEntry::Alter(CatalogTransaction transaction, AlterInfo &info)
 	}
 
 	auto &context = transaction.GetContext();
-	auto remote_txn_id = PostHogTransaction::Get(context, posthog_catalog_).remote_txn_id;
+	auto &posthog_transaction = PostHogTransaction::Get(context, posthog_catalog_);
+	posthog_transaction.RecordTableChange(name);
+	auto remote_txn_id = posthog_transaction.RemoteTransactionForWrite();
 
 	const auto &remote_catalog = posthog_catalog_.GetRemoteCatalog();
 	auto copied = info.Copy();
@@ -397,7 +405,9 @@ void PostHogSchemaEntry::DropEntry(ClientContext &context, DropInfo &info) {
 		throw NotImplementedException("PostHog: only DROP TABLE and DROP VIEW are supported for remote databases");
 	}
 
-	auto remote_txn_id = PostHogTransaction::Get(context, posthog_catalog_).remote_txn_id;
+	auto &posthog_transaction = PostHogTransaction::Get(context, posthog_catalog_);
+	posthog_transaction.RecordTableChange(name);
+	auto remote_txn_id = posthog_transaction.RemoteTransactionForWrite();
 
 	const auto &remote_catalog = posthog_catalog_.GetRemoteCatalog();
 	auto copied = info.Copy();
@@ -422,69 +432,189 @@ void PostHogSchemaEntry::LoadTablesIfNeeded(ClientContext &context) {
 	// Note: This method is called while holding tables_mutex_ from the caller
 	// or should be called with the lock already held
 	auto op_started_at = SteadyClock::now();
+	const auto &config = posthog_catalog_.GetConfig();
+
+	auto metadata_cache = posthog_catalog_.GetMetadataCache();
+
+	// First load with a current on-disk cache: build entries from it without any RPC.
+	if (!tables_loaded_ && metadata_cache) {
+		auto cached_tables = metadata_cache->TakeTables(name);
+		if (cached_tables) {
+			POSTHOG_LOG_DEBUG("Schema '%s': %zu tables from the metadata cache", name.c_str(), cached_tables->size());
+			ApplyRemoteTables(context, std::move(*cached_tables));
+			if (config.snapshot_invalidation) {
+				tables_snapshot_id_ = metadata_cache->SnapshotId();
+			}
+			return;
+		}
+	}
+
+	// First load after an attach with prefetch_metadata: adopt this schema's listing, which may be in flight.
+	if (!tables_loaded_ && !pending_tables_.valid()) {
+		pending_tables_ = posthog_catalog_.TakePrefetchedTables(name, pending_tables_snapshot_id_);
+	}
+
+	// A background listing finished, or nothing is cached yet and one is in flight: build entries from its
+	// result, waiting for it in the latter case rather than issuing a second call.
+	if (pending_tables_.valid() &&
+	    (!tables_loaded_ || pending_tables_.wait_for(std::chrono::seconds(0)) == std::future_status::ready)) {
+		try {
+			auto tables = pending_tables_.get();
+			// Name-only listings would leave processes without lazy_table_schemas fetching every schema.
+			if (metadata_cache && !config.lazy_table_schemas) {
+				metadata_cache->StoreTables(name, tables);
+			}
+			ApplyRemoteTables(context, std::move(tables));
+			tables_snapshot_id_ = pending_tables_snapshot_id_;
+			return;
+		} catch (const std::exception &e) {
+			POSTHOG_LOG_WARN("Background table listing failed for schema '%s': %s", name.c_str(), e.what());
+			if (tables_loaded_) {
+				// Keep serving the stale tables; the next expired lookup retries.
+				return;
+			}
+		}
+	}
 
 	// Check if cache is still valid
 	if (tables_loaded_) {
 		auto now = std::chrono::steady_clock::now();
 		auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - tables_loaded_at_).count();
-		if (elapsed < CACHE_TTL_SECONDS) {
+		if (elapsed < static_cast<int64_t>(config.metadata_cache_ttl)) {
 			return; // Cache is still valid
 		}
+		if (config.snapshot_invalidation && RevalidateTables(context)) {
+			tables_loaded_at_ = now;
+			return;
+		}
+		if (config.stale_while_revalidate && posthog_catalog_.IsConnected()) {
+			// Serve the expired tables and refresh off the query's critical path. Only the RPC runs
+			// in the background; entries are built by the next lookup, which has a ClientContext.
+			if (!pending_tables_.valid()) {
+				POSTHOG_LOG_DEBUG("Schema '%s': table cache expired, refreshing in the background", name.c_str());
+				auto &client = posthog_catalog_.GetFlightClient();
+				auto &catalog = posthog_catalog_;
+				pending_tables_ = std::async(std::launch::async, [this, &catalog, &client, schema_name = name]() {
+					pending_tables_snapshot_id_ = catalog.GetConfig().snapshot_invalidation
+					                                  ? catalog.CurrentSnapshotId()
+					                                  : std::optional<int64_t>();
+					return catalog.ListRemoteTables(client, schema_name);
+				});
+			}
+			return;
+		}
 		// Cache expired, need to refresh
-		std::cerr << "[PostHog] Table cache expired for schema " << name << ", refreshing..." << '\n';
+		POSTHOG_LOG_DEBUG("Schema '%s': table cache expired, refreshing", name.c_str());
 	}
 
 	if (!posthog_catalog_.IsConnected()) {
-		std::cerr << "[PostHog] Cannot load tables: not connected" << '\n';
+		POSTHOG_LOG_WARN("Schema '%s': cannot load tables, not connected", name.c_str());
 		return;
 	}
 
 	try {
+		PostHogTraceScope trace("LoadTables", name);
 		const auto &remote_catalog = posthog_catalog_.GetRemoteCatalog();
-		std::cerr << "[PostHog] Loading tables for catalog." << remote_catalog << ".schema." << name << '\n';
+		POSTHOG_LOG_DEBUG("Schema '%s': loading tables of catalog '%s'", name.c_str(), remote_catalog.c_str());
+		// Read first: the listing is then at least as recent as the snapshot it is recorded with.
+		std::optional<int64_t> snapshot_id;
+		if (config.snapshot_invalidation) {
+			snapshot_id = posthog_catalog_.CurrentSnapshotId();
+		}
 		auto &client = posthog_catalog_.GetFlightClient();
 		auto list_tables_started_at = SteadyClock::now();
-		auto table_names = client.ListTables(remote_catalog, name);
-		POSTHOG_LOG_DEBUG("Schema '%s': ListTables returned %zu tables in %lld ms", name.c_str(), table_names.size(),
+		auto tables = posthog_catalog_.ListRemoteTables(client, name);
+		POSTHOG_LOG_DEBUG("Schema '%s': listing returned %zu tables in %lld ms", name.c_str(), tables.size(),
 		                  static_cast<long long>(ElapsedMillis(list_tables_started_at)));
 
-		unordered_set<string> remote_tables;
-		remote_tables.reserve(table_names.size());
-		for (const auto &t : table_names) {
-			remote_tables.insert(t);
+		if (metadata_cache && !config.lazy_table_schemas) {
+			metadata_cache->StoreTables(name, tables);
 		}
+		ApplyRemoteTables(context, std::move(tables));
+		tables_snapshot_id_ = snapshot_id;
+		POSTHOG_LOG_DEBUG("Schema '%s': table load complete (cached=%zu total_ms=%lld)", name.c_str(),
+		                  table_cache_.size(), static_cast<long long>(ElapsedMillis(op_started_at)));
 
-		// Prune tables that no longer exist remotely.
-		for (auto it = table_cache_.begin(); it != table_cache_.end();) {
-			if (remote_tables.find(it->first) == remote_tables.end()) {
-				it = table_cache_.erase(it);
-				continue;
-			}
-			++it;
+	} catch (const std::exception &e) {
+		POSTHOG_LOG_WARN("Schema '%s': failed to load tables: %s", name.c_str(), e.what());
+		if (IsConnectionFailureMessage(e.what())) {
+			throw CatalogException("PostHog: Not connected to remote server.");
 		}
+	}
+}
 
-		// Create entries for tables not already in cache
-		size_t created_count = 0;
-		for (const auto &table_name : table_names) {
-			if (table_cache_.find(table_name) == table_cache_.end()) {
-				POSTHOG_LOG_DEBUG("Schema '%s': hydrating table '%s'", name.c_str(), table_name.c_str());
+bool PostHogSchemaEntry::RevalidateTables(ClientContext &context) {
+	// Note: Called with tables_mutex_ already held
+	auto snapshot_id = posthog_catalog_.CurrentSnapshotId();
+	if (!snapshot_id || !tables_snapshot_id_) {
+		return false;
+	}
+	if (*snapshot_id != *tables_snapshot_id_) {
+		auto changes = posthog_catalog_.ReadCatalogChanges(*tables_snapshot_id_, *snapshot_id);
+		if (!changes) {
+			return false;
+		}
+		auto changed = changes->tables.find(name);
+		if (changed != changes->tables.end()) {
+			POSTHOG_LOG_DEBUG("Schema '%s': rebuilding %zu changed table entries", name.c_str(),
+			                  changed->second.size());
+			for (auto &table_name : changed->second) {
+				// Dropped tables are not found again; created and altered ones get their current columns.
+				table_cache_.erase(table_name);
 				CreateTableEntry(context, table_name);
-				created_count++;
 			}
 		}
+		tables_snapshot_id_ = snapshot_id;
+	}
+	return true;
+}
 
-		tables_loaded_ = true;
-		tables_loaded_at_ = std::chrono::steady_clock::now();
-		std::cerr << "[PostHog] Loaded " << table_names.size() << " tables for schema " << name << '\n';
-		POSTHOG_LOG_DEBUG("Schema '%s': table load complete (created=%zu cached=%zu total_ms=%lld)", name.c_str(),
-		                  created_count, table_cache_.size(), static_cast<long long>(ElapsedMillis(op_started_at)));
+void PostHogSchemaEntry::ApplyRemoteTables(ClientContext &context, std::vector<PostHogTableInfo> tables) {
+	// Note: Called with tables_mutex_ already held
+	FreeResolvedEntries();
+	unordered_set<string> remote_tables;
+	remote_tables.reserve(tables.size());
+	for (const auto &t : tables) {
+		remote_tables.insert(t.table_name);
+	}
 
-	} catch (const std::exception &e) {
-		std::cerr << "[PostHog] Failed to load tables for schema " << name << ": " << e.what() << '\n';
-		if (IsConnectionFailureMessage(e.what())) {
-			throw CatalogException("PostHog: Not connected to remote server.");
+	// Prune tables that no longer exist remotely.
+	for (auto it = table_cache_.begin(); it != table_cache_.end();) {
+		if (remote_tables.find(it->first) == remote_tables.end()) {
+			it = table_cache_.erase(it);
+			continue;
+		}
+		++it;
+	}
+
+	// Create entries for tables not already in cache, from the schemas of the same response.
+	// Only tables the server sent without a schema cost an extra GetTableSchema call, unless
+	// lazy_table_schemas defers it until the table is bound.
+	size_t created_count = 0;
+	bool lazy = posthog_catalog_.GetConfig().lazy_table_schemas;
+	for (auto &table : tables) {
+		if (table_cache_.find(table.table_name) == table_cache_.end()) {
+			POSTHOG_LOG_DEBUG("Schema '%s': hydrating table '%s'", name.c_str(), table.table_name.c_str());
+			if (!table.schema && lazy) {
+				CreateUnresolvedTableEntry(table.table_name);
+			} else if (!table.schema) {
+				CreateTableEntry(context, table.table_name);
+			} else {
+				try {
+					CreateTableEntryFromSchema(context, table.table_name, std::move(table.schema));
+				} catch (const std::exception &e) {
+					POSTHOG_LOG_DEBUG("Table metadata hydration skipped for '%s.%s': %s", name.c_str(),
+					                  table.table_name.c_str(), e.what());
+				}
+			}
+			created_count++;
 		}
 	}
+
+	tables_loaded_ = true;
+	tables_loaded_at_ = std::chrono::steady_clock::now();
+	POSTHOG_LOG_DEBUG("Schema '%s': loaded %zu tables, created %zu table entries", name.c_str(), tables.size(),
+	                  created_count);
 }
 
 void PostHogSchemaEntry::CreateTableEntry(ClientContext &context, const string &table_name) {
@@ -509,18 +639,7 @@ void PostHogSchemaEntry::CreateTableEntry(ClientContext &context, const string &
 		POSTHOG_LOG_DEBUG("Schema '%s': GetTableSchema('%s') completed in %lld ms", name.c_str(), table_name.c_str(),
 		                  static_cast<long long>(ElapsedMillis(schema_started_at)));
 
-		vector<string> column_names;
-		vector<LogicalType> column_types;
-		PopulateTableSchemaFromArrow(context, arrow_schema, column_names, column_types);
-
-		auto create_info = make_uniq<CreateTableInfo>(*this, table_name);
-		for (idx_t i = 0; i < column_names.size(); i++) {
-			create_info->columns.AddColumn(ColumnDefinition(column_names[i], column_types[i]));
-		}
-		create_info->columns.Finalize();
-
-		auto table_entry = make_uniq<PostHogTableEntry>(catalog, *this, *create_info, posthog_catalog_, arrow_schema);
-		table_cache_.emplace(table_name, std::move(table_entry));
+		CreateTableEntryFromSchema(context, table_name, std::move(arrow_schema));
 		POSTHOG_LOG_DEBUG("Schema '%s': CreateTableEntry done table='%s' total_ms=%lld", name.c_str(),
 		                  table_name.c_str(), static_cast<long long>(ElapsedMillis(op_started_at)));
 	} catch (const std::exception &e) {
@@ -532,10 +651,46 @@ void PostHogSchemaEntry::CreateTableEntry(ClientContext &context, const string &
 	}
 }
 
+void PostHogSchemaEntry::CreateTableEntryFromSchema(ClientContext &context, const string &table_name,
+                                                    std::shared_ptr<arrow::Schema> arrow_schema) {
+	// Note: Called with tables_mutex_ already held
+	vector<string> column_names;
+	vector<LogicalType> column_types;
+	PopulateTableSchemaFromArrow(context, arrow_schema, column_names, column_types);
+
+	auto create_info = make_uniq<CreateTableInfo>(*this, table_name);
+	for (idx_t i = 0; i < column_names.size(); i++) {
+		create_info->columns.AddColumn(ColumnDefinition(column_names[i], column_types[i]));
+	}
+	create_info->columns.Finalize();
+
+	auto table_entry =
+	    make_uniq<PostHogTableEntry>(catalog, *this, *create_info, posthog_catalog_, std::move(arrow_schema));
+	table_cache_.emplace(table_name, std::move(table_entry));
+}
+
+void PostHogSchemaEntry::CreateUnresolvedTableEntry(const string &table_name) {
+	// Note: Called with tables_mutex_ already held
+	auto create_info = make_uniq<CreateTableInfo>(*this, table_name);
+	create_info->columns.Finalize();
+	auto table_entry = make_uniq<PostHogTableEntry>(catalog, *this, *create_info, posthog_catalog_, nullptr);
+	table_cache_.emplace(table_name, std::move(table_entry));
+}
+
 optional_ptr<PostHogTableEntry> PostHogSchemaEntry::GetOrCreateTable(ClientContext &context, const string &table_name) {
 	// Note: Called with tables_mutex_ already held
 
 	auto it = table_cache_.find(table_name);
+	if (it != table_cache_.end() && !it->second->IsResolved()) {
+		// Bound for the first time: fetch its schema. A concurrent catalog scan may still hold the
+		// unresolved entry, so it is kept alive rather than destroyed.
+		POSTHOG_LOG_DEBUG("Schema '%s': resolving table '%s'", name.c_str(), table_name.c_str());
+		FreeResolvedEntries();
+		auto &manager = posthog_catalog_.GetAttached().GetTransactionManager().Cast<PostHogTransactionManager>();
+		resolved_entries_.emplace_back(manager.CurrentSequence(), std::move(it->second));
+		table_cache_.erase(it);
+		it = table_cache_.end();
+	}
 	if (it != table_cache_.end()) {
 		return it->second.get();
 	}
@@ -554,6 +709,20 @@ optional_ptr<PostHogTableEntry> PostHogSchemaEntry::GetOrCreateTable(ClientConte
 	return nullptr;
 }
 
+void PostHogSchemaEntry::FreeResolvedEntries() {
+	// Note: Called with tables_mutex_ already held
+	if (resolved_entries_.empty()) {
+		return;
+	}
+	auto &manager = posthog_catalog_.GetAttached().GetTransactionManager().Cast<PostHogTransactionManager>();
+	auto oldest = manager.OldestSequence();
+	auto freed = std::remove_if(resolved_entries_.begin(), resolved_entries_.end(),
+	                            [&](const std::pair<uint64_t, unique_ptr<PostHogTableEntry>> &resolved) {
+		                            return resolved.first <= oldest;
+	                            });
+	resolved_entries_.erase(freed, resolved_entries_.end());
+}
+
 void PostHogSchemaEntry::RefreshTables() {
 	std::lock_guard<std::mutex> lock(tables_mutex_);
 	tables_loaded_ = false;
@@ -10,10 +10,15 @@
 
 #include "duckdb/catalog/catalog_entry/schema_catalog_entry.hpp"
 #include "duckdb/catalog/catalog_entry/table_function_catalog_entry.hpp"
+#include "flight/flight_client.hpp"
 
 #include <unordered_map>
 #include <mutex>
 #include <chrono>
+#include <future>
+#include <memory>
+#include <optional>
+#include <vector>
 
 namespace duckdb {
 
@@ -74,12 +79,30 @@ private:
 	// Load tables from remote server (lazy loading)
 	void LoadTablesIfNeeded(ClientContext &context);
 
+	// snapshot_invalidation: rebuild the entries of the tables changed since the snapshot the cached tables
+	// were loaded at. False when that cannot be told and the whole listing must be reloaded.
+	bool RevalidateTables(ClientContext &context);
+
+	// Replace the cached table set with a remote listing
+	void ApplyRemoteTables(ClientContext &context, std::vector<PostHogTableInfo> tables);
+
 	// Create a table entry for a remote table
 	void CreateTableEntry(ClientContext &context, const string &table_name);
 
-	// Get or create a table entry
+	// Create a table entry from an Arrow schema the server already sent
+	void CreateTableEntryFromSchema(ClientContext &context, const string &table_name,
+	                                std::shared_ptr<arrow::Schema> arrow_schema);
+
+	// lazy_table_schemas: create an entry without columns for a table listed by name only. It serves
+	// catalog scans (SHOW TABLES, duckdb_tables()) and is resolved by GetOrCreateTable once bound.
+	void CreateUnresolvedTableEntry(const string &table_name);
+
+	// Get or create a table entry, resolving an unresolved one
 	optional_ptr<PostHogTableEntry> GetOrCreateTable(ClientContext &context, const string &table_name);
 
+	// Free the resolved_entries_ no running transaction can reference anymore. Called with tables_mutex_ held.
+	void FreeResolvedEntries();
+
 	PostHogCatalog &posthog_catalog_;
 
 	// Table cache (using simple map instead of CatalogSet for simplicity)
@@ -87,12 +110,19 @@ private:
 	bool tables_loaded_ = false;
 	std::chrono::steady_clock::time_point tables_loaded_at_;
 	std::unordered_map<string, unique_ptr<PostHogTableEntry>> table_cache_;
+	// Unresolved entries replaced by their resolved ones, with the transaction sequence they were
+	// replaced at: kept until every transaction that could have looked them up has ended.
+	std::vector<std::pair<uint64_t, unique_ptr<PostHogTableEntry>>> resolved_entries_;
+	// Background listing started when stale_while_revalidate serves an expired cache
+	std::future<std::vector<PostHogTableInfo>> pending_tables_;
+	// snapshot_invalidation: snapshot id read before the pending listing; written by the background
+	// listing before its result is published, read after taking it.
+	std::optional<int64_t> pending_tables_snapshot_id_;
+	// snapshot_invalidation: snapshot id read before the cached tables were listed.
+	std::optional<int64_t> tables_snapshot_id_;
 
 	// Table function proxy cache (e.g. snapshots(), table_insertions())
 	std::unordered_map<string, unique_ptr<TableFunctionCatalogEntry>> table_function_cache_;
-
-	// Cache TTL (5 minutes by default)
-	static constexpr int64_t CACHE_TTL_SECONDS = 300;
 };
 
 } // namespace duckdb
@@ -32,9 +32,37 @@ PostHogTableEntry::PostHogTableEntry(Catalog &catalog, SchemaCatalogEntry &schem
 
 PostHogTableEntry::~PostHogTableEntry() = default;
 
+const PostHogTableStatistics &PostHogTableEntry::GetTableStatistics(ClientContext &context) {
+	auto now = std::chrono::steady_clock::now();
+	if (statistics_loaded_) {
+		auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - statistics_loaded_at_).count();
+		if (elapsed < static_cast<int64_t>(posthog_catalog_.GetConfig().metadata_cache_ttl)) {
+			return statistics_;
+		}
+	}
+	// Failures are cached as unknown statistics too, so an unreachable metadata catalog costs one
+	// round trip per TTL rather than one per planned query.
+	statistics_ = PostHogTableStatistics::Fetch(context, posthog_catalog_, schema_name_, name, columns);
+	statistics_loaded_ = true;
+	statistics_loaded_at_ = now;
+	return statistics_;
+}
+
 unique_ptr<BaseStatistics> PostHogTableEntry::GetStatistics(ClientContext &context, column_t column_id) {
-	// No statistics available for remote tables
-	return nullptr;
+	if (IsVirtualColumn(column_id)) {
+		return nullptr;
+	}
+	std::lock_guard<std::mutex> lock(statistics_mutex_);
+	auto &statistics = GetTableStatistics(context);
+	if (column_id >= statistics.columns.size() || !statistics.columns[column_id]) {
+		return nullptr;
+	}
+	return statistics.columns[column_id]->ToUnique();
+}
+
+optional_idx PostHogTableEntry::GetEstimatedCardinality(ClientContext &context) {
+	std::lock_guard<std::mutex> lock(statistics_mutex_);
+	return GetTableStatistics(context).row_count;
 }
 
 TableFunction PostHogTableEntry::GetScanFunction(ClientContext &context, unique_ptr<FunctionData> &bind_data) {
@@ -84,8 +112,14 @@ TableFunction PostHogTableEntry::GetScanFunction(ClientContext &context, unique_
 
 TableStorageInfo PostHogTableEntry::GetStorageInfo(ClientContext &context) {
 	TableStorageInfo info;
-	// Remote tables - we don't have local storage info
-	info.cardinality = 0; // Unknown
+	if (!IsResolved()) {
+		// Listing an unresolved table (duckdb_tables()) must not cost a statistics query per table.
+		info.cardinality = 0;
+		return info;
+	}
+	// No local storage; the row count comes from the remote DuckLake statistics when available
+	auto cardinality = GetEstimatedCardinality(context);
+	info.cardinality = cardinality.IsValid() ? cardinality.GetIndex() : 0;
 	return info;
 }
 
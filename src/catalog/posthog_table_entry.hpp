@@ -8,10 +8,14 @@
 
 #pragma once
 
+#include "catalog/posthog_table_statistics.hpp"
+
 #include "duckdb/catalog/catalog_entry/table_catalog_entry.hpp"
 #include "duckdb/storage/data_table.hpp"
 
+#include <chrono>
 #include <memory>
+#include <mutex>
 
 namespace arrow {
 class Schema;
@@ -69,10 +73,28 @@ public:
 		return arrow_schema_;
 	}
 
+	// False for the column-less entries lazy_table_schemas lists tables with until they are bound.
+	bool IsResolved() const {
+		return arrow_schema_ != nullptr;
+	}
+
+	// Estimated row count from the remote DuckLake statistics; invalid when unknown.
+	optional_idx GetEstimatedCardinality(ClientContext &context);
+
 private:
+	// Fetches the remote statistics on first use and again once they are older than the
+	// attach's metadata_cache_ttl.
+	// Callers must hold statistics_mutex_.
+	const PostHogTableStatistics &GetTableStatistics(ClientContext &context);
+
 	PostHogCatalog &posthog_catalog_;
 	string schema_name_;
 	std::shared_ptr<arrow::Schema> arrow_schema_;
+
+	std::mutex statistics_mutex_;
+	bool statistics_loaded_ = false;
+	std::chrono::steady_clock::time_point statistics_loaded_at_;
+	PostHogTableStatistics statistics_;
 };
 
 } // namespace duckdb
@@ -0,0 +1,110 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// catalog/posthog_table_statistics.cpp
+//
+// Table and column statistics read from the remote DuckLake metadata catalog
+//===----------------------------------------------------------------------===//
+
+#include "catalog/posthog_table_statistics.hpp"
+
+#include "catalog/posthog_catalog.hpp"
+#include "execution/posthog_sql_utils.hpp"
+#include "flight/query_result_reader.hpp"
+#include "utils/posthog_logger.hpp"
+
+#include "duckdb/common/case_insensitive_map.hpp"
+#include "duckdb/parser/column_list.hpp"
+#include "duckdb/storage/statistics/numeric_stats.hpp"
+
+namespace duckdb {
+
+namespace {
+
+// DuckLake stores min/max as text; only types whose statistics carry min/max are filled in.
+void SetMinMax(BaseStatistics &stats, const LogicalType &type, const Value &min_text, const Value &max_text) {
+	if (stats.GetStatsType() != StatisticsType::NUMERIC_STATS || min_text.IsNull() || max_text.IsNull()) {
+		return;
+	}
+	Value min_value;
+	Value max_value;
+	string error;
+	if (!min_text.DefaultTryCastAs(type, min_value, &error) || !max_text.DefaultTryCastAs(type, max_value, &error)) {
+		return;
+	}
+	NumericStats::SetMin(stats, min_value);
+	NumericStats::SetMax(stats, max_value);
+}
+
+string BuildStatisticsQuery(const string &remote_catalog, const string &schema_name, const string &table_name) {
+	// DuckLake attaches its metadata catalog as __ducklake_metadata_<catalog name>.
+	auto meta = QuoteIdent("__ducklake_metadata_" + remote_catalog);
+	return "SELECT c.column_name, ts.record_count, cs.contains_null, cs.min_value, cs.max_value FROM " + meta +
+	       ".ducklake_table t JOIN " + meta +
+	       ".ducklake_schema s ON s.schema_id = t.schema_id AND s.end_snapshot IS NULL LEFT JOIN " + meta +
+	       ".ducklake_table_stats ts ON ts.table_id = t.table_id LEFT JOIN " + meta +
+	       ".ducklake_column c ON c.table_id = t.table_id AND c.end_snapshot IS NULL AND c.parent_column IS NULL "
+	       "LEFT JOIN " +
+	       meta +
+	       ".ducklake_table_column_stats cs ON cs.table_id = t.table_id AND cs.column_id = c.column_id "
+	       "WHERE t.end_snapshot IS NULL AND s.schema_name = " +
+	       Value(schema_name).ToSQLString() + " AND t.table_name = " + Value(table_name).ToSQLString();
+}
+
+} // namespace
+
+PostHogTableStatistics PostHogTableStatistics::Fetch(ClientContext &context, PostHogCatalog &catalog,
+                                                     const string &schema_name, const string &table_name,
+                                                     const ColumnList &columns) {
+	PostHogTableStatistics result;
+	result.columns.resize(columns.LogicalColumnCount());
+	const auto &remote_catalog = catalog.GetRemoteCatalog();
+	if (remote_catalog.empty()) {
+		return result;
+	}
+
+	case_insensitive_map_t<idx_t> column_index;
+	for (auto &column : columns.Logical()) {
+		column_index[column.Name()] = column.Logical().index;
+	}
+
+	try {
+		PostHogQueryResultReader reader(
+		    context, catalog, BuildStatisticsQuery(remote_catalog, schema_name, table_name), std::nullopt,
+		    {LogicalType::VARCHAR, LogicalType::BIGINT, LogicalType::BOOLEAN, LogicalType::VARCHAR, LogicalType::VARCHAR});
+		DataChunk chunk;
+		chunk.Initialize(context, {LogicalType::VARCHAR, LogicalType::BIGINT, LogicalType::BOOLEAN,
+		                           LogicalType::VARCHAR, LogicalType::VARCHAR});
+		while (reader.Next(chunk)) {
+			for (idx_t row = 0; row < chunk.size(); row++) {
+				auto record_count = chunk.GetValue(1, row);
+				if (!record_count.IsNull() && record_count.GetValue<int64_t>() >= 0) {
+					result.row_count = NumericCast<idx_t>(record_count.GetValue<int64_t>());
+				}
+				auto column_name = chunk.GetValue(0, row);
+				if (column_name.IsNull()) {
+					continue;
+				}
+				auto it = column_index.find(column_name.ToString());
+				if (it == column_index.end()) {
+					continue;
+				}
+				auto &type = columns.GetColumn(LogicalIndex(it->second)).Type();
+				auto stats = BaseStatistics::CreateUnknown(type).ToUnique();
+				auto contains_null = chunk.GetValue(2, row);
+				if (!contains_null.IsNull() && !contains_null.GetValue<bool>()) {
+					stats->SetHasNoNull();
+				}
+				SetMinMax(*stats, type, chunk.GetValue(3, row), chunk.GetValue(4, row));
+				result.columns[it->second] = std::move(stats);
+			}
+		}
+	} catch (const std::exception &e) {
+		POSTHOG_LOG_DEBUG("Statistics unavailable for '%s.%s': %s", schema_name.c_str(), table_name.c_str(),
+		                  e.what());
+		return PostHogTableStatistics {optional_idx(), vector<unique_ptr<BaseStatistics>>(columns.LogicalColumnCount())};
+	}
+	return result;
+}
+
+} // namespace duckdb
@@ -0,0 +1,34 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// catalog/posthog_table_statistics.hpp
+//
+// Table and column statistics read from the remote DuckLake metadata catalog
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb/common/optional_idx.hpp"
+#include "duckdb/storage/statistics/base_statistics.hpp"
+
+namespace duckdb {
+
+class ClientContext;
+class ColumnList;
+class PostHogCatalog;
+
+struct PostHogTableStatistics {
+	// DuckLake's record count for the table; invalid when unknown.
+	optional_idx row_count;
+	// Per logical column (nullptr when DuckLake has no stats for it): min/max and whether NULLs
+	// may occur.
+	vector<unique_ptr<BaseStatistics>> columns;
+
+	// Reads the statistics of one table with a single remote query against the DuckLake metadata
+	// catalog. Servers without DuckLake metadata (or with the catalog omitted from the attach)
+	// yield empty statistics instead of an error: statistics only ever improve estimates.
+	static PostHogTableStatistics Fetch(ClientContext &context, PostHogCatalog &catalog, const string &schema_name,
+	                                    const string &table_name, const ColumnList &columns);
+};
+
+} // namespace duckdb
@@ -0,0 +1,74 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// catalog/remote_query.cpp
+//
+// Table function streaming the result of a planner-generated remote query
+//===----------------------------------------------------------------------===//
+
+#include "catalog/remote_query.hpp"
+#include "catalog/posthog_catalog.hpp"
+#include "flight/query_result_reader.hpp"
+#include "storage/posthog_transaction.hpp"
+
+#include "duckdb/common/exception.hpp"
+#include "duckdb/main/client_context.hpp"
+
+namespace duckdb {
+
+struct PostHogRemoteQueryGlobalState : public GlobalTableFunctionState {
+	unique_ptr<PostHogQueryResultReader> reader;
+};
+
+PostHogRemoteQueryBindData::PostHogRemoteQueryBindData(PostHogCatalog &catalog_p, string sql_p,
+                                                       vector<LogicalType> types_p, vector<string> names_p)
+    : catalog(catalog_p), sql(std::move(sql_p)), types(std::move(types_p)), names(std::move(names_p)) {
+}
+
+unique_ptr<FunctionData> PostHogRemoteQuery::Bind(ClientContext &context, TableFunctionBindInput &input,
+                                                  vector<LogicalType> &return_types, vector<string> &names) {
+	// Only ever created by the PostHog optimizer, which supplies the bind data directly.
+	throw NotImplementedException("PostHog remote_query should not be called directly");
+}
+
+unique_ptr<GlobalTableFunctionState> PostHogRemoteQuery::InitGlobal(ClientContext &context,
+                                                                    TableFunctionInitInput &input) {
+	auto &bind_data = input.bind_data->Cast<PostHogRemoteQueryBindData>();
+
+	auto &transaction = PostHogTransaction::Get(context, bind_data.catalog);
+	auto remote_txn_id = transaction.RemoteTransactionForRead(bind_data.shared_snapshot);
+
+	auto result = make_uniq<PostHogRemoteQueryGlobalState>();
+	result->reader = make_uniq<PostHogQueryResultReader>(context, bind_data.catalog, bind_data.sql,
+	                                                     std::move(remote_txn_id), bind_data.types);
+	return std::move(result);
+}
+
+void PostHogRemoteQuery::Execute(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
+	auto &state = data.global_state->Cast<PostHogRemoteQueryGlobalState>();
+	state.reader->Next(output);
+}
+
+InsertionOrderPreservingMap<string> PostHogRemoteQuery::ToString(TableFunctionToStringInput &input) {
+	InsertionOrderPreservingMap<string> result;
+	auto &bind_data = input.bind_data->Cast<PostHogRemoteQueryBindData>();
+	result["Remote SQL"] = bind_data.sql;
+	return result;
+}
+
+InsertionOrderPreservingMap<string> PostHogRemoteQuery::DynamicToString(TableFunctionDynamicToStringInput &input) {
+	InsertionOrderPreservingMap<string> result;
+	if (input.global_state) {
+		input.global_state->Cast<PostHogRemoteQueryGlobalState>().reader->GetStream().AddExplainInfo(result);
+	}
+	return result;
+}
+
+TableFunction PostHogRemoteQuery::GetFunction() {
+	TableFunction func(NAME, {}, Execute, Bind, InitGlobal);
+	func.to_string = ToString;
+	func.dynamic_to_string = DynamicToString;
+	return func;
+}
+
+} // namespace duckdb
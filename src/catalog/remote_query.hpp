@@ -0,0 +1,51 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// catalog/remote_query.hpp
+//
+// Table function streaming the result of a planner-generated remote query
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb/function/table_function.hpp"
+
+namespace duckdb {
+
+class PostHogCatalog;
+
+// Bind data of posthog_remote_query: a complete remote SELECT (built by the PostHog optimizer
+// pushdowns) and the DuckDB types its result columns are converted to.
+struct PostHogRemoteQueryBindData : public TableFunctionData {
+	PostHogRemoteQueryBindData(PostHogCatalog &catalog, string sql, vector<LogicalType> types, vector<string> names);
+
+	PostHogCatalog &catalog;
+	string sql;
+	vector<LogicalType> types;
+	vector<string> names;
+	// Set by the PostHog optimizer when the plan reads the catalog more than once, see
+	// PostHogRemoteScanBindData::shared_snapshot.
+	bool shared_snapshot = false;
+};
+
+class PostHogRemoteQuery {
+public:
+	static TableFunction GetFunction();
+
+	// Name of the table function, used to recognize pushed-down scans in plans.
+	static constexpr const char *NAME = "posthog_remote_query";
+
+private:
+	static unique_ptr<FunctionData> Bind(ClientContext &context, TableFunctionBindInput &input,
+	                                     vector<LogicalType> &return_types, vector<string> &names);
+
+	static unique_ptr<GlobalTableFunctionState> InitGlobal(ClientContext &context, TableFunctionInitInput &input);
+
+	static void Execute(ClientContext &context, TableFunctionInput &data, DataChunk &output);
+
+	static InsertionOrderPreservingMap<string> ToString(TableFunctionToStringInput &input);
+
+	static InsertionOrderPreservingMap<string> DynamicToString(TableFunctionDynamicToStringInput &input);
+};
+
+} // namespace duckdb
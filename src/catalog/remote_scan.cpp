@@ -9,25 +9,176 @@
 #include "catalog/remote_scan.hpp"
 #include "catalog/posthog_catalog.hpp"
 #include "catalog/posthog_table_entry.hpp"
+#include "catalog/remote_scan_merge.hpp"
+#include "catalog/remote_scan_sharing.hpp"
+#include "catalog/remote_scan_splits.hpp"
+#include "execution/posthog_sql_utils.hpp"
 #include "storage/posthog_transaction.hpp"
 
 #include "duckdb/common/exception.hpp"
+#include "duckdb/common/string_util.hpp"
 #include "duckdb/function/table/arrow.hpp"
 #include "duckdb/function/table_function.hpp"
 #include "duckdb/main/client_context.hpp"
 #include "duckdb/main/database.hpp"
 #include "duckdb/main/config.hpp"
+#include "duckdb/planner/operator/logical_get.hpp"
+#include "duckdb/transaction/meta_transaction.hpp"
 
 #include <arrow/c/bridge.h>
 
+#include <algorithm>
 #include <cstring>
+#include <future>
 
 namespace duckdb {
 
 struct PostHogRemoteScanGlobalState : public ArrowScanGlobalState {
 	std::unique_ptr<PostHogRemoteScanStreamFactory> stream_factory;
+	// True when the result spans several unordered endpoints: every thread then drains its
+	// own forked reader instead of contending on the single shared stream.
+	bool parallel_endpoints = false;
+	// Set with parallel_endpoints when the stream is deferred (dynamic filters), so its endpoints are
+	// only known once it opens: the first InitLocal opens and reads it, and sets deferred_parallel when
+	// later threads should fork it. Guarded by main_mutex.
+	bool deferred_endpoints = false;
+	bool deferred_parallel = false;
+	// True when the scan was split into several remote queries (scan_splits): every thread claims
+	// the next unread split and streams it on its own reader.
+	bool parallel_splits = false;
+	// Each split's query is built when it is claimed, so it includes dynamic filters filled in since.
+	ArrowStreamParameters split_parameters;
+	string split_at_clause;
+	vector<string> split_conditions;
+	std::unordered_map<idx_t, string> split_filter_sql;
+	// Guarded by main_mutex: the next split to claim, and the streams opened for splits so far.
+	idx_t next_split = 0;
+	vector<std::shared_ptr<PostHogArrowStreamState>> split_states;
+	// Set for ordered scans (PostHogRemoteScanBindData::orders), which run on one thread: reads the
+	// scan's sorted streams, split queries or endpoints, and emits their rows in order.
+	unique_ptr<PostHogScanMerge> merge;
 };
 
+struct PostHogRemoteScanLocalState : public ArrowScanLocalState {
+	PostHogRemoteScanLocalState(unique_ptr<ArrowArrayWrapper> current_chunk, ClientContext &context)
+	    : ArrowScanLocalState(std::move(current_chunk), context) {
+	}
+
+	// Thread-private reader over the shared endpoint cursor (parallel_endpoints), or over the split
+	// the thread claimed last (parallel_splits).
+	unique_ptr<ArrowArrayStreamWrapper> endpoint_stream;
+};
+
+namespace {
+
+// Endpoint-parallel counterpart of ArrowTableFunction::ArrowScanParallelStateNext: pulls
+// from the thread's own reader, so only the batch index bump needs the global lock.
+bool EndpointStreamNext(PostHogRemoteScanGlobalState &global_state, PostHogRemoteScanLocalState &state) {
+	state.Reset();
+	{
+		lock_guard<mutex> parallel_lock(global_state.main_mutex);
+		state.batch_index = ++global_state.batch_index;
+	}
+	auto current_chunk = state.endpoint_stream->GetNextChunk();
+	while (current_chunk->arrow_array.length == 0 && current_chunk->arrow_array.release) {
+		current_chunk = state.endpoint_stream->GetNextChunk();
+	}
+	state.chunk = std::move(current_chunk);
+	return state.chunk->arrow_array.release != nullptr;
+}
+
+// Split counterpart of EndpointStreamNext: once the thread's split is drained, it claims the next
+// one and opens its query.
+bool SplitStreamNext(PostHogRemoteScanGlobalState &global_state, PostHogRemoteScanLocalState &state) {
+	state.Reset();
+	{
+		lock_guard<mutex> parallel_lock(global_state.main_mutex);
+		state.batch_index = ++global_state.batch_index;
+	}
+	auto &factory = *global_state.stream_factory;
+	while (true) {
+		if (state.endpoint_stream) {
+			auto current_chunk = state.endpoint_stream->GetNextChunk();
+			while (current_chunk->arrow_array.length == 0 && current_chunk->arrow_array.release) {
+				current_chunk = state.endpoint_stream->GetNextChunk();
+			}
+			if (current_chunk->arrow_array.release) {
+				state.chunk = std::move(current_chunk);
+				return true;
+			}
+			state.endpoint_stream.reset();
+		}
+		string condition;
+		{
+			lock_guard<mutex> parallel_lock(global_state.main_mutex);
+			if (global_state.next_split >= global_state.split_conditions.size()) {
+				state.chunk = make_uniq<ArrowArrayWrapper>();
+				return false;
+			}
+			condition = global_state.split_conditions[global_state.next_split++];
+		}
+		auto query = PostHogArrowStream::BuildQuery(*factory.bind_data, global_state.split_parameters,
+		                                            global_state.split_at_clause, condition,
+		                                            global_state.split_filter_sql);
+		auto stream_state = std::make_shared<PostHogArrowStreamState>(factory.bind_data->catalog, std::move(query),
+		                                                              factory.txn_id, factory.stop_token);
+		stream_state->expected_types = factory.expected_types;
+		{
+			lock_guard<mutex> parallel_lock(global_state.main_mutex);
+			global_state.split_states.push_back(stream_state);
+		}
+		state.endpoint_stream = PostHogArrowStream::Wrap(std::move(stream_state));
+	}
+}
+
+// Opens the queries of every split of an ordered scan at once, so the server sorts them concurrently.
+vector<std::shared_ptr<PostHogArrowStreamState>> OpenSplitStreams(PostHogRemoteScanGlobalState &global_state) {
+	auto &factory = *global_state.stream_factory;
+	vector<std::future<std::shared_ptr<PostHogArrowStreamState>>> opening;
+	for (auto &condition : global_state.split_conditions) {
+		auto query = PostHogArrowStream::BuildQuery(*factory.bind_data, global_state.split_parameters,
+		                                            global_state.split_at_clause, condition,
+		                                            global_state.split_filter_sql);
+		opening.push_back(std::async(std::launch::async, [&factory, query]() {
+			return std::make_shared<PostHogArrowStreamState>(factory.bind_data->catalog, query, factory.txn_id,
+			                                                 factory.stop_token);
+		}));
+	}
+	vector<std::shared_ptr<PostHogArrowStreamState>> streams;
+	for (auto &future : opening) {
+		streams.push_back(future.get());
+		streams.back()->expected_types = factory.expected_types;
+	}
+	lock_guard<mutex> parallel_lock(global_state.main_mutex);
+	global_state.split_states = streams;
+	return streams;
+}
+
+// The scan's one stream, plus a stream pinned to each other endpoint when the server returns the sorted
+// result as several unordered endpoints, each of which is still sorted.
+vector<std::shared_ptr<PostHogArrowStreamState>> OpenEndpointStreams(std::shared_ptr<PostHogArrowStreamState> state) {
+	// Opens the query; a stream that claims an endpoint to read the schema keeps reading only that one.
+	auto schema_result = state->GetSchema();
+	if (!schema_result.ok()) {
+		throw IOException("PostHog: Failed to read remote result: " + schema_result.status().ToString());
+	}
+	vector<std::shared_ptr<PostHogArrowStreamState>> streams {state};
+	auto &query_stream = state->query_stream;
+	if (!query_stream || query_stream->EndpointCount() < 2 || query_stream->IsOrdered()) {
+		return streams;
+	}
+	while (auto endpoint_stream = query_stream->ForkEndpoint()) {
+		streams.push_back(std::make_shared<PostHogArrowStreamState>(state->catalog, state->query, state->txn_id,
+		                                                            std::move(endpoint_stream)));
+		streams.back()->expected_types = state->expected_types;
+	}
+	// The scan's own stream now reads one endpoint at most, which is not the whole result to cache.
+	state->recorded_result.reset();
+	return streams;
+}
+
+} // namespace
+
 //===----------------------------------------------------------------------===//
 // Bind Data
 //===----------------------------------------------------------------------===//
@@ -48,6 +199,52 @@ PostHogRemoteScanBindData::~PostHogRemoteScanBindData() {
 	}
 }
 
+string PostHogRemoteScanBindData::GetRemoteTableRef() const {
+	return GetRemoteTableRef(at_clause_sql);
+}
+
+string PostHogRemoteScanBindData::GetRemoteTableRef(const string &at_clause) const {
+	// If remote_catalog is empty (backward compatibility), fall back to 2-part qualification
+	const auto &remote_catalog = catalog.GetRemoteCatalog();
+	string table_ref;
+	if (remote_catalog.empty()) {
+		table_ref = QuoteIdent(schema_name) + "." + QuoteIdent(table_name);
+	} else {
+		table_ref = QualifyRemoteTableName(remote_catalog, schema_name, table_name);
+	}
+	// Append AT clause if present (e.g. time travel: AT (VERSION => 1))
+	if (!at_clause.empty()) {
+		table_ref += " " + at_clause;
+	}
+	return table_ref;
+}
+
+string PostHogRemoteScanBindData::GetSampleClause() const {
+	if (!sample_options) {
+		return string();
+	}
+	string method;
+	switch (sample_options->method) {
+	case SampleMethod::SYSTEM_SAMPLE:
+		method = "system";
+		break;
+	case SampleMethod::BERNOULLI_SAMPLE:
+		method = "bernoulli";
+		break;
+	case SampleMethod::RESERVOIR_SAMPLE:
+		method = "reservoir";
+		break;
+	default:
+		throw InternalException("PostHog: unsupported sample method for a remote scan");
+	}
+	auto size = sample_options->sample_size.ToString() + (sample_options->is_percentage ? "%" : " ROWS");
+	auto clause = "TABLESAMPLE " + method + "(" + size + ")";
+	if (sample_options->repeatable && sample_options->seed.IsValid()) {
+		clause += " REPEATABLE (" + to_string(sample_options->seed.GetIndex()) + ")";
+	}
+	return clause;
+}
+
 //===----------------------------------------------------------------------===//
 // Bind Function
 //===----------------------------------------------------------------------===//
@@ -68,9 +265,13 @@ unique_ptr<FunctionData> PostHogRemoteScan::CreateBindData(ClientContext &contex
 
 	bind_data->column_names = column_names;
 	bind_data->column_types = column_types;
+	// String columns bound as dictionaries reach DuckDB as DICTIONARY vectors; their logical
+	// type stays VARCHAR.
+	bind_data->arrow_schema =
+	    catalog.GetConfig().dictionary_strings ? DictionaryEncodeStringFields(arrow_schema) : arrow_schema;
 
 	// Export the cached Arrow schema to C ArrowSchema (no Flight RPC).
-	auto status = arrow::ExportSchema(*arrow_schema, &bind_data->schema_root.arrow_schema);
+	auto status = arrow::ExportSchema(*bind_data->arrow_schema, &bind_data->schema_root.arrow_schema);
 	if (!status.ok()) {
 		throw IOException("PostHog: Failed to export cached Arrow schema: " + status.ToString());
 	}
@@ -112,14 +313,14 @@ unique_ptr<GlobalTableFunctionState> PostHogRemoteScan::InitGlobal(ClientContext
                                                                    TableFunctionInitInput &input) {
 	auto &bind_data = input.bind_data->Cast<PostHogRemoteScanBindData>();
 
-	std::optional<TransactionId> remote_txn_id;
-	try {
-		remote_txn_id = PostHogTransaction::Get(context, bind_data.catalog).remote_txn_id;
-	} catch (const std::exception &) {
-		remote_txn_id = std::nullopt;
-	}
+	// Failed deferred writes and a failed remote BEGIN fail the scan rather than letting it read
+	// outside the transaction.
+	auto &transaction = PostHogTransaction::Get(context, bind_data.catalog);
+	auto remote_txn_id = transaction.RemoteTransactionForRead(bind_data.shared_snapshot);
+	auto stop_token = transaction.GetStopToken();
 
 	ArrowStreamParameters parameters;
+	std::vector<std::shared_ptr<arrow::DataType>> expected_types;
 	D_ASSERT(!input.column_ids.empty());
 	auto &arrow_types = bind_data.arrow_table.GetColumns();
 	for (idx_t idx = 0; idx < input.column_ids.size(); idx++) {
@@ -130,17 +331,96 @@ unique_ptr<GlobalTableFunctionState> PostHogRemoteScan::InitGlobal(ClientContext
 			parameters.projected_columns.projection_map[idx] = schema_c.name;
 			parameters.projected_columns.columns.emplace_back(schema_c.name);
 			parameters.projected_columns.filter_to_col[idx] = col_idx;
+			expected_types.push_back(bind_data.arrow_schema->field(NumericCast<int>(col_idx))->type());
 		}
 	}
 	parameters.filters = input.filters.get();
 
 	auto result = make_uniq<PostHogRemoteScanGlobalState>();
 	result->stream_factory = make_uniq<PostHogRemoteScanStreamFactory>();
+	result->stream_factory->expected_types = std::move(expected_types);
 	result->stream_factory->bind_data = &bind_data;
 	result->stream_factory->txn_id = std::move(remote_txn_id);
-	result->stream = bind_data.scanner_producer(reinterpret_cast<uintptr_t>(result->stream_factory.get()), parameters);
-
+	result->stream_factory->stop_token = std::move(stop_token);
+	result->stream_factory->context = &context;
+	auto modified_database = MetaTransaction::Get(context).ModifiedDatabase();
+	auto catalog_modified = modified_database && modified_database.get() == &bind_data.catalog.GetAttached();
+	// A sample without REPEATABLE draws other rows on every run.
+	auto random_sample = bind_data.sample_options && !bind_data.sample_options->repeatable;
+	result->stream_factory->use_result_cache = !catalog_modified && !random_sample;
 	result->max_threads = context.db->NumberOfThreads();
+
+	// Uncommitted writes of this transaction are not in the DuckLake metadata splits are planned from.
+	// Shared scans read their one shared query instead, and a sample is drawn by a single query.
+	auto scan_splits = bind_data.catalog.GetConfig().scan_splits;
+	auto ordered = !bind_data.orders.empty();
+	if (scan_splits > 1 && !catalog_modified && !bind_data.shared_scan && !bind_data.sample_options) {
+		auto plan = PostHogScanSplitPlan::Plan(context, bind_data, parameters, result->stream_factory->txn_id,
+		                                       scan_splits);
+		if (plan.split) {
+			result->split_parameters = parameters;
+			result->split_at_clause = std::move(plan.at_clause_sql);
+			result->split_conditions = std::move(plan.conditions);
+			result->split_filter_sql = PostHogArrowStream::UploadInLists(*result->stream_factory, parameters);
+			// An ordered scan sorts every split on the server and merges them instead.
+			result->parallel_splits = !ordered;
+			auto split_count = result->split_conditions.size();
+			result->max_threads = MaxValue<idx_t>(MinValue<idx_t>(split_count, result->max_threads), 1);
+		}
+	}
+
+	if (ordered) {
+		vector<LogicalType> types;
+		for (auto col_idx : input.column_ids) {
+			types.push_back(bind_data.all_types[col_idx]);
+		}
+		vector<idx_t> key_columns;
+		vector<OrderModifiers> modifiers;
+		for (auto &order : bind_data.orders) {
+			auto it = std::find(input.column_ids.begin(), input.column_ids.end(), order.column);
+			if (it == input.column_ids.end()) {
+				throw InternalException("PostHog: ordered scan does not read its sort column \"%s\"",
+				                        bind_data.column_names[order.column]);
+			}
+			key_columns.push_back(NumericCast<idx_t>(it - input.column_ids.begin()));
+			modifiers.emplace_back(order.type, order.null_order);
+		}
+		PostHogScanMerge::OpenStreams open;
+		if (!result->split_conditions.empty()) {
+			open = [&global_state = *result]() { return OpenSplitStreams(global_state); };
+		} else {
+			// Opened on the first read, like the deferred streams of Produce, so the query includes the
+			// dynamic filters known by then.
+			auto *factory = result->stream_factory.get();
+			auto open_stream = [factory, parameters](PostHogArrowStreamState &state) {
+				PostHogArrowStream::Open(*factory, parameters, state);
+			};
+			auto stream_state = std::make_shared<PostHogArrowStreamState>(bind_data.catalog, std::move(open_stream));
+			stream_state->expected_types = factory->expected_types;
+			factory->stream_state = stream_state;
+			open = [stream_state]() { return OpenEndpointStreams(stream_state); };
+		}
+		result->merge = make_uniq<PostHogScanMerge>(context, std::move(types), std::move(key_columns),
+		                                            std::move(modifiers), std::move(open));
+		result->max_threads = 1;
+	} else if (!result->parallel_splits) {
+		result->stream =
+		    bind_data.scanner_producer(reinterpret_cast<uintptr_t>(result->stream_factory.get()), parameters);
+		auto &stream_state = *result->stream_factory->stream_state;
+		if (!stream_state.opened) {
+			// The endpoint count is not known before the query opens; InitLocal decides.
+			result->parallel_endpoints = true;
+			result->deferred_endpoints = true;
+		} else {
+			// A result cache hit has no query stream and replays on a single thread.
+			auto &query_stream = stream_state.query_stream;
+			auto endpoint_count = query_stream ? query_stream->EndpointCount() : 0;
+			if (endpoint_count > 1 && !query_stream->IsOrdered()) {
+				result->parallel_endpoints = true;
+				result->max_threads = MinValue<idx_t>(endpoint_count, result->max_threads);
+			}
+		}
+	}
 	if (!input.projection_ids.empty()) {
 		result->projection_ids = input.projection_ids;
 		for (const auto &col_idx : input.column_ids) {
@@ -157,7 +437,65 @@ unique_ptr<GlobalTableFunctionState> PostHogRemoteScan::InitGlobal(ClientContext
 unique_ptr<LocalTableFunctionState> PostHogRemoteScan::InitLocal(ExecutionContext &context,
                                                                  TableFunctionInitInput &input,
                                                                  GlobalTableFunctionState *global_state) {
-	return ArrowTableFunction::ArrowScanInitLocal(context, input, global_state);
+	auto &scan_state = global_state->Cast<PostHogRemoteScanGlobalState>();
+	if (!scan_state.parallel_endpoints && !scan_state.parallel_splits && !scan_state.merge) {
+		return ArrowTableFunction::ArrowScanInitLocal(context, input, global_state);
+	}
+
+	// Mirrors ArrowScanInitLocalInternal, but hands the thread its own endpoint or split reader.
+	auto result = make_uniq<PostHogRemoteScanLocalState>(make_uniq<ArrowArrayWrapper>(), context.client);
+	result->column_ids = input.column_ids;
+	result->filters = input.filters.get();
+	if (!input.projection_ids.empty()) {
+		result->all_columns.Initialize(context.client, scan_state.scanned_types);
+	}
+	if (scan_state.merge) {
+		// The merge reads the streams itself.
+		return std::move(result);
+	}
+	if (scan_state.parallel_splits) {
+		if (!SplitStreamNext(scan_state, *result)) {
+			return nullptr;
+		}
+		return std::move(result);
+	}
+	if (scan_state.deferred_endpoints) {
+		std::shared_ptr<PostHogArrowStreamState> fork_from;
+		{
+			lock_guard<mutex> parallel_lock(scan_state.main_mutex);
+			auto &stream_state = scan_state.stream_factory->stream_state;
+			if (scan_state.stream) {
+				// The first thread opens the scan's own stream and reads it. Reading the schema may claim an
+				// endpoint, which that stream then keeps, as in OpenEndpointStreams.
+				auto schema_result = stream_state->GetSchema();
+				if (!schema_result.ok()) {
+					throw IOException("PostHog: Failed to read remote result: " + schema_result.status().ToString());
+				}
+				auto &query_stream = stream_state->query_stream;
+				scan_state.deferred_parallel =
+				    query_stream && query_stream->EndpointCount() > 1 && !query_stream->IsOrdered();
+				if (scan_state.deferred_parallel) {
+					// The scan's own stream now reads only some endpoints, which is not the whole result to cache.
+					stream_state->recorded_result.reset();
+				}
+				result->endpoint_stream = std::move(scan_state.stream);
+			} else if (scan_state.deferred_parallel) {
+				fork_from = stream_state;
+			} else {
+				// One reader, which the first thread already is.
+				return nullptr;
+			}
+		}
+		if (fork_from) {
+			result->endpoint_stream = PostHogArrowStream::Wrap(fork_from->Fork());
+		}
+	} else {
+		result->endpoint_stream = PostHogArrowStream::Wrap(scan_state.stream_factory->stream_state->Fork());
+	}
+	if (!EndpointStreamNext(scan_state, *result)) {
+		return nullptr;
+	}
+	return std::move(result);
 }
 
 //===----------------------------------------------------------------------===//
@@ -165,7 +503,49 @@ unique_ptr<LocalTableFunctionState> PostHogRemoteScan::InitLocal(ExecutionContex
 //===----------------------------------------------------------------------===//
 
 void PostHogRemoteScan::Execute(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
-	ArrowTableFunction::ArrowScanFunction(context, data, output);
+	if (!data.local_state) {
+		return;
+	}
+	auto &global_state = data.global_state->Cast<PostHogRemoteScanGlobalState>();
+	if (!global_state.parallel_endpoints && !global_state.parallel_splits && !global_state.merge) {
+		ArrowTableFunction::ArrowScanFunction(context, data, output);
+		return;
+	}
+
+	auto &bind_data = data.bind_data->CastNoConst<PostHogRemoteScanBindData>();
+	auto &state = data.local_state->Cast<PostHogRemoteScanLocalState>();
+	if (global_state.merge) {
+		if (global_state.CanRemoveFilterColumns()) {
+			global_state.merge->Next(state.all_columns);
+			output.ReferenceColumns(state.all_columns, global_state.projection_ids);
+		} else {
+			global_state.merge->Next(output);
+		}
+		bind_data.lines_read.fetch_add(output.size());
+		output.Verify();
+		return;
+	}
+	if (state.chunk_offset >= NumericCast<idx_t>(state.chunk->arrow_array.length)) {
+		auto has_chunk = global_state.parallel_splits ? SplitStreamNext(global_state, state)
+		                                              : EndpointStreamNext(global_state, state);
+		if (!has_chunk) {
+			return;
+		}
+	}
+	auto output_size =
+	    MinValue<idx_t>(STANDARD_VECTOR_SIZE, NumericCast<idx_t>(state.chunk->arrow_array.length) - state.chunk_offset);
+	auto start = bind_data.lines_read.fetch_add(output_size);
+	if (global_state.CanRemoveFilterColumns()) {
+		state.all_columns.Reset();
+		state.all_columns.SetCardinality(output_size);
+		ArrowTableFunction::ArrowToDuckDB(state, bind_data.arrow_table.GetColumns(), state.all_columns, start);
+		output.ReferenceColumns(state.all_columns, global_state.projection_ids);
+	} else {
+		output.SetCardinality(output_size);
+		ArrowTableFunction::ArrowToDuckDB(state, bind_data.arrow_table.GetColumns(), output, start);
+	}
+	output.Verify();
+	state.chunk_offset += output.size();
 }
 
 //===----------------------------------------------------------------------===//
@@ -174,10 +554,60 @@ void PostHogRemoteScan::Execute(ClientContext &context, TableFunctionInput &data
 
 double PostHogRemoteScan::Progress(ClientContext &context, const FunctionData *bind_data,
                                    const GlobalTableFunctionState *global_state) {
-	(void)context;
-	(void)bind_data;
-	(void)global_state;
-	return 0.0;
+	if (!global_state) {
+		return -1;
+	}
+	auto &state = global_state->Cast<PostHogRemoteScanGlobalState>();
+	auto percentage = [](int64_t done, int64_t total) {
+		return MinValue<double>(100.0, 100.0 * static_cast<double>(done) / static_cast<double>(total));
+	};
+	auto &scan_data = bind_data->Cast<PostHogRemoteScanBindData>();
+	if (!state.split_conditions.empty()) {
+		// Splits open their queries one after another, so only the rows scanned so far are known: those
+		// this execution's split streams read.
+		auto cardinality = scan_data.table.GetEstimatedCardinality(context);
+		if (!cardinality.IsValid() || cardinality.GetIndex() == 0) {
+			return -1;
+		}
+		int64_t rows = 0;
+		{
+			// Locking does not modify the state, but ArrowScanGlobalState's mutex is not mutable.
+			lock_guard<mutex> parallel_lock(const_cast<PostHogRemoteScanGlobalState &>(state).main_mutex);
+			for (auto &split_state : state.split_states) {
+				rows += split_state->query_stream->RecordsRead();
+			}
+		}
+		return percentage(rows, NumericCast<int64_t>(cardinality.GetIndex()));
+	}
+	if (!state.stream_factory || !state.stream_factory->stream_state || !state.stream_factory->stream_state->opened ||
+	    !state.stream_factory->stream_state->query_stream) {
+		return -1;
+	}
+	auto &query_stream = *state.stream_factory->stream_state->query_stream;
+
+	// Prefer the exact size the server announced in the FlightInfo.
+	auto total_records = query_stream.TotalRecords();
+	if (total_records > 0) {
+		return percentage(query_stream.RecordsRead(), total_records);
+	}
+	auto total_bytes = query_stream.TotalBytes();
+	if (total_bytes > 0) {
+		return percentage(query_stream.BytesRead(), total_bytes);
+	}
+	if (total_records == 0 || total_bytes == 0) {
+		return 100.0;
+	}
+
+	// Fall back to the table's row count from the remote statistics. Remote filters only make
+	// the result smaller, so this under-reports rather than overshoots.
+	if (!scan_data.at_clause_sql.empty()) {
+		return -1;
+	}
+	auto cardinality = scan_data.table.GetEstimatedCardinality(context);
+	if (!cardinality.IsValid() || cardinality.GetIndex() == 0) {
+		return -1;
+	}
+	return percentage(query_stream.RecordsRead(), NumericCast<int64_t>(cardinality.GetIndex()));
 }
 
 BindInfo PostHogRemoteScan::GetBindInfo(const optional_ptr<FunctionData> bind_data) {
@@ -185,6 +615,109 @@ BindInfo PostHogRemoteScan::GetBindInfo(const optional_ptr<FunctionData> bind_da
 	return BindInfo(scan_data.table);
 }
 
+unique_ptr<NodeStatistics> PostHogRemoteScan::Cardinality(ClientContext &context, const FunctionData *bind_data) {
+	auto &scan_data = bind_data->Cast<PostHogRemoteScanBindData>();
+	// Time-travel scans read another snapshot; the current record count would be misleading.
+	if (!scan_data.at_clause_sql.empty()) {
+		return nullptr;
+	}
+	auto cardinality = scan_data.table.GetEstimatedCardinality(context);
+	if (!cardinality.IsValid()) {
+		return nullptr;
+	}
+	return make_uniq<NodeStatistics>(cardinality.GetIndex(), cardinality.GetIndex());
+}
+
+//===----------------------------------------------------------------------===//
+// EXPLAIN
+//===----------------------------------------------------------------------===//
+
+void PostHogRemoteScan::SetExplainSQL(LogicalGet &get) {
+	auto &bind_data = get.bind_data->Cast<PostHogRemoteScanBindData>();
+	// The parameters InitGlobal hands to Produce, except that the logical plan still keys its
+	// table filters by table column rather than by position in the column ids.
+	ArrowStreamParameters parameters;
+	for (auto &column : get.GetColumnIds()) {
+		auto col_idx = column.GetPrimaryIndex();
+		if (col_idx >= bind_data.column_names.size()) {
+			continue;
+		}
+		parameters.projected_columns.columns.emplace_back(bind_data.column_names[col_idx]);
+		parameters.projected_columns.filter_to_col[col_idx] = col_idx;
+	}
+	if (bind_data.shared_scan) {
+		// The shared query reads the columns of every scan sharing it.
+		parameters.projected_columns.columns.clear();
+		for (auto col_idx : bind_data.shared_scan->ColumnIds()) {
+			parameters.projected_columns.columns.emplace_back(bind_data.column_names[col_idx]);
+		}
+	}
+	parameters.filters = &get.table_filters;
+	try {
+		bind_data.explain_sql = PostHogArrowStream::BuildQuery(bind_data, parameters);
+	} catch (const NotImplementedException &) {
+		// Produce raises the unsupported filter when the scan runs; EXPLAIN shows the table only.
+		bind_data.explain_sql.clear();
+	}
+}
+
+InsertionOrderPreservingMap<string> PostHogRemoteScan::ToString(TableFunctionToStringInput &input) {
+	InsertionOrderPreservingMap<string> result;
+	auto &bind_data = input.bind_data->Cast<PostHogRemoteScanBindData>();
+	if (bind_data.explain_sql.empty()) {
+		result["Remote Table"] = bind_data.GetRemoteTableRef();
+	} else {
+		result["Remote Scan"] = bind_data.explain_sql;
+	}
+	if (bind_data.shared_scan) {
+		result["Shared Scan"] = to_string(bind_data.shared_scan->ScanCount()) + " scans";
+	}
+	return result;
+}
+
+InsertionOrderPreservingMap<string> PostHogRemoteScan::DynamicToString(TableFunctionDynamicToStringInput &input) {
+	InsertionOrderPreservingMap<string> result;
+	if (!input.global_state) {
+		return result;
+	}
+	auto &state = input.global_state->Cast<PostHogRemoteScanGlobalState>();
+	if (state.merge && state.merge->StreamCount() > 1) {
+		result["Remote Merge"] = to_string(state.merge->StreamCount()) + " streams";
+	}
+	if (!state.split_conditions.empty()) {
+		// Every split runs the first opened one's SELECT with another condition.
+		lock_guard<mutex> parallel_lock(state.main_mutex);
+		if (!state.split_states.empty()) {
+			result["Remote Scan"] = state.split_states[0]->query;
+		}
+		result["Remote Splits"] = to_string(state.split_conditions.size());
+		int64_t rows = 0;
+		int64_t bytes = 0;
+		int64_t batches = 0;
+		int64_t remote_us = 0;
+		for (auto &split_state : state.split_states) {
+			rows += split_state->query_stream->RecordsRead();
+			bytes += split_state->query_stream->BytesRead();
+			batches += split_state->query_stream->BatchesRead();
+			remote_us = MaxValue<int64_t>(remote_us, split_state->query_stream->RemoteMicros());
+		}
+		result["Remote Time"] = FormatRemoteMillis(remote_us);
+		result["Remote Rows"] = to_string(rows);
+		result["Remote Bytes"] = StringUtil::BytesToHumanReadableString(NumericCast<idx_t>(bytes));
+		result["Remote Batches"] = to_string(batches);
+		return result;
+	}
+	if (!state.stream_factory || !state.stream_factory->stream_state || !state.stream_factory->stream_state->opened) {
+		return result;
+	}
+	// The query that actually ran, which EXPLAIN ANALYZE shows in place of the planned one. Unlike
+	// "Remote SQL" of pushed-down operators, this is the scan's own projected SELECT.
+	auto &stream_state = *state.stream_factory->stream_state;
+	result["Remote Scan"] = stream_state.query;
+	stream_state.AddExplainInfo(result);
+	return result;
+}
+
 //===----------------------------------------------------------------------===//
 // Get Table Function
 //===----------------------------------------------------------------------===//
@@ -204,6 +737,9 @@ TableFunction PostHogRemoteScan::GetFunction() {
 	func.filter_pushdown = true;
 	func.table_scan_progress = Progress;
 	func.get_bind_info = GetBindInfo;
+	func.cardinality = Cardinality;
+	func.to_string = ToString;
+	func.dynamic_to_string = DynamicToString;
 	return func;
 }
 
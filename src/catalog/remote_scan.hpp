@@ -8,12 +8,16 @@
 
 #pragma once
 
+#include "duckdb/common/enums/order_type.hpp"
 #include "duckdb/function/table/arrow.hpp"
 #include "duckdb/function/table_function.hpp"
+#include "duckdb/parser/parsed_data/sample_options.hpp"
+#include "execution/posthog_temp_table.hpp"
 #include "flight/arrow_stream.hpp"
 
 #include <memory>
 #include <optional>
+#include <vector>
 
 namespace arrow {
 class Schema;
@@ -21,13 +25,23 @@ class Schema;
 
 namespace duckdb {
 
+class LogicalGet;
 class PostHogCatalog;
+class PostHogSharedScan;
 class PostHogTableEntry;
 
 //===----------------------------------------------------------------------===//
 // Remote Scan Bind Data
 //===----------------------------------------------------------------------===//
 
+// One sort key of an ordered scan: a table column and its direction.
+struct PostHogScanOrder {
+	idx_t column;
+	OrderType type;
+	OrderByNullType null_order;
+};
+
+
 struct PostHogRemoteScanBindData : public ArrowScanFunctionData {
 	PostHogRemoteScanBindData(PostHogCatalog &catalog, PostHogTableEntry &table, const string &schema_name,
 	                          const string &table_name);
@@ -41,10 +55,46 @@ struct PostHogRemoteScanBindData : public ArrowScanFunctionData {
 	// Column information (populated during bind)
 	vector<string> column_names;
 	vector<LogicalType> column_types;
+	// Arrow schema the scan is bound to: the table's cached schema, with string columns
+	// dictionary-encoded under dictionary_strings.
+	std::shared_ptr<arrow::Schema> arrow_schema;
 
 	// Optional AT clause SQL fragment, e.g. "AT (VERSION => 1)"
 	string at_clause_sql;
 
+	// Remote WHERE conjuncts rendered by the PostHog optimizer from filter expressions that DuckDB
+	// could not hand to the scan as TableFilters (function calls, LIKE, cross-column comparisons).
+	vector<string> pushed_conditions;
+
+	// USING SAMPLE / TABLESAMPLE the PostHog optimizer took over from a sample directly above the scan.
+	// The remote SELECT samples the table before its WHERE clause, as DuckDB plans it locally.
+	unique_ptr<SampleOptions> sample_options;
+
+	// ORDER BY the PostHog optimizer took over from a sort above the scan. The remote SELECT sorts by
+	// these keys, and the scan emits its rows in that order on one thread, merging the sorted streams of
+	// its splits or endpoints (PostHogScanMerge).
+	vector<PostHogScanOrder> orders;
+
+	// Remote SELECT shown by EXPLAIN, rendered by the PostHog optimizer from the final projection
+	// and filters; empty until then. The scan itself builds its query in PostHogArrowStream::Produce.
+	string explain_sql;
+
+	// Set by the PostHog optimizer when other scans of the plan read the same rows of this table
+	// (shared_scan_bytes); the scans then read one shared remote query of all their columns.
+	std::shared_ptr<PostHogSharedScan> shared_scan;
+
+	// Set by the PostHog optimizer when the plan reads this catalog more than once: the scan then reads
+	// in a remote transaction in auto-commit mode too, see PostHogTransaction::RemoteTransactionForRead.
+	bool shared_snapshot = false;
+
+	// Remote table reference for generated SQL: "catalog"."schema"."table" [AT (...)].
+	string GetRemoteTableRef() const;
+	// The same with at_clause in place of at_clause_sql.
+	string GetRemoteTableRef(const string &at_clause) const;
+	// TABLESAMPLE clause of sample_options, e.g. "TABLESAMPLE bernoulli(1.0%) REPEATABLE (42)"; empty
+	// without a sample.
+	string GetSampleClause() const;
+
 	// Patched C ArrowSchema child name pointers.  Each entry records the child
 	// schema, the original name pointer (owned by Arrow's private data), and the
 	// strdup'd replacement.  The destructor restores originals before the base
@@ -58,10 +108,23 @@ struct PostHogRemoteScanBindData : public ArrowScanFunctionData {
 };
 
 // Per-execution stream factory passed to PostHogArrowStream::Produce.
-// Owns the transaction id captured during InitGlobal.
+// Owns the transaction id captured during InitGlobal; Produce records the stream
+// state it opened so InitLocal can fork per-thread endpoint readers from it.
 struct PostHogRemoteScanStreamFactory {
 	const PostHogRemoteScanBindData *bind_data;
 	std::optional<TransactionId> txn_id;
+	arrow::StopToken stop_token = arrow::StopToken::Unstoppable();
+	// False once this transaction wrote to the catalog: its uncommitted changes are not part of
+	// any snapshot, so cached results could be stale.
+	bool use_result_cache = false;
+	// Bound Arrow types of the projected columns, which every batch is conformed to.
+	std::vector<std::shared_ptr<arrow::DataType>> expected_types;
+	std::shared_ptr<PostHogArrowStreamState> stream_state;
+	// The scan's query, for uploading IN-list filters when a deferred stream opens.
+	ClientContext *context = nullptr;
+	// Temporary tables holding the values of IN-list filters (in_list_upload_threshold) the scan's
+	// remote queries semi-join against.
+	vector<unique_ptr<PostHogRemoteTempTable>> uploaded_in_lists;
 };
 
 //===----------------------------------------------------------------------===//
@@ -80,6 +143,9 @@ public:
 	                                               const vector<LogicalType> &column_types,
 	                                               const std::shared_ptr<arrow::Schema> &arrow_schema);
 
+	// Sets the explain_sql of a posthog_remote_scan get to the query its scan will send.
+	static void SetExplainSQL(LogicalGet &get);
+
 private:
 	// Table function callbacks
 	static unique_ptr<FunctionData> Bind(ClientContext &context, TableFunctionBindInput &input,
@@ -96,6 +162,12 @@ private:
 	                       const GlobalTableFunctionState *global_state);
 
 	static BindInfo GetBindInfo(const optional_ptr<FunctionData> bind_data);
+
+	static unique_ptr<NodeStatistics> Cardinality(ClientContext &context, const FunctionData *bind_data);
+
+	static InsertionOrderPreservingMap<string> ToString(TableFunctionToStringInput &input);
+
+	static InsertionOrderPreservingMap<string> DynamicToString(TableFunctionDynamicToStringInput &input);
 };
 
 } // namespace duckdb
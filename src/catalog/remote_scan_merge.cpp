@@ -0,0 +1,140 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// catalog/remote_scan_merge.cpp
+//
+// Streaming k-way merge of the sorted remote streams of an ordered table scan
+//===----------------------------------------------------------------------===//
+
+#include "catalog/remote_scan_merge.hpp"
+
+#include "flight/arrow_stream.hpp"
+#include "utils/arrow_chunk_converter.hpp"
+
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/operator/comparison_operators.hpp"
+#include "duckdb/common/vector_operations/vector_operations.hpp"
+
+namespace duckdb {
+
+struct PostHogScanMerge::Input {
+	std::shared_ptr<PostHogArrowStreamState> stream;
+	unique_ptr<PostHogArrowChunkConverter> converter;
+	// The rows converted last, their sort keys, and the first of them not yet merged.
+	DataChunk rows;
+	unique_ptr<Vector> keys;
+	idx_t offset = 0;
+	bool finished = false;
+
+	string_t KeyAt(idx_t row) const {
+		return FlatVector::GetData<string_t>(*keys)[row];
+	}
+};
+
+PostHogScanMerge::PostHogScanMerge(ClientContext &context, vector<LogicalType> types, vector<idx_t> key_columns,
+                                   vector<OrderModifiers> modifiers, OpenStreams open)
+    : context_(context), types_(std::move(types)), key_columns_(std::move(key_columns)),
+      modifiers_(std::move(modifiers)), open_(std::move(open)) {
+	D_ASSERT(key_columns_.size() == modifiers_.size());
+	for (auto column : key_columns_) {
+		key_types_.push_back(types_[column]);
+	}
+}
+
+PostHogScanMerge::~PostHogScanMerge() {
+}
+
+void PostHogScanMerge::Load(Input &input) {
+	input.offset = 0;
+	input.rows.Reset();
+	while (!input.converter || !input.converter->HasRows()) {
+		auto chunk_result = input.stream->Next();
+		if (!chunk_result.ok()) {
+			throw IOException("PostHog: Failed to read remote result: " + chunk_result.status().ToString());
+		}
+		auto &batch = chunk_result->data;
+		if (!batch) {
+			input.finished = true;
+			return;
+		}
+		if (!input.converter) {
+			input.converter = make_uniq<PostHogArrowChunkConverter>(context_, batch->schema(), types_);
+		}
+		input.converter->SetBatch(batch);
+	}
+	input.converter->Convert(input.rows);
+	if (inputs_.size() < 2) {
+		// A single stream is already in order.
+		return;
+	}
+	DataChunk key_chunk;
+	key_chunk.InitializeEmpty(key_types_);
+	for (idx_t i = 0; i < key_columns_.size(); i++) {
+		key_chunk.data[i].Reference(input.rows.data[key_columns_[i]]);
+	}
+	key_chunk.SetCardinality(input.rows.size());
+	input.keys = make_uniq<Vector>(LogicalType::BLOB, input.rows.size());
+	CreateSortKeyHelpers::CreateSortKey(key_chunk, modifiers_, *input.keys);
+}
+
+void PostHogScanMerge::Next(DataChunk &output) {
+	output.Reset();
+	if (!opened_) {
+		opened_ = true;
+		for (auto &stream : open_()) {
+			auto input = make_uniq<Input>();
+			input->stream = std::move(stream);
+			input->rows.Initialize(context_, types_);
+			inputs_.push_back(std::move(input));
+		}
+		stream_count_ = inputs_.size();
+		for (auto &input : inputs_) {
+			Load(*input);
+		}
+	}
+
+	idx_t count = 0;
+	while (count < STANDARD_VECTOR_SIZE) {
+		// The stream with the smallest next row, and the smallest next row of all the others.
+		optional_ptr<Input> smallest;
+		optional_ptr<Input> runner_up;
+		for (auto &input : inputs_) {
+			if (input->finished) {
+				continue;
+			}
+			if (!smallest || (input->keys && LessThan::Operation(input->KeyAt(input->offset),
+			                                                     smallest->KeyAt(smallest->offset)))) {
+				runner_up = smallest;
+				smallest = input.get();
+			} else if (!runner_up ||
+			           LessThan::Operation(input->KeyAt(input->offset), runner_up->KeyAt(runner_up->offset))) {
+				runner_up = input.get();
+			}
+		}
+		if (!smallest) {
+			break;
+		}
+		// Copy the run of rows of that stream that sort before every other stream's next row.
+		auto &input = *smallest;
+		auto end = MinValue<idx_t>(input.rows.size(), input.offset + STANDARD_VECTOR_SIZE - count);
+		if (runner_up) {
+			auto bound = runner_up->KeyAt(runner_up->offset);
+			auto run_end = input.offset + 1;
+			while (run_end < end && !LessThan::Operation(bound, input.KeyAt(run_end))) {
+				run_end++;
+			}
+			end = run_end;
+		}
+		for (idx_t col = 0; col < types_.size(); col++) {
+			VectorOperations::Copy(input.rows.data[col], output.data[col], end, input.offset, count);
+		}
+		count += end - input.offset;
+		input.offset = end;
+		if (input.offset >= input.rows.size()) {
+			Load(input);
+		}
+	}
+	output.SetCardinality(count);
+}
+
+} // namespace duckdb
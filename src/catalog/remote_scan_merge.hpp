@@ -0,0 +1,65 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// catalog/remote_scan_merge.hpp
+//
+// Streaming k-way merge of the sorted remote streams of an ordered table scan
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb/common/types/data_chunk.hpp"
+#include "duckdb/function/create_sort_key.hpp"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace duckdb {
+
+class ClientContext;
+struct PostHogArrowStreamState;
+
+// Rows of an ordered posthog_remote_scan (one whose ORDER BY the PostHog optimizer pushed into its
+// remote SELECT) arrive as one or more streams that are each sorted: the queries of its splits
+// (scan_splits), or the endpoints of a result the server returns unordered. The merge reads them all
+// and emits their rows in order, one DataChunk at a time.
+class PostHogScanMerge {
+public:
+	using OpenStreams = std::function<std::vector<std::shared_ptr<PostHogArrowStreamState>>()>;
+
+	// types: the scanned columns of every stream; key_columns and modifiers: the sort keys, as
+	// positions in types. open runs on the first Next(), so the streams see the dynamic filters filled
+	// in by then.
+	PostHogScanMerge(ClientContext &context, vector<LogicalType> types, vector<idx_t> key_columns,
+	                 vector<OrderModifiers> modifiers, OpenStreams open);
+	~PostHogScanMerge();
+
+	// Fills output, initialized with the scanned types, with the next rows in order; leaves it empty
+	// at the end.
+	void Next(DataChunk &output);
+
+	// Number of streams merged; 0 until the first Next().
+	idx_t StreamCount() const {
+		return stream_count_.load();
+	}
+
+private:
+	struct Input;
+
+	// Converts the next rows of input and computes their sort keys; marks it finished at its end.
+	void Load(Input &input);
+
+	ClientContext &context_;
+	vector<LogicalType> types_;
+	vector<idx_t> key_columns_;
+	vector<LogicalType> key_types_;
+	vector<OrderModifiers> modifiers_;
+	OpenStreams open_;
+	vector<unique_ptr<Input>> inputs_;
+	bool opened_ = false;
+	std::atomic<idx_t> stream_count_ {0};
+};
+
+} // namespace duckdb
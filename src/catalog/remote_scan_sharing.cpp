@@ -0,0 +1,344 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// catalog/remote_scan_sharing.cpp
+//
+// Identical remote table scans of one query fanned out from a single remote query
+//===----------------------------------------------------------------------===//
+
+#include "catalog/remote_scan_sharing.hpp"
+
+#include "catalog/posthog_catalog.hpp"
+#include "catalog/remote_scan.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/main/client_context.hpp"
+#include "duckdb/transaction/transaction_context.hpp"
+#include "execution/posthog_sql_utils.hpp"
+#include "flight/arrow_stream.hpp"
+
+#include <arrow/util/byte_size.h>
+
+#include <algorithm>
+#include <deque>
+
+namespace duckdb {
+
+struct PostHogSharedScanRun {
+	enum class SlotState : uint8_t {
+		// Not started reading; every buffered batch is kept for it.
+		PENDING,
+		READING,
+		DONE,
+		// Reads its own query; dropped when the buffer outgrew buffer_bytes before it started.
+		DETACHED,
+		// Was reading, but held back more than buffer_bytes of batches; re-runs the shared query.
+		DROPPED
+	};
+
+	PostHogSharedScanRun(vector<idx_t> column_ids_p, idx_t scan_count, size_t buffer_bytes_p)
+	    : column_ids(std::move(column_ids_p)), buffer_bytes(buffer_bytes_p), slots(scan_count, SlotState::PENDING),
+	      cursors(scan_count, 0) {
+	}
+
+	// Builds the shared query from the columns of all scans and the filters of the first one to read: the
+	// optimizer only groups scans whose filters are equal but for dynamic filters, which every scan's
+	// join or Top-N still applies, so the shared query leaves them out.
+	void Open(PostHogRemoteScanStreamFactory &factory, const ArrowStreamParameters &parameters);
+	// The next batch for slot; null at the end, or with dropped set once the slot was dropped.
+	arrow::Result<std::shared_ptr<arrow::RecordBatch>> Read(idx_t slot, bool &dropped);
+	// Detaches the scans that have not started, then drops the scans furthest behind reading_slot,
+	// until the buffer fits buffer_bytes again. lock must be held.
+	void EnforceBudget(idx_t reading_slot);
+	// Drops the batches every scan still reading has passed. lock must be held.
+	void Trim();
+
+	const vector<idx_t> column_ids;
+	const size_t buffer_bytes;
+
+	// Guards everything below but the source, which fetch_lock serializes.
+	std::mutex lock;
+	idx_t attached = 0;
+	vector<SlotState> slots;
+	// Index of the next batch each scan reads.
+	vector<size_t> cursors;
+	std::deque<std::pair<std::shared_ptr<arrow::RecordBatch>, size_t>> batches;
+	// Index of batches.front() among all batches of the run.
+	size_t first_batch = 0;
+	size_t buffered_bytes = 0;
+	bool finished = false;
+	arrow::Status error;
+
+	std::mutex fetch_lock;
+	// Own the filters of the shared query and the IN lists it semi-joins against.
+	TableFilterSet filters;
+	unique_ptr<PostHogRemoteScanStreamFactory> factory;
+	std::shared_ptr<PostHogArrowStreamState> source;
+	// Columns of the shared query, in the order of its batches.
+	vector<string> columns;
+};
+
+void PostHogSharedScanRun::Open(PostHogRemoteScanStreamFactory &scan_factory, const ArrowStreamParameters &parameters) {
+	auto &bind_data = *scan_factory.bind_data;
+	auto shared_factory = make_uniq<PostHogRemoteScanStreamFactory>();
+	shared_factory->bind_data = scan_factory.bind_data;
+	shared_factory->txn_id = scan_factory.txn_id;
+	shared_factory->stop_token = scan_factory.stop_token;
+	shared_factory->use_result_cache = scan_factory.use_result_cache;
+	shared_factory->context = scan_factory.context;
+
+	ArrowStreamParameters shared_parameters;
+	shared_parameters.projected_columns.filter_to_col = parameters.projected_columns.filter_to_col;
+	if (parameters.filters) {
+		for (auto &entry : parameters.filters->filters) {
+			auto filter = WithoutDynamicFilters(*entry.second);
+			if (filter) {
+				filters.filters.emplace(entry.first, std::move(filter));
+			}
+		}
+	}
+	shared_parameters.filters = &filters;
+	for (auto col_idx : column_ids) {
+		shared_parameters.projected_columns.columns.emplace_back(bind_data.column_names[col_idx]);
+	}
+	// A dropped scan re-runs the query and skips the rows it already returned, so every run must
+	// return the same rows in the same order: the server keeps the order of a SELECT without ORDER BY,
+	// and outside a remote transaction the query is pinned to the current snapshot.
+	string at_clause;
+	if (!shared_factory->txn_id.has_value() && bind_data.at_clause_sql.empty()) {
+		auto snapshot_id = bind_data.catalog.ReadSnapshotId();
+		if (snapshot_id.has_value()) {
+			at_clause = "AT (VERSION => " + to_string(*snapshot_id) + ")";
+		}
+	}
+	// Batches are conformed to each scan's own expected types once they are projected.
+	auto state = std::make_shared<PostHogArrowStreamState>(bind_data.catalog, std::string(),
+	                                                       std::shared_ptr<const PostHogCachedResult>());
+	PostHogArrowStream::Open(*shared_factory, shared_parameters, *state, at_clause);
+	columns = std::move(shared_parameters.projected_columns.columns);
+	factory = std::move(shared_factory);
+	source = std::move(state);
+}
+
+arrow::Result<std::shared_ptr<arrow::RecordBatch>> PostHogSharedScanRun::Read(idx_t slot, bool &dropped) {
+	while (true) {
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			if (slots[slot] == SlotState::DROPPED) {
+				dropped = true;
+				return std::shared_ptr<arrow::RecordBatch>();
+			}
+			auto &cursor = cursors[slot];
+			if (cursor < first_batch + batches.size()) {
+				auto batch = batches[cursor - first_batch].first;
+				cursor++;
+				Trim();
+				return batch;
+			}
+			ARROW_RETURN_NOT_OK(error);
+			if (finished) {
+				return std::shared_ptr<arrow::RecordBatch>();
+			}
+		}
+
+		// Whichever scan runs out of buffered batches first reads the next one for all of them.
+		std::lock_guard<std::mutex> fetch_guard(fetch_lock);
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			if (slots[slot] == SlotState::DROPPED || cursors[slot] < first_batch + batches.size() || finished ||
+			    !error.ok()) {
+				continue;
+			}
+		}
+		auto chunk_result = source->Next();
+		std::lock_guard<std::mutex> guard(lock);
+		if (!chunk_result.ok()) {
+			error = chunk_result.status();
+			continue;
+		}
+		auto &batch = chunk_result->data;
+		if (!batch) {
+			finished = true;
+			continue;
+		}
+		auto bytes = static_cast<size_t>(arrow::util::TotalBufferSize(*batch));
+		batches.emplace_back(std::move(batch), bytes);
+		buffered_bytes += bytes;
+		EnforceBudget(slot);
+	}
+}
+
+void PostHogSharedScanRun::EnforceBudget(idx_t reading_slot) {
+	if (buffered_bytes > buffer_bytes) {
+		for (auto &slot_state : slots) {
+			if (slot_state == SlotState::PENDING) {
+				slot_state = SlotState::DETACHED;
+			}
+		}
+	}
+	Trim();
+	while (buffered_bytes > buffer_bytes) {
+		auto lagging = DConstants::INVALID_INDEX;
+		for (idx_t i = 0; i < slots.size(); i++) {
+			if (i != reading_slot && slots[i] == SlotState::READING &&
+			    (lagging == DConstants::INVALID_INDEX || cursors[i] < cursors[lagging])) {
+				lagging = i;
+			}
+		}
+		if (lagging == DConstants::INVALID_INDEX) {
+			return;
+		}
+		slots[lagging] = SlotState::DROPPED;
+		Trim();
+	}
+}
+
+void PostHogSharedScanRun::Trim() {
+	auto keep = first_batch + batches.size();
+	for (idx_t i = 0; i < slots.size(); i++) {
+		if (slots[i] == SlotState::PENDING) {
+			keep = 0;
+		} else if (slots[i] == SlotState::READING) {
+			keep = std::min(keep, cursors[i]);
+		}
+	}
+	while (!batches.empty() && first_batch < keep) {
+		buffered_bytes -= batches.front().second;
+		batches.pop_front();
+		first_batch++;
+	}
+}
+
+PostHogSharedScan::PostHogSharedScan(vector<idx_t> column_ids_p, idx_t scan_count_p, size_t buffer_bytes_p)
+    : column_ids_(std::move(column_ids_p)), scan_count_(scan_count_p), buffer_bytes_(buffer_bytes_p) {
+}
+
+std::shared_ptr<PostHogSharedScanReader> PostHogSharedScan::Attach(ClientContext &context) {
+	std::lock_guard<std::mutex> guard(lock_);
+	auto query = context.transaction.GetActiveQuery();
+	auto run = run_.lock();
+	if (!run || run_query_ != query) {
+		run = std::make_shared<PostHogSharedScanRun>(column_ids_, scan_count_, buffer_bytes_);
+		run_ = run;
+		run_query_ = query;
+	}
+	idx_t slot;
+	{
+		std::lock_guard<std::mutex> run_guard(run->lock);
+		if (run->attached >= run->slots.size()) {
+			return nullptr;
+		}
+		slot = run->attached++;
+	}
+	return std::make_shared<PostHogSharedScanReader>(std::move(run), slot);
+}
+
+PostHogSharedScanReader::PostHogSharedScanReader(std::shared_ptr<PostHogSharedScanRun> run_p, idx_t slot_p)
+    : run_(std::move(run_p)), slot_(slot_p) {
+}
+
+PostHogSharedScanReader::~PostHogSharedScanReader() {
+	std::lock_guard<std::mutex> guard(run_->lock);
+	auto &slot_state = run_->slots[slot_];
+	if (slot_state != PostHogSharedScanRun::SlotState::DETACHED) {
+		slot_state = PostHogSharedScanRun::SlotState::DONE;
+	}
+	run_->Trim();
+}
+
+bool PostHogSharedScanReader::Claim(PostHogRemoteScanStreamFactory &factory, const ArrowStreamParameters &parameters) {
+	{
+		std::lock_guard<std::mutex> guard(run_->lock);
+		auto &slot_state = run_->slots[slot_];
+		if (slot_state == PostHogSharedScanRun::SlotState::DETACHED) {
+			return false;
+		}
+		slot_state = PostHogSharedScanRun::SlotState::READING;
+	}
+	std::lock_guard<std::mutex> fetch_guard(run_->fetch_lock);
+	if (!run_->source) {
+		run_->Open(factory, parameters);
+	}
+	auto &columns = parameters.projected_columns.columns;
+	for (auto &name : columns) {
+		auto it = std::find(run_->columns.begin(), run_->columns.end(), name);
+		if (it == run_->columns.end()) {
+			throw InternalException("PostHog: shared scan does not read column \"%s\"", name);
+		}
+		columns_.push_back(static_cast<int>(it - run_->columns.begin()));
+	}
+	if (columns.empty()) {
+		// ROW_ID-only scans read the placeholder column the shared query starts with.
+		columns_.push_back(0);
+	}
+	return true;
+}
+
+const std::string &PostHogSharedScanReader::Query() const {
+	return run_->source->query;
+}
+
+arrow::Result<std::shared_ptr<arrow::Schema>> PostHogSharedScanReader::GetSchema() {
+	if (schema_) {
+		return schema_;
+	}
+	std::shared_ptr<arrow::Schema> shared_schema;
+	{
+		std::lock_guard<std::mutex> fetch_guard(run_->fetch_lock);
+		ARROW_ASSIGN_OR_RAISE(shared_schema, run_->source->GetSchema());
+	}
+	arrow::FieldVector fields;
+	for (auto column : columns_) {
+		if (column >= shared_schema->num_fields()) {
+			return arrow::Status::Invalid("PostHog: shared scan result has ", shared_schema->num_fields(),
+			                              " columns, expected at least ", column + 1);
+		}
+		fields.push_back(shared_schema->field(column));
+	}
+	schema_ = arrow::schema(std::move(fields), shared_schema->metadata());
+	return schema_;
+}
+
+arrow::Result<arrow::flight::FlightStreamChunk> PostHogSharedScanReader::Next() {
+	std::shared_ptr<arrow::RecordBatch> batch;
+	if (!own_source_) {
+		bool dropped = false;
+		ARROW_ASSIGN_OR_RAISE(batch, run_->Read(slot_, dropped));
+		if (dropped) {
+			// The factory and source are set once the run opened, which it did before the scan read.
+			auto &factory = *run_->factory;
+			own_source_ = std::make_shared<PostHogArrowStreamState>(
+			    factory.bind_data->catalog, run_->source->query, factory.txn_id, factory.stop_token);
+			skip_rows_ = rows_read_;
+		}
+	}
+	if (own_source_) {
+		while (true) {
+			ARROW_ASSIGN_OR_RAISE(auto chunk, own_source_->Next());
+			batch = std::move(chunk.data);
+			if (!batch || batch->num_rows() > skip_rows_) {
+				break;
+			}
+			skip_rows_ -= batch->num_rows();
+		}
+		if (skip_rows_ > 0) {
+			if (!batch) {
+				return arrow::Status::IOError("PostHog: shared scan query returned fewer rows when re-run");
+			}
+			batch = batch->Slice(skip_rows_);
+			skip_rows_ = 0;
+		}
+	}
+	arrow::flight::FlightStreamChunk chunk;
+	if (batch) {
+		rows_read_ += batch->num_rows();
+		ARROW_ASSIGN_OR_RAISE(chunk.data, batch->SelectColumns(columns_));
+	}
+	return chunk;
+}
+
+void PostHogSharedScanReader::AddExplainInfo(InsertionOrderPreservingMap<string> &result) const {
+	result["Shared Scan"] = to_string(run_->slots.size()) + " scans";
+	run_->source->AddExplainInfo(result);
+}
+
+} // namespace duckdb
@@ -0,0 +1,98 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// catalog/remote_scan_sharing.hpp
+//
+// Identical remote table scans of one query fanned out from a single remote query
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb/common/constants.hpp"
+#include "duckdb/common/insertion_order_preserving_map.hpp"
+#include "duckdb/function/table/arrow.hpp"
+#include "flight/flight_client.hpp"
+
+#include <arrow/record_batch.h>
+#include <arrow/result.h>
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace duckdb {
+
+class ClientContext;
+struct PostHogArrowStreamState;
+struct PostHogRemoteScanStreamFactory;
+struct PostHogSharedScanRun;
+class PostHogSharedScanReader;
+
+// Set by the PostHog optimizer on the bind data of every remote scan of one plan that reads the same
+// table, at the same AT clause, with the same filters (shared_scan_bytes). Each execution of the plan
+// streams one remote query of the union of the scans' columns, and every scan reads its own columns
+// of the batches from a buffer shared through a run (PostHogSharedScanRun).
+class PostHogSharedScan {
+public:
+	// column_ids: the table columns any of the scan_count scans reads, in table order.
+	PostHogSharedScan(vector<idx_t> column_ids, idx_t scan_count, size_t buffer_bytes);
+
+	// Joins the run of the query context is executing, starting one if this is its first scan. Null
+	// once all scan_count scans joined it, e.g. for a scan re-initialized by a recursive CTE.
+	std::shared_ptr<PostHogSharedScanReader> Attach(ClientContext &context);
+
+	const vector<idx_t> &ColumnIds() const {
+		return column_ids_;
+	}
+	idx_t ScanCount() const {
+		return scan_count_;
+	}
+
+private:
+	vector<idx_t> column_ids_;
+	idx_t scan_count_;
+	size_t buffer_bytes_;
+	std::mutex lock_;
+	// The run ends with the last of its readers, so a buffer is never kept past its query.
+	transaction_t run_query_ = MAXIMUM_QUERY_ID;
+	std::weak_ptr<PostHogSharedScanRun> run_;
+};
+
+// One scan's view of a run. Batches a scan has not read yet stay buffered; while some scan has not
+// started reading, that is every batch. Once the buffer grows past shared_scan_bytes, scans that have
+// not started yet are detached and read their own query instead. If that is not enough, the scans
+// furthest behind are dropped from the run, down to the one reading the newest batch: a scan whose
+// consumer stopped early (a LIMIT, a join side that ran out) never reads again, and one that does
+// re-runs the shared query on its own and skips the rows it already returned.
+class PostHogSharedScanReader {
+public:
+	PostHogSharedScanReader(std::shared_ptr<PostHogSharedScanRun> run, idx_t slot);
+	~PostHogSharedScanReader();
+
+	// Called on the scan's first read, with its stream factory and parameters; the first scan to claim
+	// its reader sends the shared query. False when the scan was detached.
+	bool Claim(PostHogRemoteScanStreamFactory &factory, const ArrowStreamParameters &parameters);
+
+	// The shared query and its batches, projected to the scan's columns.
+	const std::string &Query() const;
+	arrow::Result<std::shared_ptr<arrow::Schema>> GetSchema();
+	arrow::Result<arrow::flight::FlightStreamChunk> Next();
+
+	// EXPLAIN ANALYZE details of the shared query.
+	void AddExplainInfo(InsertionOrderPreservingMap<string> &result) const;
+
+private:
+	std::shared_ptr<PostHogSharedScanRun> run_;
+	idx_t slot_;
+	// Positions of the scan's columns in the shared query's batches.
+	std::vector<int> columns_;
+	std::shared_ptr<arrow::Schema> schema_;
+	// Rows returned so far. Once the scan was dropped from the run, it reads its own run of the shared
+	// query, whose first skip_rows_ rows it already returned.
+	int64_t rows_read_ = 0;
+	int64_t skip_rows_ = 0;
+	std::shared_ptr<PostHogArrowStreamState> own_source_;
+};
+
+} // namespace duckdb
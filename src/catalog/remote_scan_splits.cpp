@@ -0,0 +1,457 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// catalog/remote_scan_splits.cpp
+//
+// Splitting one remote table scan into several remote queries read in parallel
+//===----------------------------------------------------------------------===//
+
+#include "catalog/remote_scan_splits.hpp"
+
+#include "catalog/posthog_catalog.hpp"
+#include "catalog/posthog_table_entry.hpp"
+#include "catalog/remote_scan.hpp"
+#include "execution/posthog_sql_utils.hpp"
+#include "flight/query_result_reader.hpp"
+#include "utils/posthog_logger.hpp"
+
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/common/types/data_chunk.hpp"
+#include "duckdb/planner/filter/conjunction_filter.hpp"
+#include "duckdb/planner/filter/constant_filter.hpp"
+#include "duckdb/planner/filter/in_filter.hpp"
+#include "duckdb/storage/statistics/numeric_stats.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace duckdb {
+
+namespace {
+
+// Tables with more distinct partition value tuples than this are not split: the conditions would
+// outgrow the queries they restrict.
+constexpr idx_t MAX_PARTITION_GROUPS = 4096;
+
+struct PartitionKey {
+	// Index into the bind data's columns.
+	idx_t column;
+	// DuckLake partition transform: identity, year, month, day or hour.
+	string transform;
+};
+
+struct PartitionGroup {
+	string condition;
+	int64_t record_count;
+};
+
+string MetadataTable(const PostHogRemoteScanBindData &bind_data, const string &table) {
+	// DuckLake attaches its metadata catalog as __ducklake_metadata_<catalog name>.
+	return QuoteIdent("__ducklake_metadata_" + bind_data.catalog.GetRemoteCatalog()) + "." + table;
+}
+
+// False only when no row whose column holds value can pass filter.
+bool MayMatch(const TableFilter &filter, const Value &value) {
+	switch (filter.filter_type) {
+	case TableFilterType::CONSTANT_COMPARISON: {
+		auto &cmp = filter.Cast<ConstantFilter>();
+		if (value.IsNull()) {
+			return false;
+		}
+		Value cast_value;
+		string error;
+		if (!value.DefaultTryCastAs(cmp.constant.type(), cast_value, &error)) {
+			return true;
+		}
+		return cmp.Compare(cast_value);
+	}
+	case TableFilterType::IS_NULL:
+		return value.IsNull();
+	case TableFilterType::IS_NOT_NULL:
+		return !value.IsNull();
+	case TableFilterType::CONJUNCTION_AND: {
+		for (auto &child : filter.Cast<ConjunctionAndFilter>().child_filters) {
+			if (!MayMatch(*child, value)) {
+				return false;
+			}
+		}
+		return true;
+	}
+	case TableFilterType::CONJUNCTION_OR: {
+		for (auto &child : filter.Cast<ConjunctionOrFilter>().child_filters) {
+			if (MayMatch(*child, value)) {
+				return true;
+			}
+		}
+		return false;
+	}
+	case TableFilterType::IN_FILTER: {
+		if (value.IsNull()) {
+			return false;
+		}
+		for (auto &candidate : filter.Cast<InFilter>().values) {
+			Value cast_value;
+			string error;
+			if (!value.DefaultTryCastAs(candidate.type(), cast_value, &error)) {
+				return true;
+			}
+			if (Value::NotDistinctFrom(cast_value, candidate)) {
+				return true;
+			}
+		}
+		return false;
+	}
+	default:
+		// Optional, dynamic and struct filters: assume a match.
+		return true;
+	}
+}
+
+// Renders the condition selecting the rows DuckLake filed under partition value text of key, and
+// for identity keys the value itself (typed, for pruning). False when neither can be done exactly.
+bool RenderKeyCondition(const PostHogRemoteScanBindData &bind_data, const PartitionKey &key, const Value &text,
+                        string &condition, Value &typed) {
+	auto column_expr = QuoteIdent(bind_data.column_names[key.column]);
+	auto &type = bind_data.column_types[key.column];
+	if (text.IsNull()) {
+		condition = column_expr + " IS NULL";
+		typed = Value(type);
+		return true;
+	}
+	string error;
+	if (key.transform == "identity") {
+		if (!text.DefaultTryCastAs(type, typed, &error)) {
+			return false;
+		}
+		condition = column_expr + " = " + typed.ToSQLString();
+		return true;
+	}
+	// Time transforms of TIMESTAMPTZ depend on the session time zone, so only naive types are split.
+	if (type.id() != LogicalTypeId::DATE && type.id() != LogicalTypeId::TIMESTAMP &&
+	    type.id() != LogicalTypeId::TIMESTAMP_MS && type.id() != LogicalTypeId::TIMESTAMP_NS &&
+	    type.id() != LogicalTypeId::TIMESTAMP_SEC) {
+		return false;
+	}
+	if (key.transform != "year" && key.transform != "month" && key.transform != "day" && key.transform != "hour") {
+		return false;
+	}
+	Value part;
+	if (!text.DefaultTryCastAs(LogicalType::BIGINT, part, &error)) {
+		return false;
+	}
+	condition = key.transform + "(" + column_expr + ") = " + part.ToString();
+	typed = Value();
+	return true;
+}
+
+// Column index of a DuckLake column name, or INVALID_INDEX.
+idx_t FindColumn(const PostHogRemoteScanBindData &bind_data, const string &name) {
+	for (idx_t i = 0; i < bind_data.column_names.size(); i++) {
+		if (bind_data.column_names[i] == name) {
+			return i;
+		}
+	}
+	return DConstants::INVALID_INDEX;
+}
+
+// One split per group of DuckLake partition values.
+PostHogScanSplitPlan PlanPartitionSplits(ClientContext &context, const PostHogRemoteScanBindData &bind_data,
+                                         const ArrowStreamParameters &parameters,
+                                         const std::optional<TransactionId> &txn_id, idx_t max_splits) {
+	PostHogScanSplitPlan plan;
+	auto &catalog = bind_data.catalog;
+	// Time travel reads another snapshot than the metadata describes.
+	if (catalog.GetRemoteCatalog().empty() || !bind_data.at_clause_sql.empty()) {
+		return plan;
+	}
+
+	try {
+		// The snapshot, the table's current partition spec, and whether any of its rows are inlined
+		// into the metadata catalog rather than written to files.
+		auto spec_sql =
+		    "SELECT snap.snapshot_id, t.table_id, p.partition_id, pc.partition_key_index, c.column_name, pc.transform, "
+		    "(SELECT count(*) FROM " +
+		    MetadataTable(bind_data, "ducklake_inlined_data_tables") +
+		    " i WHERE i.table_id = t.table_id) FROM " + MetadataTable(bind_data, "ducklake_table") + " t JOIN " +
+		    MetadataTable(bind_data, "ducklake_schema") +
+		    " s ON s.schema_id = t.schema_id AND s.end_snapshot IS NULL CROSS JOIN (SELECT max(snapshot_id) AS "
+		    "snapshot_id FROM " +
+		    MetadataTable(bind_data, "ducklake_snapshot") + ") snap LEFT JOIN " +
+		    MetadataTable(bind_data, "ducklake_partition_info") +
+		    " p ON p.table_id = t.table_id AND p.end_snapshot IS NULL LEFT JOIN " +
+		    MetadataTable(bind_data, "ducklake_partition_column") +
+		    " pc ON pc.partition_id = p.partition_id AND pc.table_id = t.table_id LEFT JOIN " +
+		    MetadataTable(bind_data, "ducklake_column") +
+		    " c ON c.table_id = t.table_id AND c.column_id = pc.column_id AND c.end_snapshot IS NULL WHERE "
+		    "t.end_snapshot IS NULL AND s.schema_name = " +
+		    Value(bind_data.schema_name).ToSQLString() + " AND t.table_name = " +
+		    Value(bind_data.table_name).ToSQLString() + " ORDER BY pc.partition_key_index";
+		vector<LogicalType> spec_types {LogicalType::BIGINT,  LogicalType::BIGINT,  LogicalType::BIGINT,
+		                                LogicalType::BIGINT,  LogicalType::VARCHAR, LogicalType::VARCHAR,
+		                                LogicalType::BIGINT};
+		int64_t snapshot_id = -1;
+		int64_t table_id = -1;
+		int64_t partition_id = -1;
+		vector<PartitionKey> keys;
+		{
+			PostHogQueryResultReader reader(context, catalog, spec_sql, txn_id, spec_types);
+			DataChunk chunk;
+			chunk.Initialize(context, spec_types);
+			while (reader.Next(chunk)) {
+				for (idx_t row = 0; row < chunk.size(); row++) {
+					auto partition = chunk.GetValue(2, row);
+					auto inlined = chunk.GetValue(6, row);
+					auto column_name = chunk.GetValue(4, row);
+					auto transform = chunk.GetValue(5, row);
+					if (chunk.GetValue(0, row).IsNull() || partition.IsNull() || column_name.IsNull() ||
+					    transform.IsNull() || (!inlined.IsNull() && inlined.GetValue<int64_t>() > 0) ||
+					    chunk.GetValue(3, row).GetValue<int64_t>() != static_cast<int64_t>(keys.size())) {
+						return plan;
+					}
+					snapshot_id = chunk.GetValue(0, row).GetValue<int64_t>();
+					table_id = chunk.GetValue(1, row).GetValue<int64_t>();
+					partition_id = partition.GetValue<int64_t>();
+					auto column = FindColumn(bind_data, column_name.ToString());
+					if (column == DConstants::INVALID_INDEX) {
+						return plan;
+					}
+					keys.push_back(PartitionKey {column, StringUtil::Lower(transform.ToString())});
+				}
+			}
+		}
+		if (keys.empty()) {
+			return plan;
+		}
+
+		// Distinct partition value tuples of the live data files, and whether every file was written
+		// under the current spec (files of an older spec or without values could hold any rows).
+		string key_columns;
+		string key_values;
+		for (idx_t i = 0; i < keys.size(); i++) {
+			key_columns += "key_" + to_string(i) + ", ";
+			key_values += "max(v.partition_value) FILTER (WHERE v.partition_key_index = " + to_string(i) +
+			              ") AS key_" + to_string(i) + ", ";
+		}
+		auto snapshot = to_string(snapshot_id);
+		auto files_sql = "SELECT " + key_columns +
+		                 "count(*), CAST(sum(record_count) AS BIGINT), bool_and(covered) FROM (SELECT " + key_values +
+		                 "any_value(df.record_count) AS record_count, any_value(df.partition_id) IS NOT DISTINCT "
+		                 "FROM " +
+		                 to_string(partition_id) + " AND count(v.partition_key_index) = " + to_string(keys.size()) +
+		                 " AS covered FROM " + MetadataTable(bind_data, "ducklake_data_file") + " df LEFT JOIN " +
+		                 MetadataTable(bind_data, "ducklake_file_partition_value") +
+		                 " v ON v.data_file_id = df.data_file_id AND v.table_id = df.table_id WHERE df.table_id = " +
+		                 to_string(table_id) + " AND df.begin_snapshot <= " + snapshot +
+		                 " AND (df.end_snapshot IS NULL OR df.end_snapshot > " + snapshot +
+		                 ") GROUP BY df.data_file_id) files GROUP BY " +
+		                 key_columns.substr(0, key_columns.size() - 2) + " LIMIT " +
+		                 to_string(MAX_PARTITION_GROUPS + 1);
+		vector<LogicalType> files_types(keys.size(), LogicalType::VARCHAR);
+		files_types.push_back(LogicalType::BIGINT);
+		files_types.push_back(LogicalType::BIGINT);
+		files_types.push_back(LogicalType::BOOLEAN);
+
+		// Pushed-down filters by table column, to drop partitions none of whose rows can match.
+		std::unordered_map<idx_t, const TableFilter *> column_filters;
+		if (parameters.filters) {
+			for (auto &entry : parameters.filters->filters) {
+				auto it = parameters.projected_columns.filter_to_col.find(entry.first);
+				if (it != parameters.projected_columns.filter_to_col.end()) {
+					column_filters[it->second] = entry.second.get();
+				}
+			}
+		}
+
+		vector<PartitionGroup> groups;
+		idx_t group_count = 0;
+		idx_t pruned = 0;
+		PostHogQueryResultReader reader(context, catalog, files_sql, txn_id, files_types);
+		DataChunk chunk;
+		chunk.Initialize(context, files_types);
+		while (reader.Next(chunk)) {
+			for (idx_t row = 0; row < chunk.size(); row++) {
+				auto covered = chunk.GetValue(keys.size() + 2, row);
+				if (covered.IsNull() || !covered.GetValue<bool>() || ++group_count > MAX_PARTITION_GROUPS) {
+					return plan;
+				}
+				string condition;
+				bool matches = true;
+				for (idx_t k = 0; k < keys.size(); k++) {
+					string key_condition;
+					Value typed;
+					if (!RenderKeyCondition(bind_data, keys[k], chunk.GetValue(k, row), key_condition, typed)) {
+						return plan;
+					}
+					auto filter = column_filters.find(keys[k].column);
+					if (keys[k].transform == "identity" && filter != column_filters.end() &&
+					    !MayMatch(*filter->second, typed)) {
+						matches = false;
+					}
+					condition += (k > 0 ? " AND " : "") + key_condition;
+				}
+				if (!matches) {
+					pruned++;
+					continue;
+				}
+				auto record_count = chunk.GetValue(keys.size() + 1, row);
+				groups.push_back(PartitionGroup {keys.size() > 1 ? "(" + condition + ")" : condition,
+				                                 record_count.IsNull() ? 0 : record_count.GetValue<int64_t>()});
+			}
+		}
+
+		// Largest partitions first, each into the split with the fewest rows so far.
+		std::sort(groups.begin(), groups.end(), [](const PartitionGroup &left, const PartitionGroup &right) {
+			return left.record_count > right.record_count;
+		});
+		auto split_count = MinValue<idx_t>(max_splits, groups.size());
+		vector<int64_t> split_rows(split_count, 0);
+		plan.conditions.resize(split_count);
+		for (auto &group : groups) {
+			auto least_loaded = std::min_element(split_rows.begin(), split_rows.end());
+			auto target = static_cast<idx_t>(least_loaded - split_rows.begin());
+			auto &condition = plan.conditions[target];
+			condition += (condition.empty() ? "" : " OR ") + group.condition;
+			split_rows[target] += group.record_count;
+		}
+		for (auto &condition : plan.conditions) {
+			condition = "(" + condition + ")";
+		}
+		plan.split = true;
+		plan.at_clause_sql = "AT (VERSION => " + snapshot + ")";
+		POSTHOG_LOG_DEBUG("Scan of '%s.%s': %llu partitions (%llu pruned) in %llu splits at snapshot %lld",
+		                  bind_data.schema_name.c_str(), bind_data.table_name.c_str(),
+		                  static_cast<unsigned long long>(group_count), static_cast<unsigned long long>(pruned),
+		                  static_cast<unsigned long long>(split_count), static_cast<long long>(snapshot_id));
+	} catch (const std::exception &e) {
+		POSTHOG_LOG_DEBUG("Scan of '%s.%s' not split: %s", bind_data.schema_name.c_str(), bind_data.table_name.c_str(),
+		                  e.what());
+		return PostHogScanSplitPlan();
+	}
+	return plan;
+}
+
+// Position of a range split column value on a line of int64 (days for DATE, microseconds for
+// TIMESTAMP), and back.
+bool RangePosition(const Value &value, int64_t &position) {
+	switch (value.type().id()) {
+	case LogicalTypeId::TINYINT:
+	case LogicalTypeId::SMALLINT:
+	case LogicalTypeId::INTEGER:
+	case LogicalTypeId::BIGINT:
+	case LogicalTypeId::UTINYINT:
+	case LogicalTypeId::USMALLINT:
+	case LogicalTypeId::UINTEGER:
+		position = value.GetValue<int64_t>();
+		return true;
+	case LogicalTypeId::DATE:
+		position = value.GetValue<date_t>().days;
+		return true;
+	case LogicalTypeId::TIMESTAMP:
+		position = value.GetValue<timestamp_t>().value;
+		return true;
+	default:
+		return false;
+	}
+}
+
+Value RangeValue(const LogicalType &type, int64_t position) {
+	switch (type.id()) {
+	case LogicalTypeId::DATE:
+		return Value::DATE(date_t(NumericCast<int32_t>(position)));
+	case LogicalTypeId::TIMESTAMP:
+		return Value::TIMESTAMP(timestamp_t(position));
+	default:
+		return Value::BIGINT(position).DefaultCastAs(type);
+	}
+}
+
+// Up to max_splits ranges between the remote min/max statistics of the first integer, DATE or
+// TIMESTAMP column that has them. The outer ranges are open, so rows written since the statistics
+// were gathered (and NULLs, in the first range) are still read exactly once.
+bool PlanRangeSplits(ClientContext &context, const PostHogRemoteScanBindData &bind_data, idx_t max_splits,
+                     PostHogScanSplitPlan &plan) {
+	for (idx_t column = 0; column < bind_data.column_types.size(); column++) {
+		int64_t min_position;
+		int64_t max_position;
+		auto stats = bind_data.table.GetStatistics(context, column);
+		if (!stats || stats->GetStatsType() != StatisticsType::NUMERIC_STATS || !NumericStats::HasMinMax(*stats) ||
+		    !RangePosition(NumericStats::Min(*stats), min_position) ||
+		    !RangePosition(NumericStats::Max(*stats), max_position) || min_position >= max_position) {
+			continue;
+		}
+		auto &type = bind_data.column_types[column];
+		auto column_expr = QuoteIdent(bind_data.column_names[column]);
+		auto span = static_cast<double>(max_position) - static_cast<double>(min_position);
+		vector<string> bounds;
+		int64_t previous = min_position;
+		for (idx_t i = 1; i < max_splits; i++) {
+			auto bound = min_position + static_cast<int64_t>(span * static_cast<double>(i) /
+			                                                 static_cast<double>(max_splits));
+			if (bound <= previous) {
+				continue;
+			}
+			bounds.push_back(RangeValue(type, bound).ToSQLString());
+			previous = bound;
+		}
+		if (bounds.empty()) {
+			continue;
+		}
+		plan.conditions.push_back("(" + column_expr + " < " + bounds[0] + " OR " + column_expr + " IS NULL)");
+		for (idx_t i = 1; i < bounds.size(); i++) {
+			plan.conditions.push_back("(" + column_expr + " >= " + bounds[i - 1] + " AND " + column_expr + " < " +
+			                          bounds[i] + ")");
+		}
+		plan.conditions.push_back(column_expr + " >= " + bounds.back());
+		POSTHOG_LOG_DEBUG("Scan of '%s.%s': %llu range splits on '%s'", bind_data.schema_name.c_str(),
+		                  bind_data.table_name.c_str(), static_cast<unsigned long long>(plan.conditions.size()),
+		                  bind_data.column_names[column].c_str());
+		return true;
+	}
+	return false;
+}
+
+// Fallback for tables without partitions or range statistics: ranges of an ordered column, or else
+// buckets of hash(rowid), all read at one snapshot.
+PostHogScanSplitPlan PlanGenericSplits(ClientContext &context, const PostHogRemoteScanBindData &bind_data,
+                                       const std::optional<TransactionId> &txn_id, idx_t max_splits) {
+	PostHogScanSplitPlan plan;
+	// Pin the splits to one snapshot. A time-travel scan already is; without a snapshot id, splits
+	// only agree inside a remote transaction.
+	plan.at_clause_sql = bind_data.at_clause_sql;
+	if (plan.at_clause_sql.empty()) {
+		auto snapshot_id = bind_data.catalog.ReadSnapshotId(txn_id);
+		if (snapshot_id.has_value()) {
+			plan.at_clause_sql = "AT (VERSION => " + to_string(*snapshot_id) + ")";
+		} else if (!txn_id.has_value()) {
+			return PostHogScanSplitPlan();
+		}
+	}
+	// Statistics describe the current snapshot; a time-travel scan's ranges would be guesses.
+	if (!bind_data.at_clause_sql.empty() || !PlanRangeSplits(context, bind_data, max_splits, plan)) {
+		// Every split reads the whole table on the server and keeps its own share of the rows.
+		for (idx_t i = 0; i < max_splits; i++) {
+			plan.conditions.push_back("hash(rowid) % " + to_string(max_splits) + " = " + to_string(i));
+		}
+		POSTHOG_LOG_DEBUG("Scan of '%s.%s': %llu hash splits", bind_data.schema_name.c_str(),
+		                  bind_data.table_name.c_str(), static_cast<unsigned long long>(max_splits));
+	}
+	plan.split = true;
+	return plan;
+}
+
+} // namespace
+
+PostHogScanSplitPlan PostHogScanSplitPlan::Plan(ClientContext &context, const PostHogRemoteScanBindData &bind_data,
+                                                const ArrowStreamParameters &parameters,
+                                                const std::optional<TransactionId> &txn_id, idx_t max_splits) {
+	if (max_splits < 2) {
+		return PostHogScanSplitPlan();
+	}
+	auto plan = PlanPartitionSplits(context, bind_data, parameters, txn_id, max_splits);
+	if (plan.split) {
+		return plan;
+	}
+	return PlanGenericSplits(context, bind_data, txn_id, max_splits);
+}
+
+} // namespace duckdb
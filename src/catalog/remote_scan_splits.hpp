@@ -0,0 +1,44 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// catalog/remote_scan_splits.hpp
+//
+// Splitting one remote table scan into several remote queries read in parallel
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb/common/types.hpp"
+#include "duckdb/function/table/arrow.hpp"
+#include "flight/flight_client.hpp"
+
+#include <optional>
+
+namespace duckdb {
+
+class ClientContext;
+struct PostHogRemoteScanBindData;
+
+struct PostHogScanSplitPlan {
+	// False when the scan runs as a single query.
+	bool split = false;
+	// AT clause every split reads, pinning them all to one snapshot; empty when they share a remote
+	// transaction instead.
+	string at_clause_sql;
+	// One condition per split, ANDed with the scan's own WHERE. Together they select every row of the
+	// table exactly once. Empty (with split set) when the scan's filters rule out every partition.
+	vector<string> conditions;
+
+	// Plans a scan of bind_data with the projection and filters DuckDB pushed down (parameters) as up to
+	// max_splits queries, one per group of DuckLake partition values. Partitions the pushed filters
+	// cannot match are dropped here, before any of the scan's queries is sent. Tables whose
+	// partitioning the metadata cannot vouch for (none, files of an older partition spec, inlined
+	// rows, no DuckLake metadata) are split into ranges of a column with remote min/max statistics,
+	// or else into hash(rowid) buckets. The plan is unsplit only when the splits could not be pinned
+	// to one snapshot.
+	static PostHogScanSplitPlan Plan(ClientContext &context, const PostHogRemoteScanBindData &bind_data,
+	                                 const ArrowStreamParameters &parameters,
+	                                 const std::optional<TransactionId> &txn_id, idx_t max_splits);
+};
+
+} // namespace duckdb
@@ -8,11 +8,13 @@
 
 #include "catalog/remote_table_function.hpp"
 #include "catalog/posthog_catalog.hpp"
+#include "execution/posthog_sql_utils.hpp"
 #include "flight/arrow_stream.hpp"
 #include "storage/posthog_transaction.hpp"
 
 #include "duckdb/catalog/catalog_entry/table_function_catalog_entry.hpp"
 #include "duckdb/common/exception.hpp"
+#include "duckdb/common/numeric_utils.hpp"
 #include "duckdb/function/table/arrow.hpp"
 #include "duckdb/main/client_context.hpp"
 #include "duckdb/main/database.hpp"
@@ -20,6 +22,9 @@
 #include "duckdb/main/config.hpp"
 #include "duckdb/common/string_util.hpp"
 #include "duckdb/parser/parsed_data/create_table_function_info.hpp"
+#include "duckdb/planner/filter/conjunction_filter.hpp"
+#include "duckdb/planner/filter/constant_filter.hpp"
+#include "duckdb/planner/filter/optional_filter.hpp"
 
 #include <arrow/c/bridge.h>
 
@@ -43,12 +48,27 @@ struct RemoteTableFunctionInfo : public TableFunctionInfo {
 // Bind data: extends ArrowScanFunctionData for Arrow stream consumption
 //===----------------------------------------------------------------------===//
 
+// Arguments of a table_changes(table_name, start_snapshot, end_snapshot) call.
+struct RemoteTableChangesArgs {
+	string function_base;
+	string table_name;
+	// Nullopt when the argument is NULL (passed through as is).
+	std::optional<int64_t> start_snapshot;
+	std::optional<int64_t> end_snapshot;
+};
+
 struct RemoteTableFunctionBindData : public ArrowScanFunctionData {
 	RemoteTableFunctionBindData(PostHogCatalog &catalog_p, string function_ref_p);
 
 	PostHogCatalog &catalog;
 	// The remote function reference, e.g. "ducklake"."snapshots"()
 	string function_ref;
+	// Result schema reported by the server at bind.
+	std::shared_ptr<arrow::Schema> arrow_schema;
+	// Result column names, which pushed filters refer to.
+	vector<string> column_names;
+	// Set for table_changes, whose snapshot range is narrowed to the pushed snapshot_id filters.
+	std::optional<RemoteTableChangesArgs> table_changes;
 
 	static unique_ptr<ArrowArrayStreamWrapper> Produce(uintptr_t factory_ptr, ArrowStreamParameters &parameters);
 };
@@ -56,6 +76,9 @@ struct RemoteTableFunctionBindData : public ArrowScanFunctionData {
 struct RemoteTableFunctionStreamFactory {
 	const RemoteTableFunctionBindData *bind_data;
 	std::optional<TransactionId> txn_id;
+	arrow::StopToken stop_token = arrow::StopToken::Unstoppable();
+	// Bound Arrow types of the projected columns, which every batch is conformed to.
+	std::vector<std::shared_ptr<arrow::DataType>> expected_types;
 };
 
 RemoteTableFunctionBindData::RemoteTableFunctionBindData(PostHogCatalog &catalog_p, string function_ref_p)
@@ -63,6 +86,70 @@ RemoteTableFunctionBindData::RemoteTableFunctionBindData(PostHogCatalog &catalog
       catalog(catalog_p), function_ref(std::move(function_ref_p)) {
 }
 
+// Build the function_ref for table_changes(table_name, start_snapshot, end_snapshot).
+// Escapes the VARCHAR argument; BIGINT arguments are rendered unquoted.
+static string BuildTableChangesRef(const RemoteTableChangesArgs &args, const std::optional<int64_t> &start_snapshot,
+                                   const std::optional<int64_t> &end_snapshot) {
+	auto render = [](const std::optional<int64_t> &snapshot) {
+		return snapshot.has_value() ? std::to_string(*snapshot) : string("NULL");
+	};
+	return args.function_base + "('" + StringUtil::Replace(args.table_name, "'", "''") + "', " +
+	       render(start_snapshot) + ", " + render(end_snapshot) + ")";
+}
+
+// Tightens [start, end] to the snapshot ids filter admits. Only BIGINT constant comparisons, and ANDs
+// of them, narrow the range; anything else leaves it as it is.
+static void NarrowSnapshotRange(const TableFilter &filter, int64_t &start, int64_t &end) {
+	switch (filter.filter_type) {
+	case TableFilterType::CONSTANT_COMPARISON: {
+		auto &comparison = filter.Cast<ConstantFilter>();
+		if (comparison.constant.IsNull() || comparison.constant.type().id() != LogicalTypeId::BIGINT) {
+			return;
+		}
+		auto value = comparison.constant.GetValue<int64_t>();
+		switch (comparison.comparison_type) {
+		case ExpressionType::COMPARE_EQUAL:
+			start = MaxValue(start, value);
+			end = MinValue(end, value);
+			break;
+		case ExpressionType::COMPARE_GREATERTHANOREQUALTO:
+			start = MaxValue(start, value);
+			break;
+		case ExpressionType::COMPARE_GREATERTHAN:
+			if (value < NumericLimits<int64_t>::Maximum()) {
+				start = MaxValue(start, value + 1);
+			}
+			break;
+		case ExpressionType::COMPARE_LESSTHANOREQUALTO:
+			end = MinValue(end, value);
+			break;
+		case ExpressionType::COMPARE_LESSTHAN:
+			if (value > NumericLimits<int64_t>::Minimum()) {
+				end = MinValue(end, value - 1);
+			}
+			break;
+		default:
+			break;
+		}
+		return;
+	}
+	case TableFilterType::CONJUNCTION_AND:
+		for (auto &child : filter.Cast<ConjunctionAndFilter>().child_filters) {
+			NarrowSnapshotRange(*child, start, end);
+		}
+		return;
+	case TableFilterType::OPTIONAL_FILTER: {
+		auto &optional = filter.Cast<OptionalFilter>();
+		if (optional.child_filter) {
+			NarrowSnapshotRange(*optional.child_filter, start, end);
+		}
+		return;
+	}
+	default:
+		return;
+	}
+}
+
 unique_ptr<ArrowArrayStreamWrapper> RemoteTableFunctionBindData::Produce(uintptr_t factory_ptr,
                                                                          ArrowStreamParameters &parameters) {
 	auto *factory = reinterpret_cast<RemoteTableFunctionStreamFactory *>(factory_ptr);
@@ -81,9 +168,49 @@ unique_ptr<ArrowArrayStreamWrapper> RemoteTableFunctionBindData::Produce(uintptr
 			columns_str += "\"" + columns[i] + "\"";
 		}
 	}
-	string query = "SELECT " + columns_str + " FROM " + bind_data->function_ref;
 
-	auto stream_state = std::make_shared<PostHogArrowStreamState>(bind_data->catalog, query, factory->txn_id);
+	// Pushed filters become the WHERE clause, as for remote table scans (see PostHogArrowStream::BuildQuery).
+	string where_clause;
+	auto function_ref = bind_data->function_ref;
+	auto &table_changes = bind_data->table_changes;
+	if (parameters.filters) {
+		int64_t start_snapshot = table_changes && table_changes->start_snapshot ? *table_changes->start_snapshot : 0;
+		int64_t end_snapshot = table_changes && table_changes->end_snapshot ? *table_changes->end_snapshot : 0;
+		for (auto &entry : parameters.filters->filters) {
+			auto it = parameters.projected_columns.filter_to_col.find(entry.first);
+			if (it == parameters.projected_columns.filter_to_col.end() || it->second == COLUMN_IDENTIFIER_ROW_ID ||
+			    it->second >= bind_data->column_names.size()) {
+				continue;
+			}
+			auto &column_name = bind_data->column_names[it->second];
+			if (table_changes && table_changes->start_snapshot && table_changes->end_snapshot &&
+			    column_name == "snapshot_id") {
+				NarrowSnapshotRange(*entry.second, start_snapshot, end_snapshot);
+			}
+			auto condition = FilterToSQL(*entry.second, QuoteIdent(column_name));
+			if (condition.empty()) {
+				continue;
+			}
+			if (!where_clause.empty()) {
+				where_clause += " AND ";
+			}
+			where_clause += condition;
+		}
+		// An empty range is left to the WHERE clause, since the function may reject start > end.
+		if (table_changes && table_changes->start_snapshot && table_changes->end_snapshot &&
+		    start_snapshot <= end_snapshot &&
+		    (start_snapshot != *table_changes->start_snapshot || end_snapshot != *table_changes->end_snapshot)) {
+			function_ref = BuildTableChangesRef(*table_changes, start_snapshot, end_snapshot);
+		}
+	}
+	string query = "SELECT " + columns_str + " FROM " + function_ref;
+	if (!where_clause.empty()) {
+		query += " WHERE " + where_clause;
+	}
+
+	auto stream_state =
+	    std::make_shared<PostHogArrowStreamState>(bind_data->catalog, query, factory->txn_id, factory->stop_token);
+	stream_state->expected_types = factory->expected_types;
 
 	ArrowArrayStream tmp_stream;
 	PostHogArrowStream::Initialize(tmp_stream, std::move(stream_state));
@@ -117,15 +244,6 @@ static string BuildZeroArgRef(const string &function_base) {
 	return function_base + "()";
 }
 
-// Build the function_ref for table_changes(table_name, start_snapshot, end_snapshot).
-// Escapes the VARCHAR argument; BIGINT arguments are rendered unquoted.
-static string BuildTableChangesRef(const string &function_base, const vector<Value> &inputs) {
-	auto table_name = StringUtil::Replace(inputs[0].ToString(), "'", "''");
-	auto start_snap = inputs[1].ToString();
-	auto end_snap = inputs[2].ToString();
-	return function_base + "('" + table_name + "', " + start_snap + ", " + end_snap + ")";
-}
-
 static unique_ptr<FunctionData> RemoteTableFunctionBind(ClientContext &context, TableFunctionBindInput &input,
                                                         vector<LogicalType> &return_types, vector<string> &names) {
 	auto &fn_info = input.info->Cast<RemoteTableFunctionInfo>();
@@ -136,14 +254,10 @@ static unique_ptr<FunctionData> RemoteTableFunctionBind(ClientContext &context,
 
 	// Discover the return schema by probing the remote server with SELECT *.
 	string schema_query = "SELECT * FROM " + function_ref;
-	std::optional<TransactionId> remote_txn_id;
-	try {
-		remote_txn_id = PostHogTransaction::Get(context, catalog).remote_txn_id;
-	} catch (const std::exception &) {
-		remote_txn_id = std::nullopt;
-	}
+	auto remote_txn_id = PostHogTransaction::Get(context, catalog).RemoteTransactionForRead();
 
-	auto arrow_schema = catalog.GetFlightClient().GetQuerySchema(schema_query, remote_txn_id);
+	auto arrow_schema = catalog.GetFlightClient().GetCachedQuerySchema(schema_query, remote_txn_id);
+	bind_data->arrow_schema = arrow_schema;
 
 	auto status = arrow::ExportSchema(*arrow_schema, &bind_data->schema_root.arrow_schema);
 	if (!status.ok()) {
@@ -154,6 +268,7 @@ static unique_ptr<FunctionData> RemoteTableFunctionBind(ClientContext &context,
 	names = bind_data->arrow_table.GetNames();
 	return_types = bind_data->arrow_table.GetTypes();
 	bind_data->all_types = return_types;
+	bind_data->column_names = names;
 
 	return bind_data;
 }
@@ -164,19 +279,25 @@ static unique_ptr<FunctionData> RemoteTableChangesBindArgs(ClientContext &contex
                                                            vector<LogicalType> &return_types, vector<string> &names) {
 	auto &fn_info = input.info->Cast<RemoteTableFunctionInfo>();
 	auto &catalog = fn_info.catalog;
-	auto function_ref = BuildTableChangesRef(fn_info.function_base, input.inputs);
+	RemoteTableChangesArgs args;
+	args.function_base = fn_info.function_base;
+	args.table_name = input.inputs[0].ToString();
+	if (!input.inputs[1].IsNull()) {
+		args.start_snapshot = input.inputs[1].GetValue<int64_t>();
+	}
+	if (!input.inputs[2].IsNull()) {
+		args.end_snapshot = input.inputs[2].GetValue<int64_t>();
+	}
+	auto function_ref = BuildTableChangesRef(args, args.start_snapshot, args.end_snapshot);
 
 	auto bind_data = make_uniq<RemoteTableFunctionBindData>(catalog, function_ref);
+	bind_data->table_changes = std::move(args);
 
 	string schema_query = "SELECT * FROM " + function_ref;
-	std::optional<TransactionId> remote_txn_id;
-	try {
-		remote_txn_id = PostHogTransaction::Get(context, catalog).remote_txn_id;
-	} catch (const std::exception &) {
-		remote_txn_id = std::nullopt;
-	}
+	auto remote_txn_id = PostHogTransaction::Get(context, catalog).RemoteTransactionForRead();
 
-	auto arrow_schema = catalog.GetFlightClient().GetQuerySchema(schema_query, remote_txn_id);
+	auto arrow_schema = catalog.GetFlightClient().GetCachedQuerySchema(schema_query, remote_txn_id);
+	bind_data->arrow_schema = arrow_schema;
 
 	auto status = arrow::ExportSchema(*arrow_schema, &bind_data->schema_root.arrow_schema);
 	if (!status.ok()) {
@@ -187,6 +308,7 @@ static unique_ptr<FunctionData> RemoteTableChangesBindArgs(ClientContext &contex
 	names = bind_data->arrow_table.GetNames();
 	return_types = bind_data->arrow_table.GetTypes();
 	bind_data->all_types = return_types;
+	bind_data->column_names = names;
 
 	return bind_data;
 }
@@ -195,14 +317,12 @@ static unique_ptr<GlobalTableFunctionState> RemoteTableFunctionInitGlobal(Client
                                                                           TableFunctionInitInput &input) {
 	auto &bind_data = input.bind_data->Cast<RemoteTableFunctionBindData>();
 
-	std::optional<TransactionId> remote_txn_id;
-	try {
-		remote_txn_id = PostHogTransaction::Get(context, bind_data.catalog).remote_txn_id;
-	} catch (const std::exception &) {
-		remote_txn_id = std::nullopt;
-	}
+	auto &transaction = PostHogTransaction::Get(context, bind_data.catalog);
+	auto remote_txn_id = transaction.RemoteTransactionForRead();
+	auto stop_token = transaction.GetStopToken();
 
 	ArrowStreamParameters parameters;
+	std::vector<std::shared_ptr<arrow::DataType>> expected_types;
 	auto &arrow_types = bind_data.arrow_table.GetColumns();
 	for (idx_t idx = 0; idx < input.column_ids.size(); idx++) {
 		auto col_idx = input.column_ids[idx];
@@ -212,13 +332,17 @@ static unique_ptr<GlobalTableFunctionState> RemoteTableFunctionInitGlobal(Client
 			parameters.projected_columns.projection_map[idx] = schema_c.name;
 			parameters.projected_columns.columns.emplace_back(schema_c.name);
 			parameters.projected_columns.filter_to_col[idx] = col_idx;
+			expected_types.push_back(bind_data.arrow_schema->field(NumericCast<int>(col_idx))->type());
 		}
 	}
+	parameters.filters = input.filters.get();
 
 	auto result = make_uniq<RemoteTableFunctionGlobalState>();
 	result->stream_factory = make_uniq<RemoteTableFunctionStreamFactory>();
+	result->stream_factory->expected_types = std::move(expected_types);
 	result->stream_factory->bind_data = &bind_data;
 	result->stream_factory->txn_id = std::move(remote_txn_id);
+	result->stream_factory->stop_token = std::move(stop_token);
 	result->stream = bind_data.scanner_producer(reinterpret_cast<uintptr_t>(result->stream_factory.get()), parameters);
 
 	result->max_threads = context.db->NumberOfThreads();
@@ -265,7 +389,9 @@ CreateRemoteTableFunctionEntry(PostHogCatalog &catalog, SchemaCatalogEntry &sche
 	TableFunction zero_arg(function_name, {}, RemoteTableFunctionExecute, RemoteTableFunctionBind,
 	                       RemoteTableFunctionInitGlobal, RemoteTableFunctionInitLocal);
 	zero_arg.projection_pushdown = true;
-	zero_arg.filter_pushdown = false;
+	// Produce renders every pushed filter with FilterToSQL; see PostHogRemoteScan::GetFunction for why
+	// it must handle every TableFilterType DuckDB pushes.
+	zero_arg.filter_pushdown = true;
 	zero_arg.function_info = fn_info;
 
 	TableFunctionSet func_set(function_name);
@@ -279,7 +405,7 @@ CreateRemoteTableFunctionEntry(PostHogCatalog &catalog, SchemaCatalogEntry &sche
 		                        RemoteTableFunctionExecute, RemoteTableChangesBindArgs, RemoteTableFunctionInitGlobal,
 		                        RemoteTableFunctionInitLocal);
 		with_args.projection_pushdown = true;
-		with_args.filter_pushdown = false;
+		with_args.filter_pushdown = true;
 		with_args.function_info = fn_info;
 		func_set.AddFunction(std::move(with_args));
 	}
@@ -5,8 +5,14 @@
 #include "duckdb/common/exception.hpp"
 #include "duckdb/function/scalar_function.hpp"
 #include "duckdb/main/config.hpp"
+#include "duckdb/optimizer/optimizer_extension.hpp"
 #include "duckdb/storage/storage_extension.hpp"
 
+#include "execution/posthog_query_stats.hpp"
+#include "execution/posthog_replicate.hpp"
+#include "execution/posthog_traces.hpp"
+#include "optimizer/posthog_optimizer.hpp"
+#include "storage/posthog_settings.hpp"
 #include "storage/posthog_storage.hpp"
 
 // OpenSSL linked through vcpkg
@@ -25,6 +31,22 @@ static void LoadInternal(ExtensionLoader &loader) {
 	auto &config = DBConfig::GetConfig(loader.GetDatabaseInstance());
 	StorageExtension::Register(config, "hog", make_shared_ptr<PostHogStorageExtension>());
 
+	// SET duckhog_<option> defaults for the connection string options of later attaches
+	PostHogSettings::Register(config);
+
+	// Rewrite aggregates over remote scans into remote SQL
+	OptimizerExtension::Register(config, PostHogOptimizer::GetExtension());
+
+	// Local replicas of remote tables, refreshed from table_changes()
+	loader.RegisterFunction(PostHogReplicate::GetFunction());
+
+	// Recent Flight calls of attached catalogs, with timings and transfer counters
+	loader.RegisterFunction(PostHogQueryStatsFunction::GetFunction());
+
+	// Recorded trace spans, and their export as OTLP/JSON
+	loader.RegisterFunction(PostHogTracesFunction::GetFunction());
+	loader.RegisterFunction(PostHogExportTracesFunction::GetFunction());
+
 	// Register a simple version function to verify the extension loads
 	auto duckhog_version_func = ScalarFunction("duckhog_version", {}, LogicalType::VARCHAR, DuckhogVersionScalarFun);
 	loader.RegisterFunction(duckhog_version_func);
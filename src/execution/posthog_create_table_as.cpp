@@ -11,14 +11,29 @@
 #include "duckdb/common/exception.hpp"
 #include "duckdb/common/numeric_utils.hpp"
 #include "execution/posthog_sql_utils.hpp"
+#include "execution/posthog_table_writer.hpp"
 #include "storage/posthog_transaction.hpp"
 
+#include <atomic>
+
 namespace duckdb {
 
 namespace {
 
 struct PostHogCTASGlobalSinkState : public GlobalSinkState {
-	idx_t insert_count = 0;
+	explicit PostHogCTASGlobalSinkState(unique_ptr<PostHogRemoteTableWriter> writer_p) : writer(std::move(writer_p)) {
+	}
+
+	unique_ptr<PostHogRemoteTableWriter> writer;
+	std::atomic<idx_t> insert_count {0};
+};
+
+struct PostHogCTASLocalSinkState : public LocalSinkState {
+	explicit PostHogCTASLocalSinkState(unique_ptr<PostHogPipelinedWriteBuffer> buffer_p)
+	    : buffer(std::move(buffer_p)) {
+	}
+
+	unique_ptr<PostHogPipelinedWriteBuffer> buffer;
 };
 
 struct PostHogCTASSourceState : public GlobalSourceState {
@@ -31,21 +46,28 @@ PhysicalPostHogCreateTableAs::PhysicalPostHogCreateTableAs(PhysicalPlan &physica
                                                            PostHogCatalog &catalog,
                                                            unique_ptr<CreateTableInfo> create_info,
                                                            string remote_schema, string remote_table,
-                                                           vector<string> column_names, idx_t estimated_cardinality)
+                                                           vector<string> column_names, bool parallel,
+                                                           idx_t estimated_cardinality)
     : PhysicalOperator(physical_plan, PhysicalOperatorType::EXTENSION, std::move(types), estimated_cardinality),
       catalog_(catalog), create_info_(std::move(create_info)), remote_schema_(std::move(remote_schema)),
-      remote_table_(std::move(remote_table)), column_names_(std::move(column_names)) {
+      remote_table_(std::move(remote_table)), column_names_(std::move(column_names)), parallel_(parallel) {
 }
 
 string PhysicalPostHogCreateTableAs::GetName() const {
 	return "POSTHOG_CREATE_TABLE_AS";
 }
 
+InsertionOrderPreservingMap<string> PhysicalPostHogCreateTableAs::ParamsToString() const {
+	InsertionOrderPreservingMap<string> result;
+	result["Remote Table"] = QualifyRemoteTableName(catalog_.GetRemoteCatalog(), remote_schema_, remote_table_);
+	return result;
+}
+
 unique_ptr<GlobalSinkState> PhysicalPostHogCreateTableAs::GetGlobalSinkState(ClientContext &context) const {
 	// Send CREATE TABLE DDL to the remote server before any data arrives.
 	// create_info_ already has the catalog rewritten to the remote side by PlanCreateTableAs.
 	auto ddl = create_info_->ToString();
-	auto remote_txn_id = PostHogTransaction::Get(context, catalog_).remote_txn_id;
+	auto remote_txn_id = PostHogTransaction::Get(context, catalog_).RemoteTransactionForWrite();
 
 	try {
 		catalog_.GetFlightClient().ExecuteUpdate(ddl, remote_txn_id);
@@ -55,35 +77,35 @@ unique_ptr<GlobalSinkState> PhysicalPostHogCreateTableAs::GetGlobalSinkState(Cli
 		throw IOException("PostHog: CREATE TABLE AS failed during DDL: %s", ex.what());
 	}
 
-	return make_uniq<PostHogCTASGlobalSinkState>();
+	// The new table receives every column in order, so chunks can always be bulk ingested.
+	return make_uniq<PostHogCTASGlobalSinkState>(
+	    make_uniq<PostHogRemoteTableWriter>(catalog_, remote_schema_, remote_table_, column_names_, "", true));
+}
+
+unique_ptr<LocalSinkState> PhysicalPostHogCreateTableAs::GetLocalSinkState(ExecutionContext &context) const {
+	auto &sink_state = this->sink_state->Cast<PostHogCTASGlobalSinkState>();
+	auto remote_txn_id = PostHogTransaction::Get(context.client, catalog_).RemoteTransactionForWrite();
+	return make_uniq<PostHogCTASLocalSinkState>(make_uniq<PostHogPipelinedWriteBuffer>(
+	    context.client, *sink_state.writer, children[0].get().GetTypes(), std::move(remote_txn_id),
+	    "CREATE TABLE AS into " + sink_state.writer->QualifiedTableName()));
 }
 
 SinkResultType PhysicalPostHogCreateTableAs::Sink(ExecutionContext &context, DataChunk &chunk,
                                                   OperatorSinkInput &input) const {
-	if (chunk.size() == 0) {
-		return SinkResultType::NEED_MORE_INPUT;
-	}
-
-	auto qualified = QualifyRemoteTableName(catalog_.GetRemoteCatalog(), remote_schema_, remote_table_);
-	auto sql = BuildInsertSQL(qualified, column_names_, chunk);
-	auto remote_txn_id = PostHogTransaction::Get(context.client, catalog_).remote_txn_id;
-
-	int64_t affected = 0;
-	try {
-		affected = catalog_.GetFlightClient().ExecuteUpdate(sql, remote_txn_id);
-	} catch (const Exception &) {
-		throw;
-	} catch (const std::exception &ex) {
-		throw IOException("PostHog: CREATE TABLE AS failed during INSERT: %s", ex.what());
-	}
+	(void)context;
+	auto &local_state = input.local_state.Cast<PostHogCTASLocalSinkState>();
+	local_state.buffer->Append(chunk);
+	return SinkResultType::NEED_MORE_INPUT;
+}
 
+SinkCombineResultType PhysicalPostHogCreateTableAs::Combine(ExecutionContext &context,
+                                                            OperatorSinkCombineInput &input) const {
+	(void)context;
 	auto &sink_state = input.global_state.Cast<PostHogCTASGlobalSinkState>();
-	if (affected < 0) {
-		sink_state.insert_count += chunk.size();
-	} else {
-		sink_state.insert_count += NumericCast<idx_t>(affected);
-	}
-	return SinkResultType::NEED_MORE_INPUT;
+	auto &local_state = input.local_state.Cast<PostHogCTASLocalSinkState>();
+	local_state.buffer->Finish();
+	sink_state.insert_count += local_state.buffer->RowsWritten();
+	return SinkCombineResultType::FINISHED;
 }
 
 SinkFinalizeType PhysicalPostHogCreateTableAs::Finalize(Pipeline &pipeline, Event &event, ClientContext &context,
@@ -111,8 +133,19 @@ SourceResultType PhysicalPostHogCreateTableAs::GetDataInternal(ExecutionContext
 
 	auto &global_sink = this->sink_state->Cast<PostHogCTASGlobalSinkState>();
 	chunk.SetCardinality(1);
-	chunk.SetValue(0, 0, Value::BIGINT(NumericCast<int64_t>(global_sink.insert_count)));
+	chunk.SetValue(0, 0, Value::BIGINT(NumericCast<int64_t>(global_sink.insert_count.load())));
 	return SourceResultType::FINISHED;
 }
 
+InsertionOrderPreservingMap<string> PhysicalPostHogCreateTableAs::ExtraSourceParams(GlobalSourceState &gstate,
+                                                                                    LocalSourceState &lstate) const {
+	(void)gstate;
+	(void)lstate;
+	InsertionOrderPreservingMap<string> result;
+	if (this->sink_state) {
+		this->sink_state->Cast<PostHogCTASGlobalSinkState>().writer->AddExplainInfo(result);
+	}
+	return result;
+}
+
 } // namespace duckdb
@@ -23,29 +23,34 @@ public:
 
 	PhysicalPostHogCreateTableAs(PhysicalPlan &physical_plan, vector<LogicalType> types, PostHogCatalog &catalog,
 	                             unique_ptr<CreateTableInfo> create_info, string remote_schema, string remote_table,
-	                             vector<string> column_names, idx_t estimated_cardinality);
+	                             vector<string> column_names, bool parallel, idx_t estimated_cardinality);
 
 	string GetName() const override;
+	InsertionOrderPreservingMap<string> ParamsToString() const override;
 
 	unique_ptr<GlobalSinkState> GetGlobalSinkState(ClientContext &context) const override;
+	unique_ptr<LocalSinkState> GetLocalSinkState(ExecutionContext &context) const override;
 	SinkResultType Sink(ExecutionContext &context, DataChunk &chunk, OperatorSinkInput &input) const override;
+	SinkCombineResultType Combine(ExecutionContext &context, OperatorSinkCombineInput &input) const override;
 	SinkFinalizeType Finalize(Pipeline &pipeline, Event &event, ClientContext &context,
 	                          OperatorSinkFinalizeInput &input) const override;
 
 	unique_ptr<GlobalSourceState> GetGlobalSourceState(ClientContext &context) const override;
 	SourceResultType GetDataInternal(ExecutionContext &context, DataChunk &chunk,
 	                                 OperatorSourceInput &input) const override;
+	InsertionOrderPreservingMap<string> ExtraSourceParams(GlobalSourceState &gstate,
+	                                                      LocalSourceState &lstate) const override;
 
 	bool IsSink() const override {
 		return true;
 	}
 
 	bool ParallelSink() const override {
-		return false;
+		return parallel_;
 	}
 
 	bool SinkOrderDependent() const override {
-		return true;
+		return !parallel_;
 	}
 
 	bool IsSource() const override {
@@ -58,6 +63,8 @@ private:
 	string remote_schema_;
 	string remote_table_;
 	vector<string> column_names_;
+	// False when insertion order must be preserved; the single sink thread still pipelines writes.
+	bool parallel_ = false;
 };
 
 } // namespace duckdb
@@ -7,7 +7,6 @@
 
 #pragma once
 
-#include "duckdb/common/types/column/column_data_collection.hpp"
 #include "duckdb/execution/physical_operator.hpp"
 
 namespace duckdb {
@@ -23,10 +22,13 @@ public:
 	                      idx_t estimated_cardinality);
 
 	string GetName() const override;
+	InsertionOrderPreservingMap<string> ParamsToString() const override;
 
 	unique_ptr<GlobalSourceState> GetGlobalSourceState(ClientContext &context) const override;
 	SourceResultType GetDataInternal(ExecutionContext &context, DataChunk &chunk,
 	                                 OperatorSourceInput &input) const override;
+	InsertionOrderPreservingMap<string> ExtraSourceParams(GlobalSourceState &gstate,
+	                                                      LocalSourceState &lstate) const override;
 
 	bool IsSource() const override {
 		return true;
@@ -11,23 +11,31 @@
 #include "duckdb/common/exception/binder_exception.hpp"
 #include "duckdb/parser/parsed_data/create_table_info.hpp"
 #include "duckdb/parser/parsed_data/create_view_info.hpp"
+#include "duckdb/common/case_insensitive_map.hpp"
 #include "duckdb/common/constants.hpp"
 #include "duckdb/common/enums/statement_type.hpp"
 #include "duckdb/common/exception.hpp"
 #include "duckdb/common/string_util.hpp"
 #include "duckdb/main/client_context.hpp"
+#include "duckdb/parser/expression/cast_expression.hpp"
 #include "duckdb/parser/expression/columnref_expression.hpp"
+#include "duckdb/parser/expression/function_expression.hpp"
 #include "duckdb/parser/expression/subquery_expression.hpp"
 #include "duckdb/parser/parsed_expression_iterator.hpp"
 #include "duckdb/parser/parser.hpp"
+#include "duckdb/parser/statement/create_statement.hpp"
 #include "duckdb/parser/statement/delete_statement.hpp"
 #include "duckdb/parser/statement/merge_into_statement.hpp"
 #include "duckdb/parser/statement/select_statement.hpp"
 #include "duckdb/parser/statement/update_statement.hpp"
 #include "duckdb/parser/tableref/basetableref.hpp"
+#include "duckdb/parser/tableref/joinref.hpp"
+#include "duckdb/parser/tableref/subqueryref.hpp"
 #include "duckdb/parser/tokens.hpp"
+#include "optimizer/remote_query_builder.hpp"
 
 #include <cctype>
+#include <functional>
 
 namespace duckdb {
 
@@ -131,13 +139,154 @@ void RewriteTableRef(unique_ptr<TableRef> &table_ref, const string &attached_cat
 	    [&](TableRef &child_ref) { RewriteTableRefCatalog(child_ref, attached_catalog, remote_catalog); });
 }
 
+bool IsLocalTableRef(const BaseTableRef &base_ref, const string &attached_catalog, const string &remote_catalog,
+                     const PostHogHybridDMLSource &hybrid) {
+	if (!CatalogIsUnset(base_ref.catalog_name)) {
+		return !StringUtil::CIEquals(base_ref.catalog_name, attached_catalog) &&
+		       !StringUtil::CIEquals(base_ref.catalog_name, remote_catalog);
+	}
+	return hybrid.is_local && hybrid.is_local(base_ref.schema_name, base_ref.table_name);
+}
+
+// Like RewriteTableRef, but with hybrid set, base tables of the clause that are local (directly or
+// as an input of its joins) are replaced by hybrid->temp_table under their old alias or name.
+void RewriteSourceTableRef(unique_ptr<TableRef> &table_ref, const string &attached_catalog,
+                           const string &remote_catalog, PostHogHybridDMLSource *hybrid) {
+	if (!table_ref || !hybrid) {
+		RewriteTableRef(table_ref, attached_catalog, remote_catalog);
+		return;
+	}
+	if (table_ref->type == TableReferenceType::JOIN) {
+		auto &join_ref = table_ref->Cast<JoinRef>();
+		RewriteSourceTableRef(join_ref.left, attached_catalog, remote_catalog, hybrid);
+		RewriteSourceTableRef(join_ref.right, attached_catalog, remote_catalog, hybrid);
+		RewriteExpression(join_ref.condition, attached_catalog, remote_catalog);
+		return;
+	}
+	if (table_ref->type != TableReferenceType::BASE_TABLE ||
+	    !IsLocalTableRef(table_ref->Cast<BaseTableRef>(), attached_catalog, remote_catalog, *hybrid)) {
+		RewriteTableRef(table_ref, attached_catalog, remote_catalog);
+		return;
+	}
+	auto &base_ref = table_ref->Cast<BaseTableRef>();
+	if (hybrid->Found() &&
+	    (!StringUtil::CIEquals(hybrid->catalog, base_ref.catalog_name) ||
+	     !StringUtil::CIEquals(hybrid->schema, base_ref.schema_name) ||
+	     !StringUtil::CIEquals(hybrid->table, base_ref.table_name))) {
+		throw NotImplementedException("PostHog: hybrid DML reads at most one local table");
+	}
+	hybrid->catalog = base_ref.catalog_name;
+	hybrid->schema = base_ref.schema_name;
+	hybrid->table = base_ref.table_name;
+	if (base_ref.alias.empty()) {
+		base_ref.alias = base_ref.table_name;
+	}
+	base_ref.catalog_name.clear();
+	base_ref.schema_name.clear();
+	base_ref.table_name = hybrid->temp_table;
+}
+
+// True when every base table referenced by node (including CTE bodies and subqueries) names a
+// catalog explicitly, or is a reference to a CTE defined by an enclosing query.
+bool TableRefsAreQualified(QueryNode &node, case_insensitive_set_t cte_names) {
+	for (auto &entry : node.cte_map.map) {
+		cte_names.insert(entry.first);
+	}
+	bool qualified = true;
+	for (auto &entry : node.cte_map.map) {
+		auto &cte = *entry.second;
+		if (cte.query && cte.query->node && !TableRefsAreQualified(*cte.query->node, cte_names)) {
+			qualified = false;
+		}
+	}
+	std::function<void(unique_ptr<ParsedExpression> &)> check_expression = [&](unique_ptr<ParsedExpression> &expr) {
+		if (!expr) {
+			return;
+		}
+		ParsedExpressionIterator::VisitExpressionMutable<SubqueryExpression>(
+		    *expr, [&](SubqueryExpression &subquery_expr) {
+			    if (subquery_expr.subquery && subquery_expr.subquery->node &&
+			        !TableRefsAreQualified(*subquery_expr.subquery->node, cte_names)) {
+				    qualified = false;
+			    }
+		    });
+	};
+	ParsedExpressionIterator::EnumerateQueryNodeChildren(node, check_expression, [&](TableRef &child_ref) {
+		if (child_ref.type == TableReferenceType::SUBQUERY) {
+			auto &subquery_ref = child_ref.Cast<SubqueryRef>();
+			if (subquery_ref.subquery && subquery_ref.subquery->node &&
+			    !TableRefsAreQualified(*subquery_ref.subquery->node, cte_names)) {
+				qualified = false;
+			}
+			return;
+		}
+		if (child_ref.type != TableReferenceType::BASE_TABLE) {
+			return;
+		}
+		auto &base_ref = child_ref.Cast<BaseTableRef>();
+		if (!CatalogIsUnset(base_ref.catalog_name)) {
+			return;
+		}
+		if (!base_ref.schema_name.empty() || cte_names.find(base_ref.table_name) == cte_names.end()) {
+			qualified = false;
+		}
+	});
+	return qualified;
+}
+
+// True when every function and cast written in node (including CTE bodies, subqueries and table
+// functions) is one the remote query builder pushes down. Anything else may be a local macro or UDF,
+// or be folded by the local binder from session state (current_setting(), getvariable(), TimeZone).
+bool ExpressionsAreRemote(QueryNode &node) {
+	bool remote = true;
+	for (auto &entry : node.cte_map.map) {
+		auto &cte = *entry.second;
+		if (cte.query && cte.query->node && !ExpressionsAreRemote(*cte.query->node)) {
+			remote = false;
+		}
+	}
+	std::function<void(unique_ptr<ParsedExpression> &)> check_expression = [&](unique_ptr<ParsedExpression> &expr) {
+		if (!expr) {
+			return;
+		}
+		ParsedExpressionIterator::VisitExpression<FunctionExpression>(*expr, [&](const FunctionExpression &function) {
+			if (!function.catalog.empty() || !function.schema.empty() ||
+			    !PostHogRemoteQueryBuilder::IsRemoteFunctionName(function.function_name)) {
+				remote = false;
+			}
+		});
+		ParsedExpressionIterator::VisitExpression<CastExpression>(*expr, [&](const CastExpression &cast) {
+			if (!PostHogRemoteQueryBuilder::IsRemoteCastType(cast.cast_type)) {
+				remote = false;
+			}
+		});
+		ParsedExpressionIterator::VisitExpressionMutable<SubqueryExpression>(
+		    *expr, [&](SubqueryExpression &subquery_expr) {
+			    if (subquery_expr.subquery && subquery_expr.subquery->node &&
+			        !ExpressionsAreRemote(*subquery_expr.subquery->node)) {
+				    remote = false;
+			    }
+		    });
+	};
+	ParsedExpressionIterator::EnumerateQueryNodeChildren(node, check_expression, [&](TableRef &child_ref) {
+		if (child_ref.type == TableReferenceType::SUBQUERY) {
+			auto &subquery_ref = child_ref.Cast<SubqueryRef>();
+			if (subquery_ref.subquery && subquery_ref.subquery->node &&
+			    !ExpressionsAreRemote(*subquery_ref.subquery->node)) {
+				remote = false;
+			}
+		}
+	});
+	return remote;
+}
+
 } // namespace
 
 // TRUNCATE TABLE also flows through this path: DuckDB's grammar (delete.y) desugars
 // TRUNCATE into a PGDeleteStmt with no WHERE/USING/RETURNING/WITH clauses, so it arrives
 // here as a plain unconditional DELETE and is forwarded to the remote server as such.
 PostHogRewrittenDeleteSQL RewriteRemoteDeleteSQL(const string &query, const string &attached_catalog,
-                                                 const string &remote_catalog) {
+                                                 const string &remote_catalog, PostHogHybridDMLSource *hybrid) {
 	Parser parser;
 	parser.ParseQuery(query);
 
@@ -159,7 +308,7 @@ PostHogRewrittenDeleteSQL RewriteRemoteDeleteSQL(const string &query, const stri
 	auto &rewritten_stmt = rewritten_stmt_holder->Cast<DeleteStatement>();
 	RewriteTableRef(rewritten_stmt.table, attached_catalog, remote_catalog);
 	for (auto &using_clause : rewritten_stmt.using_clauses) {
-		RewriteTableRef(using_clause, attached_catalog, remote_catalog);
+		RewriteSourceTableRef(using_clause, attached_catalog, remote_catalog, hybrid);
 	}
 	RewriteExpression(rewritten_stmt.condition, attached_catalog, remote_catalog);
 	for (auto &expr : rewritten_stmt.returning_list) {
@@ -183,12 +332,12 @@ PostHogRewrittenDeleteSQL RewriteRemoteDeleteSQL(const string &query, const stri
 }
 
 PostHogRewrittenDeleteSQL RewriteRemoteDeleteSQL(ClientContext &context, const string &attached_catalog,
-                                                 const string &remote_catalog) {
-	return RewriteRemoteDeleteSQL(context.GetCurrentQuery(), attached_catalog, remote_catalog);
+                                                 const string &remote_catalog, PostHogHybridDMLSource *hybrid) {
+	return RewriteRemoteDeleteSQL(context.GetCurrentQuery(), attached_catalog, remote_catalog, hybrid);
 }
 
 PostHogRewrittenUpdateSQL RewriteRemoteUpdateSQL(const string &query, const string &attached_catalog,
-                                                 const string &remote_catalog) {
+                                                 const string &remote_catalog, PostHogHybridDMLSource *hybrid) {
 	Parser parser;
 	parser.ParseQuery(query);
 
@@ -209,7 +358,7 @@ PostHogRewrittenUpdateSQL RewriteRemoteUpdateSQL(const string &query, const stri
 	auto rewritten_stmt_holder = update_stmt->Copy();
 	auto &rewritten_stmt = rewritten_stmt_holder->Cast<UpdateStatement>();
 	RewriteTableRef(rewritten_stmt.table, attached_catalog, remote_catalog);
-	RewriteTableRef(rewritten_stmt.from_table, attached_catalog, remote_catalog);
+	RewriteSourceTableRef(rewritten_stmt.from_table, attached_catalog, remote_catalog, hybrid);
 	if (rewritten_stmt.set_info) {
 		for (auto &expr : rewritten_stmt.set_info->expressions) {
 			RewriteExpression(expr, attached_catalog, remote_catalog);
@@ -237,7 +386,7 @@ PostHogRewrittenUpdateSQL RewriteRemoteUpdateSQL(const string &query, const stri
 }
 
 PostHogRewrittenMergeSQL RewriteRemoteMergeSQL(const string &query, const string &attached_catalog,
-                                               const string &remote_catalog) {
+                                               const string &remote_catalog, PostHogHybridDMLSource *hybrid) {
 	Parser parser;
 	parser.ParseQuery(query);
 
@@ -260,7 +409,7 @@ PostHogRewrittenMergeSQL RewriteRemoteMergeSQL(const string &query, const string
 
 	// Rewrite target and source table refs
 	RewriteTableRef(rewritten.target, attached_catalog, remote_catalog);
-	RewriteTableRef(rewritten.source, attached_catalog, remote_catalog);
+	RewriteSourceTableRef(rewritten.source, attached_catalog, remote_catalog, hybrid);
 
 	// Rewrite ON join condition
 	RewriteExpression(rewritten.join_condition, attached_catalog, remote_catalog);
@@ -304,8 +453,8 @@ PostHogRewrittenMergeSQL RewriteRemoteMergeSQL(const string &query, const string
 }
 
 PostHogRewrittenMergeSQL RewriteRemoteMergeSQL(ClientContext &context, const string &attached_catalog,
-                                               const string &remote_catalog) {
-	return RewriteRemoteMergeSQL(context.GetCurrentQuery(), attached_catalog, remote_catalog);
+                                               const string &remote_catalog, PostHogHybridDMLSource *hybrid) {
+	return RewriteRemoteMergeSQL(context.GetCurrentQuery(), attached_catalog, remote_catalog, hybrid);
 }
 
 string BuildRemoteCreateTableSQL(const CreateTableInfo &info, const string &attached_catalog,
@@ -329,8 +478,60 @@ string BuildRemoteCreateTableSQL(const CreateTableInfo &info, const string &atta
 }
 
 PostHogRewrittenUpdateSQL RewriteRemoteUpdateSQL(ClientContext &context, const string &attached_catalog,
-                                                 const string &remote_catalog) {
-	return RewriteRemoteUpdateSQL(context.GetCurrentQuery(), attached_catalog, remote_catalog);
+                                                 const string &remote_catalog, PostHogHybridDMLSource *hybrid) {
+	return RewriteRemoteUpdateSQL(context.GetCurrentQuery(), attached_catalog, remote_catalog, hybrid);
+}
+
+bool TryRewriteRemoteCreateTableAsSQL(const string &query, const CreateTableInfo &target,
+                                      const string &attached_catalog, const string &remote_catalog, string &result) {
+	Parser parser;
+	try {
+		parser.ParseQuery(query);
+	} catch (const std::exception &) {
+		return false;
+	}
+	if (parser.statements.size() != 1 || parser.statements[0]->type != StatementType::CREATE_STATEMENT) {
+		return false;
+	}
+	auto &statement = parser.statements[0]->Cast<CreateStatement>();
+	if (statement.n_param > 0 || !statement.named_param_map.empty() || !statement.info ||
+	    statement.info->type != CatalogType::TABLE_ENTRY) {
+		return false;
+	}
+	auto &create_info = statement.info->Cast<CreateTableInfo>();
+	if (!create_info.query || !create_info.query->node) {
+		return false;
+	}
+
+	if (!CatalogIsUnset(create_info.catalog) && !StringUtil::CIEquals(create_info.catalog, attached_catalog) &&
+	    !StringUtil::CIEquals(create_info.catalog, remote_catalog)) {
+		return false;
+	}
+	// The binder already resolved the target against the local search path; pin it so the server
+	// does not resolve it again against its own.
+	create_info.catalog = remote_catalog;
+	create_info.schema = target.schema;
+	create_info.table = target.table;
+
+	auto &node = *create_info.query->node;
+	try {
+		RewriteQueryNode(node, attached_catalog, remote_catalog);
+	} catch (const BinderException &) {
+		return false;
+	}
+	if (!TableRefsAreQualified(node, case_insensitive_set_t()) || !ExpressionsAreRemote(node)) {
+		return false;
+	}
+
+	result = create_info.ToString();
+	RemoveTrailingSemicolon(result);
+	return true;
+}
+
+bool TryRewriteRemoteCreateTableAsSQL(ClientContext &context, const CreateTableInfo &target,
+                                      const string &attached_catalog, const string &remote_catalog, string &result) {
+	return TryRewriteRemoteCreateTableAsSQL(context.GetCurrentQuery(), target, attached_catalog, remote_catalog,
+	                                        result);
 }
 
 string BuildRemoteCreateViewSQL(const CreateViewInfo &info, const string &attached_catalog,
@@ -7,11 +7,31 @@
 
 #pragma once
 
+#include <functional>
 #include <string>
 namespace duckdb {
 
 class ClientContext;
 
+// Hybrid DML (hybrid_dml): the one local table a remote MERGE source, UPDATE ... FROM or DELETE ...
+// USING clause reads. Given one, the rewriters below reference temp_table, a temporary table of the
+// server session, in its place instead of rejecting the external catalog.
+struct PostHogHybridDMLSource {
+	// Temporary table standing in for the local table.
+	std::string temp_table;
+	// Whether a table reference without a catalog resolves to a local table.
+	std::function<bool(const std::string &schema, const std::string &table)> is_local;
+	// Set by the rewriter to the local table found, if any. catalog and schema are empty when the
+	// statement left them out.
+	std::string catalog;
+	std::string schema;
+	std::string table;
+
+	bool Found() const {
+		return !table.empty();
+	}
+};
+
 struct PostHogRewrittenUpdateSQL {
 	std::string non_returning_sql;
 	std::string returning_sql;
@@ -19,9 +39,11 @@ struct PostHogRewrittenUpdateSQL {
 };
 
 PostHogRewrittenUpdateSQL RewriteRemoteUpdateSQL(const std::string &query, const std::string &attached_catalog,
-                                                 const std::string &remote_catalog);
+                                                 const std::string &remote_catalog,
+                                                 PostHogHybridDMLSource *hybrid = nullptr);
 PostHogRewrittenUpdateSQL RewriteRemoteUpdateSQL(ClientContext &context, const std::string &attached_catalog,
-                                                 const std::string &remote_catalog);
+                                                 const std::string &remote_catalog,
+                                                 PostHogHybridDMLSource *hybrid = nullptr);
 
 struct PostHogRewrittenDeleteSQL {
 	std::string non_returning_sql;
@@ -30,9 +52,11 @@ struct PostHogRewrittenDeleteSQL {
 };
 
 PostHogRewrittenDeleteSQL RewriteRemoteDeleteSQL(const std::string &query, const std::string &attached_catalog,
-                                                 const std::string &remote_catalog);
+                                                 const std::string &remote_catalog,
+                                                 PostHogHybridDMLSource *hybrid = nullptr);
 PostHogRewrittenDeleteSQL RewriteRemoteDeleteSQL(ClientContext &context, const std::string &attached_catalog,
-                                                 const std::string &remote_catalog);
+                                                 const std::string &remote_catalog,
+                                                 PostHogHybridDMLSource *hybrid = nullptr);
 
 struct PostHogRewrittenMergeSQL {
 	std::string non_returning_sql;
@@ -41,9 +65,11 @@ struct PostHogRewrittenMergeSQL {
 };
 
 PostHogRewrittenMergeSQL RewriteRemoteMergeSQL(const std::string &query, const std::string &attached_catalog,
-                                               const std::string &remote_catalog);
+                                               const std::string &remote_catalog,
+                                               PostHogHybridDMLSource *hybrid = nullptr);
 PostHogRewrittenMergeSQL RewriteRemoteMergeSQL(ClientContext &context, const std::string &attached_catalog,
-                                               const std::string &remote_catalog);
+                                               const std::string &remote_catalog,
+                                               PostHogHybridDMLSource *hybrid = nullptr);
 
 struct CreateTableInfo;
 struct CreateViewInfo;
@@ -51,6 +77,20 @@ struct CreateViewInfo;
 std::string BuildRemoteCreateTableSQL(const CreateTableInfo &info, const std::string &attached_catalog,
                                       const std::string &remote_catalog);
 
+// Rewrites the original CREATE TABLE ... AS SELECT text so the server runs the whole statement.
+// The target is replaced by the bound schema/table of target. Returns false, leaving result
+// untouched, when the statement cannot safely be sent verbatim: prepared-statement parameters,
+// references to external catalogs, source tables not qualified with a catalog (their
+// resolution depends on the local search path), or functions and casts outside the pushdown
+// allowlist of PostHogRemoteQueryBuilder (local macros and UDFs, session- or TimeZone-dependent
+// expressions).
+bool TryRewriteRemoteCreateTableAsSQL(const std::string &query, const CreateTableInfo &target,
+                                      const std::string &attached_catalog, const std::string &remote_catalog,
+                                      std::string &result);
+bool TryRewriteRemoteCreateTableAsSQL(ClientContext &context, const CreateTableInfo &target,
+                                      const std::string &attached_catalog, const std::string &remote_catalog,
+                                      std::string &result);
+
 std::string BuildRemoteCreateViewSQL(const CreateViewInfo &info, const std::string &attached_catalog,
                                      const std::string &remote_catalog);
 
@@ -0,0 +1,230 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// execution/posthog_hybrid_dml.cpp
+//
+// Remote MERGE/UPDATE/DELETE reading a local table through an uploaded temporary table
+//===----------------------------------------------------------------------===//
+
+#include "execution/posthog_hybrid_dml.hpp"
+
+#include "catalog/posthog_catalog.hpp"
+#include "duckdb/catalog/catalog.hpp"
+#include "duckdb/catalog/catalog_entry/table_catalog_entry.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/numeric_utils.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/common/types/column/column_data_collection.hpp"
+#include "duckdb/execution/operator/scan/physical_table_scan.hpp"
+#include "duckdb/execution/physical_plan_generator.hpp"
+#include "execution/posthog_sql_utils.hpp"
+#include "execution/posthog_temp_table.hpp"
+#include "flight/query_stats.hpp"
+#include "storage/posthog_transaction.hpp"
+#include "utils/posthog_tracer.hpp"
+
+namespace duckdb {
+
+namespace {
+
+struct PostHogHybridDMLSinkState : public GlobalSinkState {
+	PostHogHybridDMLSinkState(ClientContext &context, const vector<LogicalType> &types) : rows(context, types) {
+	}
+
+	mutex lock;
+	ColumnDataCollection rows;
+	int64_t affected_rows = 0;
+	// For EXPLAIN ANALYZE: the upload and statement together, the bytes uploaded and the row count
+	// the server reported for the statement.
+	int64_t remote_us = 0;
+	int64_t bytes_sent = 0;
+	int64_t remote_rows = -1;
+};
+
+struct PostHogHybridDMLSourceState : public GlobalSourceState {
+	bool finished = false;
+};
+
+// Collects the scans of table in plan.
+void FindTableScans(PhysicalOperator &plan, TableCatalogEntry &table, vector<reference<PhysicalTableScan>> &result) {
+	if (plan.type == PhysicalOperatorType::TABLE_SCAN) {
+		auto &scan = plan.Cast<PhysicalTableScan>();
+		if (scan.bind_data && scan.function.get_bind_info) {
+			auto scanned = scan.function.get_bind_info(scan.bind_data.get()).table;
+			if (scanned && &scanned->ParentCatalog() == &table.ParentCatalog() &&
+			    scanned->ParentSchema().name == table.ParentSchema().name && scanned->name == table.name) {
+				result.push_back(scan);
+			}
+		}
+	}
+	for (auto &child : plan.children) {
+		FindTableScans(child.get(), table, result);
+	}
+}
+
+} // namespace
+
+PhysicalPostHogHybridDML::PhysicalPostHogHybridDML(PhysicalPlan &physical_plan, vector<LogicalType> types,
+                                                   PostHogCatalog &catalog, string name, string remote_sql,
+                                                   string temp_table, string local_table, vector<string> column_names,
+                                                   idx_t estimated_cardinality)
+    : PhysicalOperator(physical_plan, PhysicalOperatorType::EXTENSION, std::move(types), estimated_cardinality),
+      catalog_(catalog), name_(std::move(name)), remote_sql_(std::move(remote_sql)),
+      temp_table_(std::move(temp_table)), local_table_(std::move(local_table)),
+      column_names_(std::move(column_names)) {
+}
+
+PhysicalOperator &PhysicalPostHogHybridDML::Plan(ClientContext &context, PhysicalPlanGenerator &planner,
+                                                 PostHogCatalog &catalog, string name, vector<LogicalType> types,
+                                                 string remote_sql, const PostHogHybridDMLSource &hybrid,
+                                                 PhysicalOperator &statement_plan, idx_t estimated_cardinality) {
+	vector<string> parts;
+	for (auto &part : {hybrid.catalog, hybrid.schema, hybrid.table}) {
+		if (!part.empty()) {
+			parts.push_back(QuoteIdent(part));
+		}
+	}
+	auto local_table = StringUtil::Join(parts, ".");
+
+	// The statement was planned in this query's context, so its scan of the local table sees the same
+	// transaction (and temporary tables) as the statement itself. That scan becomes the child.
+	auto entry = Catalog::GetEntry<TableCatalogEntry>(
+	    context, hybrid.catalog.empty() ? INVALID_CATALOG : hybrid.catalog,
+	    hybrid.schema.empty() ? INVALID_SCHEMA : hybrid.schema, hybrid.table, OnEntryNotFound::RETURN_NULL);
+	vector<reference<PhysicalTableScan>> scans;
+	if (entry) {
+		FindTableScans(statement_plan, *entry, scans);
+	}
+	if (scans.size() != 1) {
+		throw NotImplementedException("PostHog: hybrid DML needs a statement that reads %s exactly once", local_table);
+	}
+	auto &scan = scans[0].get();
+
+	// Upload only the columns the statement reads, from the rows left by the filters DuckDB pushed into
+	// the scan. Columns read only by those filters are usually projected out of the scan's result, but
+	// the rewritten statement still names them, so every column of the scan is returned.
+	vector<string> column_names;
+	vector<LogicalType> column_types;
+	vector<idx_t> projection_ids;
+	for (idx_t i = 0; i < scan.column_ids.size(); i++) {
+		auto &column = scan.column_ids[i];
+		if (column.GetPrimaryIndex() >= scan.names.size()) {
+			// A virtual column such as rowid, which the rewritten statement cannot name.
+			continue;
+		}
+		// Read struct columns whole rather than only the fields the plan uses.
+		column = ColumnIndex(column.GetPrimaryIndex());
+		projection_ids.push_back(i);
+		column_names.push_back(scan.names[column.GetPrimaryIndex()]);
+		column_types.push_back(scan.returned_types[column.GetPrimaryIndex()]);
+	}
+	if (projection_ids.empty()) {
+		// Only the row count of the table matters: upload its first column.
+		scan.column_ids.emplace_back(0);
+		projection_ids.push_back(scan.column_ids.size() - 1);
+		column_names.push_back(scan.names[0]);
+		column_types.push_back(scan.returned_types[0]);
+	}
+	if (!scan.function.filter_prune) {
+		// The scan function returns all of column_ids regardless of projection_ids.
+		if (projection_ids.size() != scan.column_ids.size()) {
+			throw NotImplementedException("PostHog: hybrid DML cannot upload the rows of %s", local_table);
+		}
+		projection_ids.clear();
+	}
+	scan.projection_ids = std::move(projection_ids);
+	scan.types = std::move(column_types);
+
+	auto &result = planner.Make<PhysicalPostHogHybridDML>(std::move(types), catalog, std::move(name),
+	                                                      std::move(remote_sql), hybrid.temp_table,
+	                                                      std::move(local_table), std::move(column_names),
+	                                                      estimated_cardinality);
+	result.children.push_back(scan);
+	return result;
+}
+
+string PhysicalPostHogHybridDML::GetName() const {
+	return name_;
+}
+
+InsertionOrderPreservingMap<string> PhysicalPostHogHybridDML::ParamsToString() const {
+	InsertionOrderPreservingMap<string> result;
+	result["Remote SQL"] = remote_sql_;
+	result["Uploaded Table"] = local_table_ + " AS " + PostHogRemoteTempTable::SQLName(temp_table_);
+	return result;
+}
+
+unique_ptr<GlobalSinkState> PhysicalPostHogHybridDML::GetGlobalSinkState(ClientContext &context) const {
+	return make_uniq<PostHogHybridDMLSinkState>(context, children[0].get().GetTypes());
+}
+
+SinkResultType PhysicalPostHogHybridDML::Sink(ExecutionContext &context, DataChunk &chunk,
+                                              OperatorSinkInput &input) const {
+	(void)context;
+	auto &sink_state = input.global_state.Cast<PostHogHybridDMLSinkState>();
+	lock_guard<mutex> guard(sink_state.lock);
+	sink_state.rows.Append(chunk);
+	return SinkResultType::NEED_MORE_INPUT;
+}
+
+SinkFinalizeType PhysicalPostHogHybridDML::Finalize(Pipeline &pipeline, Event &event, ClientContext &context,
+                                                    OperatorSinkFinalizeInput &input) const {
+	(void)pipeline;
+	(void)event;
+	auto &sink_state = input.global_state.Cast<PostHogHybridDMLSinkState>();
+	PostHogTraceScope trace(name_.c_str(), remote_sql_);
+	auto &transaction = PostHogTransaction::Get(context, catalog_);
+	auto remote_txn_id = transaction.RemoteTransactionForWrite();
+	auto stop_token = transaction.GetStopToken();
+
+	auto started = std::chrono::steady_clock::now();
+	auto temp_table = PostHogRemoteTempTable::Upload(context, catalog_, temp_table_, sink_state.rows, column_names_,
+	                                                 remote_txn_id, stop_token);
+	if (!temp_table) {
+		throw NotImplementedException("PostHog: hybrid DML needs a Flight SQL server that implements bulk ingest");
+	}
+	sink_state.bytes_sent = temp_table->BytesSent();
+	sink_state.affected_rows = catalog_.GetFlightClient().ExecuteUpdate(remote_sql_, remote_txn_id, stop_token);
+	sink_state.remote_us = MicrosSince(started);
+	sink_state.remote_rows = sink_state.affected_rows;
+	return SinkFinalizeType::READY;
+}
+
+unique_ptr<GlobalSourceState> PhysicalPostHogHybridDML::GetGlobalSourceState(ClientContext &context) const {
+	(void)context;
+	return make_uniq<PostHogHybridDMLSourceState>();
+}
+
+SourceResultType PhysicalPostHogHybridDML::GetDataInternal(ExecutionContext &context, DataChunk &chunk,
+                                                           OperatorSourceInput &input) const {
+	(void)context;
+	auto &source_state = input.global_state.Cast<PostHogHybridDMLSourceState>();
+	if (source_state.finished) {
+		return SourceResultType::FINISHED;
+	}
+	source_state.finished = true;
+	auto &sink_state = this->sink_state->Cast<PostHogHybridDMLSinkState>();
+	chunk.SetCardinality(1);
+	chunk.SetValue(0, 0, Value::BIGINT(sink_state.affected_rows));
+	return SourceResultType::FINISHED;
+}
+
+InsertionOrderPreservingMap<string> PhysicalPostHogHybridDML::ExtraSourceParams(GlobalSourceState &gstate,
+                                                                                LocalSourceState &lstate) const {
+	(void)gstate;
+	(void)lstate;
+	InsertionOrderPreservingMap<string> result;
+	if (!this->sink_state) {
+		return result;
+	}
+	auto &sink_state = this->sink_state->Cast<PostHogHybridDMLSinkState>();
+	result["Remote Time"] = FormatRemoteMillis(sink_state.remote_us);
+	result["Uploaded Rows"] = to_string(sink_state.rows.Count());
+	result["Uploaded Bytes"] = StringUtil::BytesToHumanReadableString(NumericCast<idx_t>(sink_state.bytes_sent));
+	if (sink_state.remote_rows >= 0) {
+		result["Remote Rows"] = to_string(sink_state.remote_rows);
+	}
+	return result;
+}
+
+} // namespace duckdb
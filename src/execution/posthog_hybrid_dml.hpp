@@ -0,0 +1,76 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// execution/posthog_hybrid_dml.hpp
+//
+// Remote MERGE/UPDATE/DELETE reading a local table through an uploaded temporary table
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb/execution/physical_operator.hpp"
+#include "execution/posthog_dml_rewriter.hpp"
+
+namespace duckdb {
+
+class PhysicalPlanGenerator;
+class PostHogCatalog;
+
+// Sinks the rows of the local table a hybrid statement reads (its scan is the only child), uploads
+// them to the temporary table the rewritten SQL reads in its place, and then runs that SQL, all in
+// the catalog's remote transaction. Produces the affected-row count, like PhysicalPostHogMerge.
+class PhysicalPostHogHybridDML : public PhysicalOperator {
+public:
+	static constexpr const PhysicalOperatorType TYPE = PhysicalOperatorType::EXTENSION;
+
+	PhysicalPostHogHybridDML(PhysicalPlan &physical_plan, vector<LogicalType> types, PostHogCatalog &catalog,
+	                         string name, string remote_sql, string temp_table, string local_table,
+	                         vector<string> column_names, idx_t estimated_cardinality);
+
+	// Plans the hybrid form of a statement whose rewrite found hybrid's local table: the scan of that
+	// table in statement_plan (the statement's own planned child), reading only the columns the
+	// statement uses, feeding a PhysicalPostHogHybridDML that runs remote_sql. name is the operator's
+	// name in EXPLAIN, e.g. "POSTHOG_MERGE".
+	static PhysicalOperator &Plan(ClientContext &context, PhysicalPlanGenerator &planner, PostHogCatalog &catalog,
+	                              string name, vector<LogicalType> types, string remote_sql,
+	                              const PostHogHybridDMLSource &hybrid, PhysicalOperator &statement_plan,
+	                              idx_t estimated_cardinality);
+
+	string GetName() const override;
+	InsertionOrderPreservingMap<string> ParamsToString() const override;
+
+	unique_ptr<GlobalSinkState> GetGlobalSinkState(ClientContext &context) const override;
+	SinkResultType Sink(ExecutionContext &context, DataChunk &chunk, OperatorSinkInput &input) const override;
+	SinkFinalizeType Finalize(Pipeline &pipeline, Event &event, ClientContext &context,
+	                          OperatorSinkFinalizeInput &input) const override;
+
+	unique_ptr<GlobalSourceState> GetGlobalSourceState(ClientContext &context) const override;
+	SourceResultType GetDataInternal(ExecutionContext &context, DataChunk &chunk,
+	                                 OperatorSourceInput &input) const override;
+	InsertionOrderPreservingMap<string> ExtraSourceParams(GlobalSourceState &gstate,
+	                                                      LocalSourceState &lstate) const override;
+
+	bool IsSink() const override {
+		return true;
+	}
+
+	bool ParallelSink() const override {
+		return true;
+	}
+
+	bool IsSource() const override {
+		return true;
+	}
+
+private:
+	PostHogCatalog &catalog_;
+	string name_;
+	string remote_sql_;
+	string temp_table_;
+	// The local table as written in the statement, for EXPLAIN.
+	string local_table_;
+	// Names of the uploaded columns, in the order the child returns them.
+	vector<string> column_names_;
+};
+
+} // namespace duckdb
@@ -11,14 +11,31 @@
 #include "duckdb/common/exception.hpp"
 #include "duckdb/common/numeric_utils.hpp"
 #include "execution/posthog_sql_utils.hpp"
+#include "execution/posthog_table_writer.hpp"
 #include "storage/posthog_transaction.hpp"
 
+#include <atomic>
+#include <memory>
+
 namespace duckdb {
 
 namespace {
 
 struct PostHogInsertGlobalState : public GlobalSinkState {
-	idx_t insert_count = 0;
+	explicit PostHogInsertGlobalState(std::shared_ptr<PostHogRemoteTableWriter> writer_p)
+	    : writer(std::move(writer_p)) {
+	}
+
+	// Shared with the writes a pipelined transaction defers past the end of the statement.
+	std::shared_ptr<PostHogRemoteTableWriter> writer;
+	std::atomic<idx_t> insert_count {0};
+};
+
+struct PostHogInsertLocalState : public LocalSinkState {
+	explicit PostHogInsertLocalState(unique_ptr<PostHogPipelinedWriteBuffer> buffer_p) : buffer(std::move(buffer_p)) {
+	}
+
+	unique_ptr<PostHogPipelinedWriteBuffer> buffer;
 };
 
 struct PostHogInsertSourceState : public GlobalSourceState {
@@ -30,51 +47,64 @@ struct PostHogInsertSourceState : public GlobalSourceState {
 PhysicalPostHogInsert::PhysicalPostHogInsert(PhysicalPlan &physical_plan, vector<LogicalType> types,
                                              PostHogCatalog &catalog, string remote_schema, string remote_table,
                                              vector<string> column_names, bool on_conflict_do_nothing,
-                                             string on_conflict_clause, idx_t estimated_cardinality)
+                                             string on_conflict_clause, bool bulk_ingest_eligible, bool parallel,
+                                             idx_t estimated_cardinality)
     : PhysicalOperator(physical_plan, PhysicalOperatorType::EXTENSION, std::move(types), estimated_cardinality),
       catalog_(catalog), remote_schema_(std::move(remote_schema)), remote_table_(std::move(remote_table)),
       column_names_(std::move(column_names)), on_conflict_do_nothing_(on_conflict_do_nothing),
-      on_conflict_clause_(std::move(on_conflict_clause)) {
+      on_conflict_clause_(std::move(on_conflict_clause)), bulk_ingest_eligible_(bulk_ingest_eligible),
+      parallel_(parallel) {
 }
 
 string PhysicalPostHogInsert::GetName() const {
 	return "POSTHOG_INSERT";
 }
 
+InsertionOrderPreservingMap<string> PhysicalPostHogInsert::ParamsToString() const {
+	InsertionOrderPreservingMap<string> result;
+	result["Remote Table"] = QualifyRemoteTableName(catalog_.GetRemoteCatalog(), remote_schema_, remote_table_);
+	return result;
+}
+
 unique_ptr<GlobalSinkState> PhysicalPostHogInsert::GetGlobalSinkState(ClientContext &context) const {
-	return make_uniq<PostHogInsertGlobalState>();
+	return make_uniq<PostHogInsertGlobalState>(std::make_shared<PostHogRemoteTableWriter>(
+	    catalog_, remote_schema_, remote_table_, column_names_, on_conflict_clause_, bulk_ingest_eligible_));
+}
+
+unique_ptr<LocalSinkState> PhysicalPostHogInsert::GetLocalSinkState(ExecutionContext &context) const {
+	auto &sink_state = this->sink_state->Cast<PostHogInsertGlobalState>();
+	auto &transaction = PostHogTransaction::Get(context.client, catalog_);
+	auto remote_txn_id = transaction.RemoteTransactionForAppend(sink_state.writer->QualifiedTableName());
+	return make_uniq<PostHogInsertLocalState>(make_uniq<PostHogPipelinedWriteBuffer>(
+	    context.client, *sink_state.writer, children[0].get().GetTypes(), std::move(remote_txn_id),
+	    "INSERT into " + sink_state.writer->QualifiedTableName()));
 }
 
 SinkResultType PhysicalPostHogInsert::Sink(ExecutionContext &context, DataChunk &chunk,
                                            OperatorSinkInput &input) const {
-	if (chunk.size() == 0) {
-		return SinkResultType::NEED_MORE_INPUT;
-	}
-
-	auto sql = BuildInsertSQL(chunk);
-	auto remote_txn_id = PostHogTransaction::Get(context.client, catalog_).remote_txn_id;
-	int64_t affected = 0;
-	try {
-		affected = catalog_.GetFlightClient().ExecuteUpdate(sql, remote_txn_id);
-	} catch (const Exception &) {
-		// ensure duckdb::Exceptions are bubbled up instead of being caught in next catch
-		throw;
-	} catch (const std::exception &ex) {
-		throw IOException("PostHog: INSERT into %s failed for chunk with %llu row(s): %s", QualifyTableName(),
-		                  chunk.size(), ex.what());
-	}
+	(void)context;
+	auto &local_state = input.local_state.Cast<PostHogInsertLocalState>();
+	local_state.buffer->Append(chunk);
+	return SinkResultType::NEED_MORE_INPUT;
+}
 
+SinkCombineResultType PhysicalPostHogInsert::Combine(ExecutionContext &context,
+                                                     OperatorSinkCombineInput &input) const {
 	auto &sink_state = input.global_state.Cast<PostHogInsertGlobalState>();
-	if (affected < 0) {
-		if (on_conflict_do_nothing_) {
-			throw NotImplementedException(
-			    "PostHog: INSERT ... ON CONFLICT DO NOTHING requires an affected-row count from remote server");
-		}
-		sink_state.insert_count += chunk.size();
+	auto &local_state = input.local_state.Cast<PostHogInsertLocalState>();
+	auto &transaction = PostHogTransaction::Get(context.client, catalog_);
+	// ON CONFLICT changes fewer rows than it sends, so only plain appends report rows sent as inserted.
+	if (on_conflict_clause_.empty() && transaction.PipelinesWrites()) {
+		local_state.buffer->FinishDeferred(transaction, sink_state.writer);
 	} else {
-		sink_state.insert_count += NumericCast<idx_t>(affected);
+		local_state.buffer->Finish();
 	}
-	return SinkResultType::NEED_MORE_INPUT;
+	if (on_conflict_do_nothing_ && !local_state.buffer->AllCountsReported()) {
+		throw NotImplementedException(
+		    "PostHog: INSERT ... ON CONFLICT DO NOTHING requires an affected-row count from remote server");
+	}
+	sink_state.insert_count += local_state.buffer->RowsWritten();
+	return SinkCombineResultType::FINISHED;
 }
 
 SinkFinalizeType PhysicalPostHogInsert::Finalize(Pipeline &pipeline, Event &event, ClientContext &context,
@@ -101,16 +131,19 @@ SourceResultType PhysicalPostHogInsert::GetDataInternal(ExecutionContext &contex
 	source_state.finished = true;
 	auto &global_sink = this->sink_state->Cast<PostHogInsertGlobalState>();
 	chunk.SetCardinality(1);
-	chunk.SetValue(0, 0, Value::BIGINT(NumericCast<int64_t>(global_sink.insert_count)));
+	chunk.SetValue(0, 0, Value::BIGINT(NumericCast<int64_t>(global_sink.insert_count.load())));
 	return SourceResultType::FINISHED;
 }
 
-string PhysicalPostHogInsert::QualifyTableName() const {
-	return QualifyRemoteTableName(catalog_.GetRemoteCatalog(), remote_schema_, remote_table_);
-}
-
-string PhysicalPostHogInsert::BuildInsertSQL(const DataChunk &chunk) const {
-	return duckdb::BuildInsertSQL(QualifyTableName(), column_names_, chunk, on_conflict_clause_);
+InsertionOrderPreservingMap<string> PhysicalPostHogInsert::ExtraSourceParams(GlobalSourceState &gstate,
+                                                                             LocalSourceState &lstate) const {
+	(void)gstate;
+	(void)lstate;
+	InsertionOrderPreservingMap<string> result;
+	if (this->sink_state) {
+		this->sink_state->Cast<PostHogInsertGlobalState>().writer->AddExplainInfo(result);
+	}
+	return result;
 }
 
 } // namespace duckdb
@@ -20,39 +20,41 @@ public:
 
 	PhysicalPostHogInsert(PhysicalPlan &physical_plan, vector<LogicalType> types, PostHogCatalog &catalog,
 	                      string remote_schema, string remote_table, vector<string> column_names,
-	                      bool on_conflict_do_nothing, string on_conflict_clause, idx_t estimated_cardinality);
+	                      bool on_conflict_do_nothing, string on_conflict_clause, bool bulk_ingest_eligible,
+	                      bool parallel, idx_t estimated_cardinality);
 
 	string GetName() const override;
+	InsertionOrderPreservingMap<string> ParamsToString() const override;
 
 	unique_ptr<GlobalSinkState> GetGlobalSinkState(ClientContext &context) const override;
+	unique_ptr<LocalSinkState> GetLocalSinkState(ExecutionContext &context) const override;
 	SinkResultType Sink(ExecutionContext &context, DataChunk &chunk, OperatorSinkInput &input) const override;
+	SinkCombineResultType Combine(ExecutionContext &context, OperatorSinkCombineInput &input) const override;
 	SinkFinalizeType Finalize(Pipeline &pipeline, Event &event, ClientContext &context,
 	                          OperatorSinkFinalizeInput &input) const override;
 
 	unique_ptr<GlobalSourceState> GetGlobalSourceState(ClientContext &context) const override;
 	SourceResultType GetDataInternal(ExecutionContext &context, DataChunk &chunk,
 	                                 OperatorSourceInput &input) const override;
+	InsertionOrderPreservingMap<string> ExtraSourceParams(GlobalSourceState &gstate,
+	                                                      LocalSourceState &lstate) const override;
 
 	bool IsSink() const override {
 		return true;
 	}
 
 	bool ParallelSink() const override {
-		return false;
+		return parallel_;
 	}
 
 	bool SinkOrderDependent() const override {
-		return true;
+		return !parallel_;
 	}
 
 	bool IsSource() const override {
 		return true;
 	}
 
-private:
-	string QualifyTableName() const;
-	string BuildInsertSQL(const DataChunk &chunk) const;
-
 private:
 	PostHogCatalog &catalog_;
 	string remote_schema_;
@@ -60,6 +62,10 @@ private:
 	vector<string> column_names_;
 	bool on_conflict_do_nothing_ = false;
 	string on_conflict_clause_;
+	// True when the insert targets every column in table order, so chunks can be ingested as-is.
+	bool bulk_ingest_eligible_ = false;
+	// False when insertion order must be preserved; the single sink thread still pipelines writes.
+	bool parallel_ = false;
 };
 
 } // namespace duckdb
@@ -8,27 +8,29 @@
 #include "execution/posthog_merge.hpp"
 
 #include "catalog/posthog_catalog.hpp"
-#include "duckdb/common/allocator.hpp"
 #include "duckdb/common/exception.hpp"
 #include "duckdb/common/limits.hpp"
 #include "duckdb/common/numeric_utils.hpp"
+#include "flight/query_result_reader.hpp"
+#include "flight/query_stats.hpp"
 #include "storage/posthog_transaction.hpp"
-#include "utils/arrow_value.hpp"
+#include "utils/posthog_tracer.hpp"
 
 namespace duckdb {
 
 namespace {
 
 struct PostHogMergeSourceState : public GlobalSourceState {
-	PostHogMergeSourceState(ClientContext &context, const vector<LogicalType> &types, bool return_chunk_p)
-	    : return_collection(context, types), return_chunk(return_chunk_p) {
+	explicit PostHogMergeSourceState(bool return_chunk_p) : return_chunk(return_chunk_p) {
 	}
 
 	bool initialized = false;
 	bool return_chunk;
 	int64_t affected_rows = 0;
-	ColumnDataCollection return_collection;
-	ColumnDataScanState scan_state;
+	unique_ptr<PostHogQueryResultReader> returning_reader;
+	// Duration and reported row count of the non-RETURNING statement, for EXPLAIN ANALYZE.
+	int64_t remote_us = 0;
+	int64_t remote_rows = -1;
 };
 
 } // namespace
@@ -45,48 +47,33 @@ string PhysicalPostHogMerge::GetName() const {
 	return "POSTHOG_MERGE";
 }
 
+InsertionOrderPreservingMap<string> PhysicalPostHogMerge::ParamsToString() const {
+	InsertionOrderPreservingMap<string> result;
+	result["Remote SQL"] = return_chunk_ ? returning_sql_ : non_returning_sql_;
+	return result;
+}
+
 unique_ptr<GlobalSourceState> PhysicalPostHogMerge::GetGlobalSourceState(ClientContext &context) const {
-	return make_uniq<PostHogMergeSourceState>(context, GetTypes(), return_chunk_);
+	(void)context;
+	return make_uniq<PostHogMergeSourceState>(return_chunk_);
 }
 
 SourceResultType PhysicalPostHogMerge::GetDataInternal(ExecutionContext &context, DataChunk &chunk,
                                                        OperatorSourceInput &input) const {
 	auto &state = input.global_state.Cast<PostHogMergeSourceState>();
 	if (!state.initialized) {
-		auto remote_txn_id = PostHogTransaction::Get(context.client, catalog_).remote_txn_id;
+		PostHogTraceScope trace("POSTHOG_MERGE", return_chunk_ ? returning_sql_ : non_returning_sql_);
+		auto &transaction = PostHogTransaction::Get(context.client, catalog_);
+		auto remote_txn_id = transaction.RemoteTransactionForWrite();
 		if (!state.return_chunk) {
-			state.affected_rows = catalog_.GetFlightClient().ExecuteUpdate(non_returning_sql_, remote_txn_id);
+			auto started = std::chrono::steady_clock::now();
+			state.affected_rows =
+			    catalog_.GetFlightClient().ExecuteUpdate(non_returning_sql_, remote_txn_id, transaction.GetStopToken());
+			state.remote_us = MicrosSince(started);
+			state.remote_rows = state.affected_rows;
 		} else {
-			auto result = catalog_.GetFlightClient().ExecuteQuery(returning_sql_, remote_txn_id);
-			DataChunk output_chunk;
-			output_chunk.Initialize(Allocator::Get(context.client), GetTypes());
-
-			auto combined_result = result->CombineChunksToBatch();
-			if (!combined_result.ok()) {
-				throw IOException("PostHog: failed to combine MERGE RETURNING batches: %s",
-				                  combined_result.status().ToString());
-			}
-			const auto &combined = *combined_result;
-			for (int64_t row_idx = 0; row_idx < combined->num_rows(); row_idx++) {
-				if ((idx_t)output_chunk.size() == STANDARD_VECTOR_SIZE) {
-					state.return_collection.Append(output_chunk);
-					output_chunk.Reset();
-				}
-				auto out_row = output_chunk.size();
-				output_chunk.SetCardinality(out_row + 1);
-				for (idx_t col_idx = 0; col_idx < GetTypes().size(); col_idx++) {
-					auto scalar_result = combined->column(static_cast<int>(col_idx))->GetScalar(row_idx);
-					if (!scalar_result.ok()) {
-						throw IOException("PostHog: failed to read MERGE RETURNING scalar: %s",
-						                  scalar_result.status().ToString());
-					}
-					output_chunk.SetValue(col_idx, out_row, ArrowScalarToValue(*scalar_result, GetTypes()[col_idx]));
-				}
-			}
-			if (output_chunk.size() > 0) {
-				state.return_collection.Append(output_chunk);
-			}
-			state.return_collection.InitializeScan(state.scan_state);
+			state.returning_reader = make_uniq<PostHogQueryResultReader>(context.client, catalog_, returning_sql_,
+			                                                             remote_txn_id, GetTypes());
 		}
 		state.initialized = true;
 	}
@@ -102,8 +89,23 @@ SourceResultType PhysicalPostHogMerge::GetDataInternal(ExecutionContext &context
 		return SourceResultType::FINISHED;
 	}
 
-	state.return_collection.Scan(state.scan_state, chunk);
-	return chunk.size() == 0 ? SourceResultType::FINISHED : SourceResultType::HAVE_MORE_OUTPUT;
+	return state.returning_reader->Next(chunk) ? SourceResultType::HAVE_MORE_OUTPUT : SourceResultType::FINISHED;
+}
+
+InsertionOrderPreservingMap<string> PhysicalPostHogMerge::ExtraSourceParams(GlobalSourceState &gstate,
+                                                                            LocalSourceState &lstate) const {
+	(void)lstate;
+	InsertionOrderPreservingMap<string> result;
+	auto &state = gstate.Cast<PostHogMergeSourceState>();
+	if (state.returning_reader) {
+		state.returning_reader->GetStream().AddExplainInfo(result);
+	} else if (state.initialized) {
+		result["Remote Time"] = FormatRemoteMillis(state.remote_us);
+		if (state.remote_rows >= 0) {
+			result["Remote Rows"] = to_string(state.remote_rows);
+		}
+	}
+	return result;
 }
 
 } // namespace duckdb
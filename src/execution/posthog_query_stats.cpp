@@ -0,0 +1,104 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// execution/posthog_query_stats.cpp
+//
+// duckhog_query_stats(): recent Flight calls of every attached PostHog catalog
+//===----------------------------------------------------------------------===//
+
+#include "execution/posthog_query_stats.hpp"
+#include "catalog/posthog_catalog.hpp"
+#include "flight/query_stats.hpp"
+
+#include "duckdb/common/types/timestamp.hpp"
+#include "duckdb/common/unordered_set.hpp"
+#include "duckdb/main/attached_database.hpp"
+#include "duckdb/main/client_context.hpp"
+#include "duckdb/main/database_manager.hpp"
+
+namespace duckdb {
+
+namespace {
+
+struct PostHogQueryStatsGlobalState : public GlobalTableFunctionState {
+	vector<std::pair<string, PostHogQueryStats>> rows;
+	idx_t offset = 0;
+};
+
+Value MillisValue(int64_t micros) {
+	if (micros < 0) {
+		return Value(LogicalType::DOUBLE);
+	}
+	return Value::DOUBLE(static_cast<double>(micros) / 1000.0);
+}
+
+Value CountValue(int64_t count) {
+	if (count < 0) {
+		return Value(LogicalType::BIGINT);
+	}
+	return Value::BIGINT(count);
+}
+
+} // namespace
+
+unique_ptr<FunctionData> PostHogQueryStatsFunction::Bind(ClientContext &context, TableFunctionBindInput &input,
+                                                         vector<LogicalType> &return_types, vector<string> &names) {
+	names = {"catalog", "rpc", "sql", "started_at", "status", "time_to_first_batch_ms", "total_ms", "batches", "rows",
+	         "bytes", "endpoints", "retries", "hedges", "session_invalidations"};
+	return_types = {LogicalType::VARCHAR, LogicalType::VARCHAR, LogicalType::VARCHAR, LogicalType::TIMESTAMP_TZ,
+	                LogicalType::VARCHAR, LogicalType::DOUBLE,  LogicalType::DOUBLE,  LogicalType::BIGINT,
+	                LogicalType::BIGINT,  LogicalType::BIGINT,  LogicalType::BIGINT,  LogicalType::BIGINT,
+	                LogicalType::BIGINT,  LogicalType::BIGINT};
+	return make_uniq<TableFunctionData>();
+}
+
+unique_ptr<GlobalTableFunctionState> PostHogQueryStatsFunction::InitGlobal(ClientContext &context,
+                                                                           TableFunctionInitInput &input) {
+	auto result = make_uniq<PostHogQueryStatsGlobalState>();
+	// Catalogs sharing a Flight client share its log; it is listed once, under the first of them.
+	unordered_set<PostHogFlightClient *> listed_clients;
+	for (auto &database : DatabaseManager::Get(context).GetDatabases(context)) {
+		// Failed attaches use a stub catalog of the same type, without a Flight client.
+		auto catalog = dynamic_cast<PostHogCatalog *>(&database->GetCatalog());
+		if (!catalog || !catalog->IsConnected() || !listed_clients.insert(&catalog->GetFlightClient()).second) {
+			continue;
+		}
+		for (auto &stats : catalog->GetFlightClient().GetQueryStats().Snapshot()) {
+			result->rows.emplace_back(database->GetName(), std::move(stats));
+		}
+	}
+	return std::move(result);
+}
+
+void PostHogQueryStatsFunction::Execute(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
+	auto &state = data.global_state->Cast<PostHogQueryStatsGlobalState>();
+	idx_t count = 0;
+	while (state.offset < state.rows.size() && count < STANDARD_VECTOR_SIZE) {
+		auto &entry = state.rows[state.offset++];
+		auto &stats = entry.second;
+		auto started_at_us =
+		    std::chrono::duration_cast<std::chrono::microseconds>(stats.started_at.time_since_epoch()).count();
+		output.SetValue(0, count, Value(entry.first));
+		output.SetValue(1, count, Value(stats.rpc));
+		output.SetValue(2, count, stats.sql.empty() ? Value(LogicalType::VARCHAR) : Value(stats.sql));
+		output.SetValue(3, count, Value::TIMESTAMPTZ(timestamp_tz_t(Timestamp::FromEpochMicroSeconds(started_at_us))));
+		output.SetValue(4, count, Value(stats.status));
+		output.SetValue(5, count, MillisValue(stats.first_batch_us));
+		output.SetValue(6, count, MillisValue(stats.total_us));
+		output.SetValue(7, count, Value::BIGINT(stats.batches));
+		output.SetValue(8, count, CountValue(stats.rows));
+		output.SetValue(9, count, Value::BIGINT(stats.bytes));
+		output.SetValue(10, count, Value::BIGINT(stats.endpoints));
+		output.SetValue(11, count, Value::BIGINT(stats.retries));
+		output.SetValue(12, count, Value::BIGINT(stats.hedges));
+		output.SetValue(13, count, Value::BIGINT(stats.session_invalidations));
+		count++;
+	}
+	output.SetCardinality(count);
+}
+
+TableFunction PostHogQueryStatsFunction::GetFunction() {
+	return TableFunction("duckhog_query_stats", {}, Execute, Bind, InitGlobal);
+}
+
+} // namespace duckdb
@@ -0,0 +1,29 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// execution/posthog_query_stats.hpp
+//
+// duckhog_query_stats(): recent Flight calls of every attached PostHog catalog
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb/function/table_function.hpp"
+
+namespace duckdb {
+
+// duckhog_query_stats() returns one row per recent Flight SQL call (or query stream) of each
+// attached PostHog catalog: RPC, remote SQL, timings and transfer counters, oldest first. Each
+// Flight client keeps its last PostHogQueryStatsLog::DEFAULT_CAPACITY calls.
+class PostHogQueryStatsFunction {
+public:
+	static TableFunction GetFunction();
+
+private:
+	static unique_ptr<FunctionData> Bind(ClientContext &context, TableFunctionBindInput &input,
+	                                     vector<LogicalType> &return_types, vector<string> &names);
+	static unique_ptr<GlobalTableFunctionState> InitGlobal(ClientContext &context, TableFunctionInitInput &input);
+	static void Execute(ClientContext &context, TableFunctionInput &data, DataChunk &output);
+};
+
+} // namespace duckdb
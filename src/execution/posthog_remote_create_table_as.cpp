@@ -0,0 +1,73 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// execution/posthog_remote_create_table_as.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/posthog_remote_create_table_as.hpp"
+
+#include "catalog/posthog_catalog.hpp"
+#include "duckdb/common/exception.hpp"
+#include "storage/posthog_transaction.hpp"
+#include "utils/posthog_tracer.hpp"
+
+namespace duckdb {
+
+namespace {
+
+struct PostHogRemoteCTASSourceState : public GlobalSourceState {
+	bool finished = false;
+};
+
+} // namespace
+
+PhysicalPostHogRemoteCreateTableAs::PhysicalPostHogRemoteCreateTableAs(PhysicalPlan &physical_plan,
+                                                                       vector<LogicalType> types,
+                                                                       PostHogCatalog &catalog, string remote_sql,
+                                                                       idx_t estimated_cardinality)
+    : PhysicalOperator(physical_plan, PhysicalOperatorType::EXTENSION, std::move(types), estimated_cardinality),
+      catalog_(catalog), remote_sql_(std::move(remote_sql)) {
+}
+
+string PhysicalPostHogRemoteCreateTableAs::GetName() const {
+	return "POSTHOG_REMOTE_CREATE_TABLE_AS";
+}
+
+InsertionOrderPreservingMap<string> PhysicalPostHogRemoteCreateTableAs::ParamsToString() const {
+	InsertionOrderPreservingMap<string> result;
+	result["Remote SQL"] = remote_sql_;
+	return result;
+}
+
+unique_ptr<GlobalSourceState> PhysicalPostHogRemoteCreateTableAs::GetGlobalSourceState(ClientContext &context) const {
+	(void)context;
+	return make_uniq<PostHogRemoteCTASSourceState>();
+}
+
+SourceResultType PhysicalPostHogRemoteCreateTableAs::GetDataInternal(ExecutionContext &context, DataChunk &chunk,
+                                                                     OperatorSourceInput &input) const {
+	auto &source_state = input.global_state.Cast<PostHogRemoteCTASSourceState>();
+	if (source_state.finished) {
+		return SourceResultType::FINISHED;
+	}
+	source_state.finished = true;
+
+	PostHogTraceScope trace("POSTHOG_REMOTE_CREATE_TABLE_AS", remote_sql_);
+	auto &transaction = PostHogTransaction::Get(context.client, catalog_);
+	auto remote_txn_id = transaction.RemoteTransactionForWrite();
+	int64_t affected = 0;
+	try {
+		affected = catalog_.GetFlightClient().ExecuteUpdate(remote_sql_, remote_txn_id, transaction.GetStopToken());
+	} catch (const Exception &) {
+		throw;
+	} catch (const std::exception &ex) {
+		throw IOException("PostHog: CREATE TABLE AS failed on remote server: %s", ex.what());
+	}
+
+	chunk.SetCardinality(1);
+	chunk.SetValue(0, 0, affected < 0 ? Value(LogicalType::BIGINT) : Value::BIGINT(affected));
+	return SourceResultType::FINISHED;
+}
+
+} // namespace duckdb
@@ -0,0 +1,40 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// execution/posthog_remote_create_table_as.hpp
+//
+// Source operator that runs CREATE TABLE AS entirely on the remote server
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb/execution/physical_operator.hpp"
+
+namespace duckdb {
+
+class PostHogCatalog;
+
+class PhysicalPostHogRemoteCreateTableAs : public PhysicalOperator {
+public:
+	static constexpr const PhysicalOperatorType TYPE = PhysicalOperatorType::EXTENSION;
+
+	PhysicalPostHogRemoteCreateTableAs(PhysicalPlan &physical_plan, vector<LogicalType> types,
+	                                   PostHogCatalog &catalog, string remote_sql, idx_t estimated_cardinality);
+
+	string GetName() const override;
+	InsertionOrderPreservingMap<string> ParamsToString() const override;
+
+	unique_ptr<GlobalSourceState> GetGlobalSourceState(ClientContext &context) const override;
+	SourceResultType GetDataInternal(ExecutionContext &context, DataChunk &chunk,
+	                                 OperatorSourceInput &input) const override;
+
+	bool IsSource() const override {
+		return true;
+	}
+
+private:
+	PostHogCatalog &catalog_;
+	string remote_sql_;
+};
+
+} // namespace duckdb
@@ -0,0 +1,282 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// execution/posthog_replicate.cpp
+//
+// duckhog_replicate(): local copies of remote tables kept in sync via table_changes()
+//===----------------------------------------------------------------------===//
+
+#include "execution/posthog_replicate.hpp"
+#include "catalog/posthog_catalog.hpp"
+#include "execution/posthog_sql_utils.hpp"
+#include "flight/query_result_reader.hpp"
+#include "utils/posthog_logger.hpp"
+
+#include "duckdb/catalog/catalog.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/function/table/arrow.hpp"
+#include "duckdb/main/appender.hpp"
+#include "duckdb/main/client_context.hpp"
+#include "duckdb/main/connection.hpp"
+#include "duckdb/main/database.hpp"
+#include "duckdb/parser/qualified_name.hpp"
+
+#include <arrow/c/bridge.h>
+
+namespace duckdb {
+
+namespace {
+
+struct PostHogReplicateBindData : public TableFunctionData {
+	string catalog_name;
+	string schema_name;
+	string table_name;
+	// Quoted local table reference of the replica.
+	string target;
+	// Unquoted parts of target; empty when not given.
+	string target_catalog;
+	string target_schema;
+	string target_name;
+};
+
+struct PostHogReplicateGlobalState : public GlobalTableFunctionState {
+	bool finished = false;
+};
+
+// Runs one statement on the replication connection, turning failures into PostHog errors.
+unique_ptr<MaterializedQueryResult> RunLocal(Connection &connection, const string &sql) {
+	auto result = connection.Query(sql);
+	if (result->HasError()) {
+		throw IOException("PostHog: duckhog_replicate failed: %s", result->GetError());
+	}
+	return result;
+}
+
+// First sync: create the replica from the remote table as of snapshot_id, with the server's rowids.
+// Reads the table once instead of replaying its change history. Returns the number of rows copied.
+idx_t LoadSnapshot(ClientContext &context, Connection &connection, PostHogCatalog &catalog,
+                   const PostHogReplicateBindData &bind_data, int64_t snapshot_id) {
+	const auto &remote_catalog = catalog.GetRemoteCatalog();
+	string remote_table = QuoteIdent(bind_data.schema_name) + "." + QuoteIdent(bind_data.table_name);
+	if (!remote_catalog.empty()) {
+		remote_table = QuoteIdent(remote_catalog) + "." + remote_table;
+	}
+	auto sql = "SELECT rowid AS " + QuoteIdent(PostHogReplicate::ROWID_COLUMN) + ", * FROM " + remote_table +
+	           " AT (VERSION => " + std::to_string(snapshot_id) + ")";
+
+	auto schema = catalog.GetFlightClient().GetQuerySchema(sql, std::nullopt);
+	ArrowSchema arrow_schema;
+	auto status = arrow::ExportSchema(*schema, &arrow_schema);
+	if (!status.ok()) {
+		throw IOException("PostHog: Failed to export Arrow schema: " + status.ToString());
+	}
+	ArrowTableSchema arrow_table;
+	ArrowTableFunction::PopulateArrowTableSchema(context, arrow_table, arrow_schema);
+	if (arrow_schema.release) {
+		arrow_schema.release(&arrow_schema);
+	}
+	auto names = arrow_table.GetNames();
+	auto types = arrow_table.GetTypes();
+
+	string columns;
+	for (idx_t i = 0; i < names.size(); i++) {
+		if (i > 0) {
+			columns += ", ";
+		}
+		columns += QuoteIdent(names[i]) + " " + types[i].ToString();
+	}
+	RunLocal(connection, "CREATE TABLE " + bind_data.target + " (" + columns + ")");
+
+	// The snapshot is pinned by AT (VERSION => ...), so no remote transaction is needed.
+	PostHogQueryResultReader reader(context, catalog, sql, std::nullopt, types);
+	Appender appender(connection, bind_data.target_catalog, bind_data.target_schema, bind_data.target_name);
+	DataChunk chunk;
+	chunk.Initialize(context, types);
+	idx_t rows = 0;
+	while (reader.Next(chunk)) {
+		appender.AppendDataChunk(chunk);
+		rows += chunk.size();
+	}
+	appender.Close();
+	return rows;
+}
+
+// Fetch the remote changes in (from_snapshot, to_snapshot] into a temporary table.
+void LoadChanges(Connection &connection, const PostHogReplicateBindData &bind_data, int64_t from_snapshot,
+                 int64_t to_snapshot) {
+	auto remote_table = QuoteIdent(bind_data.schema_name) + "." + QuoteIdent(bind_data.table_name);
+	RunLocal(connection, "CREATE OR REPLACE TEMPORARY TABLE __duckhog_changes AS SELECT * FROM " +
+	                         QuoteIdent(bind_data.catalog_name) + ".table_changes(" +
+	                         Value(remote_table).ToSQLString() + ", " + std::to_string(from_snapshot + 1) + ", " +
+	                         std::to_string(to_snapshot) + ")");
+}
+
+// Apply the loaded changes: every touched rowid is removed, then re-inserted with its values
+// after the last change if that change left the row in place. Columns are matched by name; when
+// the remote table's columns no longer match the replica's (an ALTER TABLE since the last sync),
+// the replica is reloaded from snapshot_id instead. Returns the number of changes, or of rows
+// copied by a reload.
+idx_t ApplyChanges(ClientContext &context, Connection &connection, PostHogCatalog &catalog,
+                   const PostHogReplicateBindData &bind_data, int64_t snapshot_id) {
+	auto &target = bind_data.target;
+	auto rowid_column = QuoteIdent(PostHogReplicate::ROWID_COLUMN);
+	auto local = RunLocal(connection, "SELECT * FROM " + target + " LIMIT 0");
+	auto changed = RunLocal(connection, "SELECT * EXCLUDE (snapshot_id, rowid, change_type) FROM __duckhog_changes"
+	                                    " LIMIT 0");
+
+	case_insensitive_map_t<LogicalType> local_types;
+	for (idx_t i = 0; i < local->names.size(); i++) {
+		local_types.emplace(local->names[i], local->types[i]);
+	}
+	bool same_columns = local_types.size() == changed->names.size() + 1 &&
+	                    local_types.count(PostHogReplicate::ROWID_COLUMN) > 0;
+	string columns;
+	for (idx_t i = 0; i < changed->names.size() && same_columns; i++) {
+		auto entry = local_types.find(changed->names[i]);
+		same_columns = entry != local_types.end() && entry->second == changed->types[i];
+		columns += ", " + QuoteIdent(changed->names[i]);
+	}
+	if (!same_columns) {
+		POSTHOG_LOG_WARN("Columns of %s.%s.%s changed since the last sync; reloading %s",
+		                 bind_data.catalog_name.c_str(), bind_data.schema_name.c_str(), bind_data.table_name.c_str(),
+		                 target.c_str());
+		RunLocal(connection, "DROP TABLE " + target);
+		return LoadSnapshot(context, connection, catalog, bind_data, snapshot_id);
+	}
+
+	RunLocal(connection,
+	         "DELETE FROM " + target + " WHERE " + rowid_column + " IN (SELECT rowid FROM __duckhog_changes)");
+	// Within one snapshot an update reports its pre-image before its post-image.
+	RunLocal(connection, "INSERT INTO " + target + " (" + rowid_column + columns + ") SELECT rowid" + columns +
+	                         " FROM __duckhog_changes"
+	                         " QUALIFY row_number() OVER (PARTITION BY rowid ORDER BY snapshot_id DESC,"
+	                         " change_type = 'update_preimage') = 1"
+	                         " AND change_type IN ('insert', 'update_postimage')");
+	auto count = RunLocal(connection, "SELECT count(*) FROM __duckhog_changes");
+	return count->GetValue(0, 0).GetValue<idx_t>();
+}
+
+} // namespace
+
+unique_ptr<FunctionData> PostHogReplicate::Bind(ClientContext &context, TableFunctionBindInput &input,
+                                                vector<LogicalType> &return_types, vector<string> &names) {
+	if (input.inputs[0].IsNull()) {
+		throw InvalidInputException("PostHog: duckhog_replicate requires a table name");
+	}
+	auto source = QualifiedName::Parse(input.inputs[0].ToString());
+	if (source.catalog.empty() || source.catalog == INVALID_CATALOG) {
+		throw InvalidInputException("PostHog: duckhog_replicate expects a fully qualified remote table, e.g. "
+		                            "'remote.schema.table' (got '%s')",
+		                            input.inputs[0].ToString());
+	}
+	auto &catalog = Catalog::GetCatalog(context, source.catalog);
+	if (catalog.GetCatalogType() != "hog") {
+		throw InvalidInputException("PostHog: duckhog_replicate source '%s' is not in an attached hog: database",
+		                            input.inputs[0].ToString());
+	}
+
+	auto result = make_uniq<PostHogReplicateBindData>();
+	result->catalog_name = source.catalog;
+	result->schema_name = source.schema.empty() || source.schema == INVALID_SCHEMA ? "main" : source.schema;
+	result->table_name = source.name;
+
+	auto target_it = input.named_parameters.find("target");
+	if (target_it != input.named_parameters.end() && !target_it->second.IsNull()) {
+		auto target = QualifiedName::Parse(target_it->second.ToString());
+		string rendered;
+		if (!target.catalog.empty() && target.catalog != INVALID_CATALOG) {
+			rendered += QuoteIdent(target.catalog) + ".";
+			result->target_catalog = target.catalog;
+		}
+		if (!target.schema.empty() && target.schema != INVALID_SCHEMA) {
+			rendered += QuoteIdent(target.schema) + ".";
+			result->target_schema = target.schema;
+		}
+		result->target = rendered + QuoteIdent(target.name);
+		result->target_name = target.name;
+	} else {
+		result->target = QuoteIdent(result->table_name);
+		result->target_name = result->table_name;
+	}
+
+	names = {"source", "target", "previous_snapshot_id", "snapshot_id", "changes"};
+	return_types = {LogicalType::VARCHAR, LogicalType::VARCHAR, LogicalType::BIGINT, LogicalType::BIGINT,
+	                LogicalType::UBIGINT};
+	return std::move(result);
+}
+
+unique_ptr<GlobalTableFunctionState> PostHogReplicate::InitGlobal(ClientContext &context,
+                                                                  TableFunctionInitInput &input) {
+	return make_uniq<PostHogReplicateGlobalState>();
+}
+
+void PostHogReplicate::Execute(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
+	auto &state = data.global_state->Cast<PostHogReplicateGlobalState>();
+	if (state.finished) {
+		return;
+	}
+	state.finished = true;
+	auto &bind_data = data.bind_data->Cast<PostHogReplicateBindData>();
+
+	auto &catalog = Catalog::GetCatalog(context, bind_data.catalog_name).Cast<PostHogCatalog>();
+	auto snapshot_id = catalog.ReadSnapshotId();
+	if (!snapshot_id.has_value()) {
+		throw IOException("PostHog: duckhog_replicate could not read the DuckLake snapshot id of '%s'",
+		                  bind_data.catalog_name);
+	}
+	auto source = bind_data.catalog_name + "." + bind_data.schema_name + "." + bind_data.table_name;
+
+	// A separate connection, so the sync commits on its own and its temporary table stays private.
+	Connection connection(*context.db);
+	RunLocal(connection, string("CREATE TABLE IF NOT EXISTS ") + REPLICAS_TABLE +
+	                         " (source VARCHAR PRIMARY KEY, target VARCHAR, snapshot_id BIGINT, refreshed_at "
+	                         "TIMESTAMP WITH TIME ZONE)");
+	RunLocal(connection, "BEGIN TRANSACTION");
+	try {
+		auto previous = RunLocal(connection, string("SELECT snapshot_id, target FROM ") + REPLICAS_TABLE +
+		                                         " WHERE source = " + Value(source).ToSQLString());
+		Value previous_snapshot(LogicalType::BIGINT);
+		idx_t changes = 0;
+		if (previous->RowCount() == 0) {
+			// First sync: copy the table as of the snapshot; table_changes() is only used for increments.
+			changes = LoadSnapshot(context, connection, catalog, bind_data, *snapshot_id);
+		} else {
+			previous_snapshot = previous->GetValue(0, 0);
+			if (previous->GetValue(1, 0).ToString() != bind_data.target) {
+				throw InvalidInputException("PostHog: '%s' is already replicated into %s", source,
+				                            previous->GetValue(1, 0).ToString());
+			}
+			auto from_snapshot = previous_snapshot.GetValue<int64_t>();
+			// Unchanged snapshot: nothing changed remotely, no Flight traffic for the table.
+			if (from_snapshot < *snapshot_id) {
+				LoadChanges(connection, bind_data, from_snapshot, *snapshot_id);
+				changes = ApplyChanges(context, connection, catalog, bind_data, *snapshot_id);
+			}
+		}
+		RunLocal(connection, string("INSERT OR REPLACE INTO ") + REPLICAS_TABLE + " VALUES (" +
+		                         Value(source).ToSQLString() + ", " + Value(bind_data.target).ToSQLString() + ", " +
+		                         std::to_string(*snapshot_id) + ", now())");
+		RunLocal(connection, "COMMIT");
+
+		POSTHOG_LOG_INFO("Replicated %s into %s at snapshot %lld (%llu changes)", source.c_str(),
+		                 bind_data.target.c_str(), static_cast<long long>(*snapshot_id),
+		                 static_cast<unsigned long long>(changes));
+		output.SetCardinality(1);
+		output.SetValue(0, 0, Value(source));
+		output.SetValue(1, 0, Value(bind_data.target));
+		output.SetValue(2, 0, previous_snapshot);
+		output.SetValue(3, 0, Value::BIGINT(*snapshot_id));
+		output.SetValue(4, 0, Value::UBIGINT(changes));
+	} catch (...) {
+		connection.Query("ROLLBACK");
+		throw;
+	}
+}
+
+TableFunction PostHogReplicate::GetFunction() {
+	TableFunction func("duckhog_replicate", {LogicalType::VARCHAR}, Execute, Bind, InitGlobal);
+	func.named_parameters["target"] = LogicalType::VARCHAR;
+	return func;
+}
+
+} // namespace duckdb
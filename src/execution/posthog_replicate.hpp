@@ -0,0 +1,35 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// execution/posthog_replicate.hpp
+//
+// duckhog_replicate(): local copies of remote tables kept in sync via table_changes()
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb/function/table_function.hpp"
+
+namespace duckdb {
+
+// duckhog_replicate('hog.schema.table' [, target := 'local_table']) creates a local DuckDB copy
+// of a remote DuckLake table on its first call and, on every later call, applies only the rows
+// changed since the snapshot it last synced (read through the catalog's table_changes() proxy).
+// Replicas are recorded in the local duckhog_replicas table. Returns one row describing the sync.
+class PostHogReplicate {
+public:
+	static TableFunction GetFunction();
+
+	// Bookkeeping table in the local default database.
+	static constexpr const char *REPLICAS_TABLE = "duckhog_replicas";
+	// Column of the replica holding the DuckLake rowid that table_changes() reports.
+	static constexpr const char *ROWID_COLUMN = "_duckhog_rowid";
+
+private:
+	static unique_ptr<FunctionData> Bind(ClientContext &context, TableFunctionBindInput &input,
+	                                     vector<LogicalType> &return_types, vector<string> &names);
+	static unique_ptr<GlobalTableFunctionState> InitGlobal(ClientContext &context, TableFunctionInitInput &input);
+	static void Execute(ClientContext &context, TableFunctionInput &data, DataChunk &output);
+};
+
+} // namespace duckdb
@@ -10,15 +10,27 @@
 #include "duckdb/common/enums/expression_type.hpp"
 #include "duckdb/common/exception.hpp"
 #include "duckdb/common/string_util.hpp"
+#include "duckdb/common/numeric_utils.hpp"
 #include "duckdb/common/types.hpp"
+#include "duckdb/common/types/date.hpp"
+#include "duckdb/common/types/decimal.hpp"
+#include "duckdb/common/types/hugeint.hpp"
+#include "duckdb/common/types/time.hpp"
+#include "duckdb/common/types/timestamp.hpp"
+#include "duckdb/common/types/uhugeint.hpp"
+#include "duckdb/common/types/uuid.hpp"
 #include "duckdb/common/types/value.hpp"
 #include "duckdb/planner/filter/conjunction_filter.hpp"
 #include "duckdb/planner/filter/constant_filter.hpp"
+#include "duckdb/planner/filter/dynamic_filter.hpp"
 #include "duckdb/planner/filter/in_filter.hpp"
 #include "duckdb/planner/filter/null_filter.hpp"
 #include "duckdb/planner/filter/optional_filter.hpp"
 #include "duckdb/planner/filter/struct_filter.hpp"
 
+#include <charconv>
+#include <cstring>
+
 namespace duckdb {
 
 /// Serialize a Value to valid SQL.
@@ -81,6 +93,202 @@ static string ValueToSQL(const Value &val) {
 	return val.ToSQLString();
 }
 
+namespace {
+
+// SQL literals of one column, rendered back to back; ends[row] is the offset where the row's literal ends.
+struct LiteralColumn {
+	string text;
+	vector<idx_t> ends;
+
+	void AppendTo(string &out, idx_t row) const {
+		auto start = row == 0 ? 0 : ends[row - 1];
+		out.append(text, start, ends[row] - start);
+	}
+};
+
+template <class T>
+void AppendInteger(string &out, T value) {
+	char buffer[24];
+	auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+	out.append(buffer, NumericCast<idx_t>(result.ptr - buffer));
+}
+
+// Same escaping as Value::ToSQLString: single quotes are doubled.
+void AppendQuoted(string &out, const char *data, idx_t size) {
+	out += '\'';
+	auto end = data + size;
+	while (data < end) {
+		auto quote = static_cast<const char *>(memchr(data, '\'', NumericCast<size_t>(end - data)));
+		if (!quote) {
+			out.append(data, NumericCast<idx_t>(end - data));
+			break;
+		}
+		out.append(data, NumericCast<idx_t>(quote - data + 1));
+		out += '\'';
+		data = quote + 1;
+	}
+	out += '\'';
+}
+
+// Renders every row of a vector of physical type T with append(out, value), NULLs as NULL.
+// width_hint is the expected literal length, used to size the column text up front.
+template <class T, class APPEND>
+void RenderLiterals(const Vector &vector, idx_t count, idx_t width_hint, LiteralColumn &column, APPEND &&append) {
+	UnifiedVectorFormat format;
+	// Only reads the vector; ToUnifiedFormat is not const because it may cache a flattened view.
+	const_cast<Vector &>(vector).ToUnifiedFormat(count, format);
+	auto data = UnifiedVectorFormat::GetData<T>(format);
+	column.text.reserve(count * width_hint);
+	column.ends.reserve(count);
+	for (idx_t row = 0; row < count; row++) {
+		auto idx = format.sel->get_index(row);
+		if (format.validity.RowIsValid(idx)) {
+			append(column.text, data[idx]);
+		} else {
+			column.text += "NULL";
+		}
+		column.ends.push_back(column.text.size());
+	}
+}
+
+template <class T>
+void RenderIntegers(const Vector &vector, idx_t count, LiteralColumn &column) {
+	RenderLiterals<T>(vector, count, 8, column, [](string &out, T value) { AppendInteger(out, value); });
+}
+
+// Literals of a type DuckDB prints as '<text>'::TYPE (dates, times, UUIDs).
+template <class T, class TO_STRING>
+void RenderTypedStrings(const Vector &vector, idx_t count, LiteralColumn &column, TO_STRING &&to_string) {
+	auto suffix = "'::" + vector.GetType().ToString();
+	RenderLiterals<T>(vector, count, 32, column, [&](string &out, T value) {
+		out += '\'';
+		out += to_string(value);
+		out += suffix;
+	});
+}
+
+template <class T>
+void RenderDecimals(const Vector &vector, idx_t count, LiteralColumn &column) {
+	auto width = DecimalType::GetWidth(vector.GetType());
+	auto scale = DecimalType::GetScale(vector.GetType());
+	RenderLiterals<T>(vector, count, idx_t(width) + 2, column,
+	                  [&](string &out, T value) { out += Decimal::ToString(value, width, scale); });
+}
+
+// Renders a column with the same literals ValueToSQL gives for its values, without materializing a Value
+// per cell except for nested and rarely inserted types.
+LiteralColumn RenderColumn(const Vector &vector, idx_t count) {
+	LiteralColumn column;
+	auto &type = vector.GetType();
+	switch (type.id()) {
+	case LogicalTypeId::BOOLEAN:
+		RenderLiterals<bool>(vector, count, 5, column,
+		                     [](string &out, bool value) { out += value ? "true" : "false"; });
+		break;
+	case LogicalTypeId::TINYINT:
+		RenderIntegers<int8_t>(vector, count, column);
+		break;
+	case LogicalTypeId::SMALLINT:
+		RenderIntegers<int16_t>(vector, count, column);
+		break;
+	case LogicalTypeId::INTEGER:
+		RenderIntegers<int32_t>(vector, count, column);
+		break;
+	case LogicalTypeId::BIGINT:
+		RenderIntegers<int64_t>(vector, count, column);
+		break;
+	case LogicalTypeId::UTINYINT:
+		RenderIntegers<uint8_t>(vector, count, column);
+		break;
+	case LogicalTypeId::USMALLINT:
+		RenderIntegers<uint16_t>(vector, count, column);
+		break;
+	case LogicalTypeId::UINTEGER:
+		RenderIntegers<uint32_t>(vector, count, column);
+		break;
+	case LogicalTypeId::UBIGINT:
+		RenderIntegers<uint64_t>(vector, count, column);
+		break;
+	case LogicalTypeId::HUGEINT:
+		RenderLiterals<hugeint_t>(vector, count, 20, column,
+		                          [](string &out, hugeint_t value) { out += Hugeint::ToString(value); });
+		break;
+	case LogicalTypeId::UHUGEINT:
+		RenderLiterals<uhugeint_t>(vector, count, 20, column,
+		                           [](string &out, uhugeint_t value) { out += Uhugeint::ToString(value); });
+		break;
+	case LogicalTypeId::FLOAT:
+		// Shortest round-trip formatting and the quoted spelling of inf/nan are DuckDB's own.
+		RenderLiterals<float>(vector, count, 12, column,
+		                      [](string &out, float value) { out += Value::FLOAT(value).ToSQLString(); });
+		break;
+	case LogicalTypeId::DOUBLE:
+		RenderLiterals<double>(vector, count, 20, column,
+		                       [](string &out, double value) { out += Value::DOUBLE(value).ToSQLString(); });
+		break;
+	case LogicalTypeId::DECIMAL:
+		switch (type.InternalType()) {
+		case PhysicalType::INT16:
+			RenderDecimals<int16_t>(vector, count, column);
+			break;
+		case PhysicalType::INT32:
+			RenderDecimals<int32_t>(vector, count, column);
+			break;
+		case PhysicalType::INT64:
+			RenderDecimals<int64_t>(vector, count, column);
+			break;
+		default:
+			RenderDecimals<hugeint_t>(vector, count, column);
+			break;
+		}
+		break;
+	case LogicalTypeId::VARCHAR:
+		RenderLiterals<string_t>(vector, count, 16, column, [](string &out, const string_t &value) {
+			if (memchr(value.GetData(), '\0', value.GetSize())) {
+				// Spelled with chr(0) by ToSQLString.
+				out += Value(value.GetString()).ToSQLString();
+				return;
+			}
+			AppendQuoted(out, value.GetData(), value.GetSize());
+		});
+		break;
+	case LogicalTypeId::DATE:
+		RenderTypedStrings<date_t>(vector, count, column, [](date_t value) { return Date::ToString(value); });
+		break;
+	case LogicalTypeId::TIME:
+		RenderTypedStrings<dtime_t>(vector, count, column, [](dtime_t value) { return Time::ToString(value); });
+		break;
+	case LogicalTypeId::TIMESTAMP:
+		RenderTypedStrings<timestamp_t>(vector, count, column,
+		                                [](timestamp_t value) { return Timestamp::ToString(value); });
+		break;
+	case LogicalTypeId::UUID:
+		RenderTypedStrings<hugeint_t>(vector, count, column, [](hugeint_t value) { return UUID::ToString(value); });
+		break;
+	default:
+		// MAP/STRUCT/LIST and the remaining scalar types go through Value.
+		column.ends.reserve(count);
+		for (idx_t row = 0; row < count; row++) {
+			column.text += ValueToSQL(vector.GetValue(row));
+			column.ends.push_back(column.text.size());
+		}
+		break;
+	}
+	return column;
+}
+
+vector<LiteralColumn> RenderColumns(const DataChunk &chunk, idx_t &literal_bytes) {
+	vector<LiteralColumn> columns;
+	columns.reserve(chunk.ColumnCount());
+	for (idx_t col_idx = 0; col_idx < chunk.ColumnCount(); col_idx++) {
+		columns.push_back(RenderColumn(chunk.data[col_idx], chunk.size()));
+		literal_bytes += columns.back().text.size();
+	}
+	return columns;
+}
+
+} // namespace
+
 string BuildInsertSQL(const string &qualified_table, const vector<string> &column_names, const DataChunk &chunk,
                       const string &on_conflict_clause) {
 	string sql = "INSERT INTO " + qualified_table;
@@ -107,16 +315,17 @@ string BuildInsertSQL(const string &qualified_table, const vector<string> &colum
 	}
 	sql += ") VALUES ";
 
+	idx_t literal_bytes = 0;
+	auto columns = RenderColumns(chunk, literal_bytes);
+	// Every row adds "(", ")" and ", " separators between its values and before the next row.
+	sql.reserve(sql.size() + literal_bytes + chunk.size() * 2 * (columns.size() + 1) + on_conflict_clause.size() + 1);
 	for (idx_t row_idx = 0; row_idx < chunk.size(); row_idx++) {
-		if (row_idx > 0) {
-			sql += ", ";
-		}
-		sql += "(";
-		for (idx_t col_idx = 0; col_idx < chunk.ColumnCount(); col_idx++) {
+		sql += row_idx == 0 ? "(" : ", (";
+		for (idx_t col_idx = 0; col_idx < columns.size(); col_idx++) {
 			if (col_idx > 0) {
 				sql += ", ";
 			}
-			sql += ValueToSQL(chunk.GetValue(col_idx, row_idx));
+			columns[col_idx].AppendTo(sql, row_idx);
 		}
 		sql += ")";
 	}
@@ -126,12 +335,75 @@ string BuildInsertSQL(const string &qualified_table, const vector<string> &colum
 	return sql;
 }
 
+string BuildValuesCTE(const string &name, const vector<string> &column_names, ColumnDataCollection &rows) {
+	auto &types = rows.Types();
+	if (types.size() != column_names.size()) {
+		throw InternalException("PostHog: VALUES rows have %llu columns but %llu names", types.size(),
+		                        column_names.size());
+	}
+	vector<string> quoted_names;
+	for (auto &column_name : column_names) {
+		quoted_names.push_back(QuoteIdent(column_name));
+	}
+	string sql = QuoteIdent(name) + "(" + StringUtil::Join(quoted_names, ", ") + ") AS (";
+	if (rows.Count() == 0) {
+		vector<string> nulls;
+		for (auto &type : types) {
+			nulls.push_back("CAST(NULL AS " + type.ToString() + ")");
+		}
+		return sql + "SELECT " + StringUtil::Join(nulls, ", ") + " WHERE FALSE)";
+	}
+
+	vector<string> casts;
+	idx_t casts_bytes = 0;
+	for (auto &type : types) {
+		casts.push_back(" AS " + type.ToString() + ")");
+		casts_bytes += casts.back().size() + 5;
+	}
+	sql += "VALUES ";
+	bool first_row = true;
+	for (auto &chunk : rows.Chunks()) {
+		idx_t literal_bytes = 0;
+		auto columns = RenderColumns(chunk, literal_bytes);
+		sql.reserve(sql.size() + literal_bytes + chunk.size() * (casts_bytes + 2 * (columns.size() + 1)) + 1);
+		for (idx_t row_idx = 0; row_idx < chunk.size(); row_idx++) {
+			sql += first_row ? "(" : ", (";
+			first_row = false;
+			for (idx_t col_idx = 0; col_idx < columns.size(); col_idx++) {
+				if (col_idx > 0) {
+					sql += ", ";
+				}
+				sql += "CAST(";
+				columns[col_idx].AppendTo(sql, row_idx);
+				sql += casts[col_idx];
+			}
+			sql += ")";
+		}
+	}
+	return sql + ")";
+}
+
+string BuildParameterizedInsertSQL(const string &qualified_table, const vector<string> &column_names,
+                                   const string &on_conflict_clause) {
+	D_ASSERT(!column_names.empty());
+	string columns;
+	string parameters;
+	for (idx_t col_idx = 0; col_idx < column_names.size(); col_idx++) {
+		if (col_idx > 0) {
+			columns += ", ";
+			parameters += ", ";
+		}
+		columns += QuoteIdent(column_names[col_idx]);
+		parameters += "?";
+	}
+	return "INSERT INTO " + qualified_table + " (" + columns + ") VALUES (" + parameters + ")" + on_conflict_clause +
+	       ";";
+}
+
 //===----------------------------------------------------------------------===//
 // Filter pushdown translation
 //===----------------------------------------------------------------------===//
 
-namespace {
-
 string ComparisonOperatorToSQL(ExpressionType type) {
 	switch (type) {
 	case ExpressionType::COMPARE_EQUAL:
@@ -155,7 +427,60 @@ string ComparisonOperatorToSQL(ExpressionType type) {
 	}
 }
 
-} // namespace
+unique_ptr<TableFilter> WithoutDynamicFilters(const TableFilter &filter) {
+	switch (filter.filter_type) {
+	case TableFilterType::DYNAMIC_FILTER:
+		return nullptr;
+	case TableFilterType::CONJUNCTION_AND: {
+		auto result = make_uniq<ConjunctionAndFilter>();
+		for (auto &child : filter.Cast<ConjunctionAndFilter>().child_filters) {
+			auto stripped = WithoutDynamicFilters(*child);
+			if (stripped) {
+				result->child_filters.push_back(std::move(stripped));
+			}
+		}
+		if (result->child_filters.empty()) {
+			return nullptr;
+		}
+		if (result->child_filters.size() == 1) {
+			return std::move(result->child_filters[0]);
+		}
+		return std::move(result);
+	}
+	case TableFilterType::CONJUNCTION_OR: {
+		auto result = make_uniq<ConjunctionOrFilter>();
+		for (auto &child : filter.Cast<ConjunctionOrFilter>().child_filters) {
+			auto stripped = WithoutDynamicFilters(*child);
+			if (!stripped) {
+				return nullptr;
+			}
+			result->child_filters.push_back(std::move(stripped));
+		}
+		return std::move(result);
+	}
+	case TableFilterType::OPTIONAL_FILTER: {
+		auto &optional = filter.Cast<OptionalFilter>();
+		if (!optional.child_filter) {
+			return filter.Copy();
+		}
+		auto child = WithoutDynamicFilters(*optional.child_filter);
+		if (!child) {
+			return nullptr;
+		}
+		return make_uniq<OptionalFilter>(std::move(child));
+	}
+	case TableFilterType::STRUCT_EXTRACT: {
+		auto &struct_filter = filter.Cast<StructFilter>();
+		auto child = WithoutDynamicFilters(*struct_filter.child_filter);
+		if (!child) {
+			return nullptr;
+		}
+		return make_uniq<StructFilter>(struct_filter.child_idx, struct_filter.child_name, std::move(child));
+	}
+	default:
+		return filter.Copy();
+	}
+}
 
 string FilterToSQL(const TableFilter &filter, const string &column_expr) {
 	switch (filter.filter_type) {
@@ -238,10 +563,20 @@ string FilterToSQL(const TableFilter &filter, const string &column_expr) {
 			return string();
 		}
 	}
-	case TableFilterType::DYNAMIC_FILTER:
-		// Dynamic filter values aren't knowable at SQL-generation time;
-		// the residual filter above the scan will apply them.
-		return string();
+	case TableFilterType::DYNAMIC_FILTER: {
+		// Filled in while the query runs (e.g. by a Top-N's current boundary).
+		// Render the value set so far; until there is one, the filter above
+		// the scan applies it.
+		auto &dynamic = filter.Cast<DynamicFilter>();
+		if (!dynamic.filter_data) {
+			return string();
+		}
+		lock_guard<mutex> guard(dynamic.filter_data->lock);
+		if (!dynamic.filter_data->initialized || !dynamic.filter_data->filter) {
+			return string();
+		}
+		return FilterToSQL(*dynamic.filter_data->filter, column_expr);
+	}
 	default:
 		throw NotImplementedException("PostHog filter pushdown: unsupported filter type");
 	}
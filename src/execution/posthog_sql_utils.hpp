@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include "duckdb/common/types/column/column_data_collection.hpp"
 #include "duckdb/common/types/data_chunk.hpp"
 #include "duckdb/parser/keyword_helper.hpp"
 #include "duckdb/planner/table_filter.hpp"
@@ -29,12 +30,30 @@ inline string QualifyRemoteTableName(const string &remote_catalog, const string
 string BuildInsertSQL(const string &qualified_table, const vector<string> &column_names, const DataChunk &chunk,
                       const string &on_conflict_clause = "");
 
+/// Build INSERT INTO ... (columns) VALUES (?, ..., ?) with one parameter per column, for binding
+/// DataChunks as Arrow parameter batches.
+string BuildParameterizedInsertSQL(const string &qualified_table, const vector<string> &column_names,
+                                   const string &on_conflict_clause = "");
+
+/// Build `name(columns) AS (VALUES ...)`, a WITH clause entry holding rows with every value cast
+/// to its column type. An empty collection gives an entry without rows.
+string BuildValuesCTE(const string &name, const vector<string> &column_names, ColumnDataCollection &rows);
+
+/// SQL spelling of a comparison ExpressionType (e.g. "<=", "IS DISTINCT FROM"). Throws
+/// NotImplementedException for non-comparison types.
+string ComparisonOperatorToSQL(ExpressionType type);
+
 /// Translate a TableFilter into a SQL boolean expression on `column_expr` (a
 /// quoted SQL identifier or expression). Returns an empty string for filter
-/// shapes whose semantics permit skipping (OPTIONAL_FILTER and DYNAMIC_FILTER
-/// — the optimizer keeps a residual above the scan or applies the filter
-/// elsewhere). Throws NotImplementedException for unhandled types so callers
+/// shapes whose semantics permit skipping (untranslatable OPTIONAL_FILTERs and
+/// DYNAMIC_FILTERs without a value yet — the optimizer keeps a residual above
+/// the scan or applies the filter elsewhere). DYNAMIC_FILTERs render the value
+/// set at call time. Throws NotImplementedException for unhandled types so callers
 /// fail loudly rather than emit a too-permissive WHERE clause.
 string FilterToSQL(const TableFilter &filter, const string &column_expr);
 
+/// Copy of filter with every DYNAMIC_FILTER (join and Top-N dynamic filters, which only narrow what
+/// the query discards anyway) taken as always true; nullptr when nothing else is left.
+unique_ptr<TableFilter> WithoutDynamicFilters(const TableFilter &filter);
+
 } // namespace duckdb
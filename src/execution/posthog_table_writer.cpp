@@ -0,0 +1,288 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// execution/posthog_table_writer.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/posthog_table_writer.hpp"
+
+#include "catalog/posthog_catalog.hpp"
+#include "duckdb/common/arrow/arrow_converter.hpp"
+#include "duckdb/common/arrow/arrow_type_extension.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/numeric_utils.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/main/client_context.hpp"
+#include "execution/posthog_sql_utils.hpp"
+#include "storage/posthog_transaction.hpp"
+#include "utils/posthog_tracer.hpp"
+
+#include <arrow/c/bridge.h>
+#include <arrow/record_batch.h>
+#include <arrow/util/byte_size.h>
+
+namespace duckdb {
+
+namespace {
+
+template <class CALLBACK>
+void ForEachChunk(ColumnDataCollection &rows, CALLBACK &&callback) {
+	ColumnDataScanState scan_state;
+	rows.InitializeScan(scan_state);
+	DataChunk chunk;
+	rows.InitializeScanChunk(chunk);
+	while (rows.Scan(scan_state, chunk)) {
+		callback(chunk);
+	}
+}
+
+} // namespace
+
+PostHogArrowBatchBuilder::PostHogArrowBatchBuilder(ClientContext &context, vector<LogicalType> types,
+                                                   const vector<string> &names)
+    : options_(context.GetClientProperties()), types_(std::move(types)) {
+	extension_types_ = ArrowTypeExtensionData::GetExtensionTypes(context, types_);
+
+	ArrowSchema c_schema;
+	ArrowConverter::ToArrowSchema(&c_schema, types_, names, options_);
+	auto schema_result = arrow::ImportSchema(&c_schema);
+	if (!schema_result.ok()) {
+		throw IOException("PostHog: Failed to build Arrow schema for remote write: " +
+		                  schema_result.status().ToString());
+	}
+	schema_ = *schema_result;
+}
+
+std::shared_ptr<arrow::RecordBatch> PostHogArrowBatchBuilder::Convert(DataChunk &chunk) const {
+	ArrowArray c_array;
+	ArrowConverter::ToArrowArray(chunk, &c_array, options_, extension_types_);
+	// ImportRecordBatch takes ownership of c_array, including on failure.
+	auto batch_result = arrow::ImportRecordBatch(&c_array, schema_);
+	if (!batch_result.ok()) {
+		throw IOException("PostHog: Failed to convert chunk to Arrow for remote write: " +
+		                  batch_result.status().ToString());
+	}
+	return *batch_result;
+}
+
+PostHogRemoteTableWriter::PostHogRemoteTableWriter(PostHogCatalog &catalog, string remote_schema, string remote_table,
+                                                   vector<string> column_names, string on_conflict_clause,
+                                                   bool bulk_ingest_eligible)
+    : catalog_(catalog), remote_schema_(std::move(remote_schema)), remote_table_(std::move(remote_table)),
+      column_names_(std::move(column_names)), on_conflict_clause_(std::move(on_conflict_clause)),
+      bulk_ingest_eligible_(bulk_ingest_eligible && on_conflict_clause_.empty()) {
+	if (!column_names_.empty()) {
+		prepared_insert_sql_ = BuildParameterizedInsertSQL(QualifiedTableName(), column_names_, on_conflict_clause_);
+	}
+}
+
+string PostHogRemoteTableWriter::QualifiedTableName() const {
+	return QualifyRemoteTableName(catalog_.GetRemoteCatalog(), remote_schema_, remote_table_);
+}
+
+bool PostHogRemoteTableWriter::UseIngest() const {
+	return bulk_ingest_eligible_ && catalog_.GetConfig().bulk_ingest && catalog_.GetFlightClient().SupportsIngest();
+}
+
+bool PostHogRemoteTableWriter::UsePreparedInsert() const {
+	return !prepared_insert_sql_.empty() && catalog_.GetConfig().prepared_insert &&
+	       catalog_.GetFlightClient().SupportsPreparedParameters();
+}
+
+optional_ptr<const PostHogArrowBatchBuilder>
+PostHogRemoteTableWriter::GetBatchBuilder(ClientContext &context, const vector<LogicalType> &types) {
+	if (!UseIngest() && !UsePreparedInsert()) {
+		return nullptr;
+	}
+	std::lock_guard<std::mutex> guard(batch_builder_mutex_);
+	if (!batch_builder_) {
+		batch_builder_ = make_uniq<PostHogArrowBatchBuilder>(context, types, column_names_);
+	}
+	return batch_builder_.get();
+}
+
+std::function<int64_t()> PostHogRemoteTableWriter::PrepareWrite(ClientContext &context,
+                                                                unique_ptr<ColumnDataCollection> rows,
+                                                                const std::optional<TransactionId> &txn_id) {
+	// The Arrow schema is resolved here because it needs the ClientContext; the conversion itself
+	// happens inside the task so it overlaps with the sink thread buffering the next batch.
+	auto builder = GetBatchBuilder(context, rows->Types());
+	// Interrupting the query cancels the in-flight write RPC.
+	auto stop_token = PostHogTransaction::Get(context, catalog_).GetStopToken();
+	shared_ptr<ColumnDataCollection> shared_rows = std::move(rows);
+	return [this, builder, shared_rows, txn_id, stop_token]() -> int64_t {
+		PostHogTraceScope trace("RemoteWrite", remote_table_);
+		auto started = std::chrono::steady_clock::now();
+		std::optional<int64_t> affected;
+		if (builder && UseIngest()) {
+			affected = Ingest(*builder, *shared_rows, txn_id, stop_token);
+		}
+		if (!affected.has_value()) {
+			affected = InsertValues(builder, *shared_rows, txn_id, stop_token);
+		}
+		rows_sent_ += NumericCast<int64_t>(shared_rows->Count());
+		remote_us_ += MicrosSince(started);
+		return *affected;
+	};
+}
+
+void PostHogRemoteTableWriter::AddExplainInfo(InsertionOrderPreservingMap<string> &result) const {
+	result["Remote Time"] = FormatRemoteMillis(remote_us_.load());
+	result["Remote Requests"] = to_string(requests_.load());
+	result["Remote Rows"] = to_string(rows_sent_.load());
+	result["Remote Bytes"] = StringUtil::BytesToHumanReadableString(NumericCast<idx_t>(bytes_sent_.load()));
+}
+
+std::optional<int64_t> PostHogRemoteTableWriter::Ingest(const PostHogArrowBatchBuilder &builder,
+                                                        ColumnDataCollection &rows,
+                                                        const std::optional<TransactionId> &txn_id,
+                                                        const arrow::StopToken &stop_token) {
+	auto &client = catalog_.GetFlightClient();
+	if (!client.SupportsIngest()) {
+		return std::nullopt;
+	}
+	// All chunks of the batch go out as one DoPut stream.
+	std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+	int64_t bytes = 0;
+	ForEachChunk(rows, [&](DataChunk &chunk) {
+		batches.push_back(builder.Convert(chunk));
+		bytes += arrow::util::TotalBufferSize(*batches.back());
+	});
+	auto reader_result = arrow::RecordBatchReader::Make(std::move(batches), builder.GetSchema());
+	if (!reader_result.ok()) {
+		throw IOException("PostHog: Failed to build Arrow reader for bulk ingest: " +
+		                  reader_result.status().ToString());
+	}
+	auto ingested = client.ExecuteIngest(*reader_result, catalog_.GetRemoteCatalog(), remote_schema_, remote_table_,
+	                                     txn_id, stop_token);
+	if (ingested.has_value()) {
+		requests_++;
+		bytes_sent_ += bytes;
+	}
+	return ingested;
+}
+
+int64_t PostHogRemoteTableWriter::InsertValues(optional_ptr<const PostHogArrowBatchBuilder> builder,
+                                               ColumnDataCollection &rows,
+                                               const std::optional<TransactionId> &txn_id,
+                                               const arrow::StopToken &stop_token) {
+	// One statement per chunk keeps the generated SQL text bounded regardless of the batch size.
+	// The prepared statement is planned once per transaction; each chunk only ships its values.
+	auto &client = catalog_.GetFlightClient();
+	auto table_name = QualifiedTableName();
+	int64_t total = 0;
+	bool reported = true;
+	ForEachChunk(rows, [&](DataChunk &chunk) {
+		std::optional<int64_t> prepared_affected;
+		if (builder && UsePreparedInsert()) {
+			auto parameters = builder->Convert(chunk);
+			prepared_affected = client.ExecutePreparedUpdate(prepared_insert_sql_, parameters, txn_id, stop_token);
+			if (prepared_affected.has_value()) {
+				bytes_sent_ += arrow::util::TotalBufferSize(*parameters);
+			}
+		}
+		int64_t affected;
+		if (prepared_affected.has_value()) {
+			affected = *prepared_affected;
+		} else {
+			auto sql = BuildInsertSQL(table_name, column_names_, chunk, on_conflict_clause_);
+			affected = client.ExecuteUpdate(sql, txn_id, stop_token);
+			bytes_sent_ += NumericCast<int64_t>(sql.size());
+		}
+		requests_++;
+		if (affected < 0) {
+			reported = false;
+		} else {
+			total += affected;
+		}
+	});
+	return reported ? total : -1;
+}
+
+PostHogPipelinedWriteBuffer::PostHogPipelinedWriteBuffer(ClientContext &context, PostHogRemoteTableWriter &writer,
+                                                         vector<LogicalType> types,
+                                                         std::optional<TransactionId> txn_id, string operation)
+    : context_(context), writer_(writer), types_(std::move(types)), txn_id_(std::move(txn_id)),
+      operation_(std::move(operation)) {
+	auto &config = writer_.GetCatalog().GetConfig();
+	batch_rows_ = config.insert_batch_rows;
+	batch_bytes_ = config.insert_batch_bytes;
+}
+
+PostHogPipelinedWriteBuffer::~PostHogPipelinedWriteBuffer() {
+	// The task references the writer and catalog, so it must not outlive this buffer. Errors were
+	// already reported through Finish() or are superseded by the error that aborted the sink.
+	if (pending_.valid()) {
+		try {
+			pending_.get();
+		} catch (...) {
+		}
+	}
+}
+
+void PostHogPipelinedWriteBuffer::Append(DataChunk &chunk) {
+	if (chunk.size() == 0) {
+		return;
+	}
+	if (!buffer_) {
+		buffer_ = make_uniq<ColumnDataCollection>(context_, types_);
+	}
+	buffer_->Append(chunk);
+	if (buffer_->Count() >= batch_rows_ || buffer_->SizeInBytes() >= batch_bytes_) {
+		SendBuffered();
+	}
+}
+
+void PostHogPipelinedWriteBuffer::Finish() {
+	if (buffer_ && buffer_->Count() > 0) {
+		SendBuffered();
+	}
+	WaitForPending();
+}
+
+void PostHogPipelinedWriteBuffer::FinishDeferred(PostHogTransaction &transaction, std::shared_ptr<void> keep_alive) {
+	if (buffer_ && buffer_->Count() > 0) {
+		SendBuffered();
+	}
+	if (!pending_.valid()) {
+		return;
+	}
+	all_counts_reported_ = false;
+	rows_written_ += pending_rows_;
+	transaction.DeferWrite(writer_.QualifiedTableName(), std::move(pending_), operation_, pending_rows_,
+	                       std::move(keep_alive));
+	pending_rows_ = 0;
+}
+
+void PostHogPipelinedWriteBuffer::SendBuffered() {
+	WaitForPending();
+	pending_rows_ = buffer_->Count();
+	auto task = writer_.PrepareWrite(context_, std::move(buffer_), txn_id_);
+	pending_ = std::async(std::launch::async, std::move(task));
+}
+
+void PostHogPipelinedWriteBuffer::WaitForPending() {
+	if (!pending_.valid()) {
+		return;
+	}
+	int64_t affected = 0;
+	try {
+		affected = pending_.get();
+	} catch (const Exception &) {
+		// ensure duckdb::Exceptions are bubbled up instead of being caught in next catch
+		throw;
+	} catch (const std::exception &ex) {
+		throw IOException("PostHog: %s failed for batch with %llu row(s): %s", operation_, pending_rows_, ex.what());
+	}
+
+	if (affected < 0) {
+		all_counts_reported_ = false;
+		rows_written_ += pending_rows_;
+	} else {
+		rows_written_ += NumericCast<idx_t>(affected);
+	}
+	pending_rows_ = 0;
+}
+
+} // namespace duckdb
@@ -0,0 +1,156 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// execution/posthog_table_writer.hpp
+//
+// Shared write path for remote INSERT / CTAS: Arrow bulk ingest, prepared INSERT with Arrow
+// parameters, and a SQL text fallback
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb/common/insertion_order_preserving_map.hpp"
+#include "duckdb/common/types/column/column_data_collection.hpp"
+#include "duckdb/common/types/data_chunk.hpp"
+#include "duckdb/main/client_properties.hpp"
+#include "flight/flight_client.hpp"
+
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+
+namespace arrow {
+class RecordBatch;
+class Schema;
+} // namespace arrow
+
+namespace duckdb {
+
+class ArrowTypeExtensionData;
+class ClientContext;
+class PostHogCatalog;
+class PostHogTransaction;
+
+// Converts DuckDB DataChunks into Arrow RecordBatches with a fixed schema.
+class PostHogArrowBatchBuilder {
+public:
+	PostHogArrowBatchBuilder(ClientContext &context, vector<LogicalType> types, const vector<string> &names);
+
+	const std::shared_ptr<arrow::Schema> &GetSchema() const {
+		return schema_;
+	}
+
+	// Safe to call from several threads at once.
+	std::shared_ptr<arrow::RecordBatch> Convert(DataChunk &chunk) const;
+
+private:
+	ClientProperties options_;
+	vector<LogicalType> types_;
+	unordered_map<idx_t, const shared_ptr<ArrowTypeExtensionData>> extension_types_;
+	std::shared_ptr<arrow::Schema> schema_;
+};
+
+// Writes batches of rows into one remote table. Prefers Flight SQL bulk ingest when the statement
+// allows it (plain append of every column, no ON CONFLICT) and the server implements it; next,
+// binds each chunk as Arrow parameters of one prepared INSERT ... VALUES (?, ...) statement
+// (including ON CONFLICT and column lists); otherwise renders INSERT ... VALUES text. One writer
+// is shared by all sink threads.
+class PostHogRemoteTableWriter {
+public:
+	PostHogRemoteTableWriter(PostHogCatalog &catalog, string remote_schema, string remote_table,
+	                         vector<string> column_names, string on_conflict_clause, bool bulk_ingest_eligible);
+
+	// Prepares the remote write of rows and returns a task that performs it. The task needs no
+	// ClientContext and may run on another thread; it returns the affected-row count reported by
+	// the server, or a negative value when the server reports none.
+	std::function<int64_t()> PrepareWrite(ClientContext &context, unique_ptr<ColumnDataCollection> rows,
+	                                      const std::optional<TransactionId> &txn_id);
+
+	string QualifiedTableName() const;
+
+	// EXPLAIN ANALYZE details: totals over the writes completed so far. The remote time includes
+	// converting rows to Arrow; bytes count the Arrow buffers or INSERT text sent.
+	void AddExplainInfo(InsertionOrderPreservingMap<string> &result) const;
+
+	PostHogCatalog &GetCatalog() const {
+		return catalog_;
+	}
+
+private:
+	optional_ptr<const PostHogArrowBatchBuilder> GetBatchBuilder(ClientContext &context,
+	                                                             const vector<LogicalType> &types);
+	bool UseIngest() const;
+	bool UsePreparedInsert() const;
+	std::optional<int64_t> Ingest(const PostHogArrowBatchBuilder &builder, ColumnDataCollection &rows,
+	                              const std::optional<TransactionId> &txn_id, const arrow::StopToken &stop_token);
+	// One statement per chunk: the prepared INSERT when builder is set and the server accepts
+	// parameters, else INSERT ... VALUES text.
+	int64_t InsertValues(optional_ptr<const PostHogArrowBatchBuilder> builder, ColumnDataCollection &rows,
+	                     const std::optional<TransactionId> &txn_id, const arrow::StopToken &stop_token);
+
+	PostHogCatalog &catalog_;
+	string remote_schema_;
+	string remote_table_;
+	vector<string> column_names_;
+	string on_conflict_clause_;
+	bool bulk_ingest_eligible_;
+	// Empty for INSERT DEFAULT VALUES, which has no parameters to bind.
+	string prepared_insert_sql_;
+	std::mutex batch_builder_mutex_;
+	unique_ptr<PostHogArrowBatchBuilder> batch_builder_;
+	std::atomic<int64_t> requests_ {0};
+	std::atomic<int64_t> rows_sent_ {0};
+	std::atomic<int64_t> bytes_sent_ {0};
+	std::atomic<int64_t> remote_us_ {0};
+};
+
+// Per-thread row buffer in front of a shared PostHogRemoteTableWriter. Rows accumulate until the
+// attach's insert_batch_rows / insert_batch_bytes limit, then the batch is written in the
+// background while the thread keeps buffering the next one. At most one write per buffer is
+// outstanding, so parallel sinks keep one remote write in flight per thread.
+class PostHogPipelinedWriteBuffer {
+public:
+	PostHogPipelinedWriteBuffer(ClientContext &context, PostHogRemoteTableWriter &writer, vector<LogicalType> types,
+	                            std::optional<TransactionId> txn_id, string operation);
+	~PostHogPipelinedWriteBuffer();
+
+	void Append(DataChunk &chunk);
+	// Sends the remaining rows and waits until every write of this buffer has completed.
+	void Finish();
+	// Sends the remaining rows and hands the last write to transaction instead of waiting for it (see
+	// PostHogTransaction::DeferWrite), with keep_alive owning the writer its task uses. The rows of
+	// that write count as written without a server-reported count.
+	void FinishDeferred(PostHogTransaction &transaction, std::shared_ptr<void> keep_alive);
+
+	// Rows written so far: the server-reported count, or the batch size when none was reported.
+	idx_t RowsWritten() const {
+		return rows_written_;
+	}
+	// False if any batch was written without the server reporting an affected-row count.
+	bool AllCountsReported() const {
+		return all_counts_reported_;
+	}
+
+private:
+	void SendBuffered();
+	void WaitForPending();
+
+	ClientContext &context_;
+	PostHogRemoteTableWriter &writer_;
+	vector<LogicalType> types_;
+	std::optional<TransactionId> txn_id_;
+	// Describes the statement in error messages, e.g. "INSERT into db.main.t".
+	string operation_;
+	idx_t batch_rows_;
+	idx_t batch_bytes_;
+	unique_ptr<ColumnDataCollection> buffer_;
+	std::future<int64_t> pending_;
+	idx_t pending_rows_ = 0;
+	idx_t rows_written_ = 0;
+	bool all_counts_reported_ = true;
+};
+
+} // namespace duckdb
@@ -0,0 +1,85 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// execution/posthog_temp_table.cpp
+//
+// Local rows uploaded to a temporary table of the server session
+//===----------------------------------------------------------------------===//
+
+#include "execution/posthog_temp_table.hpp"
+
+#include "catalog/posthog_catalog.hpp"
+#include "duckdb/common/exception.hpp"
+#include "execution/posthog_sql_utils.hpp"
+#include "execution/posthog_table_writer.hpp"
+#include "utils/posthog_logger.hpp"
+#include "utils/posthog_tracer.hpp"
+
+#include <arrow/record_batch.h>
+#include <arrow/util/byte_size.h>
+
+#include <atomic>
+
+namespace duckdb {
+
+string PostHogRemoteTempTable::NewName() {
+	static std::atomic<uint64_t> next_id {0};
+	return "__duckhog_upload_" + std::to_string(++next_id);
+}
+
+string PostHogRemoteTempTable::SQLName(const string &name) {
+	return QuoteIdent(name);
+}
+
+unique_ptr<PostHogRemoteTempTable> PostHogRemoteTempTable::Upload(ClientContext &context, PostHogCatalog &catalog,
+                                                                  string name, ColumnDataCollection &rows,
+                                                                  const vector<string> &names,
+                                                                  const std::optional<TransactionId> &txn_id,
+                                                                  const arrow::StopToken &stop_token) {
+	auto &client = catalog.GetFlightClient();
+	if (!client.SupportsIngest()) {
+		return nullptr;
+	}
+	PostHogTraceScope trace("RemoteTempTable", name);
+	PostHogArrowBatchBuilder builder(context, rows.Types(), names);
+	std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+	int64_t bytes = 0;
+	ColumnDataScanState scan_state;
+	rows.InitializeScan(scan_state);
+	DataChunk chunk;
+	rows.InitializeScanChunk(chunk);
+	while (rows.Scan(scan_state, chunk)) {
+		batches.push_back(builder.Convert(chunk));
+		bytes += arrow::util::TotalBufferSize(*batches.back());
+	}
+	auto reader_result = arrow::RecordBatchReader::Make(std::move(batches), builder.GetSchema());
+	if (!reader_result.ok()) {
+		throw IOException("PostHog: Failed to build Arrow reader for temporary table upload: " +
+		                  reader_result.status().ToString());
+	}
+	if (!client.ExecuteTemporaryIngest(*reader_result, name, txn_id, stop_token).has_value()) {
+		return nullptr;
+	}
+	POSTHOG_LOG_DEBUG("Uploaded %llu rows to temporary table %s", static_cast<unsigned long long>(rows.Count()),
+	                  name.c_str());
+	return make_uniq<PostHogRemoteTempTable>(catalog, std::move(name), txn_id, bytes);
+}
+
+PostHogRemoteTempTable::PostHogRemoteTempTable(PostHogCatalog &catalog, string name,
+                                               std::optional<TransactionId> txn_id, int64_t bytes_sent)
+    : catalog_(catalog), name_(std::move(name)), txn_id_(std::move(txn_id)), bytes_sent_(bytes_sent) {
+}
+
+PostHogRemoteTempTable::~PostHogRemoteTempTable() {
+	try {
+		catalog_.GetFlightClient().ExecuteUpdate("DROP TABLE IF EXISTS " + SQLName(), txn_id_);
+	} catch (const std::exception &e) {
+		POSTHOG_LOG_DEBUG("Failed to drop temporary table %s: %s", name_.c_str(), e.what());
+	}
+}
+
+string PostHogRemoteTempTable::SQLName() const {
+	return SQLName(name_);
+}
+
+} // namespace duckdb
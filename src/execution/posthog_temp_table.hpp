@@ -0,0 +1,57 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// execution/posthog_temp_table.hpp
+//
+// Local rows uploaded to a temporary table of the server session
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb/common/types/column/column_data_collection.hpp"
+#include "flight/flight_client.hpp"
+
+#include <optional>
+
+namespace duckdb {
+
+class ClientContext;
+class PostHogCatalog;
+
+// A temporary table in the catalog's server session, filled from local rows through Flight SQL bulk
+// ingest so that remote SQL can join against them. Dropped (best effort) when destroyed; the session
+// drops it anyway once it ends.
+class PostHogRemoteTempTable {
+public:
+	// Uploads rows, with the given column names, to a new temporary table called name in one DoPut stream.
+	// Created in txn_id when set, so the remote transaction's statements see it. Returns nullptr when the
+	// server does not implement ingest.
+	static unique_ptr<PostHogRemoteTempTable> Upload(ClientContext &context, PostHogCatalog &catalog, string name,
+	                                                 ColumnDataCollection &rows, const vector<string> &names,
+	                                                 const std::optional<TransactionId> &txn_id,
+	                                                 const arrow::StopToken &stop_token);
+	// A table name no other upload of this process uses, and so none of the server sessions its
+	// catalogs share.
+	static string NewName();
+	// Quoted SQL reference to the temporary table called name.
+	static string SQLName(const string &name);
+
+	PostHogRemoteTempTable(PostHogCatalog &catalog, string name, std::optional<TransactionId> txn_id,
+	                       int64_t bytes_sent);
+	~PostHogRemoteTempTable();
+
+	// Quoted table name for remote SQL.
+	string SQLName() const;
+	// Arrow buffer bytes of the uploaded rows.
+	int64_t BytesSent() const {
+		return bytes_sent_;
+	}
+
+private:
+	PostHogCatalog &catalog_;
+	string name_;
+	std::optional<TransactionId> txn_id_;
+	int64_t bytes_sent_;
+};
+
+} // namespace duckdb
@@ -0,0 +1,137 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// execution/posthog_traces.cpp
+//
+// duckhog_traces() and duckhog_export_traces(): read and export recorded spans
+//===----------------------------------------------------------------------===//
+
+#include "execution/posthog_traces.hpp"
+#include "utils/posthog_tracer.hpp"
+
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/types/timestamp.hpp"
+
+#include <cstdio>
+#include <fstream>
+
+namespace duckdb {
+
+namespace {
+
+struct PostHogTracesGlobalState : public GlobalTableFunctionState {
+	std::vector<PostHogTraceSpan> spans;
+	idx_t offset = 0;
+};
+
+struct PostHogExportTracesBindData : public TableFunctionData {
+	string path;
+};
+
+struct PostHogExportTracesGlobalState : public GlobalTableFunctionState {
+	bool done = false;
+};
+
+string HexId(uint64_t high, uint64_t low) {
+	char buffer[33];
+	std::snprintf(buffer, sizeof(buffer), "%016llx%016llx", static_cast<unsigned long long>(high),
+	              static_cast<unsigned long long>(low));
+	return buffer;
+}
+
+string HexId(uint64_t id) {
+	char buffer[17];
+	std::snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(id));
+	return buffer;
+}
+
+} // namespace
+
+unique_ptr<FunctionData> PostHogTracesFunction::Bind(ClientContext &context, TableFunctionBindInput &input,
+                                                     vector<LogicalType> &return_types, vector<string> &names) {
+	names = {"trace_id", "span_id", "parent_span_id", "name", "detail", "start_time", "duration_ms", "status"};
+	return_types = {LogicalType::VARCHAR, LogicalType::VARCHAR,      LogicalType::VARCHAR, LogicalType::VARCHAR,
+	                LogicalType::VARCHAR, LogicalType::TIMESTAMP_TZ, LogicalType::DOUBLE,  LogicalType::VARCHAR};
+	return make_uniq<TableFunctionData>();
+}
+
+unique_ptr<GlobalTableFunctionState> PostHogTracesFunction::InitGlobal(ClientContext &context,
+                                                                       TableFunctionInitInput &input) {
+	auto result = make_uniq<PostHogTracesGlobalState>();
+	result->spans = PostHogTracer::Instance().Snapshot();
+	return std::move(result);
+}
+
+void PostHogTracesFunction::Execute(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
+	auto &state = data.global_state->Cast<PostHogTracesGlobalState>();
+	idx_t count = 0;
+	while (state.offset < state.spans.size() && count < STANDARD_VECTOR_SIZE) {
+		auto &span = state.spans[state.offset++];
+		output.SetValue(0, count, Value(HexId(span.context.trace_id_high, span.context.trace_id_low)));
+		output.SetValue(1, count, Value(HexId(span.context.span_id)));
+		output.SetValue(2, count,
+		                span.parent_span_id == 0 ? Value(LogicalType::VARCHAR) : Value(HexId(span.parent_span_id)));
+		output.SetValue(3, count, Value(span.name));
+		output.SetValue(4, count, span.detail[0] ? Value(string(span.detail)) : Value(LogicalType::VARCHAR));
+		auto start_us = span.start_unix_nanos / 1000;
+		output.SetValue(5, count, Value::TIMESTAMPTZ(timestamp_tz_t(Timestamp::FromEpochMicroSeconds(start_us))));
+		output.SetValue(6, count,
+		                Value::DOUBLE(static_cast<double>(span.end_unix_nanos - span.start_unix_nanos) / 1000000.0));
+		output.SetValue(7, count, Value(span.error ? "error" : "ok"));
+		count++;
+	}
+	output.SetCardinality(count);
+}
+
+TableFunction PostHogTracesFunction::GetFunction() {
+	return TableFunction("duckhog_traces", {}, Execute, Bind, InitGlobal);
+}
+
+unique_ptr<FunctionData> PostHogExportTracesFunction::Bind(ClientContext &context, TableFunctionBindInput &input,
+                                                           vector<LogicalType> &return_types, vector<string> &names) {
+	if (input.inputs[0].IsNull()) {
+		throw InvalidInputException("PostHog: duckhog_export_traces requires a file path");
+	}
+	auto result = make_uniq<PostHogExportTracesBindData>();
+	result->path = input.inputs[0].ToString();
+	names = {"spans"};
+	return_types = {LogicalType::BIGINT};
+	return std::move(result);
+}
+
+unique_ptr<GlobalTableFunctionState> PostHogExportTracesFunction::InitGlobal(ClientContext &context,
+                                                                             TableFunctionInitInput &input) {
+	return make_uniq<PostHogExportTracesGlobalState>();
+}
+
+void PostHogExportTracesFunction::Execute(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
+	auto &state = data.global_state->Cast<PostHogExportTracesGlobalState>();
+	if (state.done) {
+		output.SetCardinality(0);
+		return;
+	}
+	state.done = true;
+	auto &bind_data = data.bind_data->Cast<PostHogExportTracesBindData>();
+
+	// Drained spans are gone from the rings, so the file is opened before draining.
+	std::ofstream file(bind_data.path, std::ios::app);
+	if (!file) {
+		throw IOException("PostHog: Could not open trace export file '%s'", bind_data.path);
+	}
+	auto spans = PostHogTracer::Instance().Drain();
+	if (!spans.empty()) {
+		file << PostHogTracer::ToOTLPJson(spans) << '\n';
+		file.flush();
+		if (!file) {
+			throw IOException("PostHog: Could not write trace export file '%s'", bind_data.path);
+		}
+	}
+	output.SetValue(0, 0, Value::BIGINT(static_cast<int64_t>(spans.size())));
+	output.SetCardinality(1);
+}
+
+TableFunction PostHogExportTracesFunction::GetFunction() {
+	return TableFunction("duckhog_export_traces", {LogicalType::VARCHAR}, Execute, Bind, InitGlobal);
+}
+
+} // namespace duckdb
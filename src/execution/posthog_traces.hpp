@@ -0,0 +1,42 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// execution/posthog_traces.hpp
+//
+// duckhog_traces() and duckhog_export_traces(): read and export recorded spans
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb/function/table_function.hpp"
+
+namespace duckdb {
+
+// duckhog_traces() returns the spans retained by PostHogTracer (Flight calls, query streams,
+// catalog loads and DML operators), oldest first within each thread.
+class PostHogTracesFunction {
+public:
+	static TableFunction GetFunction();
+
+private:
+	static unique_ptr<FunctionData> Bind(ClientContext &context, TableFunctionBindInput &input,
+	                                     vector<LogicalType> &return_types, vector<string> &names);
+	static unique_ptr<GlobalTableFunctionState> InitGlobal(ClientContext &context, TableFunctionInitInput &input);
+	static void Execute(ClientContext &context, TableFunctionInput &data, DataChunk &output);
+};
+
+// duckhog_export_traces(path) appends the spans recorded since the previous export to path as
+// one line of OTLP/JSON, which the OpenTelemetry Collector's otlpjsonfile receiver forwards to
+// any tracing backend. Returns the number of spans written.
+class PostHogExportTracesFunction {
+public:
+	static TableFunction GetFunction();
+
+private:
+	static unique_ptr<FunctionData> Bind(ClientContext &context, TableFunctionBindInput &input,
+	                                     vector<LogicalType> &return_types, vector<string> &names);
+	static unique_ptr<GlobalTableFunctionState> InitGlobal(ClientContext &context, TableFunctionInitInput &input);
+	static void Execute(ClientContext &context, TableFunctionInput &data, DataChunk &output);
+};
+
+} // namespace duckdb
@@ -0,0 +1,176 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// execution/posthog_upload_join.cpp
+//
+// Joins of a remote input with a small local input, run remotely against an uploaded copy
+//===----------------------------------------------------------------------===//
+
+#include "execution/posthog_upload_join.hpp"
+
+#include "catalog/posthog_catalog.hpp"
+#include "duckdb/common/numeric_utils.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/execution/physical_plan_generator.hpp"
+#include "execution/posthog_sql_utils.hpp"
+#include "execution/posthog_temp_table.hpp"
+#include "flight/query_result_reader.hpp"
+#include "storage/posthog_transaction.hpp"
+#include "utils/posthog_logger.hpp"
+
+namespace duckdb {
+
+namespace {
+
+struct PostHogUploadJoinSinkState : public GlobalSinkState {
+	PostHogUploadJoinSinkState(ClientContext &context, const vector<LogicalType> &types) : rows(context, types) {
+	}
+
+	mutex lock;
+	ColumnDataCollection rows;
+	std::optional<TransactionId> txn_id;
+	// Lives until the query ends, since the remote result is read after Finalize.
+	unique_ptr<PostHogRemoteTempTable> temp_table;
+	// remote_sql, or remote_sql under a VALUES CTE holding the rows when they could not be uploaded.
+	string sql;
+};
+
+struct PostHogUploadJoinSourceState : public GlobalSourceState {
+	unique_ptr<PostHogQueryResultReader> reader;
+};
+
+} // namespace
+
+LogicalPostHogUploadJoin::LogicalPostHogUploadJoin(idx_t table_index_p, PostHogCatalog &catalog_p,
+                                                   string remote_sql_p, string temp_table_p,
+                                                   vector<LogicalType> result_types_p)
+    : table_index(table_index_p), catalog(catalog_p), remote_sql(std::move(remote_sql_p)),
+      temp_table(std::move(temp_table_p)), result_types(std::move(result_types_p)) {
+}
+
+PhysicalOperator &LogicalPostHogUploadJoin::CreatePlan(ClientContext &context, PhysicalPlanGenerator &planner) {
+	(void)context;
+	auto &local = planner.CreatePlan(*children[0]);
+	auto &result = planner.Make<PhysicalPostHogUploadJoin>(result_types, catalog, remote_sql, temp_table,
+	                                                       shared_snapshot, estimated_cardinality);
+	result.children.push_back(local);
+	return result;
+}
+
+vector<ColumnBinding> LogicalPostHogUploadJoin::GetColumnBindings() {
+	return GenerateColumnBindings(table_index, result_types.size());
+}
+
+vector<idx_t> LogicalPostHogUploadJoin::GetTableIndex() const {
+	return vector<idx_t> {table_index};
+}
+
+string LogicalPostHogUploadJoin::GetName() const {
+	return "POSTHOG_UPLOAD_JOIN";
+}
+
+InsertionOrderPreservingMap<string> LogicalPostHogUploadJoin::ParamsToString() const {
+	InsertionOrderPreservingMap<string> result;
+	result["Remote SQL"] = remote_sql;
+	return result;
+}
+
+void LogicalPostHogUploadJoin::ResolveTypes() {
+	types = result_types;
+}
+
+PhysicalPostHogUploadJoin::PhysicalPostHogUploadJoin(PhysicalPlan &physical_plan, vector<LogicalType> types,
+                                                     PostHogCatalog &catalog, string remote_sql, string temp_table,
+                                                     bool shared_snapshot, idx_t estimated_cardinality)
+    : PhysicalOperator(physical_plan, PhysicalOperatorType::EXTENSION, std::move(types), estimated_cardinality),
+      catalog_(catalog), remote_sql_(std::move(remote_sql)), temp_table_(std::move(temp_table)),
+      shared_snapshot_(shared_snapshot) {
+}
+
+string PhysicalPostHogUploadJoin::GetName() const {
+	return "POSTHOG_UPLOAD_JOIN";
+}
+
+InsertionOrderPreservingMap<string> PhysicalPostHogUploadJoin::ParamsToString() const {
+	InsertionOrderPreservingMap<string> result;
+	result["Remote SQL"] = remote_sql_;
+	return result;
+}
+
+unique_ptr<GlobalSinkState> PhysicalPostHogUploadJoin::GetGlobalSinkState(ClientContext &context) const {
+	return make_uniq<PostHogUploadJoinSinkState>(context, children[0].get().GetTypes());
+}
+
+SinkResultType PhysicalPostHogUploadJoin::Sink(ExecutionContext &context, DataChunk &chunk,
+                                               OperatorSinkInput &input) const {
+	(void)context;
+	auto &sink_state = input.global_state.Cast<PostHogUploadJoinSinkState>();
+	lock_guard<mutex> guard(sink_state.lock);
+	sink_state.rows.Append(chunk);
+	return SinkResultType::NEED_MORE_INPUT;
+}
+
+SinkFinalizeType PhysicalPostHogUploadJoin::Finalize(Pipeline &pipeline, Event &event, ClientContext &context,
+                                                     OperatorSinkFinalizeInput &input) const {
+	(void)pipeline;
+	(void)event;
+	auto &sink_state = input.global_state.Cast<PostHogUploadJoinSinkState>();
+	auto &transaction = PostHogTransaction::Get(context, catalog_);
+	sink_state.txn_id = transaction.RemoteTransactionForRead(shared_snapshot_);
+
+	vector<string> names;
+	for (idx_t i = 0; i < sink_state.rows.ColumnCount(); i++) {
+		names.push_back("c" + to_string(i));
+	}
+	sink_state.temp_table = PostHogRemoteTempTable::Upload(context, catalog_, temp_table_, sink_state.rows, names,
+	                                                       sink_state.txn_id, transaction.GetStopToken());
+	if (sink_state.temp_table) {
+		sink_state.sql = remote_sql_;
+	} else {
+		// A CTE of the same name shadows the table reference.
+		POSTHOG_LOG_DEBUG("Server does not implement ingest; inlining %llu join rows",
+		                  static_cast<unsigned long long>(sink_state.rows.Count()));
+		sink_state.sql = "WITH " + BuildValuesCTE(temp_table_, names, sink_state.rows) + " " + remote_sql_;
+	}
+	return SinkFinalizeType::READY;
+}
+
+unique_ptr<GlobalSourceState> PhysicalPostHogUploadJoin::GetGlobalSourceState(ClientContext &context) const {
+	(void)context;
+	return make_uniq<PostHogUploadJoinSourceState>();
+}
+
+SourceResultType PhysicalPostHogUploadJoin::GetDataInternal(ExecutionContext &context, DataChunk &chunk,
+                                                            OperatorSourceInput &input) const {
+	auto &source_state = input.global_state.Cast<PostHogUploadJoinSourceState>();
+	auto &sink_state = this->sink_state->Cast<PostHogUploadJoinSinkState>();
+	if (!source_state.reader) {
+		source_state.reader = make_uniq<PostHogQueryResultReader>(context.client, catalog_, sink_state.sql,
+		                                                          sink_state.txn_id, types);
+	}
+	return source_state.reader->Next(chunk) ? SourceResultType::HAVE_MORE_OUTPUT : SourceResultType::FINISHED;
+}
+
+InsertionOrderPreservingMap<string> PhysicalPostHogUploadJoin::ExtraSourceParams(GlobalSourceState &gstate,
+                                                                                 LocalSourceState &lstate) const {
+	(void)lstate;
+	InsertionOrderPreservingMap<string> result;
+	if (!this->sink_state) {
+		return result;
+	}
+	auto &sink_state = this->sink_state->Cast<PostHogUploadJoinSinkState>();
+	if (sink_state.temp_table) {
+		result["Uploaded Rows"] = to_string(sink_state.rows.Count());
+		result["Uploaded Bytes"] =
+		    StringUtil::BytesToHumanReadableString(NumericCast<idx_t>(sink_state.temp_table->BytesSent()));
+	} else {
+		result["Inlined Rows"] = to_string(sink_state.rows.Count());
+	}
+	auto &source_state = gstate.Cast<PostHogUploadJoinSourceState>();
+	if (source_state.reader) {
+		source_state.reader->GetStream().AddExplainInfo(result);
+	}
+	return result;
+}
+
+} // namespace duckdb
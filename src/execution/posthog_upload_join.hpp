@@ -0,0 +1,88 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// execution/posthog_upload_join.hpp
+//
+// Joins of a remote input with a small local input, run remotely against an uploaded copy
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb/execution/physical_operator.hpp"
+#include "duckdb/planner/operator/logical_extension_operator.hpp"
+
+namespace duckdb {
+
+class PostHogCatalog;
+
+// Placed by the PostHog optimizer in place of a join whose only local input (its single child) is
+// small: the join's result columns are read from remote_sql, which joins the remote input with the
+// temporary table the child's rows are uploaded to.
+class LogicalPostHogUploadJoin : public LogicalExtensionOperator {
+public:
+	LogicalPostHogUploadJoin(idx_t table_index, PostHogCatalog &catalog, string remote_sql, string temp_table,
+	                         vector<LogicalType> result_types);
+
+	PhysicalOperator &CreatePlan(ClientContext &context, PhysicalPlanGenerator &planner) override;
+	vector<ColumnBinding> GetColumnBindings() override;
+	vector<idx_t> GetTableIndex() const override;
+	string GetName() const override;
+	InsertionOrderPreservingMap<string> ParamsToString() const override;
+
+	idx_t table_index;
+	PostHogCatalog &catalog;
+	string remote_sql;
+	string temp_table;
+	vector<LogicalType> result_types;
+	// Set by the PostHog optimizer when the plan reads the catalog more than once, see
+	// PostHogRemoteScanBindData::shared_snapshot.
+	bool shared_snapshot = false;
+
+protected:
+	void ResolveTypes() override;
+};
+
+// Sinks the rows of the local input, uploads them to the temporary table remote_sql reads (or, when
+// the server does not implement ingest, inlines them as a VALUES CTE of the same name), then streams
+// the remote result.
+class PhysicalPostHogUploadJoin : public PhysicalOperator {
+public:
+	static constexpr const PhysicalOperatorType TYPE = PhysicalOperatorType::EXTENSION;
+
+	PhysicalPostHogUploadJoin(PhysicalPlan &physical_plan, vector<LogicalType> types, PostHogCatalog &catalog,
+	                          string remote_sql, string temp_table, bool shared_snapshot, idx_t estimated_cardinality);
+
+	string GetName() const override;
+	InsertionOrderPreservingMap<string> ParamsToString() const override;
+
+	unique_ptr<GlobalSinkState> GetGlobalSinkState(ClientContext &context) const override;
+	SinkResultType Sink(ExecutionContext &context, DataChunk &chunk, OperatorSinkInput &input) const override;
+	SinkFinalizeType Finalize(Pipeline &pipeline, Event &event, ClientContext &context,
+	                          OperatorSinkFinalizeInput &input) const override;
+
+	unique_ptr<GlobalSourceState> GetGlobalSourceState(ClientContext &context) const override;
+	SourceResultType GetDataInternal(ExecutionContext &context, DataChunk &chunk,
+	                                 OperatorSourceInput &input) const override;
+	InsertionOrderPreservingMap<string> ExtraSourceParams(GlobalSourceState &gstate,
+	                                                      LocalSourceState &lstate) const override;
+
+	bool IsSink() const override {
+		return true;
+	}
+
+	bool ParallelSink() const override {
+		return true;
+	}
+
+	bool IsSource() const override {
+		return true;
+	}
+
+private:
+	PostHogCatalog &catalog_;
+	string remote_sql_;
+	string temp_table_;
+	bool shared_snapshot_;
+};
+
+} // namespace duckdb
@@ -10,19 +10,241 @@
 
 #include "catalog/posthog_catalog.hpp"
 #include "catalog/remote_scan.hpp"
+#include "catalog/remote_scan_sharing.hpp"
 #include "duckdb/common/exception.hpp"
+#include "duckdb/common/numeric_utils.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/planner/filter/conjunction_filter.hpp"
+#include "duckdb/planner/filter/in_filter.hpp"
+#include "duckdb/planner/filter/optional_filter.hpp"
+#include "duckdb/planner/filter/struct_filter.hpp"
 #include "execution/posthog_sql_utils.hpp"
+#include "utils/posthog_logger.hpp"
 
 #include <arrow/c/bridge.h>
+#include <arrow/util/byte_size.h>
 
 #include <utility>
 
 namespace duckdb {
 
+namespace {
+
+bool HasDynamicFilter(const TableFilter &filter) {
+	switch (filter.filter_type) {
+	case TableFilterType::DYNAMIC_FILTER:
+		return true;
+	case TableFilterType::CONJUNCTION_AND:
+	case TableFilterType::CONJUNCTION_OR:
+		for (auto &child : static_cast<const ConjunctionFilter &>(filter).child_filters) {
+			if (HasDynamicFilter(*child)) {
+				return true;
+			}
+		}
+		return false;
+	case TableFilterType::OPTIONAL_FILTER: {
+		auto &optional = filter.Cast<OptionalFilter>();
+		return optional.child_filter && HasDynamicFilter(*optional.child_filter);
+	}
+	case TableFilterType::STRUCT_EXTRACT: {
+		auto &struct_filter = filter.Cast<StructFilter>();
+		return struct_filter.child_filter && HasDynamicFilter(*struct_filter.child_filter);
+	}
+	default:
+		return false;
+	}
+}
+
+bool HasDynamicFilter(const TableFilterSet *filters) {
+	if (!filters) {
+		return false;
+	}
+	for (auto &entry : filters->filters) {
+		if (HasDynamicFilter(*entry.second)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+} // namespace
+
 PostHogArrowStreamState::PostHogArrowStreamState(PostHogCatalog &catalog_p, std::string query_p,
-                                                 std::optional<TransactionId> txn_id_p)
+                                                 std::optional<TransactionId> txn_id_p,
+                                                 const arrow::StopToken &stop_token)
     : catalog(catalog_p), query(std::move(query_p)), txn_id(std::move(txn_id_p)) {
-	query_stream = catalog.GetFlightClient().ExecuteQueryStream(query, txn_id);
+	query_stream =
+	    catalog.GetFlightClient().ExecuteQueryStream(query, txn_id, stop_token, catalog.GetMemoryPool().get());
+}
+
+PostHogArrowStreamState::PostHogArrowStreamState(PostHogCatalog &catalog_p, std::string query_p,
+                                                 std::optional<TransactionId> txn_id_p,
+                                                 std::unique_ptr<PostHogFlightQueryStream> query_stream_p)
+    : catalog(catalog_p), query(std::move(query_p)), txn_id(std::move(txn_id_p)),
+      query_stream(std::move(query_stream_p)) {
+}
+
+PostHogArrowStreamState::PostHogArrowStreamState(PostHogCatalog &catalog_p, std::string query_p,
+                                                 std::shared_ptr<const PostHogCachedResult> cached_result_p)
+    : catalog(catalog_p), query(std::move(query_p)), cached_result(std::move(cached_result_p)) {
+}
+
+PostHogArrowStreamState::PostHogArrowStreamState(PostHogCatalog &catalog_p,
+                                                 std::function<void(PostHogArrowStreamState &)> open_deferred_p)
+    : catalog(catalog_p), opened(false), open_deferred(std::move(open_deferred_p)) {
+}
+
+arrow::Status PostHogArrowStreamState::OpenIfDeferred() {
+	if (!open_deferred) {
+		return arrow::Status::OK();
+	}
+	auto open = std::move(open_deferred);
+	open_deferred = nullptr;
+	try {
+		open(*this);
+	} catch (const Exception &) {
+		// DuckDB errors, such as an interrupt or a failed IN-list upload, keep their type.
+		throw;
+	} catch (const std::exception &e) {
+		return arrow::Status::IOError(e.what());
+	}
+	opened = true;
+	return arrow::Status::OK();
+}
+
+std::shared_ptr<PostHogArrowStreamState> PostHogArrowStreamState::Fork() const {
+	auto fork = std::make_shared<PostHogArrowStreamState>(catalog, query, txn_id, query_stream->Fork());
+	fork->expected_types = expected_types;
+	return fork;
+}
+
+void PostHogArrowStreamState::RecordInto(PostHogResultCache &cache, std::string key) {
+	record_cache = &cache;
+	record_key = std::move(key);
+	recorded_result = std::make_shared<PostHogCachedResult>();
+}
+
+arrow::Result<std::shared_ptr<arrow::Schema>> PostHogArrowStreamState::GetSchema() {
+	ARROW_RETURN_NOT_OK(OpenIfDeferred());
+	if (shared_reader) {
+		return shared_reader->GetSchema();
+	}
+	if (cached_result) {
+		return cached_result->schema;
+	}
+	if (prefetcher) {
+		return prefetcher->GetSchema();
+	}
+	return query_stream->GetSchema();
+}
+
+arrow::Result<arrow::flight::FlightStreamChunk> PostHogArrowStreamState::Next() {
+	ARROW_RETURN_NOT_OK(OpenIfDeferred());
+	if (shared_reader) {
+		return shared_reader->Next();
+	}
+	if (cached_result) {
+		arrow::flight::FlightStreamChunk chunk;
+		if (cached_batch_index < cached_result->batches.size()) {
+			chunk.data = cached_result->batches[cached_batch_index++];
+		}
+		return chunk;
+	}
+	auto chunk_result = NextFromRemote();
+	if (recorded_result) {
+		Record(chunk_result);
+	}
+	return chunk_result;
+}
+
+arrow::Result<std::shared_ptr<arrow::RecordBatch>> PostHogArrowStreamState::NextBatch() {
+	if (!coalescer) {
+		auto &config = catalog.GetConfig();
+		if (config.scan_batch_rows == 0 && config.scan_batch_bytes == 0) {
+			ARROW_ASSIGN_OR_RAISE(auto chunk, NextConformed());
+			return chunk.data;
+		}
+		// Conformed first, so the coalescer only ever concatenates batches of one schema.
+		coalescer = std::make_unique<PostHogBatchCoalescer>([this]() { return NextConformed(); },
+		                                                    config.scan_batch_rows, config.scan_batch_bytes,
+		                                                    STANDARD_VECTOR_SIZE, ConversionPool());
+	}
+	return coalescer->Next();
+}
+
+arrow::Result<arrow::flight::FlightStreamChunk> PostHogArrowStreamState::NextConformed() {
+	ARROW_ASSIGN_OR_RAISE(auto chunk, Next());
+	if (chunk.data && !expected_types.empty()) {
+		ARROW_ASSIGN_OR_RAISE(chunk.data, ConformDictionaryEncoding(chunk.data, expected_types, ConversionPool()));
+	}
+	return chunk;
+}
+
+arrow::MemoryPool *PostHogArrowStreamState::ConversionPool() const {
+	auto memory_pool = catalog.GetMemoryPool();
+	if (memory_pool) {
+		return memory_pool.get();
+	}
+	return arrow::default_memory_pool();
+}
+
+void PostHogArrowStreamState::Record(const arrow::Result<arrow::flight::FlightStreamChunk> &chunk_result) {
+	if (!chunk_result.ok()) {
+		recorded_result.reset();
+		return;
+	}
+	const auto &chunk = *chunk_result;
+	if (chunk.data) {
+		recorded_result->bytes += static_cast<size_t>(arrow::util::TotalBufferSize(*chunk.data));
+		if (recorded_result->bytes > record_cache->Capacity()) {
+			// Would never fit; stop holding on to the batches.
+			recorded_result.reset();
+			return;
+		}
+		recorded_result->batches.push_back(chunk.data);
+		return;
+	}
+	auto schema_result = GetSchema();
+	if (schema_result.ok()) {
+		recorded_result->schema = *schema_result;
+		record_cache->Insert(record_key, std::move(recorded_result));
+	}
+	recorded_result.reset();
+}
+
+arrow::Result<arrow::flight::FlightStreamChunk> PostHogArrowStreamState::NextFromRemote() {
+	auto prefetch_bytes = catalog.GetConfig().prefetch_bytes;
+	if (!prefetcher && prefetch_bytes > 0) {
+		prefetcher = std::make_unique<PostHogBatchPrefetcher>(*query_stream, prefetch_bytes,
+		                                                      catalog.GetMemoryPool().get());
+	}
+	if (prefetcher) {
+		return prefetcher->Next();
+	}
+	return query_stream->Next();
+}
+
+void PostHogArrowStreamState::AddExplainInfo(InsertionOrderPreservingMap<string> &result) const {
+	if (!opened) {
+		return;
+	}
+	if (shared_reader) {
+		shared_reader->AddExplainInfo(result);
+		return;
+	}
+	if (!query_stream) {
+		result["Result Cache"] = "hit";
+		return;
+	}
+	result["Remote Time"] = FormatRemoteMillis(query_stream->RemoteMicros());
+	auto first_batch_us = query_stream->FirstBatchMicros();
+	if (first_batch_us >= 0) {
+		result["Remote First Batch"] = FormatRemoteMillis(first_batch_us);
+	}
+	result["Remote Rows"] = to_string(query_stream->RecordsRead());
+	result["Remote Bytes"] = StringUtil::BytesToHumanReadableString(NumericCast<idx_t>(query_stream->BytesRead()));
+	result["Remote Batches"] = to_string(query_stream->BatchesRead());
+	result["Remote Endpoints"] = to_string(query_stream->EndpointCount());
 }
 
 void PostHogArrowStream::Initialize(ArrowArrayStream &stream, std::shared_ptr<PostHogArrowStreamState> state) {
@@ -33,11 +255,10 @@ void PostHogArrowStream::Initialize(ArrowArrayStream &stream, std::shared_ptr<Po
 	stream.private_data = new std::shared_ptr<PostHogArrowStreamState>(std::move(state));
 }
 
-unique_ptr<ArrowArrayStreamWrapper> PostHogArrowStream::Produce(uintptr_t stream_factory_ptr,
-                                                                ArrowStreamParameters &parameters) {
-	auto *factory = reinterpret_cast<PostHogRemoteScanStreamFactory *>(stream_factory_ptr);
-	auto *bind_data = factory->bind_data;
-
+string PostHogArrowStream::BuildQuery(const PostHogRemoteScanBindData &bind_data,
+                                      const ArrowStreamParameters &parameters, const string &split_at_clause,
+                                      const string &split_condition,
+                                      const std::unordered_map<idx_t, string> &filter_sql) {
 	// Build projected SQL from the column names DuckDB's planner selected.
 	auto &columns = parameters.projected_columns.columns;
 	string columns_str;
@@ -47,8 +268,8 @@ unique_ptr<ArrowArrayStreamWrapper> PostHogArrowStream::Produce(uintptr_t stream
 		// children are ever accessed — only arrow_array.length matters for row
 		// counting.  Project the first catalog column as a cheap placeholder to
 		// get valid batches from the Flight SQL backend.
-		D_ASSERT(!bind_data->column_names.empty());
-		columns_str = QuoteIdent(bind_data->column_names[0]);
+		D_ASSERT(!bind_data.column_names.empty());
+		columns_str = QuoteIdent(bind_data.column_names[0]);
 	} else {
 		for (size_t i = 0; i < columns.size(); i++) {
 			if (i > 0) {
@@ -57,19 +278,11 @@ unique_ptr<ArrowArrayStreamWrapper> PostHogArrowStream::Produce(uintptr_t stream
 			columns_str += QuoteIdent(columns[i]);
 		}
 	}
-	// Build 3-part qualified query: "catalog"."schema"."table" [AT (...)]
-	// If remote_catalog is empty (backward compatibility), fall back to 2-part qualification
-	const auto &remote_catalog = bind_data->catalog.GetRemoteCatalog();
-	string table_ref;
-	if (remote_catalog.empty()) {
-		table_ref = QuoteIdent(bind_data->schema_name) + "." + QuoteIdent(bind_data->table_name);
-	} else {
-		table_ref = QuoteIdent(remote_catalog) + "." + QuoteIdent(bind_data->schema_name) + "." +
-		            QuoteIdent(bind_data->table_name);
-	}
-	// Append AT clause if present (e.g. time travel: AT (VERSION => 1))
-	if (!bind_data->at_clause_sql.empty()) {
-		table_ref += " " + bind_data->at_clause_sql;
+	auto table_ref =
+	    split_at_clause.empty() ? bind_data.GetRemoteTableRef() : bind_data.GetRemoteTableRef(split_at_clause);
+	auto sample_clause = bind_data.GetSampleClause();
+	if (!sample_clause.empty()) {
+		table_ref += " " + sample_clause;
 	}
 	string query = "SELECT " + columns_str + " FROM " + table_ref;
 
@@ -78,8 +291,8 @@ unique_ptr<ArrowArrayStreamWrapper> PostHogArrowStream::Produce(uintptr_t stream
 	// NotImplementedException — see the safety note in
 	// PostHogRemoteScan::GetFunction for why silent skips would be unsafe
 	// for LIKE/IN/range residuals.
+	string where_clause;
 	if (parameters.filters && !parameters.filters->filters.empty()) {
-		string where_clause;
 		for (auto &entry : parameters.filters->filters) {
 			auto pos = entry.first;
 			auto it = parameters.projected_columns.filter_to_col.find(pos);
@@ -93,30 +306,177 @@ unique_ptr<ArrowArrayStreamWrapper> PostHogArrowStream::Produce(uintptr_t stream
 			if (col_id == COLUMN_IDENTIFIER_ROW_ID) {
 				continue;
 			}
-			if (col_id >= bind_data->column_names.size()) {
+			if (col_id >= bind_data.column_names.size()) {
 				continue;
 			}
-			auto column_expr = QuoteIdent(bind_data->column_names[col_id]);
-			string filter_sql = FilterToSQL(*entry.second, column_expr);
-			if (filter_sql.empty()) {
+			auto override_entry = filter_sql.find(pos);
+			string condition = override_entry != filter_sql.end()
+			                       ? override_entry->second
+			                       : FilterToSQL(*entry.second, QuoteIdent(bind_data.column_names[col_id]));
+			if (condition.empty()) {
 				continue;
 			}
 			if (!where_clause.empty()) {
 				where_clause += " AND ";
 			}
-			where_clause += filter_sql;
+			where_clause += condition;
+		}
+	}
+	// Expression filters the PostHog optimizer moved out of the local plan.
+	for (auto &condition : bind_data.pushed_conditions) {
+		if (!where_clause.empty()) {
+			where_clause += " AND ";
 		}
+		where_clause += condition;
+	}
+	if (!split_condition.empty()) {
 		if (!where_clause.empty()) {
-			query += " WHERE " + where_clause;
+			where_clause += " AND ";
+		}
+		where_clause += split_condition;
+	}
+	if (!where_clause.empty()) {
+		query += " WHERE " + where_clause;
+	}
+	for (idx_t i = 0; i < bind_data.orders.size(); i++) {
+		auto &order = bind_data.orders[i];
+		query += i == 0 ? " ORDER BY " : ", ";
+		query += QuoteIdent(bind_data.column_names[order.column]);
+		query += order.type == OrderType::DESCENDING ? " DESC" : " ASC";
+		query += order.null_order == OrderByNullType::NULLS_FIRST ? " NULLS FIRST" : " NULLS LAST";
+	}
+	return query;
+}
+
+std::unordered_map<idx_t, string> PostHogArrowStream::UploadInLists(PostHogRemoteScanStreamFactory &factory,
+                                                                   const ArrowStreamParameters &parameters) {
+	std::unordered_map<idx_t, string> result;
+	auto &bind_data = *factory.bind_data;
+	auto threshold = bind_data.catalog.GetConfig().in_list_upload_threshold;
+	if (threshold == 0 || !factory.context || !parameters.filters) {
+		return result;
+	}
+	for (auto &entry : parameters.filters->filters) {
+		auto it = parameters.projected_columns.filter_to_col.find(entry.first);
+		if (it == parameters.projected_columns.filter_to_col.end() || it->second == COLUMN_IDENTIFIER_ROW_ID ||
+		    it->second >= bind_data.column_names.size()) {
+			continue;
+		}
+		const TableFilter *filter = entry.second.get();
+		if (filter->filter_type == TableFilterType::OPTIONAL_FILTER) {
+			filter = filter->Cast<OptionalFilter>().child_filter.get();
+		}
+		if (!filter || filter->filter_type != TableFilterType::IN_FILTER) {
+			continue;
+		}
+		auto &values = filter->Cast<InFilter>().values;
+		if (values.size() < threshold || values[0].type().IsNested()) {
+			continue;
+		}
+		ColumnDataCollection rows(Allocator::DefaultAllocator(), {values[0].type()});
+		DataChunk chunk;
+		chunk.Initialize(Allocator::DefaultAllocator(), rows.Types());
+		for (idx_t i = 0; i < values.size(); i++) {
+			chunk.SetValue(0, chunk.size(), values[i]);
+			chunk.SetCardinality(chunk.size() + 1);
+			if (chunk.size() == STANDARD_VECTOR_SIZE || i + 1 == values.size()) {
+				rows.Append(chunk);
+				chunk.Reset();
+			}
+		}
+		unique_ptr<PostHogRemoteTempTable> table;
+		try {
+			auto name = PostHogRemoteTempTable::NewName();
+			table = PostHogRemoteTempTable::Upload(*factory.context, bind_data.catalog, std::move(name), rows, {"k"},
+			                                       factory.txn_id, factory.stop_token);
+		} catch (const InterruptException &) {
+			throw;
+		} catch (const std::exception &e) {
+			POSTHOG_LOG_WARN("Failed to upload an IN list of %llu values, sending it inline: %s",
+			                 static_cast<unsigned long long>(values.size()), e.what());
+			continue;
+		}
+		if (!table) {
+			// The server does not implement ingest; the remaining lists would not upload either.
+			break;
+		}
+		result[entry.first] = QuoteIdent(bind_data.column_names[it->second]) + " IN (SELECT " + QuoteIdent("k") +
+		                      " FROM " + table->SQLName() + ")";
+		factory.uploaded_in_lists.push_back(std::move(table));
+	}
+	return result;
+}
+
+void PostHogArrowStream::Open(PostHogRemoteScanStreamFactory &factory, const ArrowStreamParameters &parameters,
+                              PostHogArrowStreamState &state, const string &at_clause) {
+	auto *bind_data = factory.bind_data;
+	state.query = BuildQuery(*bind_data, parameters, at_clause, string(), UploadInLists(factory, parameters));
+	state.txn_id = factory.txn_id;
+
+	// A repeat of a query at the same DuckLake snapshot is answered from the result cache.
+	auto result_cache = bind_data->catalog.GetResultCache();
+	string cache_key;
+	if (result_cache && factory.use_result_cache) {
+		auto snapshot_id = bind_data->catalog.ReadSnapshotId(factory.txn_id);
+		if (snapshot_id.has_value()) {
+			cache_key = PostHogResultCache::MakeKey(*snapshot_id, state.query);
+			state.cached_result = result_cache->Lookup(cache_key);
+			if (state.cached_result) {
+				return;
+			}
 		}
 	}
 
 	// Execute the projected query via Flight SQL.
-	auto stream_state = std::make_shared<PostHogArrowStreamState>(bind_data->catalog, query, factory->txn_id);
+	state.query_stream = bind_data->catalog.GetFlightClient().ExecuteQueryStream(
+	    state.query, state.txn_id, factory.stop_token, bind_data->catalog.GetMemoryPool().get());
+	if (!cache_key.empty()) {
+		state.RecordInto(*result_cache, cache_key);
+	}
+}
+
+unique_ptr<ArrowArrayStreamWrapper> PostHogArrowStream::Produce(uintptr_t stream_factory_ptr,
+                                                                ArrowStreamParameters &parameters) {
+	auto *factory = reinterpret_cast<PostHogRemoteScanStreamFactory *>(stream_factory_ptr);
+	auto &catalog = factory->bind_data->catalog;
+	// The factory keeps a handle on the state so the scan can fork per-thread readers when the
+	// result spans several endpoints.
+	std::shared_ptr<PostHogArrowStreamState> stream_state;
+	std::shared_ptr<PostHogSharedScanReader> shared_reader;
+	if (factory->bind_data->shared_scan && factory->context) {
+		shared_reader = factory->bind_data->shared_scan->Attach(*factory->context);
+	}
+	if (shared_reader) {
+		// Claimed on the first read, so a scan that never runs does not hold the shared buffer.
+		auto open_shared = [factory, parameters, shared_reader](PostHogArrowStreamState &state) {
+			if (!shared_reader->Claim(*factory, parameters)) {
+				Open(*factory, parameters, state);
+				return;
+			}
+			state.query = shared_reader->Query();
+			state.txn_id = factory->txn_id;
+			state.shared_reader = shared_reader;
+		};
+		stream_state = std::make_shared<PostHogArrowStreamState>(catalog, std::move(open_shared));
+	} else if (HasDynamicFilter(parameters.filters)) {
+		// Hash join build sides and Top-N fill dynamic filters while the query runs: open the remote
+		// query on the first read, so its WHERE clause includes the values known by then.
+		stream_state = std::make_shared<PostHogArrowStreamState>(
+		    catalog, [factory, parameters](PostHogArrowStreamState &state) { Open(*factory, parameters, state); });
+	} else {
+		stream_state = std::make_shared<PostHogArrowStreamState>(catalog, std::string(),
+		                                                        std::shared_ptr<const PostHogCachedResult>());
+		Open(*factory, parameters, *stream_state);
+	}
+	stream_state->expected_types = factory->expected_types;
+	factory->stream_state = stream_state;
+	return Wrap(std::move(stream_state));
+}
 
+unique_ptr<ArrowArrayStreamWrapper> PostHogArrowStream::Wrap(std::shared_ptr<PostHogArrowStreamState> state) {
 	// Build a temporary ArrowArrayStream and transfer it into the wrapper.
 	ArrowArrayStream tmp_stream;
-	Initialize(tmp_stream, std::move(stream_state));
+	Initialize(tmp_stream, std::move(state));
 
 	auto res = make_uniq<ArrowArrayStreamWrapper>();
 	res->arrow_array_stream = tmp_stream;
@@ -180,7 +540,7 @@ void PostHogArrowStream::StreamRelease(ArrowArrayStream *stream) {
 }
 
 int PostHogArrowStream::ExportSchema(PostHogArrowStreamState &state, ArrowSchema *out) {
-	auto schema_result = state.query_stream->GetSchema();
+	auto schema_result = state.GetSchema();
 	if (!schema_result.ok()) {
 		state.last_error = schema_result.status().ToString();
 		return -1;
@@ -194,17 +554,17 @@ int PostHogArrowStream::ExportSchema(PostHogArrowStreamState &state, ArrowSchema
 }
 
 int PostHogArrowStream::ExportNext(PostHogArrowStreamState &state, ArrowArray *out) {
-	auto chunk_result = state.query_stream->Next();
-	if (!chunk_result.ok()) {
-		state.last_error = chunk_result.status().ToString();
+	auto batch_result = state.NextBatch();
+	if (!batch_result.ok()) {
+		state.last_error = batch_result.status().ToString();
 		return -1;
 	}
-	const auto &chunk = *chunk_result;
-	if (!chunk.data) {
+	const auto &batch = *batch_result;
+	if (!batch) {
 		out->release = nullptr;
 		return 0;
 	}
-	auto status = arrow::ExportRecordBatch(*chunk.data, out);
+	auto status = arrow::ExportRecordBatch(*batch, out);
 	if (!status.ok()) {
 		state.last_error = status.ToString();
 		return -1;
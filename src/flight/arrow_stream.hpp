@@ -9,34 +9,130 @@
 #pragma once
 
 #include "duckdb/common/arrow/arrow.hpp"
+#include "duckdb/common/insertion_order_preserving_map.hpp"
 #include "duckdb/common/unique_ptr.hpp"
 #include "duckdb/function/table/arrow.hpp"
+#include "flight/batch_coalescer.hpp"
+#include "flight/batch_prefetcher.hpp"
+#include "flight/dictionary_encoding.hpp"
 #include "flight/flight_client.hpp"
+#include "flight/result_cache.hpp"
 
+#include <atomic>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace duckdb {
 
 class PostHogCatalog;
+struct PostHogRemoteScanBindData;
+struct PostHogRemoteScanStreamFactory;
+class PostHogSharedScanReader;
 
 struct PostHogArrowStreamState {
-	PostHogArrowStreamState(PostHogCatalog &catalog, std::string query, std::optional<TransactionId> txn_id);
+	// stop_token cancels the query's RPCs, and every fork's, once the DuckDB query is interrupted.
+	PostHogArrowStreamState(PostHogCatalog &catalog, std::string query, std::optional<TransactionId> txn_id,
+	                        const arrow::StopToken &stop_token = arrow::StopToken::Unstoppable());
+	// Wrap an already-open query stream (used for endpoint forks).
+	PostHogArrowStreamState(PostHogCatalog &catalog, std::string query, std::optional<TransactionId> txn_id,
+	                        std::unique_ptr<PostHogFlightQueryStream> query_stream);
+
+	// Replay a result cache hit; no Flight request is made.
+	PostHogArrowStreamState(PostHogCatalog &catalog, std::string query,
+	                        std::shared_ptr<const PostHogCachedResult> cached_result);
+
+	// Not opened yet: open_deferred fills in the query and its stream (or cached result) on the
+	// first GetSchema() or Next().
+	PostHogArrowStreamState(PostHogCatalog &catalog, std::function<void(PostHogArrowStreamState &)> open_deferred);
+
+	// Sibling state reading the remaining endpoints of the same query concurrently.
+	std::shared_ptr<PostHogArrowStreamState> Fork() const;
+
+	// Collect the batches read by this state and add them to cache under key once the stream
+	// ends. Forks never record: each only sees part of the result.
+	void RecordInto(PostHogResultCache &cache, std::string key);
+
+	// Read through the prefetch queue when prefetch_bytes is configured. The background reader
+	// starts on the first Next(), so a state that is only forked from never claims endpoints.
+	arrow::Result<std::shared_ptr<arrow::Schema>> GetSchema();
+	arrow::Result<arrow::flight::FlightStreamChunk> Next();
+	// Next() conformed to expected_types and reshaped by a PostHogBatchCoalescer to the
+	// scan_batch_rows/scan_batch_bytes targets; this is what the Arrow scan reads. Returns nullptr
+	// at end of stream.
+	arrow::Result<std::shared_ptr<arrow::RecordBatch>> NextBatch();
+
+	// EXPLAIN ANALYZE details: remote timings and the rows, bytes and batches received by this
+	// state and its forks, or the result cache hit that replaced the query.
+	void AddExplainInfo(InsertionOrderPreservingMap<string> &result) const;
 
 	PostHogCatalog &catalog;
 	std::string query;
 	std::optional<TransactionId> txn_id;
+	// Null when replaying cached_result, and until a deferred state is opened.
 	std::unique_ptr<PostHogFlightQueryStream> query_stream;
+	// Declared after query_stream so it is joined before the stream goes away.
+	std::unique_ptr<PostHogBatchPrefetcher> prefetcher;
+	// Created on the first NextBatch() unless both batch targets are 0.
+	std::unique_ptr<PostHogBatchCoalescer> coalescer;
+	// Arrow types DuckDB bound for the columns of this stream, in order. When set, NextBatch()
+	// conforms each batch's dictionary encoding to them (ConformDictionaryEncoding).
+	std::vector<std::shared_ptr<arrow::DataType>> expected_types;
 	std::string last_error;
 	bool released = false;
+	// Set once a deferred state has opened; readers on other threads (progress, EXPLAIN ANALYZE)
+	// check it before touching query_stream.
+	std::atomic<bool> opened {true};
+
+	// Result cache state: the result replayed on a hit, or the batches recorded on a miss.
+	std::shared_ptr<const PostHogCachedResult> cached_result;
+	size_t cached_batch_index = 0;
+	PostHogResultCache *record_cache = nullptr;
+	std::string record_key;
+	std::shared_ptr<PostHogCachedResult> recorded_result;
+
+	// Set when a deferred state opens as one of the scans of a shared scan (shared_scan_bytes): the
+	// batches are this scan's columns of the shared query, read from its buffer.
+	std::shared_ptr<PostHogSharedScanReader> shared_reader;
+
+private:
+	std::function<void(PostHogArrowStreamState &)> open_deferred;
+
+	// Runs open_deferred once. Its errors become an IOError status, except DuckDB exceptions, which
+	// propagate unchanged.
+	arrow::Status OpenIfDeferred();
+	arrow::Result<arrow::flight::FlightStreamChunk> NextFromRemote();
+	arrow::Result<arrow::flight::FlightStreamChunk> NextConformed();
+	// Pool of the batches NextBatch() builds: the catalog's PostHogMemoryPool with track_memory.
+	arrow::MemoryPool *ConversionPool() const;
+	void Record(const arrow::Result<arrow::flight::FlightStreamChunk> &chunk_result);
 };
 
 class PostHogArrowStream {
 public:
 	static void Initialize(ArrowArrayStream &stream, std::shared_ptr<PostHogArrowStreamState> state);
 	static unique_ptr<ArrowArrayStreamWrapper> Produce(uintptr_t stream_factory_ptr, ArrowStreamParameters &parameters);
+	// Remote SELECT for a scan of bind_data with the projection and filters DuckDB pushed down. The
+	// queries of a split scan pass the AT clause the splits are pinned to and their own condition.
+	// filter_sql replaces FilterToSQL's rendering of the filters at the given positions.
+	static string BuildQuery(const PostHogRemoteScanBindData &bind_data, const ArrowStreamParameters &parameters,
+	                         const string &split_at_clause = string(), const string &split_condition = string(),
+	                         const std::unordered_map<idx_t, string> &filter_sql = {});
+	// Uploads the values of every IN-list filter with at least in_list_upload_threshold values to a
+	// temporary table owned by factory. Returns the semi-join against it that replaces each inline
+	// list, keyed by filter position for BuildQuery; lists that could not be uploaded stay inline.
+	static std::unordered_map<idx_t, string> UploadInLists(PostHogRemoteScanStreamFactory &factory,
+	                                                      const ArrowStreamParameters &parameters);
+	// Expose a stream state through a C ArrowArrayStream owned by the returned wrapper.
+	static unique_ptr<ArrowArrayStreamWrapper> Wrap(std::shared_ptr<PostHogArrowStreamState> state);
 	static void GetSchema(ArrowArrayStream *stream_factory_ptr, ArrowSchema &schema);
+	// Builds the scan's query and opens it into state, or finds it in the result cache. at_clause
+	// replaces the scan's own AT clause, as for a split.
+	static void Open(PostHogRemoteScanStreamFactory &factory, const ArrowStreamParameters &parameters,
+	                 PostHogArrowStreamState &state, const string &at_clause = string());
 
 private:
 	static int StreamGetSchema(ArrowArrayStream *stream, ArrowSchema *out);
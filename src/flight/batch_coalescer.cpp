@@ -0,0 +1,141 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// flight/batch_coalescer.cpp
+//
+// Merges small and slices large Flight record batches to scan-friendly sizes
+//===----------------------------------------------------------------------===//
+
+#include "flight/batch_coalescer.hpp"
+
+#include <arrow/table.h>
+#include <arrow/util/byte_size.h>
+
+#include <algorithm>
+#include <utility>
+
+namespace duckdb {
+
+PostHogBatchCoalescer::PostHogBatchCoalescer(Source source, size_t target_rows, size_t target_bytes,
+                                             size_t row_alignment, arrow::MemoryPool *pool)
+    : source_(std::move(source)), target_rows_(target_rows), target_bytes_(target_bytes),
+      row_alignment_(std::max<size_t>(row_alignment, 1)), pool_(pool) {
+}
+
+bool PostHogBatchCoalescer::IsSmall(int64_t rows, int64_t bytes) const {
+	if (target_rows_ == 0 && target_bytes_ == 0) {
+		return false;
+	}
+	return (target_rows_ == 0 || static_cast<size_t>(rows) * 2 < target_rows_) &&
+	       (target_bytes_ == 0 || static_cast<size_t>(bytes) * 2 < target_bytes_);
+}
+
+bool PostHogBatchCoalescer::IsLarge(int64_t rows, int64_t bytes) const {
+	return (target_rows_ > 0 && static_cast<size_t>(rows) > target_rows_) ||
+	       (target_bytes_ > 0 && static_cast<size_t>(bytes) > target_bytes_);
+}
+
+bool PostHogBatchCoalescer::BufferFull() const {
+	return (target_rows_ > 0 && static_cast<size_t>(buffered_rows_) >= target_rows_) ||
+	       (target_bytes_ > 0 && static_cast<size_t>(buffered_bytes_) >= target_bytes_);
+}
+
+arrow::Result<std::shared_ptr<arrow::RecordBatch>> PostHogBatchCoalescer::FlushBuffer() {
+	auto batches = std::move(buffer_);
+	buffer_.clear();
+	buffered_rows_ = 0;
+	buffered_bytes_ = 0;
+	if (batches.size() == 1) {
+		return batches[0];
+	}
+	auto schema = batches[0]->schema();
+	ARROW_ASSIGN_OR_RAISE(auto table, arrow::Table::FromRecordBatches(schema, batches));
+	return table->CombineChunksToBatch(pool_);
+}
+
+std::shared_ptr<arrow::RecordBatch> PostHogBatchCoalescer::NextSlice() {
+	auto length = std::min(split_rows_, split_->num_rows() - split_offset_);
+	auto slice = split_->Slice(split_offset_, length);
+	split_offset_ += length;
+	if (split_offset_ >= split_->num_rows()) {
+		split_.reset();
+	}
+	return slice;
+}
+
+arrow::Result<std::shared_ptr<arrow::RecordBatch>> PostHogBatchCoalescer::Next() {
+	if (split_) {
+		return NextSlice();
+	}
+
+	std::shared_ptr<arrow::RecordBatch> batch = std::move(held_);
+	held_.reset();
+	while (!batch) {
+		if (finished_) {
+			if (!buffer_.empty()) {
+				return FlushBuffer();
+			}
+			if (!error_.ok()) {
+				return std::exchange(error_, arrow::Status::OK());
+			}
+			return std::shared_ptr<arrow::RecordBatch>();
+		}
+
+		auto chunk_result = source_();
+		if (!chunk_result.ok() || !chunk_result->data) {
+			// Buffered rows are still delivered; the error follows on the next call.
+			finished_ = true;
+			if (!chunk_result.ok()) {
+				error_ = chunk_result.status();
+			}
+			continue;
+		}
+		auto next = std::move(chunk_result->data);
+		auto rows = next->num_rows();
+		if (rows == 0) {
+			continue;
+		}
+		auto bytes = arrow::util::TotalBufferSize(*next);
+		if (IsSmall(rows, bytes)) {
+			buffered_rows_ += rows;
+			buffered_bytes_ += bytes;
+			buffer_.push_back(std::move(next));
+			if (BufferFull()) {
+				return FlushBuffer();
+			}
+			continue;
+		}
+		if (!buffer_.empty()) {
+			// Keep the stream's order: the buffered rows go out first.
+			held_ = std::move(next);
+			return FlushBuffer();
+		}
+		batch = std::move(next);
+	}
+
+	auto rows = batch->num_rows();
+	auto bytes = arrow::util::TotalBufferSize(*batch);
+	if (!IsLarge(rows, bytes)) {
+		return batch;
+	}
+	auto slice_rows = rows;
+	if (target_rows_ > 0) {
+		slice_rows = std::min<int64_t>(slice_rows, static_cast<int64_t>(target_rows_));
+	}
+	if (target_bytes_ > 0 && bytes > 0) {
+		// Slices share the batch's buffers, so their size is estimated from its average row width.
+		auto rows_in_budget = static_cast<int64_t>(static_cast<double>(rows) * static_cast<double>(target_bytes_) /
+		                                           static_cast<double>(bytes));
+		slice_rows = std::min<int64_t>(slice_rows, std::max<int64_t>(rows_in_budget, 1));
+	}
+	auto alignment = static_cast<int64_t>(row_alignment_);
+	if (slice_rows > alignment) {
+		slice_rows -= slice_rows % alignment;
+	}
+	split_ = std::move(batch);
+	split_offset_ = 0;
+	split_rows_ = slice_rows;
+	return NextSlice();
+}
+
+} // namespace duckdb
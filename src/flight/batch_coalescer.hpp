@@ -0,0 +1,71 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// flight/batch_coalescer.hpp
+//
+// Merges small and slices large Flight record batches to scan-friendly sizes
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <arrow/flight/types.h>
+#include <arrow/memory_pool.h>
+#include <arrow/record_batch.h>
+#include <arrow/result.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace duckdb {
+
+// Reshapes the batches of a source so the Arrow scan sees batches near target_rows rows and
+// target_bytes bytes (0 leaves that limit off):
+// - consecutive batches smaller than half a target are concatenated until one target is reached;
+// - batches larger than a target are sliced (zero-copy) into pieces of at most one target, rounded
+//   down to a multiple of row_alignment rows so only the last piece ends in a partial vector;
+// - everything in between is passed through untouched, since copying it would cost more than the
+//   per-batch overhead it saves.
+// Concatenated batches are allocated from pool.
+class PostHogBatchCoalescer {
+public:
+	// Returns an empty chunk at end of stream.
+	using Source = std::function<arrow::Result<arrow::flight::FlightStreamChunk>()>;
+
+	PostHogBatchCoalescer(Source source, size_t target_rows, size_t target_bytes, size_t row_alignment,
+	                      arrow::MemoryPool *pool = arrow::default_memory_pool());
+
+	// Returns nullptr at end of stream. A source error is returned once buffered batches are out.
+	arrow::Result<std::shared_ptr<arrow::RecordBatch>> Next();
+
+private:
+	bool IsSmall(int64_t rows, int64_t bytes) const;
+	bool IsLarge(int64_t rows, int64_t bytes) const;
+	bool BufferFull() const;
+	arrow::Result<std::shared_ptr<arrow::RecordBatch>> FlushBuffer();
+	// Next piece of split_, which is at least one row long.
+	std::shared_ptr<arrow::RecordBatch> NextSlice();
+
+	Source source_;
+	size_t target_rows_;
+	size_t target_bytes_;
+	size_t row_alignment_;
+	arrow::MemoryPool *pool_;
+
+	// Small batches waiting to be concatenated.
+	std::vector<std::shared_ptr<arrow::RecordBatch>> buffer_;
+	int64_t buffered_rows_ = 0;
+	int64_t buffered_bytes_ = 0;
+	// Batch read from the source that does not join buffer_; emitted (in slices if large) next.
+	std::shared_ptr<arrow::RecordBatch> held_;
+	// Large batch being sliced, the next row to emit and the rows per slice.
+	std::shared_ptr<arrow::RecordBatch> split_;
+	int64_t split_offset_ = 0;
+	int64_t split_rows_ = 0;
+	bool finished_ = false;
+	arrow::Status error_;
+};
+
+} // namespace duckdb
@@ -0,0 +1,103 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// flight/batch_prefetcher.cpp
+//
+// Background read-ahead of Flight record batches
+//===----------------------------------------------------------------------===//
+
+#include "flight/batch_prefetcher.hpp"
+
+#include <arrow/util/byte_size.h>
+
+#include <exception>
+
+namespace duckdb {
+
+PostHogBatchPrefetcher::PostHogBatchPrefetcher(PostHogFlightQueryStream &stream, size_t high_water_bytes,
+                                               PostHogMemoryPool *memory_pool)
+    : stream_(stream), schema_(stream_.GetSchema()), high_water_bytes_(high_water_bytes), memory_pool_(memory_pool) {
+	reader_ = std::thread([this]() { ReadLoop(); });
+}
+
+PostHogBatchPrefetcher::~PostHogBatchPrefetcher() {
+	bool finished;
+	{
+		std::lock_guard<std::mutex> guard(lock_);
+		stopping_ = true;
+		finished = finished_;
+	}
+	space_ready_.notify_all();
+	// The reader may be blocked inside a Flight Next(); cancelling the DoGet makes that return
+	// right away instead of after the next batch arrives.
+	if (!finished) {
+		stream_.Cancel();
+	}
+	if (reader_.joinable()) {
+		reader_.join();
+	}
+}
+
+arrow::Result<std::shared_ptr<arrow::Schema>> PostHogBatchPrefetcher::GetSchema() const {
+	return schema_;
+}
+
+void PostHogBatchPrefetcher::ReadLoop() {
+	while (true) {
+		{
+			std::unique_lock<std::mutex> guard(lock_);
+			// Under memory pressure at most one batch is queued; popping it wakes the reader.
+			space_ready_.wait(guard, [&]() {
+				return stopping_ || queue_.empty() ||
+				       (queued_bytes_ < high_water_bytes_ &&
+				        (!memory_pool_ || memory_pool_->HasHeadroom(static_cast<int64_t>(last_batch_bytes_))));
+			});
+			if (stopping_) {
+				return;
+			}
+		}
+
+		arrow::Result<arrow::flight::FlightStreamChunk> chunk_result;
+		try {
+			chunk_result = stream_.Next();
+		} catch (const std::exception &ex) {
+			chunk_result = arrow::Status::IOError(ex.what());
+		}
+
+		std::lock_guard<std::mutex> guard(lock_);
+		if (!chunk_result.ok()) {
+			error_ = chunk_result.status();
+			finished_ = true;
+		} else if (!chunk_result->data) {
+			finished_ = true;
+		} else {
+			auto bytes = static_cast<size_t>(arrow::util::TotalBufferSize(*chunk_result->data));
+			queued_bytes_ += bytes;
+			last_batch_bytes_ = bytes;
+			queue_.emplace_back(std::move(*chunk_result), bytes);
+		}
+		batch_ready_.notify_one();
+		if (finished_) {
+			return;
+		}
+	}
+}
+
+arrow::Result<arrow::flight::FlightStreamChunk> PostHogBatchPrefetcher::Next() {
+	std::unique_lock<std::mutex> guard(lock_);
+	batch_ready_.wait(guard, [&]() { return !queue_.empty() || finished_; });
+	if (queue_.empty()) {
+		if (!error_.ok()) {
+			return error_;
+		}
+		return arrow::flight::FlightStreamChunk();
+	}
+	auto entry = std::move(queue_.front());
+	queue_.pop_front();
+	queued_bytes_ -= entry.second;
+	guard.unlock();
+	space_ready_.notify_one();
+	return std::move(entry.first);
+}
+
+} // namespace duckdb
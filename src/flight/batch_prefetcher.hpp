@@ -0,0 +1,64 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// flight/batch_prefetcher.hpp
+//
+// Background read-ahead of Flight record batches
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "flight/flight_client.hpp"
+#include "flight/memory_pool.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace duckdb {
+
+// Drains a PostHogFlightQueryStream on a background thread into a bounded queue, so network
+// receive and IPC decode overlap with DuckDB's Arrow conversion. The reader pauses once the
+// queued batches reach high_water_bytes, or, with a memory_pool, while another batch of the size
+// of the last one would not fit in memory_limit; at least one batch is always allowed in flight.
+// The stream must outlive the prefetcher, and must not be read directly while it runs.
+class PostHogBatchPrefetcher {
+public:
+	PostHogBatchPrefetcher(PostHogFlightQueryStream &stream, size_t high_water_bytes,
+	                       PostHogMemoryPool *memory_pool = nullptr);
+	~PostHogBatchPrefetcher();
+
+	PostHogBatchPrefetcher(const PostHogBatchPrefetcher &) = delete;
+	PostHogBatchPrefetcher &operator=(const PostHogBatchPrefetcher &) = delete;
+
+	// Resolved before the reader thread starts, so this never races with Next().
+	arrow::Result<std::shared_ptr<arrow::Schema>> GetSchema() const;
+
+	// Blocks until a batch is queued. Returns an empty chunk at end of stream.
+	arrow::Result<arrow::flight::FlightStreamChunk> Next();
+
+private:
+	void ReadLoop();
+
+	PostHogFlightQueryStream &stream_;
+	arrow::Result<std::shared_ptr<arrow::Schema>> schema_;
+	size_t high_water_bytes_;
+	PostHogMemoryPool *memory_pool_;
+
+	std::mutex lock_;
+	std::condition_variable batch_ready_;
+	std::condition_variable space_ready_;
+	std::deque<std::pair<arrow::flight::FlightStreamChunk, size_t>> queue_;
+	size_t queued_bytes_ = 0;
+	size_t last_batch_bytes_ = 0;
+	bool finished_ = false;
+	bool stopping_ = false;
+	arrow::Status error_;
+
+	std::thread reader_;
+};
+
+} // namespace duckdb
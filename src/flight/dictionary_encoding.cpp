@@ -0,0 +1,156 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// flight/dictionary_encoding.cpp
+//
+// Dictionary-encoded string columns: bind-time schema rewrite and per-batch conformance
+//===----------------------------------------------------------------------===//
+
+#include "flight/dictionary_encoding.hpp"
+
+#include <arrow/array.h>
+#include <arrow/array/builder_binary.h>
+#include <arrow/array/builder_dict.h>
+#include <arrow/array/builder_primitive.h>
+
+#include <cstdint>
+#include <limits>
+
+namespace duckdb {
+
+namespace {
+
+bool IsStringType(const arrow::DataType &type) {
+	return type.id() == arrow::Type::STRING || type.id() == arrow::Type::LARGE_STRING;
+}
+
+template <class VALUE_TYPE>
+arrow::Result<std::shared_ptr<arrow::Array>> Encode(const arrow::Array &column, arrow::MemoryPool *pool) {
+	arrow::Dictionary32Builder<VALUE_TYPE> builder(pool);
+	ARROW_RETURN_NOT_OK(builder.AppendArray(column));
+	return builder.Finish();
+}
+
+arrow::Result<std::shared_ptr<arrow::Array>> Reindex(const arrow::DictionaryArray &column,
+                                                     const std::shared_ptr<arrow::DataType> &type,
+                                                     arrow::MemoryPool *pool) {
+	if (column.dictionary()->length() > std::numeric_limits<int32_t>::max()) {
+		return arrow::Status::NotImplemented("PostHog: dictionary with ", column.dictionary()->length(),
+		                                     " entries does not fit int32 indices");
+	}
+	arrow::Int32Builder indices(pool);
+	ARROW_RETURN_NOT_OK(indices.Reserve(column.length()));
+	for (int64_t i = 0; i < column.length(); i++) {
+		if (column.IsNull(i)) {
+			indices.UnsafeAppendNull();
+		} else {
+			indices.UnsafeAppend(static_cast<int32_t>(column.GetValueIndex(i)));
+		}
+	}
+	ARROW_ASSIGN_OR_RAISE(auto index_array, indices.Finish());
+	return arrow::DictionaryArray::FromArrays(type, index_array, column.dictionary());
+}
+
+template <class VALUE_ARRAY, class BUILDER>
+arrow::Result<std::shared_ptr<arrow::Array>> Decode(const arrow::DictionaryArray &column, arrow::MemoryPool *pool) {
+	const auto &values = static_cast<const VALUE_ARRAY &>(*column.dictionary());
+	BUILDER builder(pool);
+	ARROW_RETURN_NOT_OK(builder.Reserve(column.length()));
+	for (int64_t i = 0; i < column.length(); i++) {
+		if (column.IsNull(i)) {
+			ARROW_RETURN_NOT_OK(builder.AppendNull());
+			continue;
+		}
+		auto index = column.GetValueIndex(i);
+		if (values.IsNull(index)) {
+			ARROW_RETURN_NOT_OK(builder.AppendNull());
+		} else {
+			ARROW_RETURN_NOT_OK(builder.Append(values.GetView(index)));
+		}
+	}
+	return builder.Finish();
+}
+
+// Columns this cannot convert are returned unchanged; DuckDB's Arrow scan reports the mismatch.
+arrow::Result<std::shared_ptr<arrow::Array>> ConformColumn(const std::shared_ptr<arrow::Array> &column,
+                                                           const std::shared_ptr<arrow::DataType> &expected,
+                                                           arrow::MemoryPool *pool) {
+	const auto &actual = *column->type();
+	if (actual.Equals(*expected)) {
+		return column;
+	}
+	if (expected->id() == arrow::Type::DICTIONARY) {
+		const auto &expected_dict = static_cast<const arrow::DictionaryType &>(*expected);
+		if (expected_dict.index_type()->id() != arrow::Type::INT32) {
+			return column;
+		}
+		if (actual.Equals(*expected_dict.value_type())) {
+			if (actual.id() == arrow::Type::STRING) {
+				return Encode<arrow::StringType>(*column, pool);
+			}
+			if (actual.id() == arrow::Type::LARGE_STRING) {
+				return Encode<arrow::LargeStringType>(*column, pool);
+			}
+			return column;
+		}
+		if (actual.id() == arrow::Type::DICTIONARY &&
+		    static_cast<const arrow::DictionaryType &>(actual).value_type()->Equals(*expected_dict.value_type())) {
+			return Reindex(static_cast<const arrow::DictionaryArray &>(*column), expected, pool);
+		}
+		return column;
+	}
+	if (actual.id() == arrow::Type::DICTIONARY &&
+	    static_cast<const arrow::DictionaryType &>(actual).value_type()->Equals(*expected)) {
+		const auto &dict_column = static_cast<const arrow::DictionaryArray &>(*column);
+		if (expected->id() == arrow::Type::STRING) {
+			return Decode<arrow::StringArray, arrow::StringBuilder>(dict_column, pool);
+		}
+		if (expected->id() == arrow::Type::LARGE_STRING) {
+			return Decode<arrow::LargeStringArray, arrow::LargeStringBuilder>(dict_column, pool);
+		}
+	}
+	return column;
+}
+
+} // namespace
+
+std::shared_ptr<arrow::Schema> DictionaryEncodeStringFields(const std::shared_ptr<arrow::Schema> &schema) {
+	arrow::FieldVector fields;
+	fields.reserve(schema->num_fields());
+	for (const auto &field : schema->fields()) {
+		if (IsStringType(*field->type())) {
+			fields.push_back(field->WithType(arrow::dictionary(arrow::int32(), field->type())));
+		} else {
+			fields.push_back(field);
+		}
+	}
+	return arrow::schema(std::move(fields), schema->metadata());
+}
+
+arrow::Result<std::shared_ptr<arrow::RecordBatch>>
+ConformDictionaryEncoding(const std::shared_ptr<arrow::RecordBatch> &batch,
+                          const std::vector<std::shared_ptr<arrow::DataType>> &expected_types,
+                          arrow::MemoryPool *pool) {
+	if (!batch || expected_types.empty() || static_cast<size_t>(batch->num_columns()) != expected_types.size()) {
+		return batch;
+	}
+	bool changed = false;
+	arrow::ArrayVector columns;
+	arrow::FieldVector fields;
+	columns.reserve(expected_types.size());
+	fields.reserve(expected_types.size());
+	for (int i = 0; i < batch->num_columns(); i++) {
+		const auto &column = batch->column(i);
+		ARROW_ASSIGN_OR_RAISE(auto conformed, ConformColumn(column, expected_types[i], pool));
+		changed = changed || conformed != column;
+		fields.push_back(batch->schema()->field(i)->WithType(conformed->type()));
+		columns.push_back(std::move(conformed));
+	}
+	if (!changed) {
+		return batch;
+	}
+	return arrow::RecordBatch::Make(arrow::schema(std::move(fields), batch->schema()->metadata()), batch->num_rows(),
+	                                std::move(columns));
+}
+
+} // namespace duckdb
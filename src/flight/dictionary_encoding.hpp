@@ -0,0 +1,36 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// flight/dictionary_encoding.hpp
+//
+// Dictionary-encoded string columns: bind-time schema rewrite and per-batch conformance
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <arrow/memory_pool.h>
+#include <arrow/record_batch.h>
+#include <arrow/result.h>
+#include <arrow/type.h>
+
+#include <memory>
+#include <vector>
+
+namespace duckdb {
+
+// schema with every top-level utf8/large_utf8 field turned into dictionary<int32, utf8> (or
+// large_utf8). DuckDB binds such a field as VARCHAR, and its Arrow scan turns each batch's
+// dictionary into a DICTIONARY vector over the indices instead of copying one string per row.
+std::shared_ptr<arrow::Schema> DictionaryEncodeStringFields(const std::shared_ptr<arrow::Schema> &schema);
+
+// Makes the columns of batch match the encoding DuckDB bound (expected_types, one per column):
+// plain strings are dictionary-encoded, dictionaries with other index widths are reindexed to
+// int32 and dictionaries bound as plain strings are decoded. Matching columns are kept as is, so
+// a server that already sends the bound encoding costs nothing. batch is returned unchanged when
+// expected_types is empty or of another width. Converted columns are allocated from pool.
+arrow::Result<std::shared_ptr<arrow::RecordBatch>>
+ConformDictionaryEncoding(const std::shared_ptr<arrow::RecordBatch> &batch,
+                          const std::vector<std::shared_ptr<arrow::DataType>> &expected_types,
+                          arrow::MemoryPool *pool = arrow::default_memory_pool());
+
+} // namespace duckdb
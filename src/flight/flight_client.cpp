@@ -7,6 +7,8 @@
 //===----------------------------------------------------------------------===//
 
 #include "flight/flight_client.hpp"
+#include "flight/memory_pool.hpp"
+#include "flight/session_cache.hpp"
 #include "flight/session_token_utils.hpp"
 #include "utils/posthog_logger.hpp"
 
@@ -23,21 +25,58 @@
 #include <arrow/ipc/dictionary.h>
 #include <arrow/ipc/options.h>
 #include <arrow/ipc/reader.h>
+#include <arrow/util/byte_size.h>
+#include <algorithm>
 #include <chrono>
+#include <condition_variable>
+#include <exception>
 #include <iostream>
 #include <stdexcept>
 #include <string_view>
+#include <thread>
+#include <utility>
 
 namespace duckdb {
 
 namespace {
 using SteadyClock = std::chrono::steady_clock;
 constexpr const char *kSessionHeader = "x-duckgres-session";
+// Asks the server to compress the bodies of the Arrow IPC record batches it sends.
+constexpr const char *kCompressionHeader = "x-duckgres-compression";
+// Asks the server to dictionary-encode the string columns of its results.
+constexpr const char *kDictionaryHeader = "x-duckgres-dictionary-strings";
+constexpr const char *kTraceParentHeader = "traceparent";
+// FlightEndpoint location meaning "read this endpoint over the connection that returned the FlightInfo".
+constexpr const char *kReuseConnectionScheme = "arrow-flight-reuse-connection";
+// Hedged metadata calls send their second attempt once the first has run this long, as a quantile
+// of recent calls of the same kind.
+constexpr double kMetadataHedgeQuantile = 0.95;
+// Deadline of the best-effort CancelFlightInfo sent when a stream is abandoned.
+constexpr std::chrono::milliseconds kCancelTimeout {500};
 
 int64_t ElapsedMillis(const SteadyClock::time_point &started_at) {
 	return std::chrono::duration_cast<std::chrono::milliseconds>(SteadyClock::now() - started_at).count();
 }
 
+int64_t ElapsedMicros(const SteadyClock::time_point &started_at) {
+	return std::chrono::duration_cast<std::chrono::microseconds>(SteadyClock::now() - started_at).count();
+}
+
+// Bounds on the per-client statement caches; past them, statements are prepared and closed per use.
+constexpr size_t MAX_CACHED_PREPARED_STATEMENTS = 256;
+constexpr size_t MAX_CACHED_QUERY_SCHEMAS = 1024;
+
+// Important: explicitly Close() with call options. Arrow's PreparedStatement destructor
+// calls Close() with default FlightCallOptions (no headers), which breaks when the server
+// requires Authorization for ClosePreparedStatement.
+void ClosePreparedStatement(arrow::flight::sql::PreparedStatement &statement,
+                            const arrow::flight::FlightCallOptions &options) {
+	auto close_status = statement.Close(options);
+	if (!close_status.ok()) {
+		POSTHOG_LOG_WARN("Failed to close prepared statement: %s", close_status.ToString().c_str());
+	}
+}
+
 CatalogException RemoteCatalogMissingException(const std::string &catalog) {
 	return CatalogException(
 	    "PostHog: Remote catalog '%s' does not exist. Omit the catalog (use hog:?user=...) to use server-default "
@@ -124,6 +163,24 @@ std::string Base64Encode(const std::string &input) {
 	return output;
 }
 
+bool IsDeadlineExceeded(const arrow::Status &status) {
+	auto detail = arrow::flight::FlightStatusDetail::UnwrapStatus(status);
+	return detail && detail->code() == arrow::flight::FlightStatusCode::TimedOut;
+}
+
+// One attempt of a hedged metadata call, filled in by the thread running it.
+template <class T>
+struct MetadataAttemptState {
+	arrow::StopSource stop_source;
+	std::optional<arrow::Result<T>> result;
+	std::exception_ptr error;
+	bool finished = false;
+
+	bool Succeeded() const {
+		return finished && !error && result->ok();
+	}
+};
+
 [[noreturn]] void ThrowExecuteUpdateError(const arrow::Status &status) {
 	auto message = "PostHog: Update execution failed: " + status.ToString();
 	auto detail = arrow::flight::FlightStatusDetail::UnwrapStatus(status);
@@ -150,8 +207,10 @@ std::string Base64Encode(const std::string &input) {
 	case arrow::StatusCode::NotImplemented:
 		throw NotImplementedException(message);
 	case arrow::StatusCode::IOError:
-	case arrow::StatusCode::Cancelled:
 		throw IOException(message);
+	case arrow::StatusCode::Cancelled:
+		// Raised when the call's stop token fires, i.e. the query was interrupted.
+		throw InterruptException(); // NOLINT(hicpp-exception-baseclass)
 	case arrow::StatusCode::Invalid: {
 		// Some Flight SQL servers encode engine-level SQL errors as Invalid status.
 		auto lowered = StringUtil::Lower(status.message());
@@ -169,11 +228,67 @@ std::string Base64Encode(const std::string &input) {
 		throw InvalidInputException(message);
 	}
 }
+
+// Reads one row of a Flight SQL metadata string column; nullopt for NULL.
+std::optional<std::string_view> MetadataStringAt(const std::shared_ptr<arrow::Array> &column, int64_t row,
+                                                 const char *column_name) {
+	switch (column->type_id()) {
+	case arrow::Type::STRING: {
+		auto array = std::static_pointer_cast<arrow::StringArray>(column);
+		return array->IsNull(row) ? std::nullopt : std::optional<std::string_view>(array->GetView(row));
+	}
+	case arrow::Type::LARGE_STRING: {
+		auto array = std::static_pointer_cast<arrow::LargeStringArray>(column);
+		return array->IsNull(row) ? std::nullopt : std::optional<std::string_view>(array->GetView(row));
+	}
+	default:
+		throw std::runtime_error(std::string("PostHog: Unexpected ") + column_name +
+		                         " column type: " + column->type()->ToString());
+	}
+}
+
+// Reads one row of the GetTables table_schema column; nullopt for NULL.
+std::optional<std::string_view> MetadataBinaryAt(const std::shared_ptr<arrow::Array> &column, int64_t row) {
+	switch (column->type_id()) {
+	case arrow::Type::BINARY: {
+		auto array = std::static_pointer_cast<arrow::BinaryArray>(column);
+		return array->IsNull(row) ? std::nullopt : std::optional<std::string_view>(array->GetView(row));
+	}
+	case arrow::Type::LARGE_BINARY: {
+		auto array = std::static_pointer_cast<arrow::LargeBinaryArray>(column);
+		return array->IsNull(row) ? std::nullopt : std::optional<std::string_view>(array->GetView(row));
+	}
+	default:
+		throw std::runtime_error("PostHog: Unexpected table_schema column type: " + column->type()->ToString());
+	}
+}
+
+// Deserializes an IPC-encoded Arrow schema (GetTables table_schema column).
+arrow::Result<std::shared_ptr<arrow::Schema>> DeserializeSchema(std::string_view schema_bytes) {
+	arrow::ipc::DictionaryMemo dict_memo;
+	auto buffer = std::make_shared<arrow::Buffer>(reinterpret_cast<const uint8_t *>(schema_bytes.data()),
+	                                              static_cast<int64_t>(schema_bytes.size()));
+	arrow::io::BufferReader reader(buffer);
+	return arrow::ipc::ReadSchema(&reader, &dict_memo);
+}
 } // namespace
 
 PostHogFlightClient::PostHogFlightClient(const std::string &endpoint, const std::string &user,
-                                         const std::string &password, bool tls_skip_verify)
+                                         const std::string &password, bool tls_skip_verify, size_t pool_size,
+                                         const std::string &compression, size_t max_message_bytes,
+                                         size_t keepalive_ms)
     : endpoint_(endpoint), user_(user), password_(password) {
+	if (compression != "none") {
+		auto codec_type = compression == "zstd" ? arrow::Compression::ZSTD : arrow::Compression::LZ4_FRAME;
+		auto codec_result = arrow::util::Codec::Create(codec_type);
+		if (!codec_result.ok()) {
+			throw std::runtime_error("PostHog: compression=" + compression +
+			                         " is not available in this Arrow build: " + codec_result.status().ToString());
+		}
+		compression_ = compression;
+		compression_codec_ = std::move(*codec_result);
+	}
+
 	// Parse endpoint and create location
 	auto location_result = arrow::flight::Location::Parse(endpoint);
 	if (!location_result.ok()) {
@@ -189,26 +304,135 @@ PostHogFlightClient::PostHogFlightClient(const std::string &endpoint, const std:
 	options.disable_server_verification = tls_skip_verify;
 	options.middleware.emplace_back(
 	    std::make_shared<SessionTokenCaptureFactory>(&session_token_, &session_token_mutex_));
+	if (max_message_bytes > 0) {
+		// Arrow Flight otherwise receives messages of any size and sends up to gRPC's default.
+		auto limit = static_cast<int>(max_message_bytes);
+		options.generic_options.emplace_back("grpc.max_receive_message_length", limit);
+		options.generic_options.emplace_back("grpc.max_send_message_length", limit);
+	}
+	if (keepalive_ms > 0) {
+		// Only while calls are open (servers reject pings on idle connections by default), but without
+		// gRPC's cap on pings while the client sends no data, which is all of a long result stream.
+		options.generic_options.emplace_back("grpc.keepalive_time_ms", static_cast<int>(keepalive_ms));
+		options.generic_options.emplace_back("grpc.http2.max_pings_without_data", 0);
+	}
+
+	// Each pooled client owns its own gRPC channel; the shared middleware keeps a single
+	// session token across all of them.
+	pool_size = std::max<size_t>(pool_size, 1);
+	channels_.reserve(pool_size);
+	for (size_t i = 0; i < pool_size; i++) {
+		// Connect to the Flight server
+		auto client_result = arrow::flight::FlightClient::Connect(location, options);
+		if (!client_result.ok()) {
+			throw std::runtime_error("PostHog: Failed to connect to Flight server at '" + endpoint +
+			                         "': " + client_result.status().ToString());
+		}
 
-	// Connect to the Flight server
-	auto client_result = arrow::flight::FlightClient::Connect(location, options);
-	if (!client_result.ok()) {
-		throw std::runtime_error("PostHog: Failed to connect to Flight server at '" + endpoint +
-		                         "': " + client_result.status().ToString());
-	}
-
-	// FlightSqlClient takes ownership of the FlightClient via shared_ptr
-	std::shared_ptr<arrow::flight::FlightClient> flight_client = std::move(*client_result);
+		// FlightSqlClient takes ownership of the FlightClient via shared_ptr
+		std::shared_ptr<arrow::flight::FlightClient> flight_client = std::move(*client_result);
 
-	// Wrap in SQL client for Flight SQL protocol support
-	sql_client_ = std::make_unique<arrow::flight::sql::FlightSqlClient>(std::move(flight_client));
+		// Wrap in SQL client for Flight SQL protocol support
+		auto channel = std::make_unique<PooledChannel>();
+		channel->sql_client = std::make_unique<arrow::flight::sql::FlightSqlClient>(std::move(flight_client));
+		channels_.push_back(std::move(channel));
+	}
+	if (pool_size > 1) {
+		POSTHOG_LOG_DEBUG("Opened %zu pooled Flight channels to %s", pool_size, endpoint.c_str());
+	}
+	client_options_ = std::move(options);
+	coordinator_location_ = location;
 }
 
 PostHogFlightClient::~PostHogFlightClient() {
-	std::lock_guard<std::mutex> lock(client_mutex_);
+	CloseAllPreparedStatements();
 	BestEffortCloseSessionLocked();
 }
 
+PostHogFlightClient::RpcStatsScope::RpcStatsScope(PostHogFlightClient &client, const char *rpc, std::string sql)
+    : client_(client), trace_(rpc, sql), started_(SteadyClock::now()),
+      invalidations_at_start_(client.session_invalidations_.load()), uncaught_at_start_(std::uncaught_exceptions()) {
+	stats_.rpc = rpc;
+	stats_.sql = std::move(sql);
+	stats_.started_at = std::chrono::system_clock::now();
+}
+
+PostHogFlightClient::RpcStatsScope::~RpcStatsScope() {
+	if (std::uncaught_exceptions() > uncaught_at_start_) {
+		stats_.status = "error";
+	}
+	stats_.total_us = ElapsedMicros(started_);
+	stats_.session_invalidations = client_.session_invalidations_.load() - invalidations_at_start_;
+	client_.query_stats_.Add(std::move(stats_));
+}
+
+void PostHogFlightClient::RpcStatsScope::AddBatch(const arrow::RecordBatch &batch) {
+	if (stats_.first_batch_us < 0) {
+		stats_.first_batch_us = ElapsedMicros(started_);
+	}
+	stats_.batches++;
+	stats_.rows += batch.num_rows();
+	stats_.bytes += arrow::util::TotalBufferSize(batch);
+}
+
+PostHogFlightClient::ChannelLease PostHogFlightClient::AcquireChannel() {
+	if (channels_.empty()) {
+		throw std::runtime_error("PostHog: Flight client is not connected");
+	}
+	auto lease = TryAcquireChannel();
+	if (lease) {
+		return std::move(*lease);
+	}
+	auto &channel = *channels_[next_channel_.fetch_add(1) % channels_.size()];
+	return ChannelLease(channel, std::unique_lock<std::mutex>(channel.mutex));
+}
+
+std::optional<PostHogFlightClient::ChannelLease> PostHogFlightClient::TryAcquireChannel() {
+	if (channels_.empty()) {
+		return std::nullopt;
+	}
+	auto start = next_channel_.fetch_add(1) % channels_.size();
+	for (size_t i = 0; i < channels_.size(); i++) {
+		auto &channel = *channels_[(start + i) % channels_.size()];
+		std::unique_lock<std::mutex> lock(channel.mutex, std::try_to_lock);
+		if (lock.owns_lock()) {
+			return ChannelLease(channel, std::move(lock));
+		}
+	}
+	return std::nullopt;
+}
+
+std::shared_ptr<arrow::flight::FlightClient>
+PostHogFlightClient::GetLocationClient(const arrow::flight::Location &location) {
+	// Locations naming the coordinator (or asking to reuse its connection) are read on the pool.
+	if (!endpoint_locations_ || location.Equals(coordinator_location_) ||
+	    location.scheme() == kReuseConnectionScheme) {
+		return nullptr;
+	}
+	auto uri = location.ToString();
+	std::lock_guard<std::mutex> guard(location_clients_mutex_);
+	auto it = location_clients_.find(uri);
+	if (it != location_clients_.end()) {
+		return it->second;
+	}
+	auto client_result = arrow::flight::FlightClient::Connect(location, client_options_);
+	if (!client_result.ok()) {
+		POSTHOG_LOG_DEBUG("Flight endpoint location %s skipped: %s", uri.c_str(),
+		                  client_result.status().ToString().c_str());
+		return nullptr;
+	}
+	std::shared_ptr<arrow::flight::FlightClient> client = std::move(*client_result);
+	location_clients_.emplace(uri, client);
+	POSTHOG_LOG_DEBUG("Connected to Flight endpoint location %s", uri.c_str());
+	return client;
+}
+
+void PostHogFlightClient::DropLocationClient(const arrow::flight::Location &location) {
+	std::lock_guard<std::mutex> guard(location_clients_mutex_);
+	// Streams still reading from the node keep the client alive through their shared_ptr.
+	location_clients_.erase(location.ToString());
+}
+
 std::string PostHogFlightClient::GetSessionTokenSnapshot() const {
 	std::lock_guard<std::mutex> lock(session_token_mutex_);
 	return session_token_;
@@ -222,16 +446,23 @@ bool PostHogFlightClient::ShouldRetryMetadataWithFreshSession(const arrow::Statu
 }
 
 void PostHogFlightClient::InvalidateSessionTokenLocked(const char *reason, const arrow::Status *status) {
-	std::lock_guard<std::mutex> token_lock(session_token_mutex_);
-	if (session_token_.empty()) {
-		return;
-	}
-	if (status) {
-		POSTHOG_LOG_WARN("Invalidating Flight session token (%s): %s", reason, status->ToString().c_str());
-	} else {
-		POSTHOG_LOG_DEBUG("Invalidating Flight session token (%s)", reason);
+	{
+		std::lock_guard<std::mutex> token_lock(session_token_mutex_);
+		if (session_token_.empty()) {
+			return;
+		}
+		if (status) {
+			POSTHOG_LOG_WARN("Invalidating Flight session token (%s): %s", reason, status->ToString().c_str());
+		} else {
+			POSTHOG_LOG_DEBUG("Invalidating Flight session token (%s)", reason);
+		}
+		session_token_.clear();
 	}
-	session_token_.clear();
+	session_invalidations_.fetch_add(1);
+	// Prepared handles of the old session are closed with their transaction; cached schemas can
+	// simply be dropped.
+	std::lock_guard<std::mutex> cache_lock(statement_cache_mutex_);
+	query_schemas_.clear();
 }
 
 void PostHogFlightClient::InvalidateSessionTokenIfRetryableLocked(const char *reason, const arrow::Status &status) {
@@ -242,21 +473,39 @@ void PostHogFlightClient::InvalidateSessionTokenIfRetryableLocked(const char *re
 }
 
 void PostHogFlightClient::BestEffortCloseSessionLocked() {
-	if (!sql_client_) {
+	if (channels_.empty()) {
 		return;
 	}
 
-	if (!GetSessionTokenSnapshot().empty()) {
-		auto close_result = sql_client_->CloseSession(GetCallOptions(), arrow::flight::CloseSessionRequest());
+	auto session_token = GetSessionTokenSnapshot();
+	if (!session_token.empty() && !session_cache_path_.empty() &&
+	    PostHogSessionCache::Store(session_cache_path_, endpoint_, user_, session_token)) {
+		// Left open for the next process to resume.
+		POSTHOG_LOG_DEBUG("Flight session stored in %s", session_cache_path_.c_str());
+	} else if (!session_token.empty()) {
+		auto close_result =
+		    channels_.front()->sql_client->CloseSession(GetCallOptions(), arrow::flight::CloseSessionRequest());
 		if (!close_result.ok()) {
 			POSTHOG_LOG_DEBUG("Flight CloseSession skipped: %s", close_result.status().ToString().c_str());
 		}
 	}
 
-	auto close_status = sql_client_->Close();
-	if (!close_status.ok()) {
-		POSTHOG_LOG_DEBUG("Flight client close skipped: %s", close_status.ToString().c_str());
+	for (auto &channel : channels_) {
+		std::lock_guard<std::mutex> lock(channel->mutex);
+		auto close_status = channel->sql_client->Close();
+		if (!close_status.ok()) {
+			POSTHOG_LOG_DEBUG("Flight client close skipped: %s", close_status.ToString().c_str());
+		}
 	}
+
+	std::lock_guard<std::mutex> guard(location_clients_mutex_);
+	for (auto &entry : location_clients_) {
+		auto close_status = entry.second->Close();
+		if (!close_status.ok()) {
+			POSTHOG_LOG_DEBUG("Flight location client close skipped: %s", close_status.ToString().c_str());
+		}
+	}
+	location_clients_.clear();
 }
 
 void PostHogFlightClient::Authenticate() {
@@ -264,22 +513,41 @@ void PostHogFlightClient::Authenticate() {
 		throw std::runtime_error("PostHog: Missing Flight credentials (user/password)");
 	}
 	authenticated_ = true;
+	if (session_cache_path_.empty()) {
+		return;
+	}
+	auto cached_token = PostHogSessionCache::Claim(session_cache_path_, endpoint_, user_);
+	if (cached_token.empty()) {
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(session_token_mutex_);
+		session_token_ = std::move(cached_token);
+	}
+	// An expired session fails the ping with a retryable status, which drops the token and pings
+	// again in a fresh session; either way the session is known to be good before the first query.
+	auto invalidations = session_invalidations_.load();
+	auto status = Ping();
+	if (session_invalidations_.load() == invalidations && status.ok()) {
+		POSTHOG_LOG_DEBUG("Resumed Flight session from %s", session_cache_path_.c_str());
+	} else if (!status.ok()) {
+		POSTHOG_LOG_DEBUG("Flight session ping after resume failed: %s", status.ToString().c_str());
+	}
 }
 
 arrow::Status PostHogFlightClient::Ping() {
-	std::lock_guard<std::mutex> lock(client_mutex_);
-
 	if (!authenticated_) {
 		return arrow::Status::Invalid("Not authenticated. Call Authenticate() first.");
 	}
-	if (!sql_client_) {
+	if (channels_.empty()) {
 		return arrow::Status::Invalid("SQL client not initialized");
 	}
+	auto channel = AcquireChannel();
 
 	auto run_ping = [&]() -> arrow::Status {
 		// Prefer a metadata RPC that our servers/tests already implement (GetDbSchemas),
 		// since some Flight SQL servers may not implement SqlInfo.
-		auto info_result = sql_client_->GetDbSchemas(GetCallOptions(), nullptr, nullptr);
+		auto info_result = channel->GetDbSchemas(GetCallOptions(), nullptr, nullptr);
 		if (!info_result.ok()) {
 			return info_result.status();
 		}
@@ -291,7 +559,7 @@ arrow::Status PostHogFlightClient::Ping() {
 
 		// Drain the stream so server-side readers are fully released on single-conn
 		// sessions where one open result stream can block subsequent statements.
-		auto stream_result = sql_client_->DoGet(GetCallOptions(), info->endpoints()[0].ticket);
+		auto stream_result = channel->DoGet(GetCallOptions(), info->endpoints()[0].ticket);
 		if (!stream_result.ok()) {
 			return stream_result.status();
 		}
@@ -317,8 +585,9 @@ arrow::Status PostHogFlightClient::Ping() {
 	return run_ping();
 }
 
-arrow::flight::FlightCallOptions PostHogFlightClient::GetCallOptions() const {
+arrow::flight::FlightCallOptions PostHogFlightClient::GetCallOptions(const arrow::StopToken &stop_token) const {
 	arrow::flight::FlightCallOptions options;
+	options.stop_token = stop_token;
 	auto session_token = GetSessionTokenSnapshot();
 
 	// Add HTTP Basic credentials (username/password) for each request.
@@ -328,6 +597,20 @@ arrow::flight::FlightCallOptions PostHogFlightClient::GetCallOptions() const {
 	if (!session_token.empty()) {
 		options.headers.emplace_back(kSessionHeader, session_token);
 	}
+	// W3C trace context of the enclosing span, so Duckgres can attach its spans to ours.
+	auto trace = PostHogTracer::Current();
+	if (trace.IsValid()) {
+		options.headers.emplace_back(kTraceParentHeader, trace.ToTraceParent());
+	}
+	if (!compression_.empty()) {
+		// Compressed IPC bodies are decompressed by the stream reader; uploads (bulk ingest and
+		// prepared statement parameters) are compressed with the same codec.
+		options.headers.emplace_back(kCompressionHeader, compression_);
+		options.write_options.codec = compression_codec_;
+	}
+	if (dictionary_strings_) {
+		options.headers.emplace_back(kDictionaryHeader, "true");
+	}
 
 	// Control new allocations Arrow performs while decoding.
 	options.memory_manager = arrow::default_cpu_memory_manager();
@@ -340,9 +623,31 @@ arrow::flight::FlightCallOptions PostHogFlightClient::GetCallOptions() const {
 	return options;
 }
 
+void PostHogFlightClient::CancelFlightInfo(const arrow::flight::FlightInfo &info) {
+#if ARROW_VERSION_MAJOR >= 14
+	// Best effort: the server also drops the query once its session ends. The caller may be the
+	// destructor of a stream whose own thread holds the only free channel, so never wait for one.
+	auto channel = TryAcquireChannel();
+	if (!channel) {
+		POSTHOG_LOG_DEBUG("Flight CancelFlightInfo skipped: no idle channel");
+		return;
+	}
+	auto options = GetCallOptions();
+	options.timeout = std::chrono::duration_cast<arrow::flight::TimeoutDuration>(kCancelTimeout);
+	auto result = (*channel)->CancelFlightInfo(options, arrow::flight::CancelFlightInfoRequest(info));
+	if (!result.ok()) {
+		POSTHOG_LOG_DEBUG("Flight CancelFlightInfo failed: %s", result.status().ToString().c_str());
+	}
+#else
+	(void)info;
+#endif
+}
+
 std::shared_ptr<arrow::Table> PostHogFlightClient::ExecuteQuery(const std::string &sql,
-                                                                const std::optional<TransactionId> &txn_id) {
-	std::lock_guard<std::mutex> lock(client_mutex_);
+                                                                const std::optional<TransactionId> &txn_id,
+                                                                PostHogMemoryPool *memory_pool) {
+	RpcStatsScope scope(*this, "ExecuteQuery", sql);
+	auto channel = AcquireChannel();
 
 	if (!authenticated_) {
 		throw std::runtime_error("PostHog: Not authenticated. Call Authenticate() first.");
@@ -352,9 +657,9 @@ std::shared_ptr<arrow::Table> PostHogFlightClient::ExecuteQuery(const std::strin
 	arrow::Result<std::unique_ptr<arrow::flight::FlightInfo>> info_result;
 	if (txn_id.has_value()) {
 		arrow::flight::sql::Transaction txn(*txn_id);
-		info_result = sql_client_->Execute(GetCallOptions(), sql, txn);
+		info_result = channel->Execute(GetCallOptions(), sql, txn);
 	} else {
-		info_result = sql_client_->Execute(GetCallOptions(), sql);
+		info_result = channel->Execute(GetCallOptions(), sql);
 	}
 	if (!info_result.ok()) {
 		InvalidateSessionTokenIfRetryableLocked("execute query", info_result.status());
@@ -362,14 +667,19 @@ std::shared_ptr<arrow::Table> PostHogFlightClient::ExecuteQuery(const std::strin
 	}
 
 	auto flight_info = std::move(*info_result);
+	scope.Stats().endpoints = static_cast<int64_t>(flight_info->endpoints().size());
 
 	// Collect all result batches from all endpoints
 	std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
 	std::shared_ptr<arrow::Schema> result_schema;
 
+	auto fetch_options = GetCallOptions();
+	if (memory_pool) {
+		fetch_options.read_options.memory_pool = memory_pool;
+	}
 	for (const auto &endpoint : flight_info->endpoints()) {
 		// Get the result stream for this endpoint
-		auto stream_result = sql_client_->DoGet(GetCallOptions(), endpoint.ticket);
+		auto stream_result = channel->DoGet(fetch_options, endpoint.ticket);
 		if (!stream_result.ok()) {
 			InvalidateSessionTokenIfRetryableLocked("execute query fetch results", stream_result.status());
 			throw std::runtime_error("PostHog: Failed to fetch results: " + stream_result.status().ToString());
@@ -393,7 +703,16 @@ std::shared_ptr<arrow::Table> PostHogFlightClient::ExecuteQuery(const std::strin
 			if (!result_schema) {
 				result_schema = chunk.data->schema();
 			}
-			batches.push_back(chunk.data);
+			scope.AddBatch(*chunk.data);
+			if (!memory_pool) {
+				batches.push_back(chunk.data);
+				continue;
+			}
+			auto tracked = memory_pool->Track(chunk.data);
+			if (!tracked.ok()) {
+				throw std::runtime_error("PostHog: Failed to read result batch: " + tracked.status().ToString());
+			}
+			batches.push_back(*tracked);
 		}
 	}
 
@@ -421,33 +740,131 @@ std::shared_ptr<arrow::Table> PostHogFlightClient::ExecuteQuery(const std::strin
 	return *table_result;
 }
 
-int64_t PostHogFlightClient::ExecuteUpdate(const std::string &sql, const std::optional<TransactionId> &txn_id) {
-	std::lock_guard<std::mutex> lock(client_mutex_);
+int64_t PostHogFlightClient::ExecuteUpdate(const std::string &sql, const std::optional<TransactionId> &txn_id,
+                                           const arrow::StopToken &stop_token) {
+	RpcStatsScope scope(*this, "ExecuteUpdate", sql);
+	auto channel = AcquireChannel();
 
 	if (!authenticated_) {
 		throw std::runtime_error("PostHog: Not authenticated. Call Authenticate() first.");
 	}
 
-	auto call_options = GetCallOptions();
+	auto call_options = GetCallOptions(stop_token);
 
 	arrow::Result<int64_t> result;
 	if (txn_id.has_value()) {
 		arrow::flight::sql::Transaction txn(*txn_id);
-		result = sql_client_->ExecuteUpdate(call_options, sql, txn);
+		result = channel->ExecuteUpdate(call_options, sql, txn);
 	} else {
-		result = sql_client_->ExecuteUpdate(call_options, sql);
+		result = channel->ExecuteUpdate(call_options, sql);
 	}
 	if (!result.ok()) {
 		InvalidateSessionTokenIfRetryableLocked("execute update", result.status());
 		ThrowExecuteUpdateError(result.status());
 	}
 
+	scope.Stats().rows = *result;
 	return *result;
 }
 
+std::optional<int64_t> PostHogFlightClient::ExecuteIngest(const std::shared_ptr<arrow::RecordBatchReader> &reader,
+                                                          const std::string &catalog, const std::string &schema,
+                                                          const std::string &table,
+                                                          const std::optional<TransactionId> &txn_id,
+                                                          const arrow::StopToken &stop_token) {
+	return Ingest(reader, catalog, schema, table, false, txn_id, stop_token);
+}
+
+std::optional<int64_t>
+PostHogFlightClient::ExecuteTemporaryIngest(const std::shared_ptr<arrow::RecordBatchReader> &reader,
+                                            const std::string &table, const std::optional<TransactionId> &txn_id,
+                                            const arrow::StopToken &stop_token) {
+	return Ingest(reader, std::string(), std::string(), table, true, txn_id, stop_token);
+}
+
+std::optional<int64_t> PostHogFlightClient::Ingest(const std::shared_ptr<arrow::RecordBatchReader> &reader,
+                                                   const std::string &catalog, const std::string &schema,
+                                                   const std::string &table, bool temporary,
+                                                   const std::optional<TransactionId> &txn_id,
+                                                   const arrow::StopToken &stop_token) {
+	if (!ingest_supported_.load()) {
+		return std::nullopt;
+	}
+#if ARROW_VERSION_MAJOR >= 16
+	RpcStatsScope scope(*this, "ExecuteIngest", temporary ? table : catalog + "." + schema + "." + table);
+	auto channel = AcquireChannel();
+
+	if (!authenticated_) {
+		throw std::runtime_error("PostHog: Not authenticated. Call Authenticate() first.");
+	}
+
+	// Appends require an existing table; temporary tables are created by the ingest itself.
+	arrow::flight::sql::TableDefinitionOptions table_definition;
+	if (temporary) {
+		table_definition.if_not_exist = arrow::flight::sql::TableDefinitionOptionsTableNotExistOption::kCreate;
+		table_definition.if_exists = arrow::flight::sql::TableDefinitionOptionsTableExistsOption::kFail;
+	} else {
+		table_definition.if_not_exist = arrow::flight::sql::TableDefinitionOptionsTableNotExistOption::kFail;
+		table_definition.if_exists = arrow::flight::sql::TableDefinitionOptionsTableExistsOption::kAppend;
+	}
+	auto schema_name = schema.empty() ? std::nullopt : std::optional<std::string>(schema);
+	auto catalog_name = catalog.empty() ? std::nullopt : std::optional<std::string>(catalog);
+
+	arrow::Result<int64_t> result;
+	if (txn_id.has_value()) {
+		arrow::flight::sql::Transaction txn(*txn_id);
+		result = channel->ExecuteIngest(GetCallOptions(stop_token), reader, table_definition, table, schema_name,
+		                                catalog_name, temporary, txn);
+	} else {
+		result = channel->ExecuteIngest(GetCallOptions(stop_token), reader, table_definition, table, schema_name,
+		                                catalog_name, temporary);
+	}
+	if (!result.ok()) {
+		if (result.status().IsNotImplemented()) {
+			POSTHOG_LOG_INFO("Flight server does not support bulk ingest, falling back to SQL inserts: %s",
+			                 result.status().ToString().c_str());
+			ingest_supported_.store(false);
+			scope.Stats().status = "unsupported";
+			return std::nullopt;
+		}
+		InvalidateSessionTokenIfRetryableLocked("execute ingest", result.status());
+		ThrowExecuteUpdateError(result.status());
+	}
+	scope.Stats().rows = *result;
+	return *result;
+#else
+	(void)reader;
+	(void)catalog;
+	(void)schema;
+	(void)table;
+	(void)temporary;
+	(void)txn_id;
+	(void)stop_token;
+	// CommandStatementIngest was added in Arrow 16.
+	ingest_supported_.store(false);
+	return std::nullopt;
+#endif
+}
+
 std::unique_ptr<PostHogFlightQueryStream>
-PostHogFlightClient::ExecuteQueryStream(const std::string &sql, const std::optional<TransactionId> &txn_id) {
-	std::lock_guard<std::mutex> lock(client_mutex_);
+PostHogFlightClient::ExecuteQueryStream(const std::string &sql, const std::optional<TransactionId> &txn_id,
+                                        const arrow::StopToken &stop_token, PostHogMemoryPool *memory_pool) {
+	// Only a failed Execute is recorded here; the stream records itself when it is closed.
+	PostHogTraceScope trace("ExecuteQueryStream", sql);
+	auto started = SteadyClock::now();
+	PostHogQueryStats stats;
+	stats.rpc = "ExecuteQueryStream";
+	stats.sql = sql;
+	stats.started_at = std::chrono::system_clock::now();
+	auto invalidations_at_start = session_invalidations_.load();
+	auto record_failure = [&]() {
+		stats.status = "error";
+		stats.total_us = ElapsedMicros(started);
+		stats.session_invalidations = session_invalidations_.load() - invalidations_at_start;
+		query_stats_.Add(std::move(stats));
+	};
+
+	auto channel = AcquireChannel();
 
 	if (!authenticated_) {
 		throw std::runtime_error("PostHog: Not authenticated. Call Authenticate() first.");
@@ -456,22 +873,32 @@ PostHogFlightClient::ExecuteQueryStream(const std::string &sql, const std::optio
 	arrow::Result<std::unique_ptr<arrow::flight::FlightInfo>> info_result;
 	if (txn_id.has_value()) {
 		arrow::flight::sql::Transaction txn(*txn_id);
-		info_result = sql_client_->Execute(GetCallOptions(), sql, txn);
+		info_result = channel->Execute(GetCallOptions(stop_token), sql, txn);
 	} else {
-		info_result = sql_client_->Execute(GetCallOptions(), sql);
+		info_result = channel->Execute(GetCallOptions(stop_token), sql);
 	}
 	if (!info_result.ok()) {
 		InvalidateSessionTokenIfRetryableLocked("execute query stream", info_result.status());
+		record_failure();
 		throw std::runtime_error("PostHog: Query execution failed: " + info_result.status().ToString());
 	}
 
-	return std::make_unique<PostHogFlightQueryStream>(*sql_client_, client_mutex_, GetCallOptions(),
-	                                                  std::move(*info_result), &session_token_, &session_token_mutex_);
+	// Endpoint reads reuse these options, so every DoGet carries the stream's traceparent.
+	auto options = GetCallOptions(stop_token);
+	if (memory_pool) {
+		options.read_options.memory_pool = memory_pool;
+	}
+	PostHogTraceSpan trace_span;
+	auto traced = trace.Detach(trace_span);
+	return std::make_unique<PostHogFlightQueryStream>(*this, std::move(options), std::move(*info_result),
+	                                                  std::move(stats), started, traced ? &trace_span : nullptr,
+	                                                  memory_pool);
 }
 
 std::shared_ptr<arrow::Schema> PostHogFlightClient::GetQuerySchema(const std::string &sql,
                                                                    const std::optional<TransactionId> &txn_id) {
-	std::lock_guard<std::mutex> lock(client_mutex_);
+	RpcStatsScope scope(*this, "GetQuerySchema", sql);
+	auto channel = AcquireChannel();
 
 	if (!authenticated_) {
 		throw std::runtime_error("PostHog: Not authenticated. Call Authenticate() first.");
@@ -482,9 +909,9 @@ std::shared_ptr<arrow::Schema> PostHogFlightClient::GetQuerySchema(const std::st
 		arrow::Result<std::shared_ptr<arrow::flight::sql::PreparedStatement>> prepared_result;
 		if (txn_id.has_value()) {
 			arrow::flight::sql::Transaction txn(*txn_id);
-			prepared_result = sql_client_->Prepare(GetCallOptions(), sql, txn);
+			prepared_result = channel->Prepare(GetCallOptions(), sql, txn);
 		} else {
-			prepared_result = sql_client_->Prepare(GetCallOptions(), sql);
+			prepared_result = channel->Prepare(GetCallOptions(), sql);
 		}
 		if (!prepared_result.ok()) {
 			return prepared_result.status();
@@ -492,38 +919,236 @@ std::shared_ptr<arrow::Schema> PostHogFlightClient::GetQuerySchema(const std::st
 
 		auto prepared_statement = std::move(*prepared_result);
 		auto schema = prepared_statement->dataset_schema();
+		ClosePreparedStatement(*prepared_statement, GetCallOptions());
+		return schema;
+	};
 
-		// Important: explicitly Close() with call options. Arrow's PreparedStatement destructor
-		// calls Close() with default FlightCallOptions (no headers), which breaks when the server
-		// requires Authorization for ClosePreparedStatement.
-		auto close_status = prepared_statement->Close(GetCallOptions());
-		if (!close_status.ok()) {
-			POSTHOG_LOG_WARN("Failed to close prepared statement after schema inference: %s",
-			                 close_status.ToString().c_str());
+	auto schema_result = run_once();
+	if (!schema_result.ok() && ShouldRetryMetadataWithFreshSession(schema_result.status())) {
+		InvalidateSessionTokenLocked("query schema retry", &schema_result.status());
+		scope.Stats().retries++;
+		schema_result = run_once();
+	}
+	if (!schema_result.ok()) {
+		throw std::runtime_error("PostHog: Failed to prepare query: " + schema_result.status().ToString());
+	}
+	return *schema_result;
+}
+
+std::string PostHogFlightClient::MakeStatementKey(const std::string &sql,
+                                                  const std::optional<TransactionId> &txn_id) const {
+	// Length-prefixed, since session tokens and transaction ids are opaque bytes.
+	auto session_token = GetSessionTokenSnapshot();
+	std::string key = std::to_string(session_token.size()) + ":" + session_token;
+	if (txn_id.has_value()) {
+		key += std::to_string(txn_id->size()) + ":" + *txn_id;
+	} else {
+		key += "-";
+	}
+	return key + sql;
+}
+
+arrow::Result<PostHogFlightClient::CachedPreparedStatement>
+PostHogFlightClient::GetPreparedStatement(const std::string &sql, const std::optional<TransactionId> &txn_id) {
+	auto key = MakeStatementKey(sql, txn_id);
+	{
+		std::lock_guard<std::mutex> lock(statement_cache_mutex_);
+		auto entry = prepared_statements_.find(key);
+		if (entry != prepared_statements_.end()) {
+			return entry->second;
+		}
+	}
+
+	CachedPreparedStatement prepared;
+	{
+		auto channel = AcquireChannel();
+		arrow::Result<std::shared_ptr<arrow::flight::sql::PreparedStatement>> prepared_result;
+		if (txn_id.has_value()) {
+			arrow::flight::sql::Transaction txn(*txn_id);
+			prepared_result = channel->Prepare(GetCallOptions(), sql, txn);
+		} else {
+			prepared_result = channel->Prepare(GetCallOptions(), sql);
+		}
+		if (!prepared_result.ok()) {
+			return prepared_result.status();
+		}
+		prepared.txn_id = txn_id;
+		prepared.channel = &channel.Channel();
+		prepared.statement = std::move(*prepared_result);
+		prepared.cached = false;
+	}
+
+	// Auto-commit handles have no end to close them at, so they are not kept.
+	if (!txn_id.has_value()) {
+		return prepared;
+	}
+	std::lock_guard<std::mutex> lock(statement_cache_mutex_);
+	if (prepared_statements_.size() < MAX_CACHED_PREPARED_STATEMENTS) {
+		prepared.cached = prepared_statements_.emplace(key, prepared).second;
+	}
+	return prepared;
+}
+
+void PostHogFlightClient::CloseTransactionStatements(const TransactionId &txn_id) {
+	std::vector<CachedPreparedStatement> to_close;
+	{
+		std::lock_guard<std::mutex> lock(statement_cache_mutex_);
+		for (auto entry = prepared_statements_.begin(); entry != prepared_statements_.end();) {
+			if (entry->second.txn_id == txn_id) {
+				to_close.push_back(std::move(entry->second));
+				entry = prepared_statements_.erase(entry);
+			} else {
+				++entry;
+			}
+		}
+		for (auto entry = query_schemas_.begin(); entry != query_schemas_.end();) {
+			if (entry->second.txn_id == txn_id) {
+				entry = query_schemas_.erase(entry);
+			} else {
+				++entry;
+			}
+		}
+	}
+	for (auto &prepared : to_close) {
+		std::lock_guard<std::mutex> channel_lock(prepared.channel->mutex);
+		ClosePreparedStatement(*prepared.statement, GetCallOptions());
+	}
+}
+
+void PostHogFlightClient::CloseAllPreparedStatements() {
+	std::unordered_map<std::string, CachedPreparedStatement> to_close;
+	{
+		std::lock_guard<std::mutex> lock(statement_cache_mutex_);
+		to_close.swap(prepared_statements_);
+	}
+	for (auto &entry : to_close) {
+		std::lock_guard<std::mutex> channel_lock(entry.second.channel->mutex);
+		ClosePreparedStatement(*entry.second.statement, GetCallOptions());
+	}
+}
+
+void PostHogFlightClient::SetQuerySchemaCacheTtl(std::chrono::seconds ttl) {
+	std::lock_guard<std::mutex> lock(statement_cache_mutex_);
+	query_schema_ttl_ = ttl;
+	if (ttl.count() == 0) {
+		query_schemas_.clear();
+	}
+}
+
+void PostHogFlightClient::InvalidateQuerySchemas() {
+	std::lock_guard<std::mutex> lock(statement_cache_mutex_);
+	query_schemas_.clear();
+}
+
+std::shared_ptr<arrow::Schema> PostHogFlightClient::GetCachedQuerySchema(const std::string &sql,
+                                                                         const std::optional<TransactionId> &txn_id) {
+	if (!authenticated_) {
+		throw std::runtime_error("PostHog: Not authenticated. Call Authenticate() first.");
+	}
+
+	// A transaction sees its own uncommitted DDL, so its schemas are not shared with other transactions.
+	auto schema_key = MakeStatementKey(sql, txn_id);
+	{
+		std::lock_guard<std::mutex> lock(statement_cache_mutex_);
+		auto entry = query_schemas_.find(schema_key);
+		if (entry != query_schemas_.end()) {
+			if (SteadyClock::now() - entry->second.cached_at < query_schema_ttl_) {
+				return entry->second.schema;
+			}
+			query_schemas_.erase(entry);
+		}
+	}
+
+	// Cache hits make no call, so only misses are recorded.
+	RpcStatsScope scope(*this, "GetQuerySchema", sql);
+	auto run_once = [&]() -> arrow::Result<std::shared_ptr<arrow::Schema>> {
+		ARROW_ASSIGN_OR_RAISE(auto prepared, GetPreparedStatement(sql, txn_id));
+		auto schema = prepared.statement->dataset_schema();
+		if (!prepared.cached) {
+			std::lock_guard<std::mutex> channel_lock(prepared.channel->mutex);
+			ClosePreparedStatement(*prepared.statement, GetCallOptions());
 		}
 		return schema;
 	};
 
 	auto schema_result = run_once();
 	if (!schema_result.ok() && ShouldRetryMetadataWithFreshSession(schema_result.status())) {
-		InvalidateSessionTokenLocked("query schema retry", &schema_result.status());
+		InvalidateSessionTokenLocked("cached query schema retry", &schema_result.status());
+		scope.Stats().retries++;
+		schema_key = MakeStatementKey(sql, txn_id);
 		schema_result = run_once();
 	}
 	if (!schema_result.ok()) {
 		throw std::runtime_error("PostHog: Failed to prepare query: " + schema_result.status().ToString());
 	}
+
+	std::lock_guard<std::mutex> lock(statement_cache_mutex_);
+	if (query_schema_ttl_.count() > 0 && query_schemas_.size() < MAX_CACHED_QUERY_SCHEMAS) {
+		query_schemas_[schema_key] = CachedQuerySchema {txn_id, *schema_result, SteadyClock::now()};
+	}
 	return *schema_result;
 }
 
+std::optional<int64_t> PostHogFlightClient::ExecutePreparedUpdate(const std::string &sql,
+                                                                  const std::shared_ptr<arrow::RecordBatch> &parameters,
+                                                                  const std::optional<TransactionId> &txn_id,
+                                                                  const arrow::StopToken &stop_token) {
+	if (!prepared_parameters_supported_.load()) {
+		return std::nullopt;
+	}
+	if (!authenticated_) {
+		throw std::runtime_error("PostHog: Not authenticated. Call Authenticate() first.");
+	}
+
+	RpcStatsScope scope(*this, "ExecutePreparedUpdate", sql);
+	scope.Stats().bytes = arrow::util::TotalBufferSize(*parameters);
+	auto prepared_result = GetPreparedStatement(sql, txn_id);
+	if (!prepared_result.ok()) {
+		InvalidateSessionTokenIfRetryableLocked("prepare update", prepared_result.status());
+		ThrowExecuteUpdateError(prepared_result.status());
+	}
+	auto &prepared = *prepared_result;
+
+	arrow::Result<int64_t> result;
+	{
+		// The handle carries the bound parameters, so executions of one handle are serialized on
+		// the channel it belongs to.
+		std::lock_guard<std::mutex> channel_lock(prepared.channel->mutex);
+		auto bind_status = prepared.statement->SetParameters(parameters);
+		if (bind_status.ok()) {
+			result = prepared.statement->ExecuteUpdate(GetCallOptions(stop_token));
+		} else {
+			result = bind_status;
+		}
+		if (!prepared.cached) {
+			ClosePreparedStatement(*prepared.statement, GetCallOptions());
+		}
+	}
+	if (!result.ok()) {
+		if (result.status().IsNotImplemented()) {
+			POSTHOG_LOG_INFO("Flight server does not support parameterized updates, falling back to SQL text: %s",
+			                 result.status().ToString().c_str());
+			prepared_parameters_supported_.store(false);
+			scope.Stats().status = "unsupported";
+			return std::nullopt;
+		}
+		InvalidateSessionTokenIfRetryableLocked("execute prepared update", result.status());
+		ThrowExecuteUpdateError(result.status());
+	}
+	scope.Stats().rows = *result;
+	return *result;
+}
+
 TransactionId PostHogFlightClient::BeginTransaction() {
-	std::lock_guard<std::mutex> lock(client_mutex_);
+	RpcStatsScope scope(*this, "BeginTransaction", "");
+	auto channel = AcquireChannel();
 
 	if (!authenticated_) {
 		throw std::runtime_error("PostHog: Not authenticated. Call Authenticate() first.");
 	}
 
 	auto call_options = GetCallOptions();
-	auto result = sql_client_->BeginTransaction(call_options);
+	auto result = channel->BeginTransaction(call_options);
 	if (!result.ok()) {
 		InvalidateSessionTokenIfRetryableLocked("begin transaction", result.status());
 		throw std::runtime_error("PostHog: BeginTransaction failed: " + result.status().ToString());
@@ -532,7 +1157,12 @@ TransactionId PostHogFlightClient::BeginTransaction() {
 }
 
 void PostHogFlightClient::CommitTransaction(const TransactionId &txn_id) {
-	std::lock_guard<std::mutex> lock(client_mutex_);
+	// Handles prepared in the transaction end with it; close them before the lease below, which
+	// may be the channel they were prepared on.
+	CloseTransactionStatements(txn_id);
+
+	RpcStatsScope scope(*this, "CommitTransaction", "");
+	auto channel = AcquireChannel();
 
 	if (!authenticated_) {
 		throw std::runtime_error("PostHog: Not authenticated. Call Authenticate() first.");
@@ -540,7 +1170,7 @@ void PostHogFlightClient::CommitTransaction(const TransactionId &txn_id) {
 
 	auto call_options = GetCallOptions();
 	arrow::flight::sql::Transaction txn(txn_id);
-	auto status = sql_client_->Commit(call_options, txn);
+	auto status = channel->Commit(call_options, txn);
 	if (!status.ok()) {
 		InvalidateSessionTokenIfRetryableLocked("commit transaction", status);
 		throw std::runtime_error("PostHog: CommitTransaction failed: " + status.ToString());
@@ -548,7 +1178,11 @@ void PostHogFlightClient::CommitTransaction(const TransactionId &txn_id) {
 }
 
 void PostHogFlightClient::RollbackTransaction(const TransactionId &txn_id) {
-	std::lock_guard<std::mutex> lock(client_mutex_);
+	// See CommitTransaction.
+	CloseTransactionStatements(txn_id);
+
+	RpcStatsScope scope(*this, "RollbackTransaction", "");
+	auto channel = AcquireChannel();
 
 	if (!authenticated_) {
 		throw std::runtime_error("PostHog: Not authenticated. Call Authenticate() first.");
@@ -556,25 +1190,131 @@ void PostHogFlightClient::RollbackTransaction(const TransactionId &txn_id) {
 
 	auto call_options = GetCallOptions();
 	arrow::flight::sql::Transaction txn(txn_id);
-	auto status = sql_client_->Rollback(call_options, txn);
+	auto status = channel->Rollback(call_options, txn);
 	if (!status.ok()) {
 		InvalidateSessionTokenIfRetryableLocked("rollback transaction", status);
 		throw std::runtime_error("PostHog: RollbackTransaction failed: " + status.ToString());
 	}
 }
 
+template <class T>
+arrow::Result<T> PostHogFlightClient::RunMetadataCall(PostHogLatencyWindow &latency, RpcStatsScope &scope,
+                                                    const MetadataAttempt<T> &attempt) {
+	auto options = GetCallOptions();
+	if (metadata_timeout_.count() > 0) {
+		options.timeout = std::chrono::duration_cast<arrow::flight::TimeoutDuration>(metadata_timeout_);
+	}
+	std::atomic<int64_t> hedges_sent {0};
+	auto run = [&](const arrow::flight::FlightCallOptions &call_options, bool hedge) -> arrow::Result<T> {
+		std::optional<ChannelLease> channel;
+		if (hedge) {
+			// Waiting for a busy channel would only make the hedge later than the attempt it backs up.
+			channel = TryAcquireChannel();
+			if (!channel) {
+				return arrow::Status::Cancelled("no idle channel for a hedged attempt");
+			}
+			hedges_sent++;
+		} else {
+			channel.emplace(AcquireChannel());
+		}
+		auto started_at = SteadyClock::now();
+		auto result = attempt(*channel->Channel().sql_client, call_options);
+		if (result.ok()) {
+			latency.Record(ElapsedMicros(started_at));
+		}
+		return result;
+	};
+
+	std::optional<int64_t> hedge_after_us;
+	if (metadata_hedging_ && channels_.size() > 1) {
+		hedge_after_us = latency.Percentile(kMetadataHedgeQuantile);
+	}
+
+	// One attempt on the calling thread, backed up by a hedged copy on an idle channel when it outlives
+	// hedge_after_us: the timer starts the hedge's thread only then. The first attempt to succeed stops
+	// the other one. The attempts only read state of this call, so the hedge is joined before it returns.
+	auto run_hedged = [&]() -> arrow::Result<T> {
+		std::mutex lock;
+		std::condition_variable finished;
+		MetadataAttemptState<T> attempts[2];
+		std::thread hedge_thread;
+		auto run_attempt = [&](size_t index) {
+			auto call_options = options;
+			call_options.stop_token = attempts[index].stop_source.token();
+			std::optional<arrow::Result<T>> result;
+			std::exception_ptr error;
+			try {
+				result = run(call_options, index > 0);
+			} catch (...) {
+				error = std::current_exception();
+			}
+			std::lock_guard<std::mutex> guard(lock);
+			attempts[index].result = std::move(result);
+			attempts[index].error = error;
+			attempts[index].finished = true;
+			auto &other = attempts[1 - index];
+			if (attempts[index].Succeeded() && !other.finished) {
+				other.stop_source.RequestStop();
+			}
+			finished.notify_all();
+		};
+
+		auto hedge_at = SteadyClock::now() + std::chrono::microseconds(*hedge_after_us);
+		auto hedge_task = hedge_timer_.Schedule(hedge_at, [&]() {
+			std::lock_guard<std::mutex> guard(lock);
+			if (attempts[0].finished) {
+				return;
+			}
+			POSTHOG_LOG_DEBUG("Flight %s still running after %lld us; sending a hedged attempt",
+			                  scope.Stats().rpc.c_str(), static_cast<long long>(*hedge_after_us));
+			hedge_thread = std::thread([&]() { run_attempt(1); });
+		});
+		run_attempt(0);
+		// Once this returns the timer no longer runs the task, so hedge_thread is settled.
+		hedge_timer_.Cancel(hedge_task);
+
+		// Without a success the first attempt's outcome stands, not that of a hedge that found no channel.
+		size_t winner = 0;
+		if (hedge_thread.joinable()) {
+			std::unique_lock<std::mutex> guard(lock);
+			// A failed first attempt waits for the hedge; a successful one already stopped it.
+			finished.wait(guard, [&]() { return attempts[0].Succeeded() || attempts[1].finished; });
+			if (!attempts[0].Succeeded() && attempts[1].Succeeded()) {
+				winner = 1;
+			}
+			guard.unlock();
+			hedge_thread.join();
+		}
+		if (attempts[winner].error) {
+			std::rethrow_exception(attempts[winner].error);
+		}
+		return std::move(*attempts[winner].result);
+	};
+
+	auto run_call = [&]() { return hedge_after_us ? run_hedged() : run(options, false); };
+	auto result = run_call();
+	if (!result.ok() && IsDeadlineExceeded(result.status())) {
+		POSTHOG_LOG_DEBUG("Flight %s ran into its deadline; retrying once", scope.Stats().rpc.c_str());
+		scope.Stats().retries++;
+		result = run_call();
+	}
+	scope.Stats().hedges += hedges_sent.load();
+	return result;
+}
+
 std::vector<PostHogDbSchemaInfo> PostHogFlightClient::ListDbSchemas(const std::string &catalog) {
-	std::lock_guard<std::mutex> lock(client_mutex_);
+	RpcStatsScope scope(*this, "ListDbSchemas", catalog);
 
 	if (!authenticated_) {
 		throw std::runtime_error("PostHog: Not authenticated. Call Authenticate() first.");
 	}
 
-	auto run_once = [&](const std::string &metadata_catalog) -> arrow::Result<std::vector<PostHogDbSchemaInfo>> {
+	auto run_attempt = [&](arrow::flight::sql::FlightSqlClient &client, const arrow::flight::FlightCallOptions &options,
+	                       const std::string &metadata_catalog) -> arrow::Result<std::vector<PostHogDbSchemaInfo>> {
 		// GetDbSchemas returns information about schemas/catalogs.
 		// Parameters: options, catalog (nullptr = all), db_schema_filter_pattern (nullptr = all)
-		auto info_result = sql_client_->GetDbSchemas(GetCallOptions(),
-		                                             metadata_catalog.empty() ? nullptr : &metadata_catalog, nullptr);
+		auto info_result =
+		    client.GetDbSchemas(options, metadata_catalog.empty() ? nullptr : &metadata_catalog, nullptr);
 		if (!info_result.ok()) {
 			return info_result.status();
 		}
@@ -586,7 +1326,7 @@ std::vector<PostHogDbSchemaInfo> PostHogFlightClient::ListDbSchemas(const std::s
 		}
 
 		// Fetch the schema list.
-		auto stream_result = sql_client_->DoGet(GetCallOptions(), flight_info->endpoints()[0].ticket);
+		auto stream_result = client.DoGet(options, flight_info->endpoints()[0].ticket);
 		if (!stream_result.ok()) {
 			return stream_result.status();
 		}
@@ -649,10 +1389,18 @@ std::vector<PostHogDbSchemaInfo> PostHogFlightClient::ListDbSchemas(const std::s
 
 		return schemas;
 	};
+	auto run_once = [&](const std::string &metadata_catalog) {
+		return RunMetadataCall<std::vector<PostHogDbSchemaInfo>>(
+		    list_db_schemas_latency_, scope,
+		    [&](arrow::flight::sql::FlightSqlClient &client, const arrow::flight::FlightCallOptions &options) {
+			    return run_attempt(client, options, metadata_catalog);
+		    });
+	};
 
 	auto result = run_once(catalog);
 	if (!result.ok() && ShouldRetryMetadataWithFreshSession(result.status())) {
 		InvalidateSessionTokenLocked("list db schemas retry", &result.status());
+		scope.Stats().retries++;
 		result = run_once(catalog);
 	}
 	if (!result.ok()) {
@@ -665,6 +1413,7 @@ std::vector<PostHogDbSchemaInfo> PostHogFlightClient::ListDbSchemas(const std::s
 		auto unfiltered_result = run_once("");
 		if (!unfiltered_result.ok() && ShouldRetryMetadataWithFreshSession(unfiltered_result.status())) {
 			InvalidateSessionTokenLocked("list db schemas unfiltered retry", &unfiltered_result.status());
+			scope.Stats().retries++;
 			unfiltered_result = run_once("");
 		}
 		if (!unfiltered_result.ok()) {
@@ -681,11 +1430,12 @@ std::vector<PostHogDbSchemaInfo> PostHogFlightClient::ListDbSchemas(const std::s
 		}
 		result = arrow::Result<std::vector<PostHogDbSchemaInfo>>(std::move(matching_schemas));
 	}
+	scope.Stats().rows = static_cast<int64_t>(result->size());
 	return *result;
 }
 
 std::vector<std::string> PostHogFlightClient::ListTables(const std::string &catalog, const std::string &schema) {
-	std::lock_guard<std::mutex> lock(client_mutex_);
+	RpcStatsScope scope(*this, "ListTables", catalog + "." + schema);
 	auto op_started_at = SteadyClock::now();
 	POSTHOG_LOG_DEBUG("Flight ListTables start catalog='%s' schema='%s'", catalog.c_str(), schema.c_str());
 
@@ -693,12 +1443,13 @@ std::vector<std::string> PostHogFlightClient::ListTables(const std::string &cata
 		throw std::runtime_error("PostHog: Not authenticated. Call Authenticate() first.");
 	}
 
-	auto run_once = [&](const std::string &metadata_catalog) -> arrow::Result<std::vector<std::string>> {
+	auto run_attempt = [&](arrow::flight::sql::FlightSqlClient &client, const arrow::flight::FlightCallOptions &options,
+	                       const std::string &metadata_catalog) -> arrow::Result<std::vector<std::string>> {
 		// GetTables returns information about tables.
 		// Parameters: catalog, schema_filter_pattern, table_name_filter_pattern, include_schema, table_types
 		auto get_tables_started_at = SteadyClock::now();
-		auto info_result = sql_client_->GetTables(
-		    GetCallOptions(), metadata_catalog.empty() ? nullptr : &metadata_catalog, &schema, nullptr, false, nullptr);
+		auto info_result = client.GetTables(
+		    options, metadata_catalog.empty() ? nullptr : &metadata_catalog, &schema, nullptr, false, nullptr);
 		if (!info_result.ok()) {
 			return info_result.status();
 		}
@@ -716,7 +1467,7 @@ std::vector<std::string> PostHogFlightClient::ListTables(const std::string &cata
 
 		// Fetch the table list.
 		auto do_get_started_at = SteadyClock::now();
-		auto stream_result = sql_client_->DoGet(GetCallOptions(), flight_info->endpoints()[0].ticket);
+		auto stream_result = client.DoGet(options, flight_info->endpoints()[0].ticket);
 		if (!stream_result.ok()) {
 			return stream_result.status();
 		}
@@ -801,10 +1552,18 @@ std::vector<std::string> PostHogFlightClient::ListTables(const std::string &cata
 
 		return tables;
 	};
+	auto run_once = [&](const std::string &metadata_catalog) {
+		return RunMetadataCall<std::vector<std::string>>(
+		    list_tables_latency_, scope,
+		    [&](arrow::flight::sql::FlightSqlClient &client, const arrow::flight::FlightCallOptions &options) {
+			    return run_attempt(client, options, metadata_catalog);
+		    });
+	};
 
 	auto result = run_once(catalog);
 	if (!result.ok() && ShouldRetryMetadataWithFreshSession(result.status())) {
 		InvalidateSessionTokenLocked("list tables retry", &result.status());
+		scope.Stats().retries++;
 		result = run_once(catalog);
 	}
 	if (!result.ok()) {
@@ -813,12 +1572,109 @@ std::vector<std::string> PostHogFlightClient::ListTables(const std::string &cata
 
 	POSTHOG_LOG_DEBUG("Flight ListTables done tables=%zu total_ms=%lld", result->size(),
 	                  static_cast<long long>(ElapsedMillis(op_started_at)));
+	scope.Stats().rows = static_cast<int64_t>(result->size());
+	return *result;
+}
+
+std::vector<PostHogTableInfo> PostHogFlightClient::ListTablesWithSchemas(const std::string &catalog,
+                                                                         const std::string &schema) {
+	RpcStatsScope scope(*this, "ListTablesWithSchemas", catalog + "." + schema);
+	auto op_started_at = SteadyClock::now();
+	POSTHOG_LOG_DEBUG("Flight ListTablesWithSchemas start catalog='%s' schema='%s'", catalog.c_str(), schema.c_str());
+
+	if (!authenticated_) {
+		throw std::runtime_error("PostHog: Not authenticated. Call Authenticate() first.");
+	}
+
+	auto run_attempt = [&](arrow::flight::sql::FlightSqlClient &client, const arrow::flight::FlightCallOptions &options,
+	                       const std::string &metadata_catalog) -> arrow::Result<std::vector<PostHogTableInfo>> {
+		// One GetTables call with include_schema=true returns every table of the schema together
+		// with its serialized Arrow schema.
+		auto info_result = client.GetTables(
+		    options, metadata_catalog.empty() ? nullptr : &metadata_catalog, &schema, nullptr, true, nullptr);
+		if (!info_result.ok()) {
+			return info_result.status();
+		}
+
+		std::vector<PostHogTableInfo> tables;
+		auto flight_info = std::move(*info_result);
+		for (const auto &endpoint : flight_info->endpoints()) {
+			auto stream_result = client.DoGet(options, endpoint.ticket);
+			if (!stream_result.ok()) {
+				return stream_result.status();
+			}
+			auto stream = std::move(*stream_result);
+			while (true) {
+				auto chunk_result = stream->Next();
+				if (!chunk_result.ok()) {
+					return chunk_result.status();
+				}
+				const auto &chunk = *chunk_result;
+				if (!chunk.data) {
+					break;
+				}
+
+				auto catalog_col = chunk.data->GetColumnByName("catalog_name");
+				auto table_col = chunk.data->GetColumnByName("table_name");
+				auto schema_col = chunk.data->GetColumnByName("table_schema");
+				if (!table_col) {
+					continue;
+				}
+				for (int64_t i = 0; i < chunk.data->num_rows(); i++) {
+					if (!metadata_catalog.empty() && catalog_col) {
+						auto row_catalog = MetadataStringAt(catalog_col, i, "catalog_name");
+						if (!row_catalog || *row_catalog != metadata_catalog) {
+							continue;
+						}
+					}
+					auto table_name = MetadataStringAt(table_col, i, "table_name");
+					if (!table_name) {
+						continue;
+					}
+					PostHogTableInfo table_info;
+					table_info.table_name = std::string(*table_name);
+					// A missing schema is left null for the caller to resolve per table.
+					auto schema_bytes = schema_col ? MetadataBinaryAt(schema_col, i) : std::nullopt;
+					if (schema_bytes) {
+						auto schema_read_result = DeserializeSchema(*schema_bytes);
+						if (!schema_read_result.ok()) {
+							return schema_read_result.status();
+						}
+						table_info.schema = *schema_read_result;
+					}
+					tables.push_back(std::move(table_info));
+				}
+			}
+		}
+		return tables;
+	};
+	auto run_once = [&](const std::string &metadata_catalog) {
+		return RunMetadataCall<std::vector<PostHogTableInfo>>(
+		    list_tables_with_schemas_latency_, scope,
+		    [&](arrow::flight::sql::FlightSqlClient &client, const arrow::flight::FlightCallOptions &options) {
+			    return run_attempt(client, options, metadata_catalog);
+		    });
+	};
+
+	auto result = run_once(catalog);
+	if (!result.ok() && ShouldRetryMetadataWithFreshSession(result.status())) {
+		InvalidateSessionTokenLocked("list tables with schemas retry", &result.status());
+		scope.Stats().retries++;
+		result = run_once(catalog);
+	}
+	if (!result.ok()) {
+		throw std::runtime_error("PostHog: Failed to list tables: " + result.status().ToString());
+	}
+
+	POSTHOG_LOG_DEBUG("Flight ListTablesWithSchemas done tables=%zu total_ms=%lld", result->size(),
+	                  static_cast<long long>(ElapsedMillis(op_started_at)));
+	scope.Stats().rows = static_cast<int64_t>(result->size());
 	return *result;
 }
 
 std::shared_ptr<arrow::Schema>
 PostHogFlightClient::GetTableSchema(const std::string &catalog, const std::string &schema, const std::string &table) {
-	std::lock_guard<std::mutex> lock(client_mutex_);
+	RpcStatsScope scope(*this, "GetTableSchema", catalog + "." + schema + "." + table);
 	auto op_started_at = SteadyClock::now();
 	POSTHOG_LOG_DEBUG("Flight GetTableSchema start catalog='%s' schema='%s' table='%s'", catalog.c_str(),
 	                  schema.c_str(), table.c_str());
@@ -827,11 +1683,12 @@ PostHogFlightClient::GetTableSchema(const std::string &catalog, const std::strin
 		throw std::runtime_error("PostHog: Not authenticated. Call Authenticate() first.");
 	}
 
-	auto run_once = [&](const std::string &metadata_catalog) -> arrow::Result<std::shared_ptr<arrow::Schema>> {
+	auto run_attempt = [&](arrow::flight::sql::FlightSqlClient &client, const arrow::flight::FlightCallOptions &options,
+	                       const std::string &metadata_catalog) -> arrow::Result<std::shared_ptr<arrow::Schema>> {
 		// GetTables with include_schema=true returns serialized schema in the result.
 		auto get_tables_started_at = SteadyClock::now();
-		auto info_result = sql_client_->GetTables(
-		    GetCallOptions(), metadata_catalog.empty() ? nullptr : &metadata_catalog, &schema, &table, true, nullptr);
+		auto info_result = client.GetTables(
+		    options, metadata_catalog.empty() ? nullptr : &metadata_catalog, &schema, &table, true, nullptr);
 		if (!info_result.ok()) {
 			return info_result.status();
 		}
@@ -846,7 +1703,7 @@ PostHogFlightClient::GetTableSchema(const std::string &catalog, const std::strin
 
 		// Fetch the table metadata.
 		auto do_get_started_at = SteadyClock::now();
-		auto stream_result = sql_client_->DoGet(GetCallOptions(), flight_info->endpoints()[0].ticket);
+		auto stream_result = client.DoGet(options, flight_info->endpoints()[0].ticket);
 		if (!stream_result.ok()) {
 			return stream_result.status();
 		}
@@ -979,22 +1836,25 @@ PostHogFlightClient::GetTableSchema(const std::string &catalog, const std::strin
 		}
 
 		// Deserialize the Arrow schema from IPC format.
-		arrow::ipc::DictionaryMemo dict_memo;
-		auto buffer = std::make_shared<arrow::Buffer>(reinterpret_cast<const uint8_t *>(schema_bytes.data()),
-		                                              static_cast<int64_t>(schema_bytes.size()));
-		arrow::io::BufferReader reader(buffer);
-
-		auto schema_read_result = arrow::ipc::ReadSchema(&reader, &dict_memo);
+		auto schema_read_result = DeserializeSchema(schema_bytes);
 		if (!schema_read_result.ok()) {
 			return schema_read_result.status();
 		}
 
 		return *schema_read_result;
 	};
+	auto run_once = [&](const std::string &metadata_catalog) {
+		return RunMetadataCall<std::shared_ptr<arrow::Schema>>(
+		    table_schema_latency_, scope,
+		    [&](arrow::flight::sql::FlightSqlClient &client, const arrow::flight::FlightCallOptions &options) {
+			    return run_attempt(client, options, metadata_catalog);
+		    });
+	};
 
 	auto result = run_once(catalog);
 	if (!result.ok() && ShouldRetryMetadataWithFreshSession(result.status())) {
 		InvalidateSessionTokenLocked("get table schema retry", &result.status());
+		scope.Stats().retries++;
 		result = run_once(catalog);
 	}
 	if (!result.ok()) {
@@ -1006,39 +1866,202 @@ PostHogFlightClient::GetTableSchema(const std::string &catalog, const std::strin
 	return *result;
 }
 
-PostHogFlightQueryStream::PostHogFlightQueryStream(arrow::flight::sql::FlightSqlClient &client,
-                                                   std::mutex &client_mutex, arrow::flight::FlightCallOptions options,
+PostHogFlightEndpointCursor::PostHogFlightEndpointCursor(std::unique_ptr<arrow::flight::FlightInfo> info_p)
+    : info(std::move(info_p)) {
+}
+
+std::optional<size_t> PostHogFlightEndpointCursor::Claim() {
+	if (!info) {
+		return std::nullopt;
+	}
+	auto index = next_endpoint.fetch_add(1);
+	if (index >= info->endpoints().size()) {
+		return std::nullopt;
+	}
+	return index;
+}
+
+PostHogFlightQueryStream::PostHogFlightQueryStream(PostHogFlightClient &client,
+                                                   arrow::flight::FlightCallOptions options,
                                                    std::unique_ptr<arrow::flight::FlightInfo> info,
-                                                   std::string *session_token, std::mutex *session_token_mutex)
-    : client_(client), client_mutex_(client_mutex), options_(std::move(options)), info_(std::move(info)),
-      session_token_(session_token), session_token_mutex_(session_token_mutex) {
+                                                   PostHogQueryStats stats, SteadyClock::time_point started,
+                                                   const PostHogTraceSpan *trace_span, PostHogMemoryPool *memory_pool)
+    : client_(client), options_(std::move(options)),
+      cursor_(std::make_shared<PostHogFlightEndpointCursor>(std::move(info))) {
+	cursor_->open_streams.fetch_add(1);
+	if (trace_span) {
+		cursor_->trace_span = *trace_span;
+		cursor_->traced = true;
+	}
+	cursor_->stats = std::move(stats);
+	cursor_->stats.endpoints = static_cast<int64_t>(EndpointCount());
+	cursor_->started = started;
+	cursor_->invalidations_at_start = client_.session_invalidations_.load();
+	cursor_->memory_pool = memory_pool;
 }
 
-void PostHogFlightQueryStream::InvalidateSessionTokenIfRetryable(const arrow::Status &status) {
-	if (!session_token_ || !session_token_mutex_ || !IsSessionTokenRetryableStatus(status)) {
+PostHogFlightQueryStream::PostHogFlightQueryStream(PostHogFlightClient &client,
+                                                   arrow::flight::FlightCallOptions options,
+                                                   std::shared_ptr<PostHogFlightEndpointCursor> cursor,
+                                                   std::shared_ptr<arrow::Schema> schema)
+    : client_(client), options_(std::move(options)), cursor_(std::move(cursor)), schema_(std::move(schema)) {
+	cursor_->open_streams.fetch_add(1);
+}
+
+PostHogFlightQueryStream::~PostHogFlightQueryStream() {
+	if (reader_) {
+		reader_->Cancel();
+	}
+	if (cursor_->open_streams.fetch_sub(1) != 1) {
+		return;
+	}
+	const auto &info = cursor_->info;
+	bool unfinished = info && cursor_->finished_endpoints.load() < info->endpoints().size();
+	if (unfinished) {
+		client_.CancelFlightInfo(*info);
+	}
+	RecordStats(unfinished);
+}
+
+void PostHogFlightQueryStream::RecordStats(bool unfinished) {
+	if (cursor_->traced) {
+		PostHogTracer::Instance().Finish(cursor_->trace_span, cursor_->failed.load());
+	}
+	auto stats = std::move(cursor_->stats);
+	if (stats.rpc.empty()) {
 		return;
 	}
-	std::lock_guard<std::mutex> lock(*session_token_mutex_);
-	session_token_->clear();
+	stats.status = cursor_->failed.load() ? "error" : unfinished ? "cancelled" : "ok";
+	stats.first_batch_us = cursor_->first_batch_us.load();
+	stats.total_us = ElapsedMicros(cursor_->started);
+	stats.batches = cursor_->batches.load();
+	stats.rows = cursor_->records_read.load();
+	stats.bytes = cursor_->bytes_read.load();
+	stats.session_invalidations = client_.session_invalidations_.load() - cursor_->invalidations_at_start;
+	client_.query_stats_.Add(std::move(stats));
+}
+
+void PostHogFlightQueryStream::Cancel() {
+	cancelled_ = true;
+	std::lock_guard<std::mutex> guard(reader_mutex_);
+	if (reader_) {
+		reader_->Cancel();
+	}
+}
+
+size_t PostHogFlightQueryStream::EndpointCount() const {
+	return cursor_->info ? cursor_->info->endpoints().size() : 0;
+}
+
+bool PostHogFlightQueryStream::IsOrdered() const {
+	return cursor_->info && cursor_->info->ordered();
+}
+
+int64_t PostHogFlightQueryStream::TotalRecords() const {
+	return cursor_->info ? cursor_->info->total_records() : -1;
+}
+
+int64_t PostHogFlightQueryStream::TotalBytes() const {
+	return cursor_->info ? cursor_->info->total_bytes() : -1;
+}
+
+int64_t PostHogFlightQueryStream::RecordsRead() const {
+	return cursor_->records_read.load();
+}
+
+int64_t PostHogFlightQueryStream::BytesRead() const {
+	return cursor_->bytes_read.load();
+}
+
+int64_t PostHogFlightQueryStream::BatchesRead() const {
+	return cursor_->batches.load();
+}
+
+int64_t PostHogFlightQueryStream::FirstBatchMicros() const {
+	return cursor_->first_batch_us.load();
+}
+
+int64_t PostHogFlightQueryStream::RemoteMicros() const {
+	auto finished_us = cursor_->finished_us.load();
+	return finished_us >= 0 ? finished_us : ElapsedMicros(cursor_->started);
+}
+
+std::unique_ptr<PostHogFlightQueryStream> PostHogFlightQueryStream::Fork() const {
+	// Private constructor, so std::make_unique is not an option here.
+	return std::unique_ptr<PostHogFlightQueryStream>(
+	    new PostHogFlightQueryStream(client_, options_, cursor_, schema_));
+}
+
+std::unique_ptr<PostHogFlightQueryStream> PostHogFlightQueryStream::ForkEndpoint() const {
+	auto endpoint_index = cursor_->Claim();
+	if (!endpoint_index.has_value()) {
+		return nullptr;
+	}
+	auto fork = Fork();
+	fork->pinned_ = true;
+	fork->pinned_endpoint_ = endpoint_index;
+	return fork;
+}
+
+void PostHogFlightQueryStream::InvalidateSessionTokenIfRetryable(const arrow::Status &status) {
+	client_.InvalidateSessionTokenIfRetryableLocked("query stream", status);
 }
 
 arrow::Status PostHogFlightQueryStream::OpenReader() {
 	if (reader_) {
 		return arrow::Status::OK();
 	}
-	if (!info_ || info_->endpoints().empty()) {
+	if (cancelled_) {
+		return arrow::Status::Cancelled("Query stream was cancelled");
+	}
+	const auto &info = cursor_->info;
+	if (!info || info->endpoints().empty()) {
 		return arrow::Status::Invalid("FlightInfo did not return any endpoints");
 	}
-	if (endpoint_index_ >= info_->endpoints().size()) {
+	// A pinned stream opens its one endpoint, and ends once that is drained.
+	auto endpoint_index = pinned_ ? std::exchange(pinned_endpoint_, std::nullopt) : cursor_->Claim();
+	if (!endpoint_index.has_value()) {
 		return arrow::Status::OK();
 	}
-	std::lock_guard<std::mutex> lock(client_mutex_);
-	auto stream_result = client_.DoGet(options_, info_->endpoints()[endpoint_index_].ticket);
-	if (!stream_result.ok()) {
-		InvalidateSessionTokenIfRetryable(stream_result.status());
-		return stream_result.status();
+	const auto &endpoint = info->endpoints()[*endpoint_index];
+	// Read the endpoint straight from a data node that serves it, so scans are not all relayed through
+	// the coordinator. Any location that cannot be read falls through to the next, then the coordinator.
+	std::unique_ptr<arrow::flight::FlightStreamReader> reader;
+	for (const auto &location : endpoint.locations) {
+		auto location_client = client_.GetLocationClient(location);
+		if (!location_client) {
+			continue;
+		}
+		auto location_result = location_client->DoGet(options_, endpoint.ticket);
+		if (location_result.ok()) {
+			reader = std::move(*location_result);
+			break;
+		}
+		if (location_result.status().IsCancelled() || cancelled_) {
+			cursor_->failed = true;
+			return location_result.status();
+		}
+		POSTHOG_LOG_DEBUG("Flight DoGet from %s failed, trying the next location: %s", location.ToString().c_str(),
+		                  location_result.status().ToString().c_str());
+		client_.DropLocationClient(location);
+	}
+	if (!reader) {
+		// Only the DoGet open needs the channel; batches are read after the lease is released.
+		auto channel = client_.AcquireChannel();
+		auto stream_result = channel->DoGet(options_, endpoint.ticket);
+		if (!stream_result.ok()) {
+			cursor_->failed = true;
+			InvalidateSessionTokenIfRetryable(stream_result.status());
+			return stream_result.status();
+		}
+		reader = std::move(*stream_result);
+	}
+	std::lock_guard<std::mutex> guard(reader_mutex_);
+	reader_ = std::move(reader);
+	if (cancelled_) {
+		// Cancel() ran while the DoGet was being opened.
+		reader_->Cancel();
 	}
-	reader_ = std::move(*stream_result);
 	return arrow::Status::OK();
 }
 
@@ -1046,9 +2069,9 @@ arrow::Result<std::shared_ptr<arrow::Schema>> PostHogFlightQueryStream::GetSchem
 	if (schema_) {
 		return schema_;
 	}
-	if (info_) {
+	if (cursor_->info) {
 		arrow::ipc::DictionaryMemo memo;
-		auto schema_result = info_->GetSchema(&memo);
+		auto schema_result = cursor_->info->GetSchema(&memo);
 		if (schema_result.ok()) {
 			schema_ = *schema_result;
 			return schema_;
@@ -1068,6 +2091,7 @@ arrow::Result<std::shared_ptr<arrow::Schema>> PostHogFlightQueryStream::GetSchem
 
 arrow::Result<arrow::flight::FlightStreamChunk> PostHogFlightQueryStream::Next() {
 	while (true) {
+		// Each exhausted reader moves on to the next endpoint nobody else has claimed yet.
 		auto status = OpenReader();
 		if (!status.ok()) {
 			return status;
@@ -1077,18 +2101,33 @@ arrow::Result<arrow::flight::FlightStreamChunk> PostHogFlightQueryStream::Next()
 		}
 		auto chunk_result = reader_->Next();
 		if (!chunk_result.ok()) {
+			cursor_->failed = true;
 			InvalidateSessionTokenIfRetryable(chunk_result.status());
 			return chunk_result.status();
 		}
 		auto chunk = *chunk_result;
+		if (chunk.data && cursor_->memory_pool) {
+			// Waits while the batch does not fit in memory_limit; the server is not read meanwhile.
+			auto tracked = cursor_->memory_pool->Track(chunk.data);
+			if (!tracked.ok()) {
+				cursor_->failed = true;
+				return tracked.status();
+			}
+			chunk.data = *tracked;
+		}
 		if (chunk.data) {
+			int64_t unset = -1;
+			cursor_->first_batch_us.compare_exchange_strong(unset, ElapsedMicros(cursor_->started));
+			cursor_->batches.fetch_add(1);
+			cursor_->records_read.fetch_add(chunk.data->num_rows());
+			cursor_->bytes_read.fetch_add(arrow::util::TotalBufferSize(*chunk.data));
 			return chunk;
 		}
-		reader_.reset();
-		endpoint_index_++;
-		if (!info_ || endpoint_index_ >= info_->endpoints().size()) {
-			return chunk;
+		if (cursor_->finished_endpoints.fetch_add(1) + 1 == EndpointCount()) {
+			cursor_->finished_us = ElapsedMicros(cursor_->started);
 		}
+		std::lock_guard<std::mutex> guard(reader_mutex_);
+		reader_.reset();
 	}
 }
 
@@ -8,8 +8,12 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <functional>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <mutex>
 #include <cstddef>
@@ -17,12 +21,21 @@
 
 #include <arrow/flight/client.h>
 #include <arrow/flight/sql/client.h>
+#include <arrow/record_batch.h>
 #include <arrow/result.h>
 #include <arrow/table.h>
 #include <arrow/type.h>
+#include <arrow/util/cancel.h>
+#include <arrow/util/compression.h>
+
+#include "flight/hedge_timer.hpp"
+#include "flight/query_stats.hpp"
+#include "utils/posthog_tracer.hpp"
 
 namespace duckdb {
 
+class PostHogMemoryPool;
+
 // Opaque bytes representing a Flight SQL TransactionId (no encoding assumptions).
 using TransactionId = std::string;
 
@@ -31,34 +44,124 @@ struct PostHogDbSchemaInfo {
 	std::string schema_name;
 };
 
+// One row of a Flight SQL GetTables(include_schema=true) response.
+struct PostHogTableInfo {
+	std::string table_name;
+	// Null when the server did not send a schema for the table.
+	std::shared_ptr<arrow::Schema> schema;
+};
+
+// Endpoints of one FlightInfo, shared by every stream forked from the same query so that
+// each endpoint is claimed (and read) exactly once across all of them.
+struct PostHogFlightEndpointCursor {
+	explicit PostHogFlightEndpointCursor(std::unique_ptr<arrow::flight::FlightInfo> info_p);
+
+	// Returns the index of the next unclaimed endpoint, or nullopt once all are taken.
+	std::optional<size_t> Claim();
+
+	std::shared_ptr<arrow::flight::FlightInfo> info;
+	std::atomic<size_t> next_endpoint {0};
+	// Endpoints read to the end, and streams (including forks) still open over this FlightInfo.
+	std::atomic<size_t> finished_endpoints {0};
+	std::atomic<size_t> open_streams {0};
+	// Query statistics, recorded by the last stream to close. stats holds what is known when the
+	// FlightInfo arrives; the counters below are updated by every stream.
+	PostHogQueryStats stats;
+	std::chrono::steady_clock::time_point started;
+	int64_t invalidations_at_start = 0;
+	std::atomic<int64_t> first_batch_us {-1};
+	// Microseconds until the last endpoint was drained; -1 while any is still being read.
+	std::atomic<int64_t> finished_us {-1};
+	std::atomic<int64_t> batches {0};
+	std::atomic<bool> failed {false};
+	// Span covering Execute until the last stream closes, when tracing was enabled.
+	PostHogTraceSpan trace_span;
+	bool traced = false;
+	// Rows and buffer bytes received so far by all streams over this FlightInfo.
+	std::atomic<int64_t> records_read {0};
+	std::atomic<int64_t> bytes_read {0};
+	// Accounts the received batches against DuckDB's memory limit; nullptr when not tracked.
+	PostHogMemoryPool *memory_pool = nullptr;
+};
+
+class PostHogFlightClient;
+
 class PostHogFlightQueryStream {
 public:
-	PostHogFlightQueryStream(arrow::flight::sql::FlightSqlClient &client, std::mutex &client_mutex,
-	                         arrow::flight::FlightCallOptions options, std::unique_ptr<arrow::flight::FlightInfo> info,
-	                         std::string *session_token, std::mutex *session_token_mutex);
+	// stats describes the Execute call that returned info; started is when that call began.
+	// trace_span, when set, is finished once the last stream over the FlightInfo closes. memory_pool,
+	// when set, must be the pool options decode with; it tracks every batch the stream returns.
+	PostHogFlightQueryStream(PostHogFlightClient &client, arrow::flight::FlightCallOptions options,
+	                         std::unique_ptr<arrow::flight::FlightInfo> info, PostHogQueryStats stats = {},
+	                         std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now(),
+	                         const PostHogTraceSpan *trace_span = nullptr, PostHogMemoryPool *memory_pool = nullptr);
+	// Closing a stream before its endpoint is drained cancels the DoGet; when the last stream over
+	// the FlightInfo closes with endpoints left unread, the query itself is cancelled on the server.
+	~PostHogFlightQueryStream();
 
 	arrow::Result<std::shared_ptr<arrow::Schema>> GetSchema();
 	arrow::Result<arrow::flight::FlightStreamChunk> Next();
 
+	// Number of endpoints the server split the result into.
+	size_t EndpointCount() const;
+	// True when the server requires endpoints to be consumed in order (FlightInfo.ordered).
+	bool IsOrdered() const;
+
+	// Result size announced in the FlightInfo; -1 when the server did not report it.
+	int64_t TotalRecords() const;
+	int64_t TotalBytes() const;
+	// Rows and bytes received so far, summed over this stream and all of its forks.
+	int64_t RecordsRead() const;
+	int64_t BytesRead() const;
+	int64_t BatchesRead() const;
+	// Microseconds from the Execute call until the first batch arrived (-1 before it does), and
+	// until the last endpoint was drained (the time so far while endpoints are still being read).
+	int64_t FirstBatchMicros() const;
+	int64_t RemoteMicros() const;
+
+	// Create a sibling stream over the same FlightInfo. Siblings share the endpoint cursor, so
+	// draining them concurrently reads every endpoint exactly once.
+	std::unique_ptr<PostHogFlightQueryStream> Fork() const;
+	// Create a sibling stream pinned to the next endpoint nobody has claimed, which it claims right
+	// away and is the only one it reads; null once every endpoint is claimed. Each endpoint of an
+	// unordered result keeps its own row order, which such a stream preserves.
+	std::unique_ptr<PostHogFlightQueryStream> ForkEndpoint() const;
+
+	// Cancels the open DoGet from any thread. Next() then fails, and no further endpoint is opened.
+	void Cancel();
+
 private:
-	arrow::flight::sql::FlightSqlClient &client_;
-	std::mutex &client_mutex_;
+	PostHogFlightQueryStream(PostHogFlightClient &client, arrow::flight::FlightCallOptions options,
+	                         std::shared_ptr<PostHogFlightEndpointCursor> cursor,
+	                         std::shared_ptr<arrow::Schema> schema);
+
+	PostHogFlightClient &client_;
 	arrow::flight::FlightCallOptions options_;
-	std::unique_ptr<arrow::flight::FlightInfo> info_;
+	std::shared_ptr<PostHogFlightEndpointCursor> cursor_;
+	// Guards reader_ against Cancel(); only the reading thread replaces it.
+	std::mutex reader_mutex_;
 	std::unique_ptr<arrow::flight::FlightStreamReader> reader_;
-	size_t endpoint_index_ = 0;
+	std::atomic<bool> cancelled_ {false};
 	std::shared_ptr<arrow::Schema> schema_;
-	std::string *session_token_ = nullptr;
-	std::mutex *session_token_mutex_ = nullptr;
+	// Set on streams created by ForkEndpoint: the endpoint they read, until they open it.
+	bool pinned_ = false;
+	std::optional<size_t> pinned_endpoint_;
 
 	arrow::Status OpenReader();
 	void InvalidateSessionTokenIfRetryable(const arrow::Status &status);
+	// Adds the query to the client's stats log; called by the last stream over the FlightInfo.
+	void RecordStats(bool unfinished);
 };
 
 class PostHogFlightClient {
 public:
+	// pool_size gRPC channels are opened up front; every RPC borrows a free one, so concurrent
+	// queries on one attach no longer serialize. All channels share the same Duckgres session.
+	// compression ("none", "lz4" or "zstd") is requested for result batches and used for uploads.
+	// max_message_bytes and keepalive_ms configure the gRPC channels (0 keeps gRPC's defaults).
 	PostHogFlightClient(const std::string &endpoint, const std::string &user, const std::string &password,
-	                    bool tls_skip_verify);
+	                    bool tls_skip_verify, size_t pool_size = 1, const std::string &compression = "none",
+	                    size_t max_message_bytes = 0, size_t keepalive_ms = 0);
 	~PostHogFlightClient();
 
 	// Prevent copying (Flight client is not copyable)
@@ -73,9 +176,16 @@ public:
 	// Authentication
 	//===--------------------------------------------------------------------===//
 
-	// Authenticate with the server using username/password over TLS.
+	// Authenticate with the server using username/password over TLS. With a session cache, also
+	// resumes the session a previous process left there, once the server confirms it is still valid.
 	void Authenticate();
 
+	// File of the PostHogSessionCache (session_cache_dir) this client resumes its session from and
+	// leaves it in when destroyed; empty disables it. Set before Authenticate.
+	void SetSessionCachePath(std::string path) {
+		session_cache_path_ = std::move(path);
+	}
+
 	// Check if currently authenticated
 	bool IsAuthenticated() const {
 		return authenticated_;
@@ -85,21 +195,95 @@ public:
 	// Query Execution
 	//===--------------------------------------------------------------------===//
 
-	// Execute a SQL query and return results as an Arrow Table
+	// Execute a SQL query and return results as an Arrow Table. The batches are allocated from (or
+	// tracked by) memory_pool when one is given.
 	std::shared_ptr<arrow::Table> ExecuteQuery(const std::string &sql,
-	                                           const std::optional<TransactionId> &txn_id = std::nullopt);
+	                                           const std::optional<TransactionId> &txn_id = std::nullopt,
+	                                           PostHogMemoryPool *memory_pool = nullptr);
+
+	// Calls taking a stop_token fail with an InterruptException (or a Cancelled status) as soon as
+	// the token is stopped; gRPC cancels the call, so the server stops working on it.
 
 	// Execute a SQL update/DDL statement (Flight SQL StatementUpdate).
-	int64_t ExecuteUpdate(const std::string &sql, const std::optional<TransactionId> &txn_id = std::nullopt);
+	int64_t ExecuteUpdate(const std::string &sql, const std::optional<TransactionId> &txn_id = std::nullopt,
+	                      const arrow::StopToken &stop_token = arrow::StopToken::Unstoppable());
+
+	// Append record batches to an existing table via Flight SQL bulk ingest (CommandStatementIngest).
+	// Returns nullopt if the server does not implement ingest; the result is remembered, so callers
+	// fall back to SQL text without paying for a failed round trip again.
+	std::optional<int64_t> ExecuteIngest(const std::shared_ptr<arrow::RecordBatchReader> &reader,
+	                                     const std::string &catalog, const std::string &schema,
+	                                     const std::string &table,
+	                                     const std::optional<TransactionId> &txn_id = std::nullopt,
+	                                     const arrow::StopToken &stop_token = arrow::StopToken::Unstoppable());
+
+	// Create a temporary table of the reader's schema in the server session (it must not exist yet)
+	// and fill it via bulk ingest. Returns nullopt if the server does not implement ingest.
+	std::optional<int64_t> ExecuteTemporaryIngest(const std::shared_ptr<arrow::RecordBatchReader> &reader,
+	                                              const std::string &table,
+	                                              const std::optional<TransactionId> &txn_id = std::nullopt,
+	                                              const arrow::StopToken &stop_token = arrow::StopToken::Unstoppable());
+
+	bool SupportsIngest() const {
+		return ingest_supported_.load();
+	}
 
-	// Execute a SQL query and return results as a streaming reader
+	// Execute a SQL query and return results as a streaming reader. stop_token also applies to
+	// every DoGet of the stream, and memory_pool (when given) to every batch it reads.
 	std::unique_ptr<PostHogFlightQueryStream>
-	ExecuteQueryStream(const std::string &sql, const std::optional<TransactionId> &txn_id = std::nullopt);
+	ExecuteQueryStream(const std::string &sql, const std::optional<TransactionId> &txn_id = std::nullopt,
+	                   const arrow::StopToken &stop_token = arrow::StopToken::Unstoppable(),
+	                   PostHogMemoryPool *memory_pool = nullptr);
 
 	// Get the schema of a query without executing it (uses Prepare)
 	std::shared_ptr<arrow::Schema> GetQuerySchema(const std::string &sql,
 	                                              const std::optional<TransactionId> &txn_id = std::nullopt);
 
+	// Like GetQuerySchema, but answers repeated probes of the same SQL text in the same session and
+	// transaction from a cache (entries expire after the query schema TTL, and with their transaction).
+	// Inside a transaction the prepared handle is kept open until it ends, so that executing the same
+	// SQL does not plan it again; auto-commit handles are closed right away.
+	std::shared_ptr<arrow::Schema> GetCachedQuerySchema(const std::string &sql,
+	                                                    const std::optional<TransactionId> &txn_id = std::nullopt);
+
+	// Execute a parameterized update through a prepared handle cached per session, transaction and
+	// SQL text (auto-commit handles are closed after use); each row of parameters is one execution of
+	// the statement. Returns nullopt if the server does not implement parameter binding; like ingest,
+	// the result is remembered.
+	std::optional<int64_t> ExecutePreparedUpdate(const std::string &sql,
+	                                             const std::shared_ptr<arrow::RecordBatch> &parameters,
+	                                             const std::optional<TransactionId> &txn_id = std::nullopt,
+	                                             const arrow::StopToken &stop_token = arrow::StopToken::Unstoppable());
+
+	bool SupportsPreparedParameters() const {
+		return prepared_parameters_supported_.load();
+	}
+
+	// Lifetime of GetCachedQuerySchema entries; zero disables the schema cache.
+	void SetQuerySchemaCacheTtl(std::chrono::seconds ttl);
+	// Forget every GetCachedQuerySchema entry, after DDL may have changed result schemas.
+	void InvalidateQuerySchemas();
+	// Ask the server to send string columns dictionary-encoded. Set before the first call.
+	void SetDictionaryStrings(bool enabled) {
+		dictionary_strings_ = enabled;
+	}
+	// Deadline of every attempt of a metadata call (ListDbSchemas, ListTables, ListTablesWithSchemas,
+	// GetTableSchema); zero means none. An attempt that runs into it is retried once.
+	void SetMetadataTimeout(std::chrono::milliseconds timeout) {
+		metadata_timeout_ = timeout;
+	}
+	// Send a second attempt of a metadata call on another channel once the first has run longer than
+	// the p95 latency of recent calls of its kind, and keep whichever succeeds first. Only applies
+	// with more than one pooled channel.
+	void SetMetadataHedging(bool enabled) {
+		metadata_hedging_ = enabled;
+	}
+	// Read each result endpoint from the locations its FlightEndpoint lists, through a client pooled
+	// per location, before falling back to the coordinator. Set before the first call.
+	void SetEndpointLocations(bool enabled) {
+		endpoint_locations_ = enabled;
+	}
+
 	//===--------------------------------------------------------------------===//
 	// Transactions (Flight SQL BeginTransaction/EndTransaction)
 	//===--------------------------------------------------------------------===//
@@ -123,6 +307,9 @@ public:
 	// List all tables in a schema
 	std::vector<std::string> ListTables(const std::string &catalog, const std::string &schema);
 
+	// List all tables in a schema together with their Arrow schemas, in one GetTables call.
+	std::vector<PostHogTableInfo> ListTablesWithSchemas(const std::string &catalog, const std::string &schema);
+
 	// Get the schema of a specific table
 	std::shared_ptr<arrow::Schema> GetTableSchema(const std::string &catalog, const std::string &schema,
 	                                              const std::string &table);
@@ -137,30 +324,181 @@ public:
 
 	// Check if the client is connected
 	bool IsConnected() const {
-		return sql_client_ != nullptr;
+		return !channels_.empty();
+	}
+
+	size_t GetPoolSize() const {
+		return channels_.size();
+	}
+
+	// Most recent calls of this client, for duckhog_query_stats().
+	PostHogQueryStatsLog &GetQueryStats() {
+		return query_stats_;
 	}
 
 private:
+	friend class PostHogFlightQueryStream;
+
+	// One gRPC channel wrapped in a Flight SQL client. The mutex marks the channel as busy
+	// for the duration of a unary RPC or a DoGet open.
+	struct PooledChannel {
+		std::unique_ptr<arrow::flight::sql::FlightSqlClient> sql_client;
+		std::mutex mutex;
+	};
+
+	// Times one call and adds it to query_stats_ when destroyed. A scope left through an exception
+	// is recorded with status "error". Also traces the call, so its Flight requests carry the span
+	// as traceparent.
+	class RpcStatsScope {
+	public:
+		RpcStatsScope(PostHogFlightClient &client, const char *rpc, std::string sql);
+		~RpcStatsScope();
+
+		RpcStatsScope(const RpcStatsScope &) = delete;
+		RpcStatsScope &operator=(const RpcStatsScope &) = delete;
+
+		PostHogQueryStats &Stats() {
+			return stats_;
+		}
+		void AddBatch(const arrow::RecordBatch &batch);
+
+	private:
+		PostHogFlightClient &client_;
+		PostHogTraceScope trace_;
+		PostHogQueryStats stats_;
+		std::chrono::steady_clock::time_point started_;
+		int64_t invalidations_at_start_;
+		int uncaught_at_start_;
+	};
+
+	// Exclusive use of one pooled channel, released on destruction.
+	class ChannelLease {
+	public:
+		ChannelLease(PooledChannel &channel, std::unique_lock<std::mutex> lock)
+		    : channel_(&channel), lock_(std::move(lock)) {
+		}
+
+		arrow::flight::sql::FlightSqlClient *operator->() const {
+			return channel_->sql_client.get();
+		}
+
+		PooledChannel &Channel() const {
+			return *channel_;
+		}
+
+	private:
+		PooledChannel *channel_;
+		std::unique_lock<std::mutex> lock_;
+	};
+
 	std::string endpoint_;
 	std::string user_;
 	std::string password_;
 	std::string session_token_;
 	mutable std::mutex session_token_mutex_;
+	std::string session_cache_path_;
+	// Empty, or the Arrow IPC codec name sent in the compression header.
+	std::string compression_;
+	std::shared_ptr<arrow::util::Codec> compression_codec_;
+	bool dictionary_strings_ = false;
 	bool authenticated_ = false;
-
-	// Arrow Flight clients
-	std::unique_ptr<arrow::flight::sql::FlightSqlClient> sql_client_;
-
-	// Mutex for thread safety
-	mutable std::mutex client_mutex_;
+	// Cleared the first time the server answers bulk ingest with NotImplemented.
+	std::atomic<bool> ingest_supported_ {true};
+	// Cleared the first time the server answers a parameterized update with NotImplemented.
+	std::atomic<bool> prepared_parameters_supported_ {true};
+
+	// Arrow Flight clients, one per pooled gRPC channel
+	std::vector<std::unique_ptr<PooledChannel>> channels_;
+	std::atomic<size_t> next_channel_ {0};
+
+	// Options and location the channels were connected with; location clients use the same options.
+	arrow::flight::FlightClientOptions client_options_;
+	arrow::flight::Location coordinator_location_;
+	bool endpoint_locations_ = true;
+	// Clients of the data nodes results were read from, keyed by location URI. gRPC multiplexes the
+	// DoGets of every stream reading from one node over its single channel.
+	std::mutex location_clients_mutex_;
+	std::unordered_map<std::string, std::shared_ptr<arrow::flight::FlightClient>> location_clients_;
+
+	PostHogQueryStatsLog query_stats_;
+	// Session tokens dropped so far; calls report how many were dropped while they ran.
+	std::atomic<int64_t> session_invalidations_ {0};
+
+	// A server-side prepared statement. It only exists in the session (and transaction) that
+	// prepared it, and must be executed on the channel it was prepared on.
+	struct CachedPreparedStatement {
+		std::optional<TransactionId> txn_id;
+		PooledChannel *channel;
+		std::shared_ptr<arrow::flight::sql::PreparedStatement> statement;
+		// False when the cache was full (or lost a race); the caller closes the handle after use.
+		bool cached;
+	};
+	struct CachedQuerySchema {
+		std::optional<TransactionId> txn_id;
+		std::shared_ptr<arrow::Schema> schema;
+		std::chrono::steady_clock::time_point cached_at;
+	};
+	// Both caches are keyed by MakeStatementKey, which includes the session token, so entries of an
+	// invalidated session are never reused. Guarded by statement_cache_mutex_.
+	std::mutex statement_cache_mutex_;
+	std::unordered_map<std::string, CachedPreparedStatement> prepared_statements_;
+	std::unordered_map<std::string, CachedQuerySchema> query_schemas_;
+	std::chrono::seconds query_schema_ttl_ {300};
+
+	std::chrono::milliseconds metadata_timeout_ {0};
+	bool metadata_hedging_ = false;
+	// Latencies of successful metadata calls, per call, for the hedging delay.
+	PostHogLatencyWindow list_db_schemas_latency_;
+	PostHogLatencyWindow list_tables_latency_;
+	PostHogLatencyWindow list_tables_with_schemas_latency_;
+	PostHogLatencyWindow table_schema_latency_;
+	PostHogHedgeTimer hedge_timer_;
+
+	// Borrow an idle channel, or wait on the next one in round-robin order when all are busy.
+	ChannelLease AcquireChannel();
+	// Borrow an idle channel; nullopt when all are busy.
+	std::optional<ChannelLease> TryAcquireChannel();
+	// The pooled client of a data node location, connecting on first use. Null when endpoint locations
+	// are disabled, or for the coordinator itself, connection reuse and locations that fail to connect.
+	std::shared_ptr<arrow::flight::FlightClient> GetLocationClient(const arrow::flight::Location &location);
+	// Forget a location client whose DoGet failed, so the next endpoint there connects anew.
+	void DropLocationClient(const arrow::flight::Location &location);
+
+	// One attempt of a metadata call: its RPCs and the read of their results, on the given channel.
+	template <class T>
+	using MetadataAttempt = std::function<arrow::Result<T>(arrow::flight::sql::FlightSqlClient &,
+	                                                       const arrow::flight::FlightCallOptions &)>;
+	// Runs attempt with the metadata deadline on a borrowed channel, hedged when that is enabled and
+	// latency has enough samples. Failed attempts keep their status; exceptions they throw propagate.
+	template <class T>
+	arrow::Result<T> RunMetadataCall(PostHogLatencyWindow &latency, RpcStatsScope &scope,
+	                                 const MetadataAttempt<T> &attempt);
 
 	// Get call options with authentication headers
-	arrow::flight::FlightCallOptions GetCallOptions() const;
+	arrow::flight::FlightCallOptions
+	GetCallOptions(const arrow::StopToken &stop_token = arrow::StopToken::Unstoppable()) const;
+	// Best-effort CancelFlightInfo for a query whose result will not be read to the end. Never waits
+	// for a channel (it is skipped when all are busy) and gives up after a short deadline.
+	void CancelFlightInfo(const arrow::flight::FlightInfo &info);
 	std::string GetSessionTokenSnapshot() const;
 	bool ShouldRetryMetadataWithFreshSession(const arrow::Status &status) const;
 	void InvalidateSessionTokenLocked(const char *reason, const arrow::Status *status = nullptr);
 	void InvalidateSessionTokenIfRetryableLocked(const char *reason, const arrow::Status &status);
 	void BestEffortCloseSessionLocked();
+
+	std::string MakeStatementKey(const std::string &sql, const std::optional<TransactionId> &txn_id) const;
+	// Returns the cached prepared handle for sql in txn_id, preparing it on a miss. Only handles of a
+	// transaction are cached, since CloseTransactionStatements ends them; the caller closes the others.
+	arrow::Result<CachedPreparedStatement> GetPreparedStatement(const std::string &sql,
+	                                                            const std::optional<TransactionId> &txn_id);
+	// Close the handles prepared in txn_id, or every cached handle, and forget them. The first also
+	// drops the query schemas cached for txn_id.
+	void CloseTransactionStatements(const TransactionId &txn_id);
+	void CloseAllPreparedStatements();
+	// Shared by ExecuteIngest (append to an existing table) and ExecuteTemporaryIngest.
+	std::optional<int64_t> Ingest(const std::shared_ptr<arrow::RecordBatchReader> &reader, const std::string &catalog,
+	                              const std::string &schema, const std::string &table, bool temporary,
+	                              const std::optional<TransactionId> &txn_id, const arrow::StopToken &stop_token);
 };
 
 } // namespace duckdb
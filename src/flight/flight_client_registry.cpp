@@ -0,0 +1,86 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// flight/flight_client_registry.cpp
+//
+// Process-wide registry of Flight clients shared by catalogs attached to the same server
+//===----------------------------------------------------------------------===//
+
+#include "flight/flight_client_registry.hpp"
+#include "flight/session_cache.hpp"
+#include "utils/posthog_logger.hpp"
+
+#include <chrono>
+#include <iterator>
+
+namespace duckdb {
+
+namespace {
+
+std::shared_ptr<PostHogFlightClient> CreateClient(const PostHogConnectionConfig &config) {
+	auto client =
+	    std::make_shared<PostHogFlightClient>(config.flight_server, config.user, config.password,
+	                                          config.tls_skip_verify, config.pool_size, config.compression,
+	                                          config.max_message_bytes, config.keepalive_ms);
+	client->SetQuerySchemaCacheTtl(std::chrono::seconds(config.metadata_cache_ttl));
+	client->SetDictionaryStrings(config.dictionary_strings);
+	client->SetMetadataTimeout(std::chrono::milliseconds(config.metadata_timeout_ms));
+	client->SetMetadataHedging(config.metadata_hedging);
+	client->SetEndpointLocations(config.endpoint_locations);
+	if (!config.session_cache_dir.empty() && PostHogSessionCache::PrepareDirectory(config.session_cache_dir)) {
+		client->SetSessionCachePath(
+		    PostHogSessionCache::CachePath(config.session_cache_dir, config.flight_server, config.user));
+	}
+	client->Authenticate();
+	return client;
+}
+
+} // namespace
+
+PostHogFlightClientRegistry &PostHogFlightClientRegistry::Instance() {
+	static PostHogFlightClientRegistry instance;
+	return instance;
+}
+
+std::string PostHogFlightClientRegistry::MakeKey(const PostHogConnectionConfig &config) {
+	// Length-prefixed fields, so no value can run into the next one.
+	std::string key;
+	for (const auto &part : {config.flight_server, config.user, config.password,
+	                         std::string(config.tls_skip_verify ? "1" : "0"), std::to_string(config.pool_size),
+	                         config.compression, std::string(config.dictionary_strings ? "1" : "0"),
+	                         std::to_string(config.metadata_cache_ttl), std::to_string(config.metadata_timeout_ms),
+	                         std::string(config.metadata_hedging ? "1" : "0"), std::to_string(config.max_message_bytes),
+	                         std::to_string(config.keepalive_ms), std::string(config.endpoint_locations ? "1" : "0"),
+	                         config.session_cache_dir}) {
+		key += std::to_string(part.size());
+		key += ':';
+		key += part;
+	}
+	return key;
+}
+
+std::shared_ptr<PostHogFlightClient> PostHogFlightClientRegistry::Acquire(const PostHogConnectionConfig &config) {
+	if (!config.shared_client) {
+		return CreateClient(config);
+	}
+	auto key = MakeKey(config);
+	// Held while a new client connects, so concurrent attaches of one key share a single client.
+	std::lock_guard<std::mutex> guard(lock_);
+	auto it = clients_.find(key);
+	if (it != clients_.end()) {
+		auto client = it->second.lock();
+		if (client) {
+			POSTHOG_LOG_DEBUG("Reusing the Flight client for %s", config.flight_server.c_str());
+			return client;
+		}
+	}
+	// Drop entries of detached clients while the lock is held anyway.
+	for (auto entry = clients_.begin(); entry != clients_.end();) {
+		entry = entry->second.expired() ? clients_.erase(entry) : std::next(entry);
+	}
+	auto client = CreateClient(config);
+	clients_[key] = client;
+	return client;
+}
+
+} // namespace duckdb
@@ -0,0 +1,44 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// flight/flight_client_registry.hpp
+//
+// Process-wide registry of Flight clients shared by catalogs attached to the same server
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "flight/flight_client.hpp"
+#include "utils/connection_string.hpp"
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace duckdb {
+
+// Hands catalogs attached with the same endpoint, credentials and client settings one
+// PostHogFlightClient, so its channels, TLS handshakes and Duckgres session are set up once per
+// process. Catalogs hold the client through a shared_ptr: the last DETACH of a key destroys it
+// (closing its prepared statements and session); the registry itself only keeps weak references.
+class PostHogFlightClientRegistry {
+public:
+	static PostHogFlightClientRegistry &Instance();
+
+	// The live client registered for config's key, or a new authenticated one. Clients whose
+	// construction or authentication fails are not registered.
+	std::shared_ptr<PostHogFlightClient> Acquire(const PostHogConnectionConfig &config);
+
+	// Every setting that changes how a client talks to the server is part of the key; anything else
+	// (caches, batch sizes, pushdown) is per catalog.
+	static std::string MakeKey(const PostHogConnectionConfig &config);
+
+private:
+	PostHogFlightClientRegistry() = default;
+
+	std::mutex lock_;
+	std::unordered_map<std::string, std::weak_ptr<PostHogFlightClient>> clients_;
+};
+
+} // namespace duckdb
@@ -0,0 +1,71 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// flight/hedge_timer.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "flight/hedge_timer.hpp"
+
+#include <algorithm>
+
+namespace duckdb {
+
+PostHogHedgeTimer::~PostHogHedgeTimer() {
+	{
+		std::lock_guard<std::mutex> guard(lock_);
+		stopping_ = true;
+	}
+	changed_.notify_all();
+	if (thread_.joinable()) {
+		thread_.join();
+	}
+}
+
+uint64_t PostHogHedgeTimer::Schedule(std::chrono::steady_clock::time_point at, std::function<void()> task) {
+	uint64_t id;
+	{
+		std::lock_guard<std::mutex> guard(lock_);
+		id = ++next_id_;
+		tasks_.push_back({id, at, std::move(task)});
+		if (!thread_.joinable()) {
+			thread_ = std::thread([this]() { Loop(); });
+		}
+	}
+	changed_.notify_all();
+	return id;
+}
+
+void PostHogHedgeTimer::Cancel(uint64_t id) {
+	std::unique_lock<std::mutex> guard(lock_);
+	tasks_.erase(std::remove_if(tasks_.begin(), tasks_.end(), [&](const Task &task) { return task.id == id; }),
+	             tasks_.end());
+	changed_.wait(guard, [&]() { return running_id_ != id; });
+}
+
+void PostHogHedgeTimer::Loop() {
+	std::unique_lock<std::mutex> guard(lock_);
+	while (!stopping_) {
+		if (tasks_.empty()) {
+			changed_.wait(guard, [&]() { return stopping_ || !tasks_.empty(); });
+			continue;
+		}
+		auto next = std::min_element(tasks_.begin(), tasks_.end(),
+		                             [](const Task &left, const Task &right) { return left.at < right.at; });
+		if (next->at > std::chrono::steady_clock::now()) {
+			// Woken early by a new task or a cancel, which may change the next deadline.
+			changed_.wait_until(guard, next->at);
+			continue;
+		}
+		auto task = std::move(*next);
+		tasks_.erase(next);
+		running_id_ = task.id;
+		guard.unlock();
+		task.run();
+		guard.lock();
+		running_id_ = 0;
+		changed_.notify_all();
+	}
+}
+
+} // namespace duckdb
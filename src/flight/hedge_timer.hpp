@@ -0,0 +1,58 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// flight/hedge_timer.hpp
+//
+// Delayed start of hedged metadata attempts
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace duckdb {
+
+// Runs a task once its time comes, unless it is cancelled first. A metadata call schedules the start
+// of its hedged attempt here and runs its first attempt on its own thread, so a call that finishes
+// within the hedging delay starts no thread at all. One thread per Flight client, started on first
+// use, waits for the deadlines; tasks must be short, since they run on it one after another.
+class PostHogHedgeTimer {
+public:
+	PostHogHedgeTimer() = default;
+	~PostHogHedgeTimer();
+
+	PostHogHedgeTimer(const PostHogHedgeTimer &) = delete;
+	PostHogHedgeTimer &operator=(const PostHogHedgeTimer &) = delete;
+
+	// Returns the id of the task, for Cancel.
+	uint64_t Schedule(std::chrono::steady_clock::time_point at, std::function<void()> task);
+	// Drops the task if it has not run yet, or else waits until it has, so that whatever it references
+	// may go away once this returns.
+	void Cancel(uint64_t id);
+
+private:
+	struct Task {
+		uint64_t id;
+		std::chrono::steady_clock::time_point at;
+		std::function<void()> run;
+	};
+
+	void Loop();
+
+	std::mutex lock_;
+	std::condition_variable changed_;
+	std::vector<Task> tasks_;
+	uint64_t next_id_ = 0;
+	// Id of the task running now, 0 when none is.
+	uint64_t running_id_ = 0;
+	bool stopping_ = false;
+	std::thread thread_;
+};
+
+} // namespace duckdb
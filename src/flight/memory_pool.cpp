@@ -0,0 +1,232 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// flight/memory_pool.cpp
+//
+// Arrow memory pool accounted against DuckDB's buffer manager
+//===----------------------------------------------------------------------===//
+
+#include "flight/memory_pool.hpp"
+
+#include "duckdb/common/error_data.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/storage/buffer_manager.hpp"
+
+#include <arrow/array/data.h>
+
+#include <algorithm>
+
+namespace duckdb {
+
+namespace {
+
+// DuckDB's own operators release memory without notifying the pool, so waiting reservations also poll.
+constexpr std::chrono::milliseconds kReservationPoll {50};
+
+// Returned to the pool when the last buffer of a tracked batch is released.
+struct PostHogMemoryReservation {
+	PostHogMemoryReservation(PostHogMemoryPool &pool_p, int64_t bytes_p) : pool(pool_p), bytes(bytes_p) {
+	}
+	~PostHogMemoryReservation() {
+		pool.Release(bytes);
+	}
+
+	PostHogMemoryPool &pool;
+	int64_t bytes;
+};
+
+// A view of a receive buffer that also keeps the reservation of its batch alive.
+class ReservedBuffer : public arrow::Buffer {
+public:
+	ReservedBuffer(const std::shared_ptr<arrow::Buffer> &parent,
+	               std::shared_ptr<PostHogMemoryReservation> reservation)
+	    : arrow::Buffer(parent, 0, parent->size()), reservation_(std::move(reservation)) {
+	}
+
+private:
+	std::shared_ptr<PostHogMemoryReservation> reservation_;
+};
+
+int64_t UntrackedBytes(const PostHogMemoryPool &pool, const arrow::ArrayData &data) {
+	int64_t bytes = 0;
+	for (const auto &buffer : data.buffers) {
+		if (buffer && !pool.Owns(*buffer)) {
+			bytes += buffer->size();
+		}
+	}
+	for (const auto &child : data.child_data) {
+		bytes += UntrackedBytes(pool, *child);
+	}
+	if (data.dictionary) {
+		bytes += UntrackedBytes(pool, *data.dictionary);
+	}
+	return bytes;
+}
+
+std::shared_ptr<arrow::ArrayData> WrapUntracked(const PostHogMemoryPool &pool,
+                                                const std::shared_ptr<arrow::ArrayData> &data,
+                                                const std::shared_ptr<PostHogMemoryReservation> &reservation) {
+	auto wrapped = std::make_shared<arrow::ArrayData>(*data);
+	for (auto &buffer : wrapped->buffers) {
+		if (buffer && !pool.Owns(*buffer)) {
+			buffer = std::make_shared<ReservedBuffer>(buffer, reservation);
+		}
+	}
+	for (auto &child : wrapped->child_data) {
+		child = WrapUntracked(pool, child, reservation);
+	}
+	if (wrapped->dictionary) {
+		wrapped->dictionary = WrapUntracked(pool, wrapped->dictionary, reservation);
+	}
+	return wrapped;
+}
+
+} // namespace
+
+PostHogMemoryPool::PostHogMemoryPool(BufferManager &buffer_manager)
+    : buffer_manager_(buffer_manager), base_(arrow::default_memory_pool()) {
+}
+
+arrow::Status PostHogMemoryPool::Allocate(int64_t size, int64_t alignment, uint8_t **out) {
+	ARROW_RETURN_NOT_OK(Reserve(size));
+	auto status = base_->Allocate(size, alignment, out);
+	if (!status.ok()) {
+		Release(size);
+		return status;
+	}
+	{
+		std::lock_guard<std::mutex> guard(allocations_lock_);
+		allocations_.insert(*out);
+	}
+	bytes_allocated_.fetch_add(size);
+	total_bytes_allocated_.fetch_add(size);
+	num_allocations_.fetch_add(1);
+	return status;
+}
+
+arrow::Status PostHogMemoryPool::Reallocate(int64_t old_size, int64_t new_size, int64_t alignment, uint8_t **ptr) {
+	auto growth = new_size - old_size;
+	if (growth > 0) {
+		ARROW_RETURN_NOT_OK(Reserve(growth));
+	}
+	auto old_ptr = *ptr;
+	auto status = base_->Reallocate(old_size, new_size, alignment, ptr);
+	if (!status.ok()) {
+		if (growth > 0) {
+			Release(growth);
+		}
+		return status;
+	}
+	if (*ptr != old_ptr) {
+		std::lock_guard<std::mutex> guard(allocations_lock_);
+		allocations_.erase(old_ptr);
+		allocations_.insert(*ptr);
+	}
+	if (growth < 0) {
+		Release(-growth);
+	} else {
+		total_bytes_allocated_.fetch_add(growth);
+	}
+	bytes_allocated_.fetch_add(growth);
+	num_allocations_.fetch_add(1);
+	return status;
+}
+
+void PostHogMemoryPool::Free(uint8_t *buffer, int64_t size, int64_t alignment) {
+	{
+		std::lock_guard<std::mutex> guard(allocations_lock_);
+		allocations_.erase(buffer);
+	}
+	base_->Free(buffer, size, alignment);
+	bytes_allocated_.fetch_sub(size);
+	Release(size);
+}
+
+void PostHogMemoryPool::ReleaseUnused() {
+	base_->ReleaseUnused();
+}
+
+int64_t PostHogMemoryPool::bytes_allocated() const {
+	return bytes_allocated_.load();
+}
+
+int64_t PostHogMemoryPool::total_bytes_allocated() const {
+	return total_bytes_allocated_.load();
+}
+
+int64_t PostHogMemoryPool::num_allocations() const {
+	return num_allocations_.load();
+}
+
+std::string PostHogMemoryPool::backend_name() const {
+	return "duckdb(" + base_->backend_name() + ")";
+}
+
+arrow::Status PostHogMemoryPool::Reserve(int64_t bytes) {
+	if (bytes <= 0) {
+		return arrow::Status::OK();
+	}
+	auto deadline = std::chrono::steady_clock::now() + RESERVATION_WAIT;
+	while (true) {
+		std::string error;
+		try {
+			buffer_manager_.ReserveMemory(static_cast<idx_t>(bytes));
+			reserved_bytes_.fetch_add(bytes);
+			return arrow::Status::OK();
+		} catch (const OutOfMemoryException &ex) {
+			error = ErrorData(ex).RawMessage();
+		}
+		// Waiting only helps while batches of this pool are held by readers that will release them.
+		auto now = std::chrono::steady_clock::now();
+		if (reserved_bytes_.load() == 0 || now >= deadline) {
+			return arrow::Status::OutOfMemory("PostHog: Flight result batches do not fit in memory_limit: ", error);
+		}
+		std::unique_lock<std::mutex> guard(lock_);
+		released_.wait_until(guard, std::min(deadline, now + kReservationPoll));
+	}
+}
+
+void PostHogMemoryPool::Release(int64_t bytes) {
+	if (bytes <= 0) {
+		return;
+	}
+	buffer_manager_.FreeReservedMemory(static_cast<idx_t>(bytes));
+	reserved_bytes_.fetch_sub(bytes);
+	released_.notify_all();
+}
+
+bool PostHogMemoryPool::Owns(const arrow::Buffer &buffer) const {
+	// Slices and views share the memory of the buffer at the root of their parents.
+	auto root = &buffer;
+	while (root->parent()) {
+		root = root->parent().get();
+	}
+	std::lock_guard<std::mutex> guard(allocations_lock_);
+	return allocations_.count(root->data()) > 0;
+}
+
+bool PostHogMemoryPool::HasHeadroom(int64_t bytes) const {
+	return buffer_manager_.GetUsedMemory() + static_cast<idx_t>(std::max<int64_t>(bytes, 0)) <=
+	       buffer_manager_.GetMaxMemory();
+}
+
+arrow::Result<std::shared_ptr<arrow::RecordBatch>>
+PostHogMemoryPool::Track(const std::shared_ptr<arrow::RecordBatch> &batch) {
+	int64_t bytes = 0;
+	for (const auto &column : batch->column_data()) {
+		bytes += UntrackedBytes(*this, *column);
+	}
+	if (bytes == 0) {
+		return batch;
+	}
+	ARROW_RETURN_NOT_OK(Reserve(bytes));
+	auto reservation = std::make_shared<PostHogMemoryReservation>(*this, bytes);
+	arrow::ArrayDataVector columns;
+	columns.reserve(static_cast<size_t>(batch->num_columns()));
+	for (const auto &column : batch->column_data()) {
+		columns.push_back(WrapUntracked(*this, column, reservation));
+	}
+	return arrow::RecordBatch::Make(batch->schema(), batch->num_rows(), std::move(columns));
+}
+
+} // namespace duckdb
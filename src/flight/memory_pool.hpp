@@ -0,0 +1,85 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// flight/memory_pool.hpp
+//
+// Arrow memory pool accounted against DuckDB's buffer manager
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <arrow/buffer.h>
+#include <arrow/memory_pool.h>
+#include <arrow/record_batch.h>
+#include <arrow/result.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+
+namespace duckdb {
+
+class BufferManager;
+
+// Allocates through Arrow's default pool, but reserves every allocation from DuckDB's buffer manager
+// first, so result batches count against memory_limit and DuckDB evicts or spills its own buffers to
+// make room for them. A reservation that does not fit while the pool holds others waits (up to
+// RESERVATION_WAIT) for memory to be released before the allocation fails with OutOfMemory; a stream
+// reading through the pool thus stops pulling batches off the wire until the scans ahead of it catch
+// up. With nothing of the pool held, no release can come and it fails at once.
+// The pool must outlive every buffer allocated from it or tracked by it.
+class PostHogMemoryPool : public arrow::MemoryPool {
+public:
+	static constexpr std::chrono::milliseconds RESERVATION_WAIT {5000};
+
+	explicit PostHogMemoryPool(BufferManager &buffer_manager);
+
+	using arrow::MemoryPool::Allocate;
+	using arrow::MemoryPool::Free;
+	using arrow::MemoryPool::Reallocate;
+
+	arrow::Status Allocate(int64_t size, int64_t alignment, uint8_t **out) override;
+	arrow::Status Reallocate(int64_t old_size, int64_t new_size, int64_t alignment, uint8_t **ptr) override;
+	void Free(uint8_t *buffer, int64_t size, int64_t alignment) override;
+	void ReleaseUnused() override;
+
+	int64_t bytes_allocated() const override;
+	int64_t total_bytes_allocated() const override;
+	int64_t num_allocations() const override;
+	std::string backend_name() const override;
+
+	// Reserves bytes from the buffer manager, waiting for releases while they do not fit and other
+	// reservations of the pool are held.
+	arrow::Status Reserve(int64_t bytes);
+	void Release(int64_t bytes);
+	// True while bytes more fit under memory_limit without evicting anything.
+	bool HasHeadroom(int64_t bytes) const;
+	// True for buffers (and slices of buffers) this pool allocated and has not freed.
+	bool Owns(const arrow::Buffer &buffer) const;
+
+	// Receive buffers that gRPC owns (uncompressed batch bodies) are not allocated from any pool.
+	// Returns batch with those buffers wrapped so that a reservation of their size is held until the
+	// last of them is released; buffers this pool allocated are already accounted and kept as they are.
+	arrow::Result<std::shared_ptr<arrow::RecordBatch>> Track(const std::shared_ptr<arrow::RecordBatch> &batch);
+
+private:
+	BufferManager &buffer_manager_;
+	arrow::MemoryPool *base_;
+	std::mutex lock_;
+	std::condition_variable released_;
+	// Bytes reserved through the pool and not yet released.
+	std::atomic<int64_t> reserved_bytes_ {0};
+	// Start of every live allocation, for Owns().
+	mutable std::mutex allocations_lock_;
+	std::unordered_set<const uint8_t *> allocations_;
+	std::atomic<int64_t> bytes_allocated_ {0};
+	std::atomic<int64_t> total_bytes_allocated_ {0};
+	std::atomic<int64_t> num_allocations_ {0};
+};
+
+} // namespace duckdb
@@ -0,0 +1,45 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// flight/query_result_reader.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "flight/query_result_reader.hpp"
+#include "storage/posthog_transaction.hpp"
+
+#include "duckdb/common/exception.hpp"
+
+namespace duckdb {
+
+PostHogQueryResultReader::PostHogQueryResultReader(ClientContext &context, PostHogCatalog &catalog, std::string sql,
+                                                   std::optional<TransactionId> txn_id, vector<LogicalType> types)
+    : context_(context), types_(std::move(types)),
+      stream_(catalog, std::move(sql), std::move(txn_id), PostHogTransaction::Get(context, catalog).GetStopToken()) {
+}
+
+bool PostHogQueryResultReader::Next(DataChunk &output) {
+	output.Reset();
+	while (!finished_ && (!converter_ || !converter_->HasRows())) {
+		auto chunk_result = stream_.Next();
+		if (!chunk_result.ok()) {
+			throw IOException("PostHog: Failed to read remote result: " + chunk_result.status().ToString());
+		}
+		auto &batch = chunk_result->data;
+		if (!batch) {
+			finished_ = true;
+			break;
+		}
+		if (!converter_) {
+			converter_ = make_uniq<PostHogArrowChunkConverter>(context_, batch->schema(), types_);
+		}
+		converter_->SetBatch(batch);
+	}
+	if (finished_) {
+		return false;
+	}
+	converter_->Convert(output);
+	return true;
+}
+
+} // namespace duckdb
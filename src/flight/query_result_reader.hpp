@@ -0,0 +1,47 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// flight/query_result_reader.hpp
+//
+// Incremental DataChunk reader over a remote query result
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb/common/types/data_chunk.hpp"
+#include "flight/arrow_stream.hpp"
+#include "utils/arrow_chunk_converter.hpp"
+
+#include <optional>
+#include <string>
+
+namespace duckdb {
+
+class ClientContext;
+class PostHogCatalog;
+
+// Streams the result of a remote query as DataChunks of fixed types. Only the record batch being
+// converted (plus the prefetch queue, when prefetch_bytes is set) is held in memory, and the
+// first rows are returned as soon as the first batch arrives.
+class PostHogQueryResultReader {
+public:
+	PostHogQueryResultReader(ClientContext &context, PostHogCatalog &catalog, std::string sql,
+	                         std::optional<TransactionId> txn_id, vector<LogicalType> types);
+
+	// Fills output with the next rows. Returns false, leaving output empty, at end of result.
+	bool Next(DataChunk &output);
+
+	// The remote query stream, for EXPLAIN ANALYZE details.
+	const PostHogArrowStreamState &GetStream() const {
+		return stream_;
+	}
+
+private:
+	ClientContext &context_;
+	vector<LogicalType> types_;
+	PostHogArrowStreamState stream_;
+	unique_ptr<PostHogArrowChunkConverter> converter_;
+	bool finished_ = false;
+};
+
+} // namespace duckdb
@@ -0,0 +1,76 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// flight/query_stats.cpp
+//
+// Bounded log of per-RPC timings and transfer counters of one Flight client
+//===----------------------------------------------------------------------===//
+
+#include "flight/query_stats.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace duckdb {
+
+int64_t MicrosSince(std::chrono::steady_clock::time_point started) {
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started).count();
+}
+
+std::string FormatRemoteMillis(int64_t micros) {
+	char buffer[32];
+	std::snprintf(buffer, sizeof(buffer), "%.2fms", static_cast<double>(micros) / 1000.0);
+	return buffer;
+}
+
+PostHogQueryStatsLog::PostHogQueryStatsLog(size_t capacity) : capacity_(capacity) {
+}
+
+void PostHogQueryStatsLog::Add(PostHogQueryStats stats) {
+	std::lock_guard<std::mutex> guard(lock_);
+	if (capacity_ == 0) {
+		return;
+	}
+	if (entries_.size() >= capacity_) {
+		entries_.pop_front();
+	}
+	entries_.push_back(std::move(stats));
+}
+
+std::vector<PostHogQueryStats> PostHogQueryStatsLog::Snapshot() const {
+	std::lock_guard<std::mutex> guard(lock_);
+	return std::vector<PostHogQueryStats>(entries_.begin(), entries_.end());
+}
+
+void PostHogQueryStatsLog::Clear() {
+	std::lock_guard<std::mutex> guard(lock_);
+	entries_.clear();
+}
+
+void PostHogLatencyWindow::Record(int64_t micros) {
+	std::lock_guard<std::mutex> guard(lock_);
+	if (samples_.size() < CAPACITY) {
+		samples_.push_back(micros);
+		return;
+	}
+	samples_[next_] = micros;
+	next_ = (next_ + 1) % CAPACITY;
+}
+
+std::optional<int64_t> PostHogLatencyWindow::Percentile(double quantile) const {
+	std::vector<int64_t> samples;
+	{
+		std::lock_guard<std::mutex> guard(lock_);
+		if (samples_.size() < MIN_SAMPLES) {
+			return std::nullopt;
+		}
+		samples = samples_;
+	}
+	auto rank = static_cast<size_t>(std::ceil(quantile * static_cast<double>(samples.size())));
+	auto index = std::min(std::max<size_t>(rank, 1), samples.size()) - 1;
+	std::nth_element(samples.begin(), samples.begin() + static_cast<std::ptrdiff_t>(index), samples.end());
+	return samples[index];
+}
+
+} // namespace duckdb
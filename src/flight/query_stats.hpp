@@ -0,0 +1,88 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// flight/query_stats.hpp
+//
+// Bounded log of per-RPC timings and transfer counters of one Flight client
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace duckdb {
+
+// One Flight SQL call (or one query stream, from Execute to the close of its last reader).
+struct PostHogQueryStats {
+	// Client method, e.g. "ExecuteQueryStream", "ExecuteUpdate", "ListTables".
+	std::string rpc;
+	// Remote SQL, or a description of the metadata request; empty for transaction control.
+	std::string sql;
+	std::chrono::system_clock::time_point started_at;
+	// "ok", "error", or "cancelled" for streams closed before every endpoint was read.
+	std::string status = "ok";
+	// Microseconds until the first record batch arrived; -1 when none did.
+	int64_t first_batch_us = -1;
+	int64_t total_us = 0;
+	int64_t batches = 0;
+	// Rows received, or rows affected for updates and ingest; -1 when the server did not report it.
+	int64_t rows = 0;
+	int64_t bytes = 0;
+	int64_t endpoints = 0;
+	// Attempts repeated (with a fresh session or after a deadline), hedged attempts sent alongside a
+	// slow one (metadata_hedging), and session tokens invalidated during the call.
+	int64_t retries = 0;
+	int64_t hedges = 0;
+	int64_t session_invalidations = 0;
+};
+
+// Microseconds elapsed since started.
+int64_t MicrosSince(std::chrono::steady_clock::time_point started);
+// Renders a duration for EXPLAIN ANALYZE, e.g. "12.34ms".
+std::string FormatRemoteMillis(int64_t micros);
+
+// Keeps the most recent calls of one PostHogFlightClient, oldest first. Thread-safe.
+class PostHogQueryStatsLog {
+public:
+	static constexpr size_t DEFAULT_CAPACITY = 1024;
+
+	explicit PostHogQueryStatsLog(size_t capacity = DEFAULT_CAPACITY);
+
+	void Add(PostHogQueryStats stats);
+	std::vector<PostHogQueryStats> Snapshot() const;
+	void Clear();
+
+private:
+	size_t capacity_;
+	mutable std::mutex lock_;
+	std::deque<PostHogQueryStats> entries_;
+};
+
+// Durations of the most recent successful calls of one kind, from which hedged metadata calls take
+// their delay. Thread-safe.
+class PostHogLatencyWindow {
+public:
+	static constexpr size_t CAPACITY = 64;
+	// Percentiles of fewer samples are not trusted.
+	static constexpr size_t MIN_SAMPLES = 8;
+
+	void Record(int64_t micros);
+	// Nearest-rank quantile (0 < quantile <= 1) of the recorded durations; nullopt until MIN_SAMPLES
+	// have been recorded.
+	std::optional<int64_t> Percentile(double quantile) const;
+
+private:
+	mutable std::mutex lock_;
+	std::vector<int64_t> samples_;
+	// Slot the next sample overwrites once the window is full.
+	size_t next_ = 0;
+};
+
+} // namespace duckdb
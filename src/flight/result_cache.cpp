@@ -0,0 +1,56 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// flight/result_cache.cpp
+//
+// Snapshot-keyed in-memory cache of remote scan results
+//===----------------------------------------------------------------------===//
+
+#include "flight/result_cache.hpp"
+
+namespace duckdb {
+
+PostHogResultCache::PostHogResultCache(size_t capacity_bytes) : capacity_bytes_(capacity_bytes) {
+}
+
+std::string PostHogResultCache::MakeKey(int64_t snapshot_id, const std::string &query) {
+	return std::to_string(snapshot_id) + "\n" + query;
+}
+
+std::shared_ptr<const PostHogCachedResult> PostHogResultCache::Lookup(const std::string &key) {
+	std::lock_guard<std::mutex> guard(lock_);
+	auto it = entries_.find(key);
+	if (it == entries_.end()) {
+		return nullptr;
+	}
+	lru_.splice(lru_.begin(), lru_, it->second);
+	return it->second->second;
+}
+
+void PostHogResultCache::Insert(const std::string &key, std::shared_ptr<const PostHogCachedResult> result) {
+	if (!result || result->bytes > capacity_bytes_) {
+		return;
+	}
+	std::lock_guard<std::mutex> guard(lock_);
+	auto it = entries_.find(key);
+	if (it != entries_.end()) {
+		// Another scan of the same query finished first; both results are identical.
+		lru_.splice(lru_.begin(), lru_, it->second);
+		return;
+	}
+	EvictToFit(result->bytes);
+	used_bytes_ += result->bytes;
+	lru_.emplace_front(key, std::move(result));
+	entries_[key] = lru_.begin();
+}
+
+void PostHogResultCache::EvictToFit(size_t incoming_bytes) {
+	while (!lru_.empty() && used_bytes_ + incoming_bytes > capacity_bytes_) {
+		auto &victim = lru_.back();
+		used_bytes_ -= victim.second->bytes;
+		entries_.erase(victim.first);
+		lru_.pop_back();
+	}
+}
+
+} // namespace duckdb
@@ -0,0 +1,62 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// flight/result_cache.hpp
+//
+// Snapshot-keyed in-memory cache of remote scan results
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <arrow/record_batch.h>
+#include <arrow/type.h>
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace duckdb {
+
+// Complete result of one remote scan query.
+struct PostHogCachedResult {
+	std::shared_ptr<arrow::Schema> schema;
+	std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+	size_t bytes = 0;
+};
+
+// LRU cache of remote scan results, bounded by the total buffer size of the cached batches.
+// Keys combine the DuckLake snapshot id with the generated remote SQL (table, projection and
+// WHERE), so an entry stays valid for as long as the remote snapshot is unchanged.
+class PostHogResultCache {
+public:
+	explicit PostHogResultCache(size_t capacity_bytes);
+
+	static std::string MakeKey(int64_t snapshot_id, const std::string &query);
+
+	std::shared_ptr<const PostHogCachedResult> Lookup(const std::string &key);
+	// Results larger than the whole cache are not kept.
+	void Insert(const std::string &key, std::shared_ptr<const PostHogCachedResult> result);
+
+	size_t Capacity() const {
+		return capacity_bytes_;
+	}
+
+private:
+	using LruList = std::list<std::pair<std::string, std::shared_ptr<const PostHogCachedResult>>>;
+
+	// Called with lock_ held.
+	void EvictToFit(size_t incoming_bytes);
+
+	const size_t capacity_bytes_;
+	std::mutex lock_;
+	size_t used_bytes_ = 0;
+	// Most recently used first.
+	LruList lru_;
+	std::unordered_map<std::string, LruList::iterator> entries_;
+};
+
+} // namespace duckdb
@@ -0,0 +1,113 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// flight/session_cache.cpp
+//
+// Optional on-disk cache of Duckgres session tokens, resumed by the next process
+//===----------------------------------------------------------------------===//
+
+#include "flight/session_cache.hpp"
+
+#include "utils/posthog_file_utils.hpp"
+#include "utils/posthog_logger.hpp"
+
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/common/types/hash.hpp"
+
+#include <cinttypes>
+#include <cstdio>
+#include <filesystem>
+#include <sstream>
+#include <system_error>
+
+namespace duckdb {
+
+namespace {
+
+// Bump when the file layout changes; files with another header are ignored.
+constexpr const char *SESSION_FILE_HEADER = "duckhog-session-cache-v2";
+
+// Endpoint and user a session belongs to. The password is not part of it: every call still sends the
+// credentials, so a session resumed with other ones is refused by the server like any expired session.
+std::string SessionKey(const std::string &endpoint, const std::string &user) {
+	return endpoint + "\n" + user;
+}
+
+} // namespace
+
+bool PostHogSessionCache::PrepareDirectory(const std::string &dir) {
+	if (!PostHogPrepareOwnerOnlyDirectory(dir)) {
+		POSTHOG_LOG_WARN("Session cache disabled: %s is not a directory private to this user", dir.c_str());
+		return false;
+	}
+	return true;
+}
+
+std::string PostHogSessionCache::CachePath(const std::string &dir, const std::string &endpoint,
+                                           const std::string &user) {
+	auto key = SessionKey(endpoint, user);
+	char name[32];
+	snprintf(name, sizeof(name), "%016" PRIx64 ".session", static_cast<uint64_t>(Hash(key.c_str())));
+	if (!dir.empty() && dir.back() == '/') {
+		return dir + name;
+	}
+	return dir + "/" + name;
+}
+
+std::string PostHogSessionCache::Claim(const std::string &path, const std::string &endpoint,
+                                       const std::string &user) {
+	// Renaming is atomic, so of several processes starting at once only one gets the session.
+	auto claimed_path = path + ".claim" + PostHogUniqueFileSuffix();
+	std::error_code error;
+	std::filesystem::rename(path, claimed_path, error);
+	if (error) {
+		return "";
+	}
+	// A file someone else could have written, or read, is never used: it may hold their session.
+	std::string contents;
+	auto owner_only = PostHogReadOwnerOnlyFile(claimed_path, contents);
+	std::filesystem::remove(claimed_path, error);
+	if (!owner_only) {
+		POSTHOG_LOG_DEBUG("Session cache: ignoring %s, not a private file of this user", path.c_str());
+		return "";
+	}
+	std::string header;
+	std::string stored_endpoint;
+	std::string stored_user;
+	std::string token;
+	std::istringstream in(contents);
+	std::getline(in, header);
+	std::getline(in, stored_endpoint);
+	std::getline(in, stored_user);
+	std::getline(in, token);
+	StringUtil::Trim(token);
+	if (header != SESSION_FILE_HEADER || token.empty()) {
+		POSTHOG_LOG_DEBUG("Session cache: ignoring unreadable file %s", path.c_str());
+		return "";
+	}
+	if (stored_endpoint != endpoint || stored_user != user) {
+		// Another endpoint or user with the same name hash: its session is of no use here, so put it
+		// back for its owner.
+		POSTHOG_LOG_DEBUG("Session cache: ignoring %s, stored for another endpoint or user", path.c_str());
+		Store(path, stored_endpoint, stored_user, token);
+		return "";
+	}
+	return token;
+}
+
+bool PostHogSessionCache::Store(const std::string &path, const std::string &endpoint, const std::string &user,
+                                const std::string &token) {
+	if (endpoint.find('\n') != std::string::npos || user.find('\n') != std::string::npos) {
+		return false;
+	}
+	// Created owner-only and exclusively: never readable by others, never partially read, and never
+	// replacing the session another process stored first.
+	auto contents = std::string(SESSION_FILE_HEADER) + "\n" + endpoint + "\n" + user + "\n" + token + "\n";
+	if (!PostHogCreateFileExclusively(path, contents, true)) {
+		POSTHOG_LOG_DEBUG("Session cache: not storing in %s, already taken or not writable", path.c_str());
+		return false;
+	}
+	return true;
+}
+
+} // namespace duckdb
@@ -0,0 +1,41 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// flight/session_cache.hpp
+//
+// Optional on-disk cache of Duckgres session tokens, resumed by the next process
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+
+namespace duckdb {
+
+// Hands a Duckgres session from one process to the next attaching the same server as the same
+// user, so short-lived processes skip setting up a new session. A process claims the cached
+// token (removing the file, so no two processes ever share a session at once) and stores its own
+// session back when its client is destroyed, instead of closing it. Files are readable by their
+// owner only, and files or directories that are not are refused. Every error is swallowed: the cache
+// can only save a session setup, never fail an attach.
+class PostHogSessionCache {
+public:
+	// Creates dir (mode 0700) unless it exists. False, disabling the cache, unless it is a directory of
+	// the effective user that no one else has any access to.
+	static bool PrepareDirectory(const std::string &dir);
+
+	// One token file per endpoint and user inside dir.
+	static std::string CachePath(const std::string &dir, const std::string &endpoint, const std::string &user);
+
+	// Returns the cached token and removes the file; empty when there is none, when the file was
+	// stored for another endpoint or user (whose name hashes to the same path), or when it is not a
+	// file of the effective user that no one else has any access to.
+	static std::string Claim(const std::string &path, const std::string &endpoint, const std::string &user);
+
+	// Creates path holding token, endpoint and user. Returns false when another process already stored
+	// a session there (or the file cannot be written), in which case the caller closes its session instead.
+	static bool Store(const std::string &path, const std::string &endpoint, const std::string &user,
+	                  const std::string &token);
+};
+
+} // namespace duckdb
@@ -0,0 +1,694 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// optimizer/posthog_optimizer.cpp
+//
+// Optimizer extension pushing work from local operators into remote SQL
+//===----------------------------------------------------------------------===//
+
+#include "optimizer/posthog_optimizer.hpp"
+
+#include "catalog/posthog_catalog.hpp"
+#include "catalog/remote_query.hpp"
+#include "catalog/remote_scan.hpp"
+#include "catalog/remote_scan_sharing.hpp"
+#include "execution/posthog_sql_utils.hpp"
+#include "execution/posthog_temp_table.hpp"
+#include "execution/posthog_upload_join.hpp"
+#include "optimizer/remote_query_builder.hpp"
+
+#include "duckdb/common/exception.hpp"
+#include "duckdb/optimizer/column_binding_replacer.hpp"
+#include "duckdb/optimizer/optimizer.hpp"
+#include "duckdb/planner/binder.hpp"
+#include "duckdb/planner/expression/bound_aggregate_expression.hpp"
+#include "duckdb/planner/expression/bound_columnref_expression.hpp"
+#include "duckdb/planner/expression/bound_constant_expression.hpp"
+#include "duckdb/planner/operator/logical_aggregate.hpp"
+#include "duckdb/planner/operator/logical_filter.hpp"
+#include "duckdb/planner/operator/logical_get.hpp"
+#include "duckdb/planner/operator/logical_limit.hpp"
+#include "duckdb/planner/operator/logical_order.hpp"
+#include "duckdb/planner/operator/logical_projection.hpp"
+#include "duckdb/planner/operator/logical_sample.hpp"
+#include "duckdb/planner/operator/logical_top_n.hpp"
+
+#include <algorithm>
+#include <set>
+
+namespace duckdb {
+
+namespace {
+
+struct PushdownContext {
+	Binder &binder;
+	unique_ptr<LogicalOperator> &root;
+};
+
+// Replace op with a posthog_remote_query scan producing the given columns, then repoint every
+// reference to op's bindings at the matching result column. The remap runs over the whole plan
+// right away so that parents can themselves be pushed down afterwards.
+void ReplaceWithRemoteQuery(PushdownContext &pushdown, unique_ptr<LogicalOperator> &op,
+                            PostHogRemoteQueryBuilder &builder, string sql, vector<LogicalType> types,
+                            vector<string> names, const vector<ColumnBinding> &old_bindings) {
+	D_ASSERT(old_bindings.size() == types.size());
+	auto table_index = pushdown.binder.GenerateTableIndex();
+	ColumnBindingReplacer replacer;
+	for (idx_t i = 0; i < old_bindings.size(); i++) {
+		replacer.replacement_bindings.emplace_back(old_bindings[i], ColumnBinding(table_index, i));
+	}
+
+	auto bind_data = make_uniq<PostHogRemoteQueryBindData>(builder.GetCatalog(), std::move(sql), types, names);
+	auto get = make_uniq<LogicalGet>(table_index, PostHogRemoteQuery::GetFunction(), std::move(bind_data),
+	                                 std::move(types), std::move(names));
+	for (idx_t i = 0; i < old_bindings.size(); i++) {
+		get->AddColumnId(i);
+	}
+	if (op->has_estimated_cardinality) {
+		get->SetEstimatedCardinality(op->estimated_cardinality);
+	}
+	op = std::move(get);
+	replacer.VisitOperator(*pushdown.root);
+}
+
+// Select exactly the output bindings of op (a pass-through operator such as a limit or a join)
+// from the builder's source.
+bool SelectOutputColumns(PostHogRemoteQueryBuilder &builder, LogicalOperator &op, vector<ColumnBinding> &bindings,
+                         vector<string> &select_list, vector<string> &names) {
+	op.ResolveOperatorTypes();
+	bindings = op.GetColumnBindings();
+	for (auto &binding : bindings) {
+		string sql;
+		if (!builder.ColumnToSQL(binding, sql)) {
+			return false;
+		}
+		names.push_back(sql);
+		select_list.push_back(std::move(sql));
+	}
+	return !select_list.empty();
+}
+
+bool IsRemoteQuery(LogicalOperator &op) {
+	return op.type == LogicalOperatorType::LOGICAL_GET && op.Cast<LogicalGet>().function.name == PostHogRemoteQuery::NAME;
+}
+
+// Move a USING SAMPLE / TABLESAMPLE directly over a remote scan into the scan, whose SELECT then samples
+// the table on the server. DuckDB plans the sample below the WHERE clause and the remote TABLESAMPLE
+// applies before it too, so filters above the sample are still pushed into the scan afterwards; a scan
+// that already has filters of its own (a sample over a filtered subquery) keeps the local sample.
+void TryPushDownSample(unique_ptr<LogicalOperator> &op) {
+	if (op->type != LogicalOperatorType::LOGICAL_SAMPLE) {
+		return;
+	}
+	auto &sample = op->Cast<LogicalSample>();
+	auto &child = sample.children[0];
+	auto bind_data = PostHogRemoteQueryBuilder::GetRemoteScan(*child);
+	if (!bind_data || !bind_data->catalog.GetConfig().pushdown || bind_data->sample_options) {
+		return;
+	}
+	auto &get = child->Cast<LogicalGet>();
+	if (!get.table_filters.filters.empty() || !bind_data->pushed_conditions.empty() || get.extra_info.sample_options) {
+		return;
+	}
+	switch (sample.sample_options->method) {
+	case SampleMethod::SYSTEM_SAMPLE:
+	case SampleMethod::BERNOULLI_SAMPLE:
+	case SampleMethod::RESERVOIR_SAMPLE:
+		break;
+	default:
+		return;
+	}
+	bind_data->sample_options = std::move(sample.sample_options);
+	if (op->has_estimated_cardinality) {
+		get.SetEstimatedCardinality(op->estimated_cardinality);
+	}
+	// The sample passes its child's bindings through, so nothing needs remapping.
+	op = std::move(sample.children[0]);
+}
+
+// Move the conjuncts of a filter that render as remote SQL into its input: into the WHERE clause of
+// a remote scan (which keeps its projection and endpoint parallelism), or into a WHERE over an
+// already pushed-down query. The filter keeps only what the server cannot evaluate, and
+// disappears when nothing is left.
+void TryPushDownFilter(PushdownContext &pushdown, unique_ptr<LogicalOperator> &op) {
+	if (op->type != LogicalOperatorType::LOGICAL_FILTER) {
+		return;
+	}
+	auto &filter = op->Cast<LogicalFilter>();
+	auto &child = filter.children[0];
+	auto bind_data = PostHogRemoteQueryBuilder::GetRemoteScan(*child);
+	PostHogRemoteQueryBuilder builder;
+	if ((!bind_data && !IsRemoteQuery(*child)) || !builder.AddSource(*child)) {
+		return;
+	}
+
+	vector<unique_ptr<Expression>> residual;
+	bool pushed = false;
+	for (auto &expr : filter.expressions) {
+		string condition;
+		if (expr->IsVolatile() || !builder.ExpressionToSQL(*expr, condition)) {
+			residual.push_back(std::move(expr));
+			continue;
+		}
+		if (bind_data) {
+			bind_data->pushed_conditions.push_back(condition);
+		}
+		builder.AddCondition(std::move(condition));
+		pushed = true;
+	}
+	if (!pushed) {
+		filter.expressions = std::move(residual);
+		return;
+	}
+	bool drop_filter = residual.empty() && filter.projection_map.empty();
+	if (residual.empty()) {
+		// Keep the filter for its projection_map; an always-true condition keeps it well-formed.
+		residual.push_back(make_uniq<BoundConstantExpression>(Value::BOOLEAN(true)));
+	}
+	filter.expressions = std::move(residual);
+
+	if (!bind_data) {
+		vector<ColumnBinding> bindings;
+		vector<string> select_list;
+		vector<string> names;
+		if (!SelectOutputColumns(builder, *child, bindings, select_list, names)) {
+			throw InternalException("PostHog: pushed-down query has unmapped output columns");
+		}
+		auto sql = builder.Build(select_list);
+		ReplaceWithRemoteQuery(pushdown, child, builder, std::move(sql), child->types, std::move(names), bindings);
+	}
+	if (drop_filter) {
+		// The filter passes its child's bindings through, so nothing needs remapping.
+		op = std::move(filter.children[0]);
+	}
+}
+
+// SELECT <groups>, <aggregates> FROM <source> [WHERE ...] GROUP BY 1, ..., n
+bool TryPushDownAggregate(PushdownContext &pushdown, unique_ptr<LogicalOperator> &op) {
+	if (op->type != LogicalOperatorType::LOGICAL_AGGREGATE_AND_GROUP_BY) {
+		return false;
+	}
+	auto &aggregate = op->Cast<LogicalAggregate>();
+	// ROLLUP/CUBE/GROUPING SETS and GROUPING() stay local.
+	if (aggregate.grouping_sets.size() > 1 || !aggregate.grouping_functions.empty()) {
+		return false;
+	}
+	PostHogRemoteQueryBuilder builder;
+	if (!builder.AddSource(*aggregate.children[0])) {
+		return false;
+	}
+
+	vector<string> select_list;
+	vector<string> group_by;
+	vector<LogicalType> types;
+	vector<string> names;
+	vector<ColumnBinding> old_bindings;
+	for (idx_t i = 0; i < aggregate.groups.size(); i++) {
+		auto &group = *aggregate.groups[i];
+		string sql;
+		if (!builder.ExpressionToSQL(group, sql)) {
+			return false;
+		}
+		select_list.push_back(std::move(sql));
+		// Ordinals, so that constant group keys are not mistaken for expressions.
+		group_by.push_back(to_string(i + 1));
+		types.push_back(group.return_type);
+		names.push_back(group.GetName());
+		old_bindings.emplace_back(aggregate.group_index, i);
+	}
+	for (idx_t i = 0; i < aggregate.expressions.size(); i++) {
+		auto &expr = *aggregate.expressions[i];
+		if (expr.GetExpressionClass() != ExpressionClass::BOUND_AGGREGATE) {
+			return false;
+		}
+		string sql;
+		if (!builder.AggregateToSQL(expr.Cast<BoundAggregateExpression>(), sql)) {
+			return false;
+		}
+		select_list.push_back(std::move(sql));
+		types.push_back(expr.return_type);
+		names.push_back(expr.GetName());
+		old_bindings.emplace_back(aggregate.aggregate_index, i);
+	}
+
+	auto sql = builder.Build(select_list, group_by);
+	ReplaceWithRemoteQuery(pushdown, op, builder, std::move(sql), std::move(types), std::move(names), old_bindings);
+	return true;
+}
+
+// Only constant limits are known at plan time; PERCENT and parameterized limits stay local.
+bool GetConstantLimit(const BoundLimitNode &node, optional_idx &result) {
+	switch (node.Type()) {
+	case LimitNodeType::UNSET:
+		return true;
+	case LimitNodeType::CONSTANT_VALUE:
+		result = node.GetConstantValue();
+		return true;
+	default:
+		return false;
+	}
+}
+
+// SELECT <columns> FROM <source> [WHERE ...] [ORDER BY ...] LIMIT n [OFFSET m], for a LIMIT
+// (optionally over an ORDER BY) or a TOP_N directly above a pushable source.
+bool TryPushDownLimit(PushdownContext &pushdown, unique_ptr<LogicalOperator> &op) {
+	optional_idx limit;
+	optional_idx offset;
+	optional_ptr<vector<BoundOrderByNode>> orders;
+	optional_ptr<LogicalOperator> source;
+	if (op->type == LogicalOperatorType::LOGICAL_TOP_N) {
+		auto &top_n = op->Cast<LogicalTopN>();
+		limit = top_n.limit;
+		offset = top_n.offset;
+		orders = &top_n.orders;
+		source = top_n.children[0].get();
+	} else if (op->type == LogicalOperatorType::LOGICAL_LIMIT) {
+		auto &limit_op = op->Cast<LogicalLimit>();
+		if (!GetConstantLimit(limit_op.limit_val, limit) || !GetConstantLimit(limit_op.offset_val, offset)) {
+			return false;
+		}
+		source = limit_op.children[0].get();
+		if (source->type == LogicalOperatorType::LOGICAL_ORDER_BY) {
+			orders = &source->Cast<LogicalOrder>().orders;
+			source = source->children[0].get();
+		}
+	} else {
+		return false;
+	}
+
+	PostHogRemoteQueryBuilder builder;
+	if (!builder.AddSource(*source)) {
+		return false;
+	}
+	vector<string> order_by;
+	if (orders) {
+		for (auto &order : *orders) {
+			string sql;
+			if (!builder.OrderToSQL(order, sql)) {
+				return false;
+			}
+			order_by.push_back(std::move(sql));
+		}
+	}
+
+	vector<ColumnBinding> bindings;
+	vector<string> select_list;
+	vector<string> names;
+	if (!SelectOutputColumns(builder, *op, bindings, select_list, names)) {
+		return false;
+	}
+
+	auto sql = builder.Build(select_list, {}, order_by, limit, offset.IsValid() ? offset.GetIndex() : 0);
+	ReplaceWithRemoteQuery(pushdown, op, builder, std::move(sql), op->types, std::move(names), bindings);
+	return true;
+}
+
+idx_t EstimatedCardinality(ClientContext &context, LogicalOperator &op) {
+	return op.has_estimated_cardinality ? op.estimated_cardinality : op.EstimateCardinality(context);
+}
+
+// Rows the local plan of op streams from the server: the inputs of its (not yet pushed-down) joins.
+idx_t StreamedCardinality(ClientContext &context, LogicalOperator &op) {
+	if (op.type != LogicalOperatorType::LOGICAL_COMPARISON_JOIN && op.type != LogicalOperatorType::LOGICAL_ANY_JOIN) {
+		return EstimatedCardinality(context, op);
+	}
+	idx_t rows = 0;
+	for (auto &child : op.children) {
+		rows += StreamedCardinality(context, *child);
+	}
+	return rows;
+}
+
+// SELECT <output columns> FROM t0 JOIN t1 ON ..., for joins whose inputs all read tables of the same
+// catalog and whose result is estimated at no more rows than streaming the inputs. Other joins (and
+// cross products, see AddSource) still run remotely when a pushed-down aggregate or limit above them
+// absorbs them.
+bool TryPushDownJoin(PushdownContext &pushdown, unique_ptr<LogicalOperator> &op) {
+	if (op->type != LogicalOperatorType::LOGICAL_COMPARISON_JOIN && op->type != LogicalOperatorType::LOGICAL_ANY_JOIN) {
+		return false;
+	}
+	auto &context = pushdown.binder.context;
+	if (EstimatedCardinality(context, *op) > StreamedCardinality(context, *op)) {
+		return false;
+	}
+	PostHogRemoteQueryBuilder builder;
+	if (!builder.AddSource(*op)) {
+		return false;
+	}
+	vector<ColumnBinding> bindings;
+	vector<string> select_list;
+	vector<string> names;
+	if (!SelectOutputColumns(builder, *op, bindings, select_list, names)) {
+		return false;
+	}
+	auto sql = builder.Build(select_list);
+	ReplaceWithRemoteQuery(pushdown, op, builder, std::move(sql), op->types, std::move(names), bindings);
+	return true;
+}
+
+// True if op can be evaluated on its own, without the server: no PostHog scans (of any catalog) and
+// no references to rows produced elsewhere in the plan.
+bool IsSelfContainedLocalPlan(LogicalOperator &op) {
+	switch (op.type) {
+	case LogicalOperatorType::LOGICAL_GET: {
+		auto &get = op.Cast<LogicalGet>();
+		if (get.function.name == PostHogRemoteQuery::NAME || PostHogRemoteQueryBuilder::GetRemoteScan(op)) {
+			return false;
+		}
+		break;
+	}
+	case LogicalOperatorType::LOGICAL_DELIM_GET:
+	case LogicalOperatorType::LOGICAL_CTE_REF:
+	case LogicalOperatorType::LOGICAL_EXTENSION_OPERATOR:
+		return false;
+	default:
+		break;
+	}
+	for (auto &child : op.children) {
+		if (!IsSelfContainedLocalPlan(*child)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// join_upload_rows: a join of a remote input with a local one normally streams the whole remote
+// input. When the local input is estimated at no more than join_upload_rows rows, and uploading it
+// and reading back the join result moves fewer rows than that stream, the join is replaced by a
+// POSTHOG_UPLOAD_JOIN that sends the local rows to a temporary table and runs the join remotely.
+bool TryUploadJoin(PushdownContext &pushdown, unique_ptr<LogicalOperator> &op) {
+	if (op->type != LogicalOperatorType::LOGICAL_COMPARISON_JOIN && op->type != LogicalOperatorType::LOGICAL_ANY_JOIN) {
+		return false;
+	}
+	auto &context = pushdown.binder.context;
+	for (idx_t local_side = 0; local_side < 2; local_side++) {
+		auto &local = op->children[local_side];
+		auto &remote = op->children[1 - local_side];
+		if (!IsSelfContainedLocalPlan(*local)) {
+			continue;
+		}
+		PostHogRemoteQueryBuilder remote_builder;
+		if (!remote_builder.AddSource(*remote)) {
+			continue;
+		}
+		auto limit = remote_builder.GetCatalog().GetConfig().join_upload_rows;
+		auto local_rows = EstimatedCardinality(context, *local);
+		auto remote_rows = EstimatedCardinality(context, *remote);
+		auto joined_rows = EstimatedCardinality(context, *op);
+		if (limit == 0 || local_rows > limit || local_rows + joined_rows >= remote_rows) {
+			continue;
+		}
+
+		auto temp_table = PostHogRemoteTempTable::NewName();
+		PostHogRemoteQueryBuilder builder;
+		if (!builder.AddJoinWithUpload(*op, local_side, PostHogRemoteTempTable::SQLName(temp_table))) {
+			continue;
+		}
+		vector<ColumnBinding> bindings;
+		vector<string> select_list;
+		vector<string> names;
+		if (!SelectOutputColumns(builder, *op, bindings, select_list, names)) {
+			continue;
+		}
+
+		auto table_index = pushdown.binder.GenerateTableIndex();
+		auto upload_join = make_uniq<LogicalPostHogUploadJoin>(table_index, builder.GetCatalog(),
+		                                                       builder.Build(select_list), std::move(temp_table),
+		                                                       op->types);
+		upload_join->SetEstimatedCardinality(joined_rows);
+		// Detached while the references to the join are repointed, which must not reach into it.
+		auto local_plan = std::move(local);
+		op = std::move(upload_join);
+		ColumnBindingReplacer replacer;
+		for (idx_t i = 0; i < bindings.size(); i++) {
+			replacer.replacement_bindings.emplace_back(bindings[i], ColumnBinding(table_index, i));
+		}
+		replacer.VisitOperator(*pushdown.root);
+		op->children.push_back(std::move(local_plan));
+		return true;
+	}
+	return false;
+}
+
+// An ORDER BY over a remote scan, through projections and filters that pass the sort columns through,
+// moves into the scan: its SELECT sorts on the server, and the scan emits the rows in that order on one
+// thread, merging the sorted streams of its splits or endpoints. The local sort goes away.
+void TryPushDownOrder(PushdownContext &pushdown, unique_ptr<LogicalOperator> &op) {
+	if (op->type != LogicalOperatorType::LOGICAL_ORDER_BY) {
+		return;
+	}
+	auto &order = op->Cast<LogicalOrder>();
+	vector<ColumnBinding> keys;
+	for (auto &node : order.orders) {
+		if (node.expression->GetExpressionType() != ExpressionType::BOUND_COLUMN_REF) {
+			return;
+		}
+		if ((node.type != OrderType::ASCENDING && node.type != OrderType::DESCENDING) ||
+		    (node.null_order != OrderByNullType::NULLS_FIRST && node.null_order != OrderByNullType::NULLS_LAST)) {
+			return;
+		}
+		keys.push_back(node.expression->Cast<BoundColumnRefExpression>().binding);
+	}
+	// Follow the sort keys down to the scan's columns.
+	auto source = order.children[0].get();
+	while (source->type == LogicalOperatorType::LOGICAL_PROJECTION ||
+	       source->type == LogicalOperatorType::LOGICAL_FILTER) {
+		if (source->type == LogicalOperatorType::LOGICAL_PROJECTION) {
+			auto &projection = source->Cast<LogicalProjection>();
+			for (auto &key : keys) {
+				if (key.table_index != projection.table_index || key.column_index >= projection.expressions.size()) {
+					return;
+				}
+				auto &expr = *projection.expressions[key.column_index];
+				if (expr.GetExpressionType() != ExpressionType::BOUND_COLUMN_REF) {
+					return;
+				}
+				key = expr.Cast<BoundColumnRefExpression>().binding;
+			}
+		}
+		source = source->children[0].get();
+	}
+	auto bind_data = PostHogRemoteQueryBuilder::GetRemoteScan(*source);
+	if (!bind_data || !bind_data->catalog.GetConfig().pushdown || !bind_data->orders.empty()) {
+		return;
+	}
+	auto &get = source->Cast<LogicalGet>();
+	auto &column_ids = get.GetColumnIds();
+	for (auto &column : column_ids) {
+		// Row-id placeholders and nested column extraction keep the Arrow scan.
+		if (column.HasChildren() || column.GetPrimaryIndex() >= bind_data->column_names.size()) {
+			return;
+		}
+	}
+	auto bindings = get.GetColumnBindings();
+	vector<PostHogScanOrder> orders;
+	for (idx_t i = 0; i < keys.size(); i++) {
+		auto it = std::find(bindings.begin(), bindings.end(), keys[i]);
+		if (it == bindings.end()) {
+			return;
+		}
+		auto binding_idx = NumericCast<idx_t>(it - bindings.begin());
+		auto &column = column_ids[get.projection_ids.empty() ? binding_idx : get.projection_ids[binding_idx]];
+		orders.push_back({column.GetPrimaryIndex(), order.orders[i].type, order.orders[i].null_order});
+	}
+	bind_data->orders = std::move(orders);
+
+	if (order.projection_map.empty()) {
+		// The sort passes its child's bindings through, so nothing needs remapping.
+		op = std::move(order.children[0]);
+		return;
+	}
+	// The sort also dropped columns: a projection of the ones it kept takes its place.
+	order.ResolveOperatorTypes();
+	auto order_bindings = order.GetColumnBindings();
+	auto table_index = pushdown.binder.GenerateTableIndex();
+	ColumnBindingReplacer replacer;
+	vector<unique_ptr<Expression>> expressions;
+	for (idx_t i = 0; i < order_bindings.size(); i++) {
+		expressions.push_back(make_uniq<BoundColumnRefExpression>(order.types[i], order_bindings[i]));
+		replacer.replacement_bindings.emplace_back(order_bindings[i], ColumnBinding(table_index, i));
+	}
+	auto projection = make_uniq<LogicalProjection>(table_index, std::move(expressions));
+	projection->children.push_back(std::move(order.children[0]));
+	if (order.has_estimated_cardinality) {
+		projection->SetEstimatedCardinality(order.estimated_cardinality);
+	}
+	op = std::move(projection);
+	replacer.stop_operator = op.get();
+	replacer.VisitOperator(*pushdown.root);
+}
+
+// Bottom-up, so that an operator can absorb the remote query its input was already rewritten to
+// (e.g. a Top-N over a pushed-down aggregate, or an aggregate over a pushed-down join).
+void PushDown(PushdownContext &pushdown, unique_ptr<LogicalOperator> &op) {
+	for (auto &child : op->children) {
+		PushDown(pushdown, child);
+	}
+	TryPushDownSample(op);
+	TryPushDownFilter(pushdown, op);
+	if (TryPushDownJoin(pushdown, op) || TryUploadJoin(pushdown, op) || TryPushDownAggregate(pushdown, op)) {
+		return;
+	}
+	TryPushDownLimit(pushdown, op);
+	// After the parent's own pushdown, so that a LIMIT over an ORDER BY is pushed down with it first.
+	for (auto &child : op->children) {
+		TryPushDownOrder(pushdown, child);
+	}
+}
+
+void CollectRemoteScans(LogicalOperator &op, vector<reference<LogicalGet>> &scans) {
+	for (auto &child : op.children) {
+		CollectRemoteScans(*child, scans);
+	}
+	if (PostHogRemoteQueryBuilder::GetRemoteScan(op)) {
+		scans.push_back(op.Cast<LogicalGet>());
+	}
+}
+
+// Filter entries that remain once dynamic filters are taken as always true.
+bool ContainsStaticFilters(const TableFilterSet &left, const TableFilterSet &right) {
+	for (auto &entry : left.filters) {
+		auto filter = WithoutDynamicFilters(*entry.second);
+		if (!filter) {
+			continue;
+		}
+		auto other = right.filters.find(entry.first);
+		if (other == right.filters.end()) {
+			return false;
+		}
+		auto other_filter = WithoutDynamicFilters(*other->second);
+		if (!other_filter || !filter->Equals(*other_filter)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// True if both scans read the same rows: the same table at the same AT clause, with the same filters
+// but for dynamic ones. Samples draw their rows independently, so sampled scans never do, and ordered
+// scans read their own sorted query.
+bool ReadSameRows(LogicalGet &left, LogicalGet &right) {
+	auto &left_data = left.bind_data->Cast<PostHogRemoteScanBindData>();
+	auto &right_data = right.bind_data->Cast<PostHogRemoteScanBindData>();
+	if (left_data.sample_options || right_data.sample_options || !left_data.orders.empty() ||
+	    !right_data.orders.empty()) {
+		return false;
+	}
+	return &left_data.catalog == &right_data.catalog && &left_data.table == &right_data.table &&
+	       left_data.at_clause_sql == right_data.at_clause_sql &&
+	       left_data.pushed_conditions == right_data.pushed_conditions &&
+	       ContainsStaticFilters(left.table_filters, right.table_filters) &&
+	       ContainsStaticFilters(right.table_filters, left.table_filters);
+}
+
+// shared_scan_bytes: scans the pushdown passes left in the plan that read the same rows of a table
+// (self-joins the server cannot run, UNION ALL branches over one table, a CTE inlined twice) share one
+// remote query of the union of their columns, whose batches are fanned out to all of them.
+void ShareRemoteScans(LogicalOperator &root) {
+	vector<reference<LogicalGet>> scans;
+	CollectRemoteScans(root, scans);
+	vector<bool> grouped(scans.size(), false);
+	for (idx_t i = 0; i < scans.size(); i++) {
+		auto &bind_data = scans[i].get().bind_data->Cast<PostHogRemoteScanBindData>();
+		auto buffer_bytes = bind_data.catalog.GetConfig().shared_scan_bytes;
+		if (grouped[i] || buffer_bytes == 0) {
+			continue;
+		}
+		vector<reference<LogicalGet>> group {scans[i]};
+		for (idx_t j = i + 1; j < scans.size(); j++) {
+			if (!grouped[j] && ReadSameRows(scans[i], scans[j])) {
+				group.push_back(scans[j]);
+				grouped[j] = true;
+			}
+		}
+		if (group.size() < 2) {
+			continue;
+		}
+		std::set<idx_t> columns;
+		for (auto &get : group) {
+			for (auto &column : get.get().GetColumnIds()) {
+				auto col_idx = column.GetPrimaryIndex();
+				if (col_idx < bind_data.column_names.size()) {
+					columns.insert(col_idx);
+				}
+			}
+		}
+		auto shared_scan = std::make_shared<PostHogSharedScan>(vector<idx_t>(columns.begin(), columns.end()),
+		                                                       group.size(), buffer_bytes);
+		for (auto &get : group) {
+			get.get().bind_data->Cast<PostHogRemoteScanBindData>().shared_scan = shared_scan;
+		}
+	}
+}
+
+// One remote read of a plan: a remote scan (all the scans of one shared scan are one read), a
+// pushed-down query or an upload join.
+struct RemoteRead {
+	PostHogCatalog &catalog;
+	const void *source;
+	bool &shared_snapshot;
+};
+
+void CollectRemoteReads(LogicalOperator &op, vector<RemoteRead> &reads) {
+	for (auto &child : op.children) {
+		CollectRemoteReads(*child, reads);
+	}
+	if (auto bind_data = PostHogRemoteQueryBuilder::GetRemoteScan(op)) {
+		const void *source = bind_data->shared_scan ? bind_data->shared_scan.get() : static_cast<void *>(&op);
+		reads.push_back({bind_data->catalog, source, bind_data->shared_snapshot});
+	} else if (IsRemoteQuery(op)) {
+		auto &bind_data = op.Cast<LogicalGet>().bind_data->Cast<PostHogRemoteQueryBindData>();
+		reads.push_back({bind_data.catalog, &op, bind_data.shared_snapshot});
+	} else if (op.type == LogicalOperatorType::LOGICAL_EXTENSION_OPERATOR) {
+		auto upload_join = dynamic_cast<LogicalPostHogUploadJoin *>(&op);
+		if (upload_join) {
+			reads.push_back({upload_join->catalog, &op, upload_join->shared_snapshot});
+		}
+	}
+}
+
+// Reads in auto-commit mode run outside any remote transaction, so two reads of one statement (a
+// self-join or a subquery the server could not run as one query) could see different snapshots of
+// the catalog. When the plan reads a catalog more than once, its reads share a remote transaction.
+void ShareSnapshots(LogicalOperator &root) {
+	vector<RemoteRead> reads;
+	CollectRemoteReads(root, reads);
+	for (auto &read : reads) {
+		for (auto &other : reads) {
+			if (&other.catalog == &read.catalog && other.source != read.source) {
+				read.shared_snapshot = true;
+				break;
+			}
+		}
+	}
+}
+
+// Runs last: the scans left in the plan have their final projection and filters, so the SQL
+// shown by EXPLAIN matches what they send.
+void SetExplainSQL(LogicalOperator &op) {
+	for (auto &child : op.children) {
+		SetExplainSQL(*child);
+	}
+	if (PostHogRemoteQueryBuilder::GetRemoteScan(op)) {
+		PostHogRemoteScan::SetExplainSQL(op.Cast<LogicalGet>());
+	}
+}
+
+} // namespace
+
+OptimizerExtension PostHogOptimizer::GetExtension() {
+	OptimizerExtension extension;
+	extension.optimize_function = Optimize;
+	return extension;
+}
+
+void PostHogOptimizer::Optimize(OptimizerExtensionInput &input, unique_ptr<LogicalOperator> &plan) {
+	PushdownContext pushdown {input.optimizer.binder, plan};
+	PushDown(pushdown, plan);
+	TryPushDownOrder(pushdown, plan);
+	ShareRemoteScans(*plan);
+	ShareSnapshots(*plan);
+	SetExplainSQL(*plan);
+}
+
+} // namespace duckdb
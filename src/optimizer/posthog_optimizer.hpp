@@ -0,0 +1,25 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// optimizer/posthog_optimizer.hpp
+//
+// Optimizer extension pushing work from local operators into remote SQL
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb/optimizer/optimizer_extension.hpp"
+
+namespace duckdb {
+
+// Runs after DuckDB's built-in optimizers, once filters and projections have been pushed into
+// posthog_remote_scan. Operators that can be answered entirely by the server are replaced by a
+// posthog_remote_query scan of the equivalent remote SELECT.
+class PostHogOptimizer {
+public:
+	static OptimizerExtension GetExtension();
+
+	static void Optimize(OptimizerExtensionInput &input, unique_ptr<LogicalOperator> &plan);
+};
+
+} // namespace duckdb
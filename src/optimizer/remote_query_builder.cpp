@@ -0,0 +1,631 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// optimizer/remote_query_builder.cpp
+//
+// Renders logical plan fragments over posthog_remote_scan as remote SQL
+//===----------------------------------------------------------------------===//
+
+#include "optimizer/remote_query_builder.hpp"
+
+#include "catalog/posthog_catalog.hpp"
+#include "catalog/remote_query.hpp"
+#include "catalog/remote_scan.hpp"
+#include "execution/posthog_sql_utils.hpp"
+
+#include "duckdb/common/case_insensitive_map.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/planner/expression/list.hpp"
+#include "duckdb/planner/operator/logical_any_join.hpp"
+#include "duckdb/planner/operator/logical_comparison_join.hpp"
+#include "duckdb/planner/operator/logical_filter.hpp"
+#include "duckdb/planner/operator/logical_get.hpp"
+#include "duckdb/planner/operator/logical_projection.hpp"
+
+namespace duckdb {
+
+namespace {
+
+// Scalar functions whose remote evaluation is identical to local evaluation. Anything volatile,
+// session-dependent or extension-provided stays local.
+bool IsPushableScalarFunction(const string &name) {
+	static const case_insensitive_set_t functions {
+	    // numeric
+	    "abs", "ceil", "ceiling", "floor", "round", "greatest", "least",
+	    // string
+	    "lower", "upper", "length", "trim", "ltrim", "rtrim", "substring", "concat", "prefix", "suffix", "contains",
+	    "starts_with", "strpos", "replace", "left", "right", "regexp_matches", "nullif",
+	    // date/time
+	    "date_trunc", "date_part", "year", "month", "day", "hour", "minute", "second", "epoch", "strftime",
+	    // nested and JSON (->, ->>)
+	    "struct_extract", "list_contains", "json_extract", "json_extract_string", "json_exists"};
+	return functions.count(name) > 0;
+}
+
+// Bound names of the LIKE family, which DuckDB binds as functions.
+bool GetLikeOperator(const string &name, string &result) {
+	if (name == "~~") {
+		result = "LIKE";
+	} else if (name == "!~~") {
+		result = "NOT LIKE";
+	} else if (name == "~~*") {
+		result = "ILIKE";
+	} else if (name == "!~~*") {
+		result = "NOT ILIKE";
+	} else {
+		return false;
+	}
+	return true;
+}
+
+bool IsInfixOperator(const string &name) {
+	return name == "+" || name == "-" || name == "*" || name == "/" || name == "//" || name == "%" || name == "||";
+}
+
+// Aggregates AggregateToSQL renders, by their bound name.
+bool IsPushableAggregate(const string &name) {
+	return name == "count_star" || name == "count" || name == "sum" || name == "sum_no_overflow" || name == "min" ||
+	       name == "max" || name == "avg";
+}
+
+// TIMESTAMP WITH TIME ZONE arithmetic and conversions depend on the TimeZone setting, which
+// the server does not share with the local session.
+bool DependsOnTimeZone(const LogicalType &type) {
+	return type.id() == LogicalTypeId::TIMESTAMP_TZ || type.id() == LogicalTypeId::TIME_TZ;
+}
+
+bool TypeToSQL(const LogicalType &type, string &result) {
+	// Enum and user type names are local catalog objects; they may not exist remotely.
+	if (type.id() == LogicalTypeId::ENUM || type.id() == LogicalTypeId::USER || type.HasAlias()) {
+		return false;
+	}
+	result = type.ToString();
+	return true;
+}
+
+bool ConstantToSQL(const Value &value, string &result) {
+	string type_sql;
+	if (!TypeToSQL(value.type(), type_sql)) {
+		return false;
+	}
+	if (value.IsNull()) {
+		result = "CAST(NULL AS " + type_sql + ")";
+		return true;
+	}
+	switch (value.type().id()) {
+	case LogicalTypeId::BOOLEAN:
+	case LogicalTypeId::INTEGER:
+	case LogicalTypeId::VARCHAR:
+		// The remote binder infers the same type for these literals.
+		result = value.ToSQLString();
+		return true;
+	default:
+		result = "CAST(" + value.ToSQLString() + " AS " + type_sql + ")";
+		return true;
+	}
+}
+
+} // namespace
+
+optional_ptr<PostHogRemoteScanBindData> PostHogRemoteQueryBuilder::GetRemoteScan(LogicalOperator &op) {
+	if (op.type != LogicalOperatorType::LOGICAL_GET) {
+		return nullptr;
+	}
+	auto &get = op.Cast<LogicalGet>();
+	if (get.function.name != "posthog_remote_scan" || !get.bind_data) {
+		return nullptr;
+	}
+	return &get.bind_data->Cast<PostHogRemoteScanBindData>();
+}
+
+bool PostHogRemoteQueryBuilder::IsRemotelyEvaluable(const Expression &expr) {
+	PostHogRemoteQueryBuilder builder;
+	builder.any_column_ = true;
+	string sql;
+	if (expr.GetExpressionClass() == ExpressionClass::BOUND_AGGREGATE) {
+		return builder.AggregateToSQL(expr.Cast<BoundAggregateExpression>(), sql);
+	}
+	return builder.ExpressionToSQL(expr, sql);
+}
+
+bool PostHogRemoteQueryBuilder::IsRemoteFunctionName(const string &name) {
+	string like_operator;
+	return IsPushableScalarFunction(name) || IsInfixOperator(name) || GetLikeOperator(name, like_operator) ||
+	       IsPushableAggregate(name);
+}
+
+bool PostHogRemoteQueryBuilder::IsRemoteCastType(const LogicalType &type) {
+	string type_sql;
+	return !DependsOnTimeZone(type) && TypeToSQL(type, type_sql);
+}
+
+PostHogCatalog &PostHogRemoteQueryBuilder::GetCatalog() const {
+	D_ASSERT(catalog_);
+	return *catalog_;
+}
+
+bool PostHogRemoteQueryBuilder::AddSource(LogicalOperator &op) {
+	switch (op.type) {
+	case LogicalOperatorType::LOGICAL_GET: {
+		auto &get = op.Cast<LogicalGet>();
+		if (get.function.name == PostHogRemoteQuery::NAME) {
+			return AddRemoteQuery(get);
+		}
+		return AddGet(get);
+	}
+	case LogicalOperatorType::LOGICAL_FILTER: {
+		if (!AddSource(*op.children[0])) {
+			return false;
+		}
+		// A projection_map only hides child bindings, so the column SQL stays valid.
+		for (auto &expr : op.expressions) {
+			string condition;
+			if (!ExpressionToSQL(*expr, condition)) {
+				return false;
+			}
+			conditions_.push_back(std::move(condition));
+		}
+		return true;
+	}
+	case LogicalOperatorType::LOGICAL_PROJECTION: {
+		auto &projection = op.Cast<LogicalProjection>();
+		if (!AddSource(*op.children[0])) {
+			return false;
+		}
+		column_binding_map_t<string> projected;
+		for (idx_t i = 0; i < projection.expressions.size(); i++) {
+			string sql;
+			if (!ExpressionToSQL(*projection.expressions[i], sql)) {
+				return false;
+			}
+			projected[ColumnBinding(projection.table_index, i)] = std::move(sql);
+		}
+		columns_ = std::move(projected);
+		return true;
+	}
+	case LogicalOperatorType::LOGICAL_COMPARISON_JOIN:
+	case LogicalOperatorType::LOGICAL_ANY_JOIN:
+		// Cross products are never pushed: the server would send N*M rows instead of N+M.
+		return AddJoin(op);
+	default:
+		return false;
+	}
+}
+
+void PostHogRemoteQueryBuilder::AddCondition(string condition) {
+	conditions_.push_back(std::move(condition));
+}
+
+bool PostHogRemoteQueryBuilder::AddJoinWithUpload(LogicalOperator &join, idx_t upload_side,
+                                                  const string &table_sql) {
+	if (join.type != LogicalOperatorType::LOGICAL_COMPARISON_JOIN &&
+	    join.type != LogicalOperatorType::LOGICAL_ANY_JOIN) {
+		return false;
+	}
+	return AddJoin(join, upload_side, table_sql);
+}
+
+bool PostHogRemoteQueryBuilder::AddUpload(LogicalOperator &op, const string &table_sql) {
+	op.ResolveOperatorTypes();
+	auto bindings = op.GetColumnBindings();
+	for (idx_t i = 0; i < bindings.size(); i++) {
+		// The uploaded column must come back as the same type for the remote join to compare like the
+		// local one.
+		string type_sql;
+		if (!TypeToSQL(op.types[i], type_sql)) {
+			return false;
+		}
+		columns_[bindings[i]] = "c" + to_string(i);
+	}
+	from_clause_ = table_sql;
+	return true;
+}
+
+bool PostHogRemoteQueryBuilder::AddJoin(LogicalOperator &op, optional_idx upload_side, const string &table_sql) {
+	PostHogRemoteQueryBuilder left;
+	PostHogRemoteQueryBuilder right;
+	auto add_side = [&](PostHogRemoteQueryBuilder &side, idx_t index) {
+		if (upload_side.IsValid() && upload_side.GetIndex() == index) {
+			return side.AddUpload(*op.children[index], table_sql);
+		}
+		return side.AddSource(*op.children[index]);
+	};
+	if (!add_side(left, 0) || !add_side(right, 1)) {
+		return false;
+	}
+	if (upload_side.IsValid()) {
+		// The uploaded input has no catalog; the remote one decides where the query runs.
+		catalog_ = left.catalog_ ? left.catalog_ : right.catalog_;
+	} else if (left.catalog_.get() != right.catalog_.get()) {
+		return false;
+	} else {
+		catalog_ = left.catalog_;
+	}
+
+	string keyword;
+	switch (op.Cast<LogicalJoin>().join_type) {
+	case JoinType::INNER:
+		keyword = "JOIN";
+		break;
+	case JoinType::LEFT:
+		keyword = "LEFT JOIN";
+		break;
+	case JoinType::RIGHT:
+		keyword = "RIGHT JOIN";
+		break;
+	case JoinType::OUTER:
+		keyword = "FULL OUTER JOIN";
+		break;
+	case JoinType::SEMI:
+		keyword = "SEMI JOIN";
+		break;
+	case JoinType::ANTI:
+		keyword = "ANTI JOIN";
+		break;
+	default:
+		// MARK, SINGLE and RIGHT_SEMI/RIGHT_ANTI joins have no direct SQL spelling.
+		return false;
+	}
+
+	// Each side becomes a derived table, so its own filters and column names stay scoped to it.
+	from_clause_ = left.ToDerivedTable("t0", columns_) + " " + keyword + " " + right.ToDerivedTable("t1", columns_);
+
+	vector<string> conditions;
+	if (op.type == LogicalOperatorType::LOGICAL_COMPARISON_JOIN) {
+		for (auto &condition : op.Cast<LogicalComparisonJoin>().conditions) {
+			string lhs;
+			string rhs;
+			if (!ExpressionToSQL(*condition.left, lhs) || !ExpressionToSQL(*condition.right, rhs)) {
+				return false;
+			}
+			try {
+				conditions.push_back("(" + lhs + " " + ComparisonOperatorToSQL(condition.comparison) + " " + rhs +
+				                     ")");
+			} catch (const NotImplementedException &) {
+				return false;
+			}
+		}
+	} else if (op.type == LogicalOperatorType::LOGICAL_ANY_JOIN) {
+		string condition;
+		if (!ExpressionToSQL(*op.Cast<LogicalAnyJoin>().condition, condition)) {
+			return false;
+		}
+		conditions.push_back(std::move(condition));
+	}
+	from_clause_ += " ON " + (conditions.empty() ? string("TRUE") : StringUtil::Join(conditions, " AND "));
+	return true;
+}
+
+string PostHogRemoteQueryBuilder::ToDerivedTable(const string &alias, column_binding_map_t<string> &columns) const {
+	vector<string> select_list;
+	for (auto &entry : columns_) {
+		auto name = "c" + to_string(select_list.size());
+		select_list.push_back(entry.second + " AS " + name);
+		columns[entry.first] = alias + "." + name;
+	}
+	if (select_list.empty()) {
+		// Row-id-only side (e.g. an EXISTS probe): keep the SELECT list valid.
+		select_list.push_back("NULL AS c0");
+	}
+	return "(" + Build(select_list) + ") AS " + alias;
+}
+
+bool PostHogRemoteQueryBuilder::AddGet(LogicalGet &get) {
+	auto bind_data = GetRemoteScan(get);
+	// An ordered scan's rows are only in order as the scan emits them; a query built over it would lose
+	// the order.
+	if (!bind_data || !bind_data->catalog.GetConfig().pushdown || get.extra_info.sample_options ||
+	    !bind_data->orders.empty()) {
+		return false;
+	}
+	catalog_ = &bind_data->catalog;
+	from_clause_ = bind_data->GetRemoteTableRef();
+	auto sample_clause = bind_data->GetSampleClause();
+	if (!sample_clause.empty()) {
+		from_clause_ += " " + sample_clause;
+	}
+
+	auto &column_ids = get.GetColumnIds();
+	auto bindings = get.GetColumnBindings();
+	for (idx_t i = 0; i < bindings.size(); i++) {
+		auto &column = column_ids[get.projection_ids.empty() ? i : get.projection_ids[i]];
+		// Row-id placeholders (count(*) scans) have no remote column; they are never referenced
+		// by the expressions above, so leaving them unmapped is enough.
+		if (column.HasChildren() || column.GetPrimaryIndex() >= bind_data->column_names.size()) {
+			continue;
+		}
+		columns_[bindings[i]] = QuoteIdent(bind_data->column_names[column.GetPrimaryIndex()]);
+	}
+
+	for (auto &condition : bind_data->pushed_conditions) {
+		conditions_.push_back(condition);
+	}
+	// Filters DuckDB pushed into the scan are keyed by table column index.
+	for (auto &entry : get.table_filters.filters) {
+		if (entry.first >= bind_data->column_names.size()) {
+			return false;
+		}
+		string condition;
+		try {
+			condition = FilterToSQL(*entry.second, QuoteIdent(bind_data->column_names[entry.first]));
+		} catch (const NotImplementedException &) {
+			return false;
+		}
+		if (!condition.empty()) {
+			conditions_.push_back(std::move(condition));
+		}
+	}
+	return true;
+}
+
+bool PostHogRemoteQueryBuilder::AddRemoteQuery(LogicalGet &get) {
+	auto &bind_data = get.bind_data->Cast<PostHogRemoteQueryBindData>();
+	if (!get.table_filters.filters.empty()) {
+		return false;
+	}
+	catalog_ = &bind_data.catalog;
+
+	// Result columns of the nested query are addressed by position, whatever they were named.
+	vector<string> aliases;
+	for (idx_t i = 0; i < bind_data.types.size(); i++) {
+		aliases.push_back("c" + to_string(i));
+	}
+	from_clause_ = "(" + bind_data.sql + ") AS posthog_subquery(" + StringUtil::Join(aliases, ", ") + ")";
+
+	auto &column_ids = get.GetColumnIds();
+	auto bindings = get.GetColumnBindings();
+	for (idx_t i = 0; i < bindings.size(); i++) {
+		auto column = column_ids[get.projection_ids.empty() ? i : get.projection_ids[i]].GetPrimaryIndex();
+		if (column >= aliases.size()) {
+			return false;
+		}
+		columns_[bindings[i]] = aliases[column];
+	}
+	return true;
+}
+
+bool PostHogRemoteQueryBuilder::ColumnToSQL(const ColumnBinding &binding, string &result) const {
+	if (any_column_) {
+		result = "#" + to_string(binding.table_index) + "." + to_string(binding.column_index);
+		return true;
+	}
+	auto it = columns_.find(binding);
+	if (it == columns_.end()) {
+		return false;
+	}
+	result = it->second;
+	return true;
+}
+
+bool PostHogRemoteQueryBuilder::ExpressionToSQL(const Expression &expr, string &result) const {
+	switch (expr.GetExpressionClass()) {
+	case ExpressionClass::BOUND_COLUMN_REF:
+		return ColumnToSQL(expr.Cast<BoundColumnRefExpression>().binding, result);
+	case ExpressionClass::BOUND_CONSTANT:
+		return ConstantToSQL(expr.Cast<BoundConstantExpression>().value, result);
+	case ExpressionClass::BOUND_CAST: {
+		auto &cast = expr.Cast<BoundCastExpression>();
+		string child;
+		string type_sql;
+		if (cast.return_type != cast.child->return_type &&
+		    (DependsOnTimeZone(cast.return_type) || DependsOnTimeZone(cast.child->return_type))) {
+			return false;
+		}
+		if (!ExpressionToSQL(*cast.child, child) || !TypeToSQL(cast.return_type, type_sql)) {
+			return false;
+		}
+		result = string(cast.try_cast ? "TRY_CAST(" : "CAST(") + child + " AS " + type_sql + ")";
+		return true;
+	}
+	case ExpressionClass::BOUND_COMPARISON: {
+		auto &comparison = expr.Cast<BoundComparisonExpression>();
+		string left;
+		string right;
+		if (!ExpressionToSQL(*comparison.left, left) || !ExpressionToSQL(*comparison.right, right)) {
+			return false;
+		}
+		result = "(" + left + " " + ComparisonOperatorToSQL(comparison.GetExpressionType()) + " " + right + ")";
+		return true;
+	}
+	case ExpressionClass::BOUND_CONJUNCTION: {
+		auto &conjunction = expr.Cast<BoundConjunctionExpression>();
+		auto separator = conjunction.GetExpressionType() == ExpressionType::CONJUNCTION_AND ? " AND " : " OR ";
+		vector<string> children;
+		for (auto &child : conjunction.children) {
+			string child_sql;
+			if (!ExpressionToSQL(*child, child_sql)) {
+				return false;
+			}
+			children.push_back(std::move(child_sql));
+		}
+		result = "(" + StringUtil::Join(children, separator) + ")";
+		return true;
+	}
+	case ExpressionClass::BOUND_BETWEEN: {
+		auto &between = expr.Cast<BoundBetweenExpression>();
+		string input;
+		string lower;
+		string upper;
+		if (!ExpressionToSQL(*between.input, input) || !ExpressionToSQL(*between.lower, lower) ||
+		    !ExpressionToSQL(*between.upper, upper)) {
+			return false;
+		}
+		result = "(" + input + (between.lower_inclusive ? " >= " : " > ") + lower + " AND " + input +
+		         (between.upper_inclusive ? " <= " : " < ") + upper + ")";
+		return true;
+	}
+	case ExpressionClass::BOUND_OPERATOR: {
+		auto &op = expr.Cast<BoundOperatorExpression>();
+		vector<string> children;
+		for (auto &child : op.children) {
+			string child_sql;
+			if (!ExpressionToSQL(*child, child_sql)) {
+				return false;
+			}
+			children.push_back(std::move(child_sql));
+		}
+		switch (op.GetExpressionType()) {
+		case ExpressionType::OPERATOR_NOT:
+			result = "(NOT " + children[0] + ")";
+			return true;
+		case ExpressionType::OPERATOR_IS_NULL:
+			result = "(" + children[0] + " IS NULL)";
+			return true;
+		case ExpressionType::OPERATOR_IS_NOT_NULL:
+			result = "(" + children[0] + " IS NOT NULL)";
+			return true;
+		case ExpressionType::OPERATOR_COALESCE:
+			result = "COALESCE(" + StringUtil::Join(children, ", ") + ")";
+			return true;
+		case ExpressionType::COMPARE_IN:
+		case ExpressionType::COMPARE_NOT_IN: {
+			auto input = children[0];
+			children.erase(children.begin());
+			auto keyword = op.GetExpressionType() == ExpressionType::COMPARE_IN ? " IN (" : " NOT IN (";
+			result = "(" + input + keyword + StringUtil::Join(children, ", ") + "))";
+			return true;
+		}
+		default:
+			return false;
+		}
+	}
+	case ExpressionClass::BOUND_CASE: {
+		auto &case_expr = expr.Cast<BoundCaseExpression>();
+		result = "CASE";
+		for (auto &check : case_expr.case_checks) {
+			string when_sql;
+			string then_sql;
+			if (!ExpressionToSQL(*check.when_expr, when_sql) || !ExpressionToSQL(*check.then_expr, then_sql)) {
+				return false;
+			}
+			result += " WHEN " + when_sql + " THEN " + then_sql;
+		}
+		string else_sql;
+		if (!ExpressionToSQL(*case_expr.else_expr, else_sql)) {
+			return false;
+		}
+		result += " ELSE " + else_sql + " END";
+		return true;
+	}
+	case ExpressionClass::BOUND_FUNCTION: {
+		auto &function = expr.Cast<BoundFunctionExpression>();
+		auto &name = function.function.name;
+		vector<string> children;
+		for (auto &child : function.children) {
+			if (DependsOnTimeZone(child->return_type)) {
+				return false;
+			}
+			string child_sql;
+			if (!ExpressionToSQL(*child, child_sql)) {
+				return false;
+			}
+			children.push_back(std::move(child_sql));
+		}
+		string like_operator;
+		if (GetLikeOperator(name, like_operator)) {
+			if (children.size() != 2) {
+				return false;
+			}
+			result = "(" + children[0] + " " + like_operator + " " + children[1] + ")";
+			return true;
+		}
+		if (IsInfixOperator(name)) {
+			if (children.size() == 1 && name == "-") {
+				result = "(-" + children[0] + ")";
+				return true;
+			}
+			if (children.size() != 2) {
+				return false;
+			}
+			result = "(" + children[0] + " " + name + " " + children[1] + ")";
+			return true;
+		}
+		if (!IsPushableScalarFunction(name)) {
+			return false;
+		}
+		result = name + "(" + StringUtil::Join(children, ", ") + ")";
+		return true;
+	}
+	default:
+		return false;
+	}
+}
+
+bool PostHogRemoteQueryBuilder::AggregateToSQL(const BoundAggregateExpression &aggr, string &result) const {
+	if (aggr.order_bys) {
+		return false;
+	}
+	auto &name = aggr.function.name;
+	if (name == "count_star") {
+		result = "count(*)";
+	} else {
+		string remote_name;
+		if (name == "count" || name == "sum" || name == "min" || name == "max" || name == "avg") {
+			remote_name = name;
+		} else if (name == "sum_no_overflow") {
+			// Statistics-driven variant of sum. The server returns sum's wider type, which
+			// PostHogArrowChunkConverter casts to the narrower bound type when converting results.
+			remote_name = "sum";
+		} else {
+			return false;
+		}
+		if (aggr.children.size() != 1) {
+			return false;
+		}
+		string child;
+		if (!ExpressionToSQL(*aggr.children[0], child)) {
+			return false;
+		}
+		result = remote_name + "(" + (aggr.IsDistinct() ? "DISTINCT " : "") + child + ")";
+	}
+	if (aggr.filter) {
+		string filter;
+		if (!ExpressionToSQL(*aggr.filter, filter)) {
+			return false;
+		}
+		result += " FILTER (WHERE " + filter + ")";
+	}
+	return true;
+}
+
+bool PostHogRemoteQueryBuilder::OrderToSQL(const BoundOrderByNode &order, string &result) const {
+	string expr;
+	if (!ExpressionToSQL(*order.expression, expr)) {
+		return false;
+	}
+	// The binder has resolved the default null order; spell both out so the server's own defaults
+	// cannot change the result.
+	if (order.type != OrderType::ASCENDING && order.type != OrderType::DESCENDING) {
+		return false;
+	}
+	if (order.null_order != OrderByNullType::NULLS_FIRST && order.null_order != OrderByNullType::NULLS_LAST) {
+		return false;
+	}
+	result = expr + (order.type == OrderType::ASCENDING ? " ASC" : " DESC") +
+	         (order.null_order == OrderByNullType::NULLS_FIRST ? " NULLS FIRST" : " NULLS LAST");
+	return true;
+}
+
+string PostHogRemoteQueryBuilder::Build(const vector<string> &select_list, const vector<string> &group_by,
+                                        const vector<string> &order_by, optional_idx limit, idx_t offset) const {
+	string sql = "SELECT " + StringUtil::Join(select_list, ", ") + " FROM " + from_clause_;
+	if (!conditions_.empty()) {
+		sql += " WHERE " + StringUtil::Join(conditions_, " AND ");
+	}
+	if (!group_by.empty()) {
+		sql += " GROUP BY " + StringUtil::Join(group_by, ", ");
+	}
+	if (!order_by.empty()) {
+		sql += " ORDER BY " + StringUtil::Join(order_by, ", ");
+	}
+	if (limit.IsValid()) {
+		sql += " LIMIT " + to_string(limit.GetIndex());
+	}
+	if (offset > 0) {
+		sql += " OFFSET " + to_string(offset);
+	}
+	return sql;
+}
+
+} // namespace duckdb
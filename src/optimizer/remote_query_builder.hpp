@@ -0,0 +1,87 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// optimizer/remote_query_builder.hpp
+//
+// Renders logical plan fragments over posthog_remote_scan as remote SQL
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb/common/optional_idx.hpp"
+#include "duckdb/planner/bound_result_modifier.hpp"
+#include "duckdb/planner/column_binding_map.hpp"
+#include "duckdb/planner/expression.hpp"
+#include "duckdb/planner/logical_operator.hpp"
+
+namespace duckdb {
+
+class BoundAggregateExpression;
+class LogicalGet;
+class PostHogCatalog;
+struct PostHogRemoteScanBindData;
+
+// Collects the FROM clause, WHERE conjuncts and per-binding column SQL of a plan fragment that
+// only reads tables of one PostHog catalog, so that an operator above it can be rewritten into
+// one remote SELECT. Everything is rendered as DuckDB SQL, since the server runs DuckDB too.
+class PostHogRemoteQueryBuilder {
+public:
+	// Returns the bind data if op is a posthog_remote_scan, else nullptr.
+	static optional_ptr<PostHogRemoteScanBindData> GetRemoteScan(LogicalOperator &op);
+
+	// True when expr (a scalar or aggregate expression) is in the subset ExpressionToSQL and
+	// AggregateToSQL render, i.e. evaluates identically on the server, whatever its columns are.
+	static bool IsRemotelyEvaluable(const Expression &expr);
+	// The same allowlists for statements sent as SQL text: function names as written (including
+	// operators and aggregates), and types a cast may target.
+	static bool IsRemoteFunctionName(const string &name);
+	static bool IsRemoteCastType(const LogicalType &type);
+
+	// Absorbs op, a tree of filters, projections and joins over posthog_remote_scans of one
+	// catalog (or over the posthog_remote_query of an earlier pushdown, which becomes a subquery).
+	// Returns false if any part of the tree (including the scans' pushed-down filters) has no
+	// remote rendering, if it spans catalogs, if it contains a cross product, or if pushdown is
+	// disabled for the catalog.
+	bool AddSource(LogicalOperator &op);
+
+	// Absorbs join, a join whose input upload_side is evaluated locally and uploaded to the remote
+	// table table_sql, with one column c0, c1, ... per output binding of that input. The other input
+	// must be a source AddSource accepts.
+	bool AddJoinWithUpload(LogicalOperator &join, idx_t upload_side, const string &table_sql);
+
+	// Adds a WHERE conjunct, already rendered over the source's bindings.
+	void AddCondition(string condition);
+
+	// Render expressions over the bindings of the absorbed source. Return false for expressions
+	// outside the supported subset; result is unspecified in that case.
+	bool ExpressionToSQL(const Expression &expr, string &result) const;
+	bool AggregateToSQL(const BoundAggregateExpression &aggr, string &result) const;
+	bool OrderToSQL(const BoundOrderByNode &order, string &result) const;
+	bool ColumnToSQL(const ColumnBinding &binding, string &result) const;
+
+	// SELECT <select_list> FROM <source> [WHERE ...] [GROUP BY <group_by>] [ORDER BY <order_by>]
+	// [LIMIT <limit>] [OFFSET <offset>]
+	string Build(const vector<string> &select_list, const vector<string> &group_by = {},
+	             const vector<string> &order_by = {}, optional_idx limit = optional_idx(), idx_t offset = 0) const;
+
+	PostHogCatalog &GetCatalog() const;
+
+private:
+	bool AddGet(LogicalGet &get);
+	bool AddRemoteQuery(LogicalGet &get);
+	bool AddJoin(LogicalOperator &join, optional_idx upload_side = optional_idx(), const string &table_sql = "");
+	bool AddUpload(LogicalOperator &op, const string &table_sql);
+
+	// Renders this source as a derived table named alias and records, in columns, the SQL that
+	// each of its bindings has outside of it.
+	string ToDerivedTable(const string &alias, column_binding_map_t<string> &columns) const;
+
+	optional_ptr<PostHogCatalog> catalog_;
+	// IsRemotelyEvaluable: render every column reference, whatever its binding.
+	bool any_column_ = false;
+	string from_clause_;
+	vector<string> conditions_;
+	column_binding_map_t<string> columns_;
+};
+
+} // namespace duckdb
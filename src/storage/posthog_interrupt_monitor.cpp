@@ -0,0 +1,80 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// storage/posthog_interrupt_monitor.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/posthog_interrupt_monitor.hpp"
+
+#include "duckdb/main/client_context.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+namespace duckdb {
+
+namespace {
+// How quickly an interrupt reaches the server; each poll is one atomic load per watched context.
+constexpr std::chrono::milliseconds POLL_INTERVAL(20);
+} // namespace
+
+PostHogInterruptMonitor::Watch::Watch(PostHogInterruptMonitor &monitor, std::shared_ptr<WatchedContext> entry)
+    : monitor_(monitor), entry_(std::move(entry)) {
+}
+
+PostHogInterruptMonitor::Watch::~Watch() {
+	monitor_.Remove(*entry_);
+}
+
+PostHogInterruptMonitor::~PostHogInterruptMonitor() {
+	{
+		std::lock_guard<std::mutex> guard(lock_);
+		stopping_ = true;
+	}
+	watching_.notify_all();
+	if (poller_.joinable()) {
+		poller_.join();
+	}
+}
+
+std::unique_ptr<PostHogInterruptMonitor::Watch> PostHogInterruptMonitor::Start(ClientContext &context) {
+	auto entry = std::make_shared<WatchedContext>();
+	entry->context = &context;
+	{
+		std::lock_guard<std::mutex> guard(lock_);
+		entries_.push_back(entry);
+		if (!poller_.joinable()) {
+			poller_ = std::thread([this]() { PollLoop(); });
+		}
+	}
+	watching_.notify_all();
+	return std::make_unique<Watch>(*this, std::move(entry));
+}
+
+void PostHogInterruptMonitor::Remove(const WatchedContext &entry) {
+	std::lock_guard<std::mutex> guard(lock_);
+	entries_.erase(std::remove_if(entries_.begin(), entries_.end(),
+	                              [&](const std::shared_ptr<WatchedContext> &watched) {
+		                              return watched.get() == &entry;
+	                              }),
+	               entries_.end());
+}
+
+void PostHogInterruptMonitor::PollLoop() {
+	std::unique_lock<std::mutex> guard(lock_);
+	while (!stopping_) {
+		if (entries_.empty()) {
+			watching_.wait(guard, [&]() { return stopping_ || !entries_.empty(); });
+			continue;
+		}
+		for (auto &entry : entries_) {
+			if (entry->context->interrupted && !entry->source.token().IsStopRequested()) {
+				entry->source.RequestStop();
+			}
+		}
+		watching_.wait_for(guard, POLL_INTERVAL, [&]() { return stopping_; });
+	}
+}
+
+} // namespace duckdb
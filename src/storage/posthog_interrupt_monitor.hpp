@@ -0,0 +1,68 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// storage/posthog_interrupt_monitor.hpp
+//
+// Turns DuckDB query interrupts into Arrow stop requests for in-flight Flight calls
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <arrow/util/cancel.h>
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace duckdb {
+
+class ClientContext;
+
+// DuckDB only raises a flag when a query is interrupted (Ctrl-C, statement timeout), which a thread
+// blocked in a Flight call never looks at. One background thread per attached catalog polls the
+// flag of every watched context and stops its StopSource, which cancels the Flight calls made
+// with its token. The thread sleeps while nothing is watched.
+class PostHogInterruptMonitor {
+public:
+	PostHogInterruptMonitor() = default;
+	~PostHogInterruptMonitor();
+
+	PostHogInterruptMonitor(const PostHogInterruptMonitor &) = delete;
+	PostHogInterruptMonitor &operator=(const PostHogInterruptMonitor &) = delete;
+
+	struct WatchedContext {
+		ClientContext *context;
+		arrow::StopSource source;
+	};
+
+	// Watches context until the returned handle is destroyed; the context must outlive it.
+	class Watch {
+	public:
+		Watch(PostHogInterruptMonitor &monitor, std::shared_ptr<WatchedContext> entry);
+		~Watch();
+
+		arrow::StopToken Token() const {
+			return entry_->source.token();
+		}
+
+	private:
+		PostHogInterruptMonitor &monitor_;
+		std::shared_ptr<WatchedContext> entry_;
+	};
+
+	std::unique_ptr<Watch> Start(ClientContext &context);
+
+private:
+	void Remove(const WatchedContext &entry);
+	void PollLoop();
+
+	std::mutex lock_;
+	std::condition_variable watching_;
+	std::vector<std::shared_ptr<WatchedContext>> entries_;
+	bool stopping_ = false;
+	std::thread poller_;
+};
+
+} // namespace duckdb
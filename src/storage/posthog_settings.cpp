@@ -0,0 +1,82 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// storage/posthog_settings.cpp
+//
+// SET duckhog_<option> defaults for the performance options of hog: connection strings
+//===----------------------------------------------------------------------===//
+
+#include "storage/posthog_settings.hpp"
+
+#include "duckdb/main/client_context.hpp"
+#include "duckdb/main/config.hpp"
+
+namespace duckdb {
+
+namespace {
+
+struct PostHogSetting {
+	const char *option;
+	LogicalTypeId type;
+	const char *description;
+};
+
+// Byte sizes and compression are VARCHAR so that they take the same values as the connection string.
+const PostHogSetting POSTHOG_SETTINGS[] = {
+    {"pool_size", LogicalTypeId::UBIGINT, "Default pool_size of hog: attaches (pooled Flight channels)"},
+    {"metadata_timeout_ms", LogicalTypeId::UBIGINT, "Default metadata_timeout_ms of hog: attaches"},
+    {"metadata_hedging", LogicalTypeId::BOOLEAN, "Default metadata_hedging of hog: attaches"},
+    {"max_message_bytes", LogicalTypeId::VARCHAR, "Default max_message_bytes of hog: attaches (gRPC message limit)"},
+    {"keepalive_ms", LogicalTypeId::UBIGINT, "Default keepalive_ms of hog: attaches (gRPC keepalive interval)"},
+    {"endpoint_locations", LogicalTypeId::BOOLEAN, "Default endpoint_locations of hog: attaches"},
+    {"prefetch_bytes", LogicalTypeId::VARCHAR, "Default prefetch_bytes of hog: attaches (read-ahead per stream)"},
+    {"track_memory", LogicalTypeId::BOOLEAN, "Default track_memory of hog: attaches"},
+    {"scan_batch_rows", LogicalTypeId::UBIGINT, "Default scan_batch_rows of hog: attaches"},
+    {"scan_batch_bytes", LogicalTypeId::VARCHAR, "Default scan_batch_bytes of hog: attaches"},
+    {"scan_splits", LogicalTypeId::UBIGINT, "Default scan_splits of hog: attaches"},
+    {"dictionary_strings", LogicalTypeId::BOOLEAN, "Default dictionary_strings of hog: attaches"},
+    {"compression", LogicalTypeId::VARCHAR, "Default compression of hog: attaches (none, lz4 or zstd)"},
+    {"metadata_cache_ttl", LogicalTypeId::UBIGINT, "Default metadata_cache_ttl of hog: attaches, in seconds"},
+    {"stale_while_revalidate", LogicalTypeId::BOOLEAN, "Default stale_while_revalidate of hog: attaches"},
+    {"snapshot_invalidation", LogicalTypeId::BOOLEAN, "Default snapshot_invalidation of hog: attaches"},
+    {"prefetch_metadata", LogicalTypeId::BOOLEAN, "Default prefetch_metadata of hog: attaches"},
+    {"metadata_concurrency", LogicalTypeId::UBIGINT, "Default metadata_concurrency of hog: attaches"},
+    {"lazy_table_schemas", LogicalTypeId::BOOLEAN, "Default lazy_table_schemas of hog: attaches"},
+    {"result_cache_bytes", LogicalTypeId::VARCHAR, "Default result_cache_bytes of hog: attaches"},
+    {"pushdown", LogicalTypeId::BOOLEAN, "Default pushdown of hog: attaches"},
+    {"in_list_upload_threshold", LogicalTypeId::UBIGINT, "Default in_list_upload_threshold of hog: attaches"},
+    {"join_upload_rows", LogicalTypeId::UBIGINT, "Default join_upload_rows of hog: attaches"},
+    {"shared_scan_bytes", LogicalTypeId::VARCHAR, "Default shared_scan_bytes of hog: attaches"},
+    {"bulk_ingest", LogicalTypeId::BOOLEAN, "Default bulk_ingest of hog: attaches"},
+    {"prepared_insert", LogicalTypeId::BOOLEAN, "Default prepared_insert of hog: attaches"},
+    {"pipelined_transactions", LogicalTypeId::BOOLEAN, "Default pipelined_transactions of hog: attaches"},
+    {"insert_batch_rows", LogicalTypeId::UBIGINT, "Default insert_batch_rows of hog: attaches"},
+    {"insert_batch_bytes", LogicalTypeId::VARCHAR, "Default insert_batch_bytes of hog: attaches"},
+};
+
+string SettingName(const PostHogSetting &setting) {
+	return string("duckhog_") + setting.option;
+}
+
+} // namespace
+
+void PostHogSettings::Register(DBConfig &config) {
+	for (auto &setting : POSTHOG_SETTINGS) {
+		config.AddExtensionOption(SettingName(setting), setting.description, LogicalType(setting.type));
+	}
+}
+
+void PostHogSettings::ApplyDefaults(ClientContext &context, PostHogConnectionConfig &config) {
+	for (auto &setting : POSTHOG_SETTINGS) {
+		if (config.options.find(setting.option) != config.options.end()) {
+			continue;
+		}
+		Value value;
+		if (!context.TryGetCurrentSetting(SettingName(setting), value) || value.IsNull()) {
+			continue;
+		}
+		config.options[setting.option] = value.ToString();
+	}
+}
+
+} // namespace duckdb
@@ -0,0 +1,31 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// storage/posthog_settings.hpp
+//
+// SET duckhog_<option> defaults for the performance options of hog: connection strings
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "utils/connection_string.hpp"
+
+namespace duckdb {
+
+class ClientContext;
+class DBConfig;
+
+// Every tuning option of the connection string (channels, streams, metadata caches, pushdown and
+// writes) is also a duckhog_<option> setting. A setting applies to the attaches that follow it in
+// its scope, and an option given in the connection string wins. Settings are unset by default, so
+// the option's own default applies.
+class PostHogSettings {
+public:
+	static void Register(DBConfig &config);
+
+	// Adds the duckhog_* settings of context to config.options for the options the connection string
+	// leaves out. They are then validated like the connection string's own.
+	static void ApplyDefaults(ClientContext &context, PostHogConnectionConfig &config);
+};
+
+} // namespace duckdb
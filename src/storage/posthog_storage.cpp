@@ -8,13 +8,16 @@
 #include "duckdb.hpp"
 
 #include "storage/posthog_storage.hpp"
+#include "storage/posthog_settings.hpp"
 #include "storage/posthog_transaction_manager.hpp"
 #include "catalog/posthog_catalog.hpp"
 #include "utils/connection_string.hpp"
 #include "flight/flight_client.hpp"
 #include "duckdb/main/attached_database.hpp"
+#include "duckdb/common/operator/cast_operators.hpp"
 #include "duckdb/common/string_util.hpp"
 #include "utils/posthog_logger.hpp"
+#include "utils/posthog_tracer.hpp"
 
 namespace duckdb {
 
@@ -31,6 +34,281 @@ bool ParseBoolOptionValue(const string &key, const string &value) {
 	throw InvalidInputException("PostHog: Invalid value for %s: '%s' (expected true or false).", key, value);
 }
 
+idx_t ParseBoundedIntegerOptionValue(const string &key, const string &value, idx_t min_value, idx_t max_value) {
+	idx_t result;
+	if (!TryCast::Operation<string_t, idx_t>(string_t(value), result, true) || result < min_value ||
+	    result > max_value) {
+		throw InvalidInputException("PostHog: Invalid value for %s: '%s' (expected an integer between %llu and %llu).",
+		                            key, value, min_value, max_value);
+	}
+	return result;
+}
+
+// Accepts a plain byte count or a count with a KB/MB/GB (or KiB/MiB/GiB) suffix.
+idx_t ParseByteSizeOptionValue(const string &key, const string &value) {
+	auto lower = StringUtil::Lower(value);
+	StringUtil::Trim(lower);
+	idx_t digits_end = 0;
+	while (digits_end < lower.size() && StringUtil::CharacterIsDigit(lower[digits_end])) {
+		digits_end++;
+	}
+	auto unit = lower.substr(digits_end);
+	StringUtil::Trim(unit);
+	idx_t multiplier;
+	if (unit.empty() || unit == "b") {
+		multiplier = 1;
+	} else if (unit == "kb" || unit == "kib") {
+		multiplier = 1024ULL;
+	} else if (unit == "mb" || unit == "mib") {
+		multiplier = 1024ULL * 1024ULL;
+	} else if (unit == "gb" || unit == "gib") {
+		multiplier = 1024ULL * 1024ULL * 1024ULL;
+	} else {
+		multiplier = 0;
+	}
+	idx_t count;
+	if (digits_end == 0 || multiplier == 0 ||
+	    !TryCast::Operation<string_t, idx_t>(string_t(lower.substr(0, digits_end)), count, true) ||
+	    count > NumericLimits<idx_t>::Maximum() / multiplier) {
+		throw InvalidInputException("PostHog: Invalid value for %s: '%s' (expected a byte size such as 64MB).", key,
+		                            value);
+	}
+	return count * multiplier;
+}
+
+void ResolvePoolOptions(PostHogConnectionConfig &config) {
+	auto it = config.options.find("pool_size");
+	if (it != config.options.end()) {
+		config.pool_size =
+		    ParseBoundedIntegerOptionValue("pool_size", it->second, 1, PostHogConnectionConfig::MAX_POOL_SIZE);
+		config.options.erase(it);
+	}
+
+	it = config.options.find("shared_client");
+	if (it != config.options.end()) {
+		config.shared_client = ParseBoolOptionValue("shared_client", it->second);
+		config.options.erase(it);
+	}
+
+	it = config.options.find("metadata_timeout_ms");
+	if (it != config.options.end()) {
+		config.metadata_timeout_ms = ParseBoundedIntegerOptionValue("metadata_timeout_ms", it->second, 0,
+		                                                            PostHogConnectionConfig::MAX_METADATA_TIMEOUT_MS);
+		config.options.erase(it);
+	}
+
+	it = config.options.find("metadata_hedging");
+	if (it != config.options.end()) {
+		config.metadata_hedging = ParseBoolOptionValue("metadata_hedging", it->second);
+		config.options.erase(it);
+	}
+
+	it = config.options.find("max_message_bytes");
+	if (it != config.options.end()) {
+		config.max_message_bytes = ParseByteSizeOptionValue("max_message_bytes", it->second);
+		if (config.max_message_bytes > PostHogConnectionConfig::MAX_MESSAGE_BYTES) {
+			throw InvalidInputException(
+			    "PostHog: Invalid value for max_message_bytes: '%s' (gRPC messages are limited to %llu bytes).",
+			    it->second, PostHogConnectionConfig::MAX_MESSAGE_BYTES);
+		}
+		config.options.erase(it);
+	}
+
+	it = config.options.find("keepalive_ms");
+	if (it != config.options.end()) {
+		config.keepalive_ms =
+		    ParseBoundedIntegerOptionValue("keepalive_ms", it->second, 0, PostHogConnectionConfig::MAX_KEEPALIVE_MS);
+		config.options.erase(it);
+	}
+
+	it = config.options.find("session_cache_dir");
+	if (it != config.options.end()) {
+		config.session_cache_dir = it->second;
+		config.options.erase(it);
+	}
+
+	it = config.options.find("endpoint_locations");
+	if (it != config.options.end()) {
+		config.endpoint_locations = ParseBoolOptionValue("endpoint_locations", it->second);
+		config.options.erase(it);
+	}
+}
+
+void ResolveStreamOptions(PostHogConnectionConfig &config) {
+	auto it = config.options.find("prefetch_bytes");
+	if (it != config.options.end()) {
+		config.prefetch_bytes = ParseByteSizeOptionValue("prefetch_bytes", it->second);
+		config.options.erase(it);
+	}
+
+	it = config.options.find("track_memory");
+	if (it != config.options.end()) {
+		config.track_memory = ParseBoolOptionValue("track_memory", it->second);
+		config.options.erase(it);
+	}
+
+	it = config.options.find("scan_batch_rows");
+	if (it != config.options.end()) {
+		config.scan_batch_rows = ParseBoundedIntegerOptionValue("scan_batch_rows", it->second, 0,
+		                                                        PostHogConnectionConfig::MAX_SCAN_BATCH_ROWS);
+		config.options.erase(it);
+	}
+
+	it = config.options.find("scan_batch_bytes");
+	if (it != config.options.end()) {
+		config.scan_batch_bytes = ParseByteSizeOptionValue("scan_batch_bytes", it->second);
+		config.options.erase(it);
+	}
+
+	it = config.options.find("scan_splits");
+	if (it != config.options.end()) {
+		config.scan_splits =
+		    ParseBoundedIntegerOptionValue("scan_splits", it->second, 0, PostHogConnectionConfig::MAX_SCAN_SPLITS);
+		config.options.erase(it);
+	}
+
+	it = config.options.find("dictionary_strings");
+	if (it != config.options.end()) {
+		config.dictionary_strings = ParseBoolOptionValue("dictionary_strings", it->second);
+		config.options.erase(it);
+	}
+
+	it = config.options.find("compression");
+	if (it != config.options.end()) {
+		auto lower = StringUtil::Lower(it->second);
+		if (lower != "none" && lower != "lz4" && lower != "zstd") {
+			throw InvalidInputException("PostHog: Invalid value for compression: '%s' (expected none, lz4 or zstd).",
+			                            it->second);
+		}
+		config.compression = lower;
+		config.options.erase(it);
+	}
+}
+
+void ResolveCacheOptions(PostHogConnectionConfig &config) {
+	auto it = config.options.find("metadata_cache_ttl");
+	if (it != config.options.end()) {
+		config.metadata_cache_ttl = ParseBoundedIntegerOptionValue("metadata_cache_ttl", it->second, 0,
+		                                                           PostHogConnectionConfig::MAX_METADATA_CACHE_TTL);
+		config.options.erase(it);
+	}
+
+	it = config.options.find("stale_while_revalidate");
+	if (it != config.options.end()) {
+		config.stale_while_revalidate = ParseBoolOptionValue("stale_while_revalidate", it->second);
+		config.options.erase(it);
+	}
+
+	it = config.options.find("snapshot_invalidation");
+	if (it != config.options.end()) {
+		config.snapshot_invalidation = ParseBoolOptionValue("snapshot_invalidation", it->second);
+		config.options.erase(it);
+	}
+
+	it = config.options.find("prefetch_metadata");
+	if (it != config.options.end()) {
+		config.prefetch_metadata = ParseBoolOptionValue("prefetch_metadata", it->second);
+		config.options.erase(it);
+	}
+
+	it = config.options.find("metadata_concurrency");
+	if (it != config.options.end()) {
+		config.metadata_concurrency = ParseBoundedIntegerOptionValue(
+		    "metadata_concurrency", it->second, 1, PostHogConnectionConfig::MAX_METADATA_CONCURRENCY);
+		config.options.erase(it);
+	}
+
+	it = config.options.find("lazy_table_schemas");
+	if (it != config.options.end()) {
+		config.lazy_table_schemas = ParseBoolOptionValue("lazy_table_schemas", it->second);
+		config.options.erase(it);
+	}
+
+	it = config.options.find("metadata_cache_dir");
+	if (it != config.options.end()) {
+		config.metadata_cache_dir = it->second;
+		config.options.erase(it);
+	}
+
+	it = config.options.find("result_cache_bytes");
+	if (it != config.options.end()) {
+		config.result_cache_bytes = ParseByteSizeOptionValue("result_cache_bytes", it->second);
+		config.options.erase(it);
+	}
+}
+
+void ResolveQueryOptions(PostHogConnectionConfig &config) {
+	auto it = config.options.find("pushdown");
+	if (it != config.options.end()) {
+		config.pushdown = ParseBoolOptionValue("pushdown", it->second);
+		config.options.erase(it);
+	}
+
+	it = config.options.find("in_list_upload_threshold");
+	if (it != config.options.end()) {
+		config.in_list_upload_threshold = ParseBoundedIntegerOptionValue(
+		    "in_list_upload_threshold", it->second, 0, PostHogConnectionConfig::MAX_IN_LIST_UPLOAD_THRESHOLD);
+		config.options.erase(it);
+	}
+
+	it = config.options.find("join_upload_rows");
+	if (it != config.options.end()) {
+		config.join_upload_rows = ParseBoundedIntegerOptionValue("join_upload_rows", it->second, 0,
+		                                                         PostHogConnectionConfig::MAX_JOIN_UPLOAD_ROWS);
+		config.options.erase(it);
+	}
+
+	it = config.options.find("shared_scan_bytes");
+	if (it != config.options.end()) {
+		config.shared_scan_bytes = ParseByteSizeOptionValue("shared_scan_bytes", it->second);
+		config.options.erase(it);
+	}
+}
+
+void ResolveWriteOptions(PostHogConnectionConfig &config) {
+	auto it = config.options.find("bulk_ingest");
+	if (it != config.options.end()) {
+		config.bulk_ingest = ParseBoolOptionValue("bulk_ingest", it->second);
+		config.options.erase(it);
+	}
+
+	it = config.options.find("prepared_insert");
+	if (it != config.options.end()) {
+		config.prepared_insert = ParseBoolOptionValue("prepared_insert", it->second);
+		config.options.erase(it);
+	}
+
+	it = config.options.find("hybrid_dml");
+	if (it != config.options.end()) {
+		config.hybrid_dml = ParseBoolOptionValue("hybrid_dml", it->second);
+		config.options.erase(it);
+	}
+
+	it = config.options.find("pipelined_transactions");
+	if (it != config.options.end()) {
+		config.pipelined_transactions = ParseBoolOptionValue("pipelined_transactions", it->second);
+		config.options.erase(it);
+	}
+
+	it = config.options.find("insert_batch_rows");
+	if (it != config.options.end()) {
+		config.insert_batch_rows = ParseBoundedIntegerOptionValue("insert_batch_rows", it->second, 1,
+		                                                          PostHogConnectionConfig::MAX_INSERT_BATCH_ROWS);
+		config.options.erase(it);
+	}
+
+	it = config.options.find("insert_batch_bytes");
+	if (it != config.options.end()) {
+		config.insert_batch_bytes = ParseByteSizeOptionValue("insert_batch_bytes", it->second);
+		if (config.insert_batch_bytes == 0) {
+			throw InvalidInputException(
+			    "PostHog: Invalid value for insert_batch_bytes: '%s' (expected a byte size greater than zero).",
+			    it->second);
+		}
+		config.options.erase(it);
+	}
+}
+
 void ResolveSecurityOptions(PostHogConnectionConfig &config) {
 	auto it = config.options.find("tls_skip_verify");
 	if (it == config.options.end()) {
@@ -40,13 +318,23 @@ void ResolveSecurityOptions(PostHogConnectionConfig &config) {
 	config.options.erase(it);
 }
 
+void ResolveTraceOptions(PostHogConnectionConfig &config) {
+	auto it = config.options.find("trace");
+	if (it == config.options.end()) {
+		return;
+	}
+	config.trace = ParseBoolOptionValue("trace", it->second);
+	config.options.erase(it);
+}
+
 } // namespace
 
 static unique_ptr<Catalog> PostHogAttach(optional_ptr<StorageExtensionInfo> storage_info, ClientContext &context,
                                          AttachedDatabase &db, const string &name, AttachInfo &info,
                                          AttachOptions &attach_options) {
-	// Parse the connection string
+	// Parse the connection string; SET duckhog_<option> supplies the options it leaves out.
 	auto config = ConnectionString::Parse(info.path);
+	PostHogSettings::ApplyDefaults(context, config);
 
 	if (config.user.empty()) {
 		throw InvalidInputException(
@@ -61,6 +349,18 @@ static unique_ptr<Catalog> PostHogAttach(optional_ptr<StorageExtensionInfo> stor
 		config.flight_server = PostHogConnectionConfig::DEFAULT_FLIGHT_SERVER;
 	}
 	ResolveSecurityOptions(config);
+	ResolvePoolOptions(config);
+	ResolveStreamOptions(config);
+	ResolveCacheOptions(config);
+	ResolveQueryOptions(config);
+	ResolveWriteOptions(config);
+	ResolveTraceOptions(config);
+	if (config.trace) {
+		PostHogTracer::Instance().SetEnabled(true);
+	}
+	for (auto &option : config.options) {
+		POSTHOG_LOG_WARN("Ignoring unknown connection string option '%s'", option.first.c_str());
+	}
 
 	// Attach exactly one catalog.
 	// If `config.database` is empty (e.g. hog:?user=...), the server resolves
@@ -0,0 +1,194 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// storage/posthog_transaction.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/posthog_transaction.hpp"
+
+#include "catalog/posthog_catalog.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/main/client_context.hpp"
+
+#include <cctype>
+#include <exception>
+
+namespace duckdb {
+
+namespace {
+
+bool IsConnectionFailureMessage(const std::string &message) {
+	std::string lower;
+	lower.reserve(message.size());
+	for (unsigned char ch : message) {
+		lower.push_back(static_cast<char>(std::tolower(ch)));
+	}
+	return lower.find("failed to connect") != std::string::npos ||
+	       lower.find("connection refused") != std::string::npos || lower.find("unavailable") != std::string::npos ||
+	       lower.find("timed out") != std::string::npos;
+}
+
+} // namespace
+
+PostHogTransaction::PostHogTransaction(TransactionManager &manager, ClientContext &context, PostHogCatalog *catalog)
+    : Transaction(manager, context), catalog_(catalog), client_context_(context),
+      auto_commit_(context.transaction.IsAutoCommit()) {
+}
+
+PostHogTransaction::~PostHogTransaction() {
+	// The tasks use the catalog's client; none may outlive the transaction.
+	DiscardDeferredWrites();
+}
+
+arrow::StopToken PostHogTransaction::GetStopToken() {
+	lock_guard<mutex> guard(lock_);
+	if (!catalog_) {
+		return arrow::StopToken::Unstoppable();
+	}
+	// Interrupting a query aborts its transaction, so one watch covers the whole transaction.
+	if (!interrupt_watch_) {
+		interrupt_watch_ = catalog_->GetInterruptMonitor().Start(client_context_);
+	}
+	return interrupt_watch_->Token();
+}
+
+std::optional<TransactionId> PostHogTransaction::RemoteTransactionForRead(bool shared_snapshot) {
+	if (auto_commit_ && !shared_snapshot) {
+		return StartedRemoteTransaction();
+	}
+	WaitForDeferredWrites();
+	return BeginRemoteTransaction();
+}
+
+std::optional<TransactionId> PostHogTransaction::RemoteTransactionForWrite() {
+	WaitForDeferredWrites();
+	return BeginRemoteTransaction();
+}
+
+std::optional<TransactionId> PostHogTransaction::RemoteTransactionForAppend(const string &table) {
+	WaitForDeferredWrites(&table);
+	return BeginRemoteTransaction();
+}
+
+bool PostHogTransaction::PipelinesWrites() const {
+	return !auto_commit_ && catalog_ && catalog_->GetConfig().pipelined_transactions;
+}
+
+void PostHogTransaction::DeferWrite(const string &table, std::future<int64_t> result, string operation, idx_t rows,
+                                    std::shared_ptr<void> keep_alive) {
+	lock_guard<mutex> guard(lock_);
+	deferred_writes_.push_back({table, std::move(result), std::move(operation), rows, std::move(keep_alive)});
+}
+
+std::vector<PostHogTransaction::DeferredWrite> PostHogTransaction::TakeDeferredWrites(const string *table) {
+	lock_guard<mutex> guard(lock_);
+	std::vector<DeferredWrite> taken;
+	for (auto it = deferred_writes_.begin(); it != deferred_writes_.end();) {
+		if (table && it->table != *table) {
+			++it;
+			continue;
+		}
+		taken.push_back(std::move(*it));
+		it = deferred_writes_.erase(it);
+	}
+	return taken;
+}
+
+void PostHogTransaction::WaitForDeferredWrites(const string *table) {
+	lock_guard<mutex> wait_guard(deferred_wait_lock_);
+	{
+		// The failed writes are gone from the list: every later statement, and the commit, fails too.
+		lock_guard<mutex> guard(lock_);
+		if (deferred_error_) {
+			std::rethrow_exception(deferred_error_);
+		}
+	}
+	auto writes = TakeDeferredWrites(table);
+	// Every write is awaited before the first error is thrown, so no task outlives its keep_alive.
+	std::exception_ptr first_error;
+	for (auto &write : writes) {
+		try {
+			write.result.get();
+		} catch (const Exception &) {
+			if (!first_error) {
+				first_error = std::current_exception();
+			}
+		} catch (const std::exception &ex) {
+			if (!first_error) {
+				first_error = std::make_exception_ptr(IOException("PostHog: %s failed for batch with %llu row(s): %s",
+				                                                  write.operation, write.rows, ex.what()));
+			}
+		}
+	}
+	if (first_error) {
+		{
+			lock_guard<mutex> guard(lock_);
+			deferred_error_ = first_error;
+		}
+		std::rethrow_exception(first_error);
+	}
+}
+
+void PostHogTransaction::DiscardDeferredWrites() {
+	lock_guard<mutex> wait_guard(deferred_wait_lock_);
+	for (auto &write : TakeDeferredWrites(nullptr)) {
+		try {
+			write.result.get();
+		} catch (...) {
+		}
+	}
+}
+
+std::optional<TransactionId> PostHogTransaction::StartedRemoteTransaction() const {
+	lock_guard<mutex> guard(lock_);
+	return remote_txn_id_;
+}
+
+void PostHogTransaction::RecordSchemaListChange() {
+	lock_guard<mutex> guard(lock_);
+	schema_list_changed_ = true;
+	InvalidateQuerySchemas();
+}
+
+void PostHogTransaction::RecordTableChange(const string &schema_name) {
+	lock_guard<mutex> guard(lock_);
+	changed_schemas_.insert(schema_name);
+	InvalidateQuerySchemas();
+}
+
+void PostHogTransaction::InvalidateQuerySchemas() {
+	// The DDL may change the result schema of any query probed before it.
+	if (catalog_ && catalog_->IsConnected()) {
+		catalog_->GetFlightClient().InvalidateQuerySchemas();
+	}
+}
+
+bool PostHogTransaction::SchemaListChanged() const {
+	lock_guard<mutex> guard(lock_);
+	return schema_list_changed_;
+}
+
+unordered_set<string> PostHogTransaction::ChangedSchemas() const {
+	lock_guard<mutex> guard(lock_);
+	return changed_schemas_;
+}
+
+std::optional<TransactionId> PostHogTransaction::BeginRemoteTransaction() {
+	// Sink threads of one statement may get here at the same time; only the first begins.
+	lock_guard<mutex> guard(lock_);
+	if (remote_txn_id_.has_value() || !catalog_ || !catalog_->IsConnected()) {
+		return remote_txn_id_;
+	}
+	try {
+		remote_txn_id_ = catalog_->GetFlightClient().BeginTransaction();
+	} catch (const std::exception &e) {
+		if (IsConnectionFailureMessage(e.what())) {
+			throw CatalogException("PostHog: Not connected to remote server.");
+		}
+		throw;
+	}
+	return remote_txn_id_;
+}
+
+} // namespace duckdb
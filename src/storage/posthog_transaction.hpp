@@ -7,22 +7,102 @@
 
 #pragma once
 
+#include "duckdb/common/mutex.hpp"
+#include "duckdb/common/unordered_set.hpp"
 #include "duckdb/transaction/transaction.hpp"
 #include "flight/flight_client.hpp"
+#include "storage/posthog_interrupt_monitor.hpp"
 
+#include <exception>
+#include <future>
+#include <memory>
 #include <optional>
+#include <vector>
 
 namespace duckdb {
 
+class PostHogCatalog;
+
 class PostHogTransaction : public Transaction {
 public:
-	PostHogTransaction(TransactionManager &manager, ClientContext &context) : Transaction(manager, context) {
-	}
+	PostHogTransaction(TransactionManager &manager, ClientContext &context, PostHogCatalog *catalog);
+	~PostHogTransaction() override;
+
+	// Remote Flight SQL transaction for this DuckDB transaction (per attached hog: database). It is
+	// begun lazily, by the first write or by the first statement of an explicit BEGIN ... COMMIT
+	// block. Reads in auto-commit mode run outside any remote transaction unless a write of the same
+	// statement already began one, so read-only auto-commit statements cost no Begin/Commit RPCs.
+	// Both first wait for the deferred writes of earlier statements, see DeferWrite.
+	// shared_snapshot is set for the reads of a statement that reads the catalog more than once (see
+	// PostHogOptimizer): they begin the remote transaction in auto-commit mode too, so that all of them
+	// see the same snapshot.
+	std::optional<TransactionId> RemoteTransactionForRead(bool shared_snapshot = false);
+	std::optional<TransactionId> RemoteTransactionForWrite();
+	// For an INSERT into table (its qualified remote name), which only waits for the deferred
+	// writes to the same table: appends to different tables do not depend on each other.
+	std::optional<TransactionId> RemoteTransactionForAppend(const string &table);
+
+	// True in an explicit BEGIN ... COMMIT block of a catalog attached with pipelined_transactions.
+	// Statements may then leave their last remote write in flight and complete without its result.
+	bool PipelinesWrites() const;
+	// Hands over the in-flight write of rows rows to table, which the next statement that may depend
+	// on it, or else the commit, waits for. keep_alive holds whatever the write's task references.
+	// operation describes the statement in the error message, e.g. "INSERT into db.main.t".
+	void DeferWrite(const string &table, std::future<int64_t> result, string operation, idx_t rows,
+	                std::shared_ptr<void> keep_alive);
+	// Waits for the deferred writes to table, or for all of them, and throws the first error. Once a
+	// deferred write failed, every later call throws that error again.
+	void WaitForDeferredWrites(const string *table = nullptr);
+	// Waits for every deferred write and ignores their errors; before a rollback.
+	void DiscardDeferredWrites();
+
+	// Stopped when the client's current query is interrupted. Pass it to Flight calls made for the
+	// query so that an interrupt cancels them on the server instead of waiting for them.
+	arrow::StopToken GetStopToken();
+
+	// The remote transaction if one was begun; never begins one.
+	std::optional<TransactionId> StartedRemoteTransaction() const;
 
-	// Remote Flight SQL transaction id for this DuckDB transaction (per attached hog: database).
-	std::optional<TransactionId> remote_txn_id;
+	// Remember which cached metadata the transaction's DDL touched, so that a rollback only drops
+	// those caches: the schema list (CREATE/DROP SCHEMA) or the table list of one schema.
+	void RecordSchemaListChange();
+	void RecordTableChange(const string &schema_name);
+	bool SchemaListChanged() const;
+	unordered_set<string> ChangedSchemas() const;
 
 	static PostHogTransaction &Get(ClientContext &context, Catalog &catalog);
+
+private:
+	// Drop the catalog's cached query schemas; called for DDL.
+	void InvalidateQuerySchemas();
+
+	struct DeferredWrite {
+		string table;
+		std::future<int64_t> result;
+		string operation;
+		idx_t rows;
+		std::shared_ptr<void> keep_alive;
+	};
+
+	std::optional<TransactionId> BeginRemoteTransaction();
+	// Removes the deferred writes to table (all of them when null) from deferred_writes_.
+	std::vector<DeferredWrite> TakeDeferredWrites(const string *table);
+
+	PostHogCatalog *catalog_;
+	ClientContext &client_context_;
+	bool auto_commit_;
+	unique_ptr<PostHogInterruptMonitor::Watch> interrupt_watch_;
+	// Guards the remote transaction id and the recorded metadata changes.
+	mutable mutex lock_;
+	std::optional<TransactionId> remote_txn_id_;
+	bool schema_list_changed_ = false;
+	unordered_set<string> changed_schemas_;
+	// Guarded by lock_. deferred_wait_lock_ is held while writes taken from it are awaited, so that a
+	// statement never starts while a concurrent sink thread is still waiting for what it depends on.
+	std::vector<DeferredWrite> deferred_writes_;
+	// Guarded by lock_. First error of a deferred write.
+	std::exception_ptr deferred_error_;
+	mutex deferred_wait_lock_;
 };
 
 inline PostHogTransaction &PostHogTransaction::Get(ClientContext &context, Catalog &catalog) {
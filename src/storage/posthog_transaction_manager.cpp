@@ -10,80 +10,89 @@
 #include "catalog/posthog_catalog.hpp"
 #include "duckdb/common/exception.hpp"
 
-#include <cctype>
-
 namespace duckdb {
 
-namespace {
-
-bool IsConnectionFailureMessage(const std::string &message) {
-	std::string lower;
-	lower.reserve(message.size());
-	for (unsigned char ch : message) {
-		lower.push_back(static_cast<char>(std::tolower(ch)));
-	}
-	return lower.find("failed to connect") != std::string::npos ||
-	       lower.find("connection refused") != std::string::npos || lower.find("unavailable") != std::string::npos ||
-	       lower.find("timed out") != std::string::npos;
-}
-
-} // namespace
-
 PostHogTransactionManager::PostHogTransactionManager(AttachedDatabase &db_p, PostHogCatalog *catalog)
     : TransactionManager(db_p), catalog_(catalog) {
 }
 
 Transaction &PostHogTransactionManager::StartTransaction(ClientContext &context) {
-	lock_guard<mutex> guard(transaction_lock_);
-
-	auto transaction = make_uniq<PostHogTransaction>(*this, context);
-	if (catalog_ && catalog_->IsConnected()) {
-		try {
-			transaction->remote_txn_id = catalog_->GetFlightClient().BeginTransaction();
-		} catch (const std::exception &e) {
-			if (IsConnectionFailureMessage(e.what())) {
-				throw CatalogException("PostHog: Not connected to remote server.");
-			}
-			throw;
-		}
-	}
+	// The remote transaction is begun lazily, see PostHogTransaction.
+	auto transaction = make_uniq<PostHogTransaction>(*this, context, catalog_);
 	auto &result = *transaction;
+
+	lock_guard<mutex> guard(transaction_lock_);
 	transactions_[result] = std::move(transaction);
+	start_sequences_[result] = next_sequence_++;
 	return result;
 }
 
-ErrorData PostHogTransactionManager::CommitTransaction(ClientContext &context, Transaction &transaction) {
+uint64_t PostHogTransactionManager::CurrentSequence() {
+	lock_guard<mutex> guard(transaction_lock_);
+	return next_sequence_;
+}
+
+uint64_t PostHogTransactionManager::OldestSequence() {
+	lock_guard<mutex> guard(transaction_lock_);
+	auto oldest = next_sequence_;
+	for (auto &entry : start_sequences_) {
+		oldest = MinValue(oldest, entry.second);
+	}
+	return oldest;
+}
+
+// transaction_lock_ only guards transactions_: the remote RPCs below run without it, so a slow
+// commit does not hold up connections that start or end their own transactions.
+void PostHogTransactionManager::RemoveTransaction(Transaction &transaction) {
 	lock_guard<mutex> guard(transaction_lock_);
+	start_sequences_.erase(transaction);
+	transactions_.erase(transaction);
+}
 
+ErrorData PostHogTransactionManager::CommitTransaction(ClientContext &context, Transaction &transaction) {
 	auto &txn = transaction.Cast<PostHogTransaction>();
-	if (catalog_ && txn.remote_txn_id.has_value()) {
+	// Writes still in flight from pipelined statements fail the commit, which then rolls back.
+	try {
+		txn.WaitForDeferredWrites();
+	} catch (const std::exception &e) {
+		ErrorData error(e);
+		RollbackTransaction(transaction);
+		return error;
+	}
+	auto remote_txn_id = txn.StartedRemoteTransaction();
+	ErrorData result;
+	if (catalog_ && remote_txn_id.has_value()) {
 		try {
-			catalog_->GetFlightClient().CommitTransaction(*txn.remote_txn_id);
+			catalog_->GetFlightClient().CommitTransaction(*remote_txn_id);
 		} catch (const std::exception &e) {
-			transactions_.erase(transaction);
-			return ErrorData(ExceptionType::CONNECTION, e.what());
+			result = ErrorData(ExceptionType::CONNECTION, e.what());
+		}
+		// Other transactions may have cached the result schemas from before the committed DDL.
+		if (txn.SchemaListChanged() || !txn.ChangedSchemas().empty()) {
+			catalog_->GetFlightClient().InvalidateQuerySchemas();
 		}
 	}
 
-	transactions_.erase(transaction);
-	return ErrorData();
+	RemoveTransaction(transaction);
+	return result;
 }
 
 void PostHogTransactionManager::RollbackTransaction(Transaction &transaction) {
-	lock_guard<mutex> guard(transaction_lock_);
-
 	auto &txn = transaction.Cast<PostHogTransaction>();
-	if (catalog_ && txn.remote_txn_id.has_value()) {
+	txn.DiscardDeferredWrites();
+	auto remote_txn_id = txn.StartedRemoteTransaction();
+	if (catalog_ && remote_txn_id.has_value()) {
 		try {
-			catalog_->GetFlightClient().RollbackTransaction(*txn.remote_txn_id);
+			catalog_->GetFlightClient().RollbackTransaction(*remote_txn_id);
 		} catch (const std::exception &) {
 			// Best-effort rollback for MVP; propagate errors via the original statement failure paths.
 		}
-		// Ensure local caches are invalidated so rolled-back DDL does not linger.
-		catalog_->RefreshSchemas();
+		// Drop the cached metadata that rolled-back DDL may have changed, so it does not linger.
+		// Transactions without DDL leave the caches of other connections alone.
+		catalog_->RefreshChangedSchemas(txn.SchemaListChanged(), txn.ChangedSchemas());
 	}
 
-	transactions_.erase(transaction);
+	RemoveTransaction(transaction);
 }
 
 void PostHogTransactionManager::Checkpoint(ClientContext &context, bool force) {
@@ -24,9 +24,20 @@ public:
 	void RollbackTransaction(Transaction &transaction) override;
 	void Checkpoint(ClientContext &context, bool force = false) override;
 
+	// Catalog entries a cache replaces may still be referenced by the transactions running at that
+	// time. Stamp them with CurrentSequence() and free them once the stamp is at most OldestSequence().
+	uint64_t CurrentSequence();
+	// Sequence of the oldest running transaction; CurrentSequence() when none is running.
+	uint64_t OldestSequence();
+
 private:
+	void RemoveTransaction(Transaction &transaction);
+
+	// Guards transactions_ only; never held across a remote RPC.
 	mutex transaction_lock_;
 	reference_map_t<Transaction, unique_ptr<PostHogTransaction>> transactions_;
+	reference_map_t<Transaction, uint64_t> start_sequences_;
+	uint64_t next_sequence_ = 0;
 	PostHogCatalog *catalog_;
 };
 
@@ -0,0 +1,73 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// utils/arrow_chunk_converter.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "utils/arrow_chunk_converter.hpp"
+
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/numeric_utils.hpp"
+#include "duckdb/common/vector_operations/vector_operations.hpp"
+#include "duckdb/main/client_context.hpp"
+
+#include <arrow/c/bridge.h>
+#include <arrow/record_batch.h>
+
+namespace duckdb {
+
+PostHogArrowChunkConverter::PostHogArrowChunkConverter(ClientContext &context,
+                                                       const std::shared_ptr<arrow::Schema> &schema,
+                                                       vector<LogicalType> target_types)
+    : context_(context), target_types_(std::move(target_types)) {
+	ArrowSchemaWrapper schema_root;
+	auto status = arrow::ExportSchema(*schema, &schema_root.arrow_schema);
+	if (!status.ok()) {
+		throw IOException("PostHog: Failed to export Arrow schema: " + status.ToString());
+	}
+	ArrowTableFunction::PopulateArrowTableSchema(context, arrow_table_, schema_root.arrow_schema);
+
+	auto arrow_types = arrow_table_.GetTypes();
+	if (arrow_types.size() != target_types_.size()) {
+		throw IOException("PostHog: remote result has %llu column(s) but %llu were expected", arrow_types.size(),
+		                  target_types_.size());
+	}
+	arrow_chunk_.Initialize(context, arrow_types);
+	scan_state_ = make_uniq<ArrowScanLocalState>(make_uniq<ArrowArrayWrapper>(), context);
+}
+
+void PostHogArrowChunkConverter::SetBatch(const std::shared_ptr<arrow::RecordBatch> &batch) {
+	auto wrapper = make_uniq<ArrowArrayWrapper>();
+	auto status = arrow::ExportRecordBatch(*batch, &wrapper->arrow_array);
+	if (!status.ok()) {
+		throw IOException("PostHog: Failed to export Arrow record batch: " + status.ToString());
+	}
+	scan_state_->Reset();
+	scan_state_->chunk = std::move(wrapper);
+	batch_length_ = NumericCast<idx_t>(batch->num_rows());
+	batch_offset_ = 0;
+}
+
+void PostHogArrowChunkConverter::Convert(DataChunk &output) {
+	auto count = MinValue<idx_t>(STANDARD_VECTOR_SIZE, batch_length_ - batch_offset_);
+	arrow_chunk_.Reset();
+	arrow_chunk_.SetCardinality(count);
+	scan_state_->chunk_offset = batch_offset_;
+	ArrowTableFunction::ArrowToDuckDB(*scan_state_, arrow_table_.GetColumns(), arrow_chunk_, batch_offset_);
+	batch_offset_ += count;
+
+	output.Reset();
+	output.SetCardinality(count);
+	for (idx_t col_idx = 0; col_idx < target_types_.size(); col_idx++) {
+		auto &source = arrow_chunk_.data[col_idx];
+		if (source.GetType() == target_types_[col_idx]) {
+			output.data[col_idx].Reference(source);
+		} else {
+			VectorOperations::Cast(context_, source, output.data[col_idx], count);
+		}
+	}
+	output.Verify();
+}
+
+} // namespace duckdb
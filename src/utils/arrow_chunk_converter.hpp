@@ -0,0 +1,56 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// utils/arrow_chunk_converter.hpp
+//
+// Columnar conversion of Arrow record batches into DuckDB DataChunks
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb/common/types/data_chunk.hpp"
+#include "duckdb/function/table/arrow.hpp"
+
+#include <memory>
+
+namespace arrow {
+class RecordBatch;
+class Schema;
+} // namespace arrow
+
+namespace duckdb {
+
+class ClientContext;
+
+// Converts record batches of one Arrow schema into DataChunks of target_types using DuckDB's
+// Arrow scan conversion (the same path as PostHogRemoteScan), so buffers are referenced rather
+// than copied wherever DuckDB allows. Columns whose Arrow-derived type differs from the target
+// type are cast vector-at-a-time.
+class PostHogArrowChunkConverter {
+public:
+	PostHogArrowChunkConverter(ClientContext &context, const std::shared_ptr<arrow::Schema> &schema,
+	                           vector<LogicalType> target_types);
+
+	// Starts converting batch; the batch is kept alive by the chunks that reference it.
+	void SetBatch(const std::shared_ptr<arrow::RecordBatch> &batch);
+
+	// True while the current batch has rows that have not been converted yet.
+	bool HasRows() const {
+		return batch_offset_ < batch_length_;
+	}
+
+	// Writes up to STANDARD_VECTOR_SIZE rows of the current batch into output, which must be
+	// initialized with the target types.
+	void Convert(DataChunk &output);
+
+private:
+	ClientContext &context_;
+	ArrowTableSchema arrow_table_;
+	vector<LogicalType> target_types_;
+	DataChunk arrow_chunk_;
+	unique_ptr<ArrowScanLocalState> scan_state_;
+	idx_t batch_length_ = 0;
+	idx_t batch_offset_ = 0;
+};
+
+} // namespace duckdb
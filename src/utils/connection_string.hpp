@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <string>
 #include <unordered_map>
 
@@ -20,9 +21,103 @@ struct PostHogConnectionConfig {
 	std::string flight_server;
 	// If true, skip TLS certificate verification (for local/dev only).
 	bool tls_skip_verify = false;
+	// Reuse the Flight client (channels and session) of another catalog attached with the same
+	// server, credentials and client settings.
+	bool shared_client = true;
+	// Number of pooled Flight SQL channels per attached catalog.
+	size_t pool_size = DEFAULT_POOL_SIZE;
+	// Deadline in milliseconds of each metadata RPC attempt (0 means none).
+	size_t metadata_timeout_ms = 0;
+	// Hedge slow metadata RPCs with a second attempt on another pooled channel.
+	bool metadata_hedging = false;
+	// Largest gRPC message sent or received on each Flight channel (0 keeps Arrow Flight's defaults).
+	size_t max_message_bytes = 0;
+	// Interval in milliseconds of gRPC keepalive pings while Flight calls are open (0 disables them).
+	size_t keepalive_ms = 0;
+	// Directory of the on-disk session cache, through which processes attaching the same server as the
+	// same user hand their Duckgres session on to the next one (empty disables it).
+	std::string session_cache_dir;
+	// Read result endpoints from the data node locations their FlightEndpoint lists, falling back to
+	// flight_server.
+	bool endpoint_locations = true;
+	// Byte budget of the background read-ahead queue per remote stream (0 disables prefetching).
+	size_t prefetch_bytes = 0;
+	// Account remote result batches against DuckDB's memory_limit (PostHogMemoryPool).
+	bool track_memory = true;
+	// Targets the batches handed to DuckDB's Arrow scan are merged or sliced to (0 disables either).
+	size_t scan_batch_rows = DEFAULT_SCAN_BATCH_ROWS;
+	size_t scan_batch_bytes = DEFAULT_SCAN_BATCH_BYTES;
+	// Most remote queries one table scan is split into to read it on several threads (0 or 1 disables).
+	size_t scan_splits = 0;
+	// Bind string columns of remote tables as dictionaries and ask the server to send them so.
+	bool dictionary_strings = false;
+	// Arrow IPC body compression requested for results and used for uploads: "none", "lz4" or "zstd".
+	std::string compression = "none";
+	// Seconds schema, table and statistics metadata is cached before it is reloaded.
+	size_t metadata_cache_ttl = DEFAULT_METADATA_CACHE_TTL;
+	// Keep serving expired metadata while a background request reloads it.
+	bool stale_while_revalidate = false;
+	// On expiry, compare the remote DuckLake snapshot id and reload only the schemas and tables changed since.
+	bool snapshot_invalidation = false;
+	// Start listing schemas and their tables on background threads as soon as ATTACH connects.
+	bool prefetch_metadata = false;
+	// Schemas whose tables prefetch_metadata lists at the same time.
+	size_t metadata_concurrency = DEFAULT_METADATA_CONCURRENCY;
+	// List tables by name only and fetch a table's Arrow schema when it is first bound.
+	bool lazy_table_schemas = false;
+	// Directory of the on-disk metadata cache shared by processes attaching the same catalog
+	// (empty disables it).
+	std::string metadata_cache_dir;
+	// Memory budget of the snapshot-keyed remote scan result cache (0 disables it).
+	size_t result_cache_bytes = 0;
+	// Let the optimizer rewrite filters, aggregates, limits and joins over remote scans into remote SQL.
+	bool pushdown = true;
+	// IN-list scan filters with at least this many values are uploaded to a temporary table on the
+	// server and applied as a semi-join instead of inline SQL text (0 disables).
+	size_t in_list_upload_threshold = 0;
+	// Local join inputs estimated at up to this many rows are uploaded to a temporary table so the join
+	// runs remotely, when that transfers fewer rows than streaming the remote input (0 disables).
+	size_t join_upload_rows = 0;
+	// Buffer budget of remote scans of one query that read the same rows and share one remote query
+	// (0 disables sharing).
+	size_t shared_scan_bytes = 0;
+	// Load INSERT/CTAS data through Flight SQL bulk ingest when the server supports it.
+	bool bulk_ingest = true;
+	// Send other INSERT data as Arrow parameters of one prepared INSERT ... VALUES (?, ...) statement
+	// when the server supports parameter binding.
+	bool prepared_insert = true;
+	// Run MERGE/UPDATE/DELETE statements that read one local table remotely, against an uploaded copy.
+	bool hybrid_dml = false;
+	// In explicit transactions, let an INSERT complete without waiting for its last remote write, so
+	// the writes of consecutive statements overlap; errors surface by the commit at the latest.
+	bool pipelined_transactions = false;
+	// Rows buffered per sink thread before an INSERT/CTAS batch is sent; a batch is also sent once
+	// it reaches insert_batch_bytes.
+	size_t insert_batch_rows = DEFAULT_INSERT_BATCH_ROWS;
+	size_t insert_batch_bytes = DEFAULT_INSERT_BATCH_BYTES;
+	// Record trace spans of Flight calls, catalog loads and remote DML (process-wide, like POSTHOG_TRACE=1).
+	bool trace = false;
 	std::unordered_map<std::string, std::string> options;
 
 	static constexpr const char *DEFAULT_FLIGHT_SERVER = "grpc+tls://127.0.0.1:8815";
+	static constexpr size_t DEFAULT_POOL_SIZE = 1;
+	static constexpr size_t MAX_POOL_SIZE = 64;
+	static constexpr size_t DEFAULT_SCAN_BATCH_ROWS = 65536;
+	static constexpr size_t MAX_SCAN_BATCH_ROWS = 100000000;
+	static constexpr size_t DEFAULT_SCAN_BATCH_BYTES = 16ULL * 1024 * 1024;
+	static constexpr size_t MAX_SCAN_SPLITS = 1024;
+	static constexpr size_t MAX_IN_LIST_UPLOAD_THRESHOLD = 100000000;
+	static constexpr size_t MAX_JOIN_UPLOAD_ROWS = 100000000;
+	static constexpr size_t MAX_METADATA_TIMEOUT_MS = 60 * 60 * 1000;
+	static constexpr size_t MAX_MESSAGE_BYTES = 2147483647;
+	static constexpr size_t MAX_KEEPALIVE_MS = 60 * 60 * 1000;
+	static constexpr size_t DEFAULT_METADATA_CONCURRENCY = 8;
+	static constexpr size_t MAX_METADATA_CONCURRENCY = 64;
+	static constexpr size_t DEFAULT_METADATA_CACHE_TTL = 300;
+	static constexpr size_t MAX_METADATA_CACHE_TTL = 7 * 24 * 60 * 60;
+	static constexpr size_t DEFAULT_INSERT_BATCH_ROWS = 122880;
+	static constexpr size_t DEFAULT_INSERT_BATCH_BYTES = 64ULL * 1024 * 1024;
+	static constexpr size_t MAX_INSERT_BATCH_ROWS = 100000000;
 };
 
 class ConnectionString {
@@ -0,0 +1,218 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// utils/posthog_file_utils.cpp
+//
+// Atomic file replacement and owner-only files for the on-disk caches shared between processes
+//===----------------------------------------------------------------------===//
+
+#include "utils/posthog_file_utils.hpp"
+
+#include <cerrno>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <fcntl.h>
+#include <filesystem>
+#include <random>
+#include <sys/stat.h>
+#include <system_error>
+
+#if defined(_WIN32)
+#include <io.h>
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace duckdb {
+
+namespace {
+
+#if defined(_WIN32)
+int OpenExclusive(const std::string &path, bool owner_only) {
+	(void)owner_only;
+	return _open(path.c_str(), _O_CREAT | _O_EXCL | _O_WRONLY | _O_BINARY, _S_IREAD | _S_IWRITE);
+}
+
+int OpenOwnerOnly(const std::string &path) {
+	return _open(path.c_str(), _O_RDONLY | _O_BINARY);
+}
+
+long long ReadSome(int fd, char *data, size_t size) {
+	return _read(fd, data, static_cast<unsigned int>(size));
+}
+
+bool PrepareOwnerOnlyDirectory(const std::string &path) {
+	std::error_code error;
+	std::filesystem::create_directory(path, error);
+	return std::filesystem::is_directory(path, error);
+}
+
+long long WriteSome(int fd, const char *data, size_t size) {
+	return _write(fd, data, static_cast<unsigned int>(size > 0x40000000 ? 0x40000000 : size));
+}
+
+int CloseFile(int fd) {
+	return _close(fd);
+}
+
+long long ProcessId() {
+	return _getpid();
+}
+
+int PublishExclusively(const std::string &tmp_path, const std::string &path) {
+	// Unlike POSIX rename, the CRT rename fails when the target exists.
+	return std::rename(tmp_path.c_str(), path.c_str());
+}
+#else
+int OpenExclusive(const std::string &path, bool owner_only) {
+	return open(path.c_str(), O_CREAT | O_EXCL | O_WRONLY | O_CLOEXEC, owner_only ? 0600 : 0666);
+}
+
+bool IsOwnerOnly(const struct stat &st) {
+	return st.st_uid == geteuid() && (st.st_mode & 077) == 0;
+}
+
+// Opens path for reading if it is a regular owner-only file, and not a symbolic link to one.
+int OpenOwnerOnly(const std::string &path) {
+	auto fd = open(path.c_str(), O_RDONLY | O_CLOEXEC | O_NOFOLLOW);
+	if (fd < 0) {
+		return fd;
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || !IsOwnerOnly(st)) {
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+long long ReadSome(int fd, char *data, size_t size) {
+	return read(fd, data, size);
+}
+
+bool PrepareOwnerOnlyDirectory(const std::string &path) {
+	if (mkdir(path.c_str(), 0700) != 0 && errno != EEXIST) {
+		return false;
+	}
+	struct stat st;
+	return lstat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode) && IsOwnerOnly(st);
+}
+
+long long WriteSome(int fd, const char *data, size_t size) {
+	return write(fd, data, size);
+}
+
+int CloseFile(int fd) {
+	return close(fd);
+}
+
+long long ProcessId() {
+	return getpid();
+}
+
+int PublishExclusively(const std::string &tmp_path, const std::string &path) {
+	// link fails with EEXIST rather than replacing path; the scratch name is dropped either way.
+	auto result = link(tmp_path.c_str(), path.c_str());
+	std::remove(tmp_path.c_str());
+	return result;
+}
+#endif
+
+// Writes contents to a new scratch sibling of path and returns its name; empty, leaving nothing
+// behind, on any error.
+std::string WriteScratchFile(const std::string &path, const std::string &contents, bool owner_only) {
+	auto tmp_path = path + ".tmp" + PostHogUniqueFileSuffix();
+	// The mode applies at creation, so not even an owner-only file is ever readable by others.
+	auto fd = OpenExclusive(tmp_path, owner_only);
+	if (fd < 0) {
+		return "";
+	}
+	bool ok = true;
+	size_t written = 0;
+	while (written < contents.size()) {
+		auto result = WriteSome(fd, contents.data() + written, contents.size() - written);
+		if (result < 0 && errno == EINTR) {
+			continue;
+		}
+		if (result <= 0) {
+			ok = false;
+			break;
+		}
+		written += static_cast<size_t>(result);
+	}
+	if (CloseFile(fd) != 0) {
+		ok = false;
+	}
+	if (!ok) {
+		std::remove(tmp_path.c_str());
+		return "";
+	}
+	return tmp_path;
+}
+
+} // namespace
+
+std::string PostHogUniqueFileSuffix() {
+	std::random_device random;
+	auto bits = (static_cast<uint64_t>(random()) << 32) ^ static_cast<uint64_t>(random());
+	char suffix[64];
+	snprintf(suffix, sizeof(suffix), ".%lld.%016" PRIx64, ProcessId(), bits);
+	return suffix;
+}
+
+bool PostHogWriteFileAtomically(const std::string &path, const std::string &contents, bool owner_only) {
+	auto tmp_path = WriteScratchFile(path, contents, owner_only);
+	if (tmp_path.empty()) {
+		return false;
+	}
+	if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+		std::remove(tmp_path.c_str());
+		return false;
+	}
+	return true;
+}
+
+bool PostHogReadOwnerOnlyFile(const std::string &path, std::string &contents) {
+	auto fd = OpenOwnerOnly(path);
+	if (fd < 0) {
+		return false;
+	}
+	contents.clear();
+	char buffer[4096];
+	bool ok = true;
+	while (true) {
+		auto result = ReadSome(fd, buffer, sizeof(buffer));
+		if (result < 0 && errno == EINTR) {
+			continue;
+		}
+		if (result < 0) {
+			ok = false;
+		}
+		if (result <= 0) {
+			break;
+		}
+		contents.append(buffer, static_cast<size_t>(result));
+	}
+	CloseFile(fd);
+	return ok;
+}
+
+bool PostHogPrepareOwnerOnlyDirectory(const std::string &path) {
+	return PrepareOwnerOnlyDirectory(path);
+}
+
+bool PostHogCreateFileExclusively(const std::string &path, const std::string &contents, bool owner_only) {
+	auto tmp_path = WriteScratchFile(path, contents, owner_only);
+	if (tmp_path.empty()) {
+		return false;
+	}
+	if (PublishExclusively(tmp_path, path) != 0) {
+		std::remove(tmp_path.c_str());
+		return false;
+	}
+	return true;
+}
+
+} // namespace duckdb
@@ -0,0 +1,40 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// utils/posthog_file_utils.hpp
+//
+// Atomic file replacement and owner-only files for the on-disk caches shared between processes
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+
+namespace duckdb {
+
+// Suffix for scratch files next to a shared file, distinct across processes and threads (process
+// id plus 64 random bits).
+std::string PostHogUniqueFileSuffix();
+
+// Writes contents to a new sibling of path, created exclusively (O_CREAT | O_EXCL) with mode 0600
+// when owner_only (otherwise 0666 minus the umask), and renames it over path, so readers never see
+// a partial file and no two writers share a scratch file. Returns false, leaving nothing behind,
+// on any error.
+bool PostHogWriteFileAtomically(const std::string &path, const std::string &contents, bool owner_only);
+
+// Like PostHogWriteFileAtomically, but publishes the scratch file with a hard link (a rename on
+// Windows) that fails when path exists, so of several concurrent writers exactly one succeeds and an
+// existing file is never replaced. Returns false, leaving nothing behind, when path exists or on any
+// error.
+bool PostHogCreateFileExclusively(const std::string &path, const std::string &contents, bool owner_only);
+
+// Reads the file at path into contents. False when it cannot be read, or when it is not a regular
+// file owned by the effective user without any permission for group or others; checked on the open
+// file, so it cannot be swapped for another in between. Windows only reads it.
+bool PostHogReadOwnerOnlyFile(const std::string &path, std::string &contents);
+
+// Creates the directory path with mode 0700 unless it exists. False unless path then is a directory
+// owned by the effective user without any permission for group or others. Windows only creates it.
+bool PostHogPrepareOwnerOnlyDirectory(const std::string &path);
+
+} // namespace duckdb
@@ -8,12 +8,12 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cstdio>
 #include <cstdlib>
-#include <iomanip>
-#include <iostream>
-#include <mutex>
-#include <sstream>
+#include <ctime>
 #include <string>
 
 namespace duckdb {
@@ -30,12 +30,12 @@ public:
 
 	// Set the log level
 	void SetLevel(PostHogLogLevel level) {
-		log_level_ = level;
+		log_level_.store(level, std::memory_order_relaxed);
 	}
 
 	// Get the current log level
 	PostHogLogLevel GetLevel() const {
-		return log_level_;
+		return log_level_.load(std::memory_order_relaxed);
 	}
 
 	// Enable/disable timestamps
@@ -106,22 +106,18 @@ private:
 
 	// Overload for no-argument case to avoid format security warning
 	void Log(PostHogLogLevel level, const char *message) {
-		if (level < log_level_) {
+		if (level < GetLevel()) {
 			return;
 		}
-
-		std::lock_guard<std::mutex> lock(mutex_);
-		std::cerr << FormatPrefix(level) << message << '\n';
+		Write(level, message);
 	}
 
 	template <typename... Args>
 	void Log(PostHogLogLevel level, const char *format, Args... args) {
-		if (level < log_level_) {
+		if (level < GetLevel()) {
 			return;
 		}
 
-		std::lock_guard<std::mutex> lock(mutex_);
-
 		// Format the message
 		char buffer[4096];
 #if defined(__clang__)
@@ -133,48 +129,54 @@ private:
 #pragma clang diagnostic pop
 #endif
 
-		std::cerr << FormatPrefix(level) << buffer << '\n';
+		Write(level, buffer);
 	}
 
-	std::string FormatPrefix(PostHogLogLevel level) {
-		std::ostringstream oss;
+	// Emits the whole line with one fwrite, which stdio performs under the stream's own lock, so
+	// concurrent lines never interleave and no logger-wide mutex is needed.
+	void Write(PostHogLogLevel level, const char *message) {
+		char line[4352];
+		size_t length = 0;
 
 		// Add timestamp if enabled
-		if (show_timestamps_) {
+		if (show_timestamps_.load(std::memory_order_relaxed)) {
 			auto now = std::chrono::system_clock::now();
 			auto time = std::chrono::system_clock::to_time_t(now);
 			auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()) % 1000;
-			oss << std::put_time(std::localtime(&time), "%Y-%m-%d %H:%M:%S");
-			oss << "." << std::setfill('0') << std::setw(3) << ms.count() << " ";
+			std::tm local_time {};
+#if defined(_WIN32)
+			localtime_s(&local_time, &time);
+#else
+			localtime_r(&time, &local_time);
+#endif
+			length = std::strftime(line, sizeof(line), "%Y-%m-%d %H:%M:%S", &local_time);
+			length += snprintf(line + length, sizeof(line) - length, ".%03d ", static_cast<int>(ms.count()));
 		}
 
-		// Add prefix
-		oss << "[PostHog]";
-
-		// Add level
+		const char *level_tag = "";
 		switch (level) {
 		case PostHogLogLevel::Debug:
-			oss << "[DEBUG] ";
+			level_tag = "[DEBUG] ";
 			break;
 		case PostHogLogLevel::Info:
-			oss << " ";
+			level_tag = " ";
 			break;
 		case PostHogLogLevel::Warn:
-			oss << "[WARN] ";
+			level_tag = "[WARN] ";
 			break;
 		case PostHogLogLevel::Error:
-			oss << "[ERROR] ";
+			level_tag = "[ERROR] ";
 			break;
 		default:
 			break;
 		}
-
-		return oss.str();
+		auto written = snprintf(line + length, sizeof(line) - length, "[PostHog]%s%s\n", level_tag, message);
+		length = std::min(sizeof(line) - 1, length + static_cast<size_t>(written < 0 ? 0 : written));
+		std::fwrite(line, 1, length, stderr);
 	}
 
-	PostHogLogLevel log_level_;
-	bool show_timestamps_;
-	std::mutex mutex_;
+	std::atomic<PostHogLogLevel> log_level_;
+	std::atomic<bool> show_timestamps_;
 };
 
 // Convenience macros for logging
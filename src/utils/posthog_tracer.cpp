@@ -0,0 +1,309 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// utils/posthog_tracer.cpp
+//
+// Per-thread span ring buffers with W3C trace context and OTLP/JSON export
+//===----------------------------------------------------------------------===//
+
+#include "utils/posthog_tracer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <random>
+#include <thread>
+#include <type_traits>
+
+namespace duckdb {
+
+static_assert(std::is_trivially_copyable<PostHogTraceSpan>::value, "ring slots are copied without locks");
+
+struct PostHogTracer::Ring {
+	// sequence is odd while the owning thread rewrites span.
+	struct Slot {
+		std::atomic<uint64_t> sequence {0};
+		PostHogTraceSpan span;
+	};
+
+	std::array<Slot, RING_CAPACITY> slots;
+	// Spans written so far; slot index is head % RING_CAPACITY.
+	std::atomic<uint64_t> head {0};
+	// Spans before this index were cleared.
+	std::atomic<uint64_t> cleared_until {0};
+	// Set when the owning thread exits.
+	std::atomic<bool> retired {false};
+};
+
+namespace {
+
+thread_local PostHogTraceContext current_context {};
+
+// Keeps the calling thread's ring alive in the tracer after the thread exits.
+struct LocalRingHolder {
+	std::shared_ptr<void> ring;
+	std::atomic<bool> *retired = nullptr;
+
+	~LocalRingHolder() {
+		if (retired) {
+			retired->store(true);
+		}
+	}
+};
+
+thread_local LocalRingHolder local_ring;
+
+uint64_t RandomId() {
+	thread_local std::mt19937_64 generator([]() {
+		std::random_device device;
+		auto seed = (static_cast<uint64_t>(device()) << 32) ^ device();
+		seed ^= std::hash<std::thread::id>()(std::this_thread::get_id());
+		seed ^= static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+		return seed;
+	}());
+	uint64_t id;
+	do {
+		id = generator();
+	} while (id == 0);
+	return id;
+}
+
+int64_t UnixNanosNow() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch())
+	    .count();
+}
+
+void AppendHex(std::string &out, uint64_t value) {
+	char buffer[17];
+	std::snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(value));
+	out += buffer;
+}
+
+void AppendJsonString(std::string &out, const char *value) {
+	out += '"';
+	for (auto *c = value; *c; c++) {
+		switch (*c) {
+		case '"':
+			out += "\\\"";
+			break;
+		case '\\':
+			out += "\\\\";
+			break;
+		case '\n':
+			out += "\\n";
+			break;
+		case '\r':
+			out += "\\r";
+			break;
+		case '\t':
+			out += "\\t";
+			break;
+		default:
+			if (static_cast<unsigned char>(*c) < 0x20) {
+				char buffer[8];
+				std::snprintf(buffer, sizeof(buffer), "\\u%04x", static_cast<unsigned>(*c));
+				out += buffer;
+			} else {
+				out += *c;
+			}
+		}
+	}
+	out += '"';
+}
+
+} // namespace
+
+std::string PostHogTraceContext::ToTraceParent() const {
+	std::string result = "00-";
+	AppendHex(result, trace_id_high);
+	AppendHex(result, trace_id_low);
+	result += '-';
+	AppendHex(result, span_id);
+	result += "-01";
+	return result;
+}
+
+PostHogTracer::PostHogTracer() : enabled_(false) {
+	const char *trace_str = std::getenv("POSTHOG_TRACE");
+	if (trace_str && (std::string(trace_str) == "1" || std::string(trace_str) == "true")) {
+		enabled_ = true;
+	}
+}
+
+PostHogTracer &PostHogTracer::Instance() {
+	static PostHogTracer instance;
+	return instance;
+}
+
+PostHogTraceContext PostHogTracer::Current() {
+	return current_context;
+}
+
+PostHogTracer::Ring &PostHogTracer::LocalRing() {
+	if (local_ring.ring) {
+		return *static_cast<Ring *>(local_ring.ring.get());
+	}
+	auto ring = std::make_shared<Ring>();
+	{
+		std::lock_guard<std::mutex> guard(rings_mutex_);
+		size_t retired = std::count_if(rings_.begin(), rings_.end(), [](const std::shared_ptr<Ring> &entry) {
+			return entry->retired.load();
+		});
+		for (auto it = rings_.begin(); it != rings_.end() && retired >= MAX_RETIRED_RINGS;) {
+			if ((*it)->retired.load()) {
+				it = rings_.erase(it);
+				retired--;
+			} else {
+				++it;
+			}
+		}
+		rings_.push_back(ring);
+	}
+	local_ring.retired = &ring->retired;
+	local_ring.ring = ring;
+	return *ring;
+}
+
+void PostHogTracer::Finish(PostHogTraceSpan &span, bool error) {
+	span.end_unix_nanos = UnixNanosNow();
+	span.error = error;
+	Record(span);
+}
+
+void PostHogTracer::Record(const PostHogTraceSpan &span) {
+	// Single writer per ring: only the owning thread advances head.
+	auto &ring = LocalRing();
+	auto index = ring.head.load(std::memory_order_relaxed);
+	auto &slot = ring.slots[index % RING_CAPACITY];
+	auto sequence = slot.sequence.load(std::memory_order_relaxed);
+	slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	std::memcpy(&slot.span, &span, sizeof(PostHogTraceSpan));
+	slot.sequence.store(sequence + 2, std::memory_order_release);
+	ring.head.store(index + 1, std::memory_order_release);
+}
+
+std::vector<PostHogTraceSpan> PostHogTracer::Snapshot() const {
+	return Collect(false);
+}
+
+std::vector<PostHogTraceSpan> PostHogTracer::Drain() {
+	return Collect(true);
+}
+
+std::vector<PostHogTraceSpan> PostHogTracer::Collect(bool drain) const {
+	std::vector<PostHogTraceSpan> result;
+	// Held only against ring registration and concurrent drains; writers never take it.
+	std::lock_guard<std::mutex> guard(rings_mutex_);
+	for (auto &ring : rings_) {
+		auto head = ring->head.load(std::memory_order_acquire);
+		auto begin = std::max(ring->cleared_until.load(std::memory_order_relaxed),
+		                      head > RING_CAPACITY ? head - RING_CAPACITY : 0);
+		for (auto index = begin; index < head; index++) {
+			auto &slot = ring->slots[index % RING_CAPACITY];
+			auto before = slot.sequence.load(std::memory_order_acquire);
+			if (before & 1) {
+				continue;
+			}
+			PostHogTraceSpan span;
+			std::memcpy(&span, &slot.span, sizeof(PostHogTraceSpan));
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (slot.sequence.load(std::memory_order_relaxed) != before) {
+				// Overwritten by a newer span while copying.
+				continue;
+			}
+			span.detail[PostHogTraceSpan::DETAIL_SIZE - 1] = '\0';
+			result.push_back(span);
+		}
+		if (drain) {
+			ring->cleared_until.store(head, std::memory_order_relaxed);
+		}
+	}
+	return result;
+}
+
+std::string PostHogTracer::ToOTLPJson(const std::vector<PostHogTraceSpan> &spans) {
+	std::string out = "{\"resourceSpans\":[{\"resource\":{\"attributes\":[{\"key\":\"service.name\",\"value\":"
+	                  "{\"stringValue\":\"duckhog\"}}]},\"scopeSpans\":[{\"scope\":{\"name\":\"duckhog\"},\"spans\":[";
+	for (size_t i = 0; i < spans.size(); i++) {
+		auto &span = spans[i];
+		if (i > 0) {
+			out += ',';
+		}
+		out += "{\"traceId\":\"";
+		AppendHex(out, span.context.trace_id_high);
+		AppendHex(out, span.context.trace_id_low);
+		out += "\",\"spanId\":\"";
+		AppendHex(out, span.context.span_id);
+		out += '"';
+		if (span.parent_span_id != 0) {
+			out += ",\"parentSpanId\":\"";
+			AppendHex(out, span.parent_span_id);
+			out += '"';
+		}
+		out += ",\"name\":";
+		AppendJsonString(out, span.name);
+		// SPAN_KIND_INTERNAL; OTLP/JSON encodes 64-bit integers as strings.
+		out += ",\"kind\":1,\"startTimeUnixNano\":\"" + std::to_string(span.start_unix_nanos) +
+		       "\",\"endTimeUnixNano\":\"" + std::to_string(span.end_unix_nanos) + "\"";
+		if (span.detail[0]) {
+			out += ",\"attributes\":[{\"key\":\"duckhog.detail\",\"value\":{\"stringValue\":";
+			AppendJsonString(out, span.detail);
+			out += "}}]";
+		}
+		// STATUS_CODE_ERROR or STATUS_CODE_OK.
+		out += span.error ? ",\"status\":{\"code\":2}}" : ",\"status\":{\"code\":1}}";
+	}
+	out += "]}]}]}";
+	return out;
+}
+
+PostHogTraceScope::PostHogTraceScope(const char *name, const std::string &detail) {
+	if (!PostHogTracer::Instance().IsEnabled()) {
+		return;
+	}
+	active_ = true;
+	uncaught_at_start_ = std::uncaught_exceptions();
+	previous_ = current_context;
+	if (previous_.IsValid()) {
+		span_.context.trace_id_high = previous_.trace_id_high;
+		span_.context.trace_id_low = previous_.trace_id_low;
+	} else {
+		span_.context.trace_id_high = RandomId();
+		span_.context.trace_id_low = RandomId();
+	}
+	span_.context.span_id = RandomId();
+	span_.parent_span_id = previous_.span_id;
+	span_.start_unix_nanos = UnixNanosNow();
+	span_.end_unix_nanos = 0;
+	span_.name = name;
+	span_.error = false;
+	auto length = std::min(detail.size(), PostHogTraceSpan::DETAIL_SIZE - 1);
+	std::memcpy(span_.detail, detail.data(), length);
+	span_.detail[length] = '\0';
+	current_context = span_.context;
+}
+
+PostHogTraceScope::~PostHogTraceScope() {
+	if (!active_) {
+		return;
+	}
+	current_context = previous_;
+	PostHogTracer::Instance().Finish(span_, std::uncaught_exceptions() > uncaught_at_start_);
+}
+
+bool PostHogTraceScope::Detach(PostHogTraceSpan &span) {
+	if (!active_) {
+		return false;
+	}
+	active_ = false;
+	current_context = previous_;
+	span = span_;
+	return true;
+}
+
+} // namespace duckdb
@@ -0,0 +1,120 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// utils/posthog_tracer.hpp
+//
+// Per-thread span ring buffers with W3C trace context and OTLP/JSON export
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace duckdb {
+
+// W3C trace context of a span: 128-bit trace id and 64-bit span id, zero when unset.
+struct PostHogTraceContext {
+	uint64_t trace_id_high;
+	uint64_t trace_id_low;
+	uint64_t span_id;
+
+	bool IsValid() const {
+		return span_id != 0;
+	}
+	// "00-<32 hex trace id>-<16 hex span id>-01", the value of the traceparent header.
+	std::string ToTraceParent() const;
+};
+
+// One span. Fixed-size and trivially copyable, so ring slots can be overwritten without locks.
+struct PostHogTraceSpan {
+	static constexpr size_t DETAIL_SIZE = 160;
+
+	PostHogTraceContext context;
+	uint64_t parent_span_id;
+	int64_t start_unix_nanos;
+	int64_t end_unix_nanos;
+	// String literal naming the operation, e.g. "ExecuteUpdate" or "LoadTables".
+	const char *name;
+	bool error;
+	// NUL-terminated detail (remote SQL, schema or table name), truncated to fit.
+	char detail[DETAIL_SIZE];
+};
+
+// Process-wide span sink. Each thread appends finished spans to its own ring of RING_CAPACITY
+// slots (a seqlock per slot), so recording takes no lock once the thread's ring exists; readers
+// copy slots and drop the ones overwritten meanwhile. While disabled, a scope costs one relaxed
+// atomic load. Enabled by POSTHOG_TRACE=1 or the trace attach option.
+class PostHogTracer {
+public:
+	static constexpr size_t RING_CAPACITY = 512;
+	// Rings of exited threads kept for reading; older ones are dropped when new threads record.
+	static constexpr size_t MAX_RETIRED_RINGS = 16;
+
+	static PostHogTracer &Instance();
+
+	bool IsEnabled() const {
+		return enabled_.load(std::memory_order_relaxed);
+	}
+	void SetEnabled(bool enabled) {
+		enabled_.store(enabled, std::memory_order_relaxed);
+	}
+
+	// Sets the end time and status of a span started by PostHogTraceScope and records it.
+	void Finish(PostHogTraceSpan &span, bool error);
+	// Appends span to the calling thread's ring, overwriting its oldest span when full.
+	void Record(const PostHogTraceSpan &span);
+	// Spans retained by every ring, oldest first within each thread.
+	std::vector<PostHogTraceSpan> Snapshot() const;
+	// Like Snapshot, but the returned spans are left out of later snapshots (export without repeats).
+	std::vector<PostHogTraceSpan> Drain();
+
+	// Context of the innermost open scope on the calling thread; invalid when there is none.
+	static PostHogTraceContext Current();
+
+	// One OTLP/JSON ExportTraceServiceRequest (the format of the Collector's otlpjsonfile
+	// receiver) holding spans, on a single line.
+	static std::string ToOTLPJson(const std::vector<PostHogTraceSpan> &spans);
+
+private:
+	struct Ring;
+
+	PostHogTracer();
+	Ring &LocalRing();
+	std::vector<PostHogTraceSpan> Collect(bool drain) const;
+
+	std::atomic<bool> enabled_;
+	// Only taken when a thread records its first span, and by readers.
+	mutable std::mutex rings_mutex_;
+	std::vector<std::shared_ptr<Ring>> rings_;
+};
+
+// Measures one operation on the calling thread. A scope opened while another is open on the same
+// thread becomes its child; Flight calls made inside it send its context as traceparent.
+class PostHogTraceScope {
+public:
+	// name must be a string literal. Nothing is measured while tracing is disabled.
+	explicit PostHogTraceScope(const char *name, const std::string &detail = std::string());
+	// Records the span, with error status if it is left through an exception.
+	~PostHogTraceScope();
+
+	PostHogTraceScope(const PostHogTraceScope &) = delete;
+	PostHogTraceScope &operator=(const PostHogTraceScope &) = delete;
+
+	// Hands the open span to the caller, who ends it with PostHogTracer::Finish (e.g. once a
+	// query stream is closed), and restores the thread's previous context. False when inactive.
+	bool Detach(PostHogTraceSpan &span);
+
+private:
+	bool active_ = false;
+	int uncaught_at_start_ = 0;
+	PostHogTraceContext previous_;
+	PostHogTraceSpan span_;
+};
+
+} // namespace duckdb
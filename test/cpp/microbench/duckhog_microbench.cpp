@@ -0,0 +1,348 @@
+//===----------------------------------------------------------------------===//
+//                         PostHog DuckDB Extension
+//
+// test/cpp/microbench/duckhog_microbench.cpp
+//
+// Offline microbenchmarks of SQL generation, filter translation and DML rewriting
+//===----------------------------------------------------------------------===//
+
+#include "duckdb/common/allocator.hpp"
+#include "duckdb/common/types/column/column_data_collection.hpp"
+#include "duckdb/common/types/data_chunk.hpp"
+#include "duckdb/planner/filter/conjunction_filter.hpp"
+#include "duckdb/planner/filter/constant_filter.hpp"
+#include "duckdb/planner/filter/in_filter.hpp"
+#include "execution/posthog_dml_rewriter.hpp"
+#include "execution/posthog_sql_utils.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <regex>
+
+using namespace duckdb;
+
+namespace {
+
+// One timed call: returns the bytes of SQL it produced, which also keeps the work from being optimized out.
+using BenchmarkBody = std::function<size_t()>;
+
+struct MicroBenchmark {
+	const char *name;
+	// Builds the inputs, untimed, and returns the body to time.
+	BenchmarkBody (*setup)();
+};
+
+const string TABLE = "ducklake.bench.events";
+
+vector<string> ColumnNames(idx_t count) {
+	vector<string> names;
+	for (idx_t i = 0; i < count; i++) {
+		names.push_back("c" + std::to_string(i));
+	}
+	return names;
+}
+
+// A full vector of rows, filled through make_value(column, row).
+unique_ptr<DataChunk> MakeChunk(const vector<LogicalType> &types,
+                                const std::function<Value(idx_t, idx_t)> &make_value) {
+	auto chunk = make_uniq<DataChunk>();
+	chunk->Initialize(Allocator::DefaultAllocator(), types);
+	for (idx_t row = 0; row < STANDARD_VECTOR_SIZE; row++) {
+		for (idx_t col = 0; col < types.size(); col++) {
+			chunk->SetValue(col, row, make_value(col, row));
+		}
+	}
+	chunk->SetCardinality(STANDARD_VECTOR_SIZE);
+	return chunk;
+}
+
+// 64 columns cycling through the scalar types INSERTs most often carry.
+BenchmarkBody InsertWideChunk() {
+	const vector<LogicalType> cycle = {LogicalType::INTEGER,       LogicalType::BIGINT,  LogicalType::DOUBLE,
+	                                   LogicalType::VARCHAR,       LogicalType::DATE,    LogicalType::TIMESTAMP,
+	                                   LogicalType::DECIMAL(18, 3), LogicalType::BOOLEAN};
+	vector<LogicalType> types;
+	for (idx_t i = 0; i < 64; i++) {
+		types.push_back(cycle[i % cycle.size()]);
+	}
+	auto make_value = [&types](idx_t col, idx_t row) {
+		auto n = static_cast<int64_t>(row * 64 + col);
+		switch (types[col].id()) {
+		case LogicalTypeId::INTEGER:
+			return Value::INTEGER(static_cast<int32_t>(n));
+		case LogicalTypeId::BIGINT:
+			return Value::BIGINT(n * 1000003);
+		case LogicalTypeId::DOUBLE:
+			return Value::DOUBLE(static_cast<double>(n) / 7.0);
+		case LogicalTypeId::VARCHAR:
+			return Value("event_" + std::to_string(n % 97));
+		case LogicalTypeId::DATE:
+			return Value::DATE(date_t(static_cast<int32_t>(19000 + n % 1000)));
+		case LogicalTypeId::TIMESTAMP:
+			return Value::TIMESTAMP(timestamp_t(1700000000000000LL + n * 1000));
+		case LogicalTypeId::DECIMAL:
+			return Value::DECIMAL(n * 1001, 18, 3);
+		default:
+			return Value::BOOLEAN(n % 2 == 0);
+		}
+	};
+	auto chunk = MakeChunk(types, make_value);
+	auto names = ColumnNames(types.size());
+	return [chunk = std::shared_ptr<DataChunk>(std::move(chunk)), names]() {
+		return BuildInsertSQL(TABLE, names, *chunk).size();
+	};
+}
+
+// STRUCT, MAP and LIST columns, whose literals are rendered recursively.
+BenchmarkBody InsertNestedChunk() {
+	auto struct_type = LogicalType::STRUCT({{"id", LogicalType::INTEGER}, {"name", LogicalType::VARCHAR}});
+	auto map_type = LogicalType::MAP(LogicalType::VARCHAR, LogicalType::BIGINT);
+	auto list_type = LogicalType::LIST(LogicalType::DOUBLE);
+	vector<LogicalType> types = {struct_type, map_type, list_type};
+	auto make_value = [](idx_t col, idx_t row) {
+		auto n = static_cast<int64_t>(row);
+		if (col == 0) {
+			child_list_t<Value> fields = {{"id", Value::INTEGER(static_cast<int32_t>(n))},
+			                              {"name", Value("person " + std::to_string(n))}};
+			return Value::STRUCT(std::move(fields));
+		}
+		if (col == 1) {
+			vector<Value> keys;
+			vector<Value> values;
+			for (int64_t i = 0; i < 8; i++) {
+				keys.emplace_back("$prop_" + std::to_string(i));
+				values.push_back(Value::BIGINT(n * 8 + i));
+			}
+			return Value::MAP(LogicalType::VARCHAR, LogicalType::BIGINT, std::move(keys), std::move(values));
+		}
+		vector<Value> elements;
+		for (int64_t i = 0; i < 16; i++) {
+			elements.push_back(Value::DOUBLE(static_cast<double>(n + i) / 3.0));
+		}
+		return Value::LIST(LogicalType::DOUBLE, std::move(elements));
+	};
+	auto chunk = MakeChunk(types, make_value);
+	auto names = ColumnNames(types.size());
+	return [chunk = std::shared_ptr<DataChunk>(std::move(chunk)), names]() {
+		return BuildInsertSQL(TABLE, names, *chunk).size();
+	};
+}
+
+// Long strings with quotes to escape.
+BenchmarkBody InsertQuotedStrings() {
+	vector<LogicalType> types(4, LogicalType::VARCHAR);
+	auto make_value = [](idx_t col, idx_t row) {
+		return Value("it's row " + std::to_string(row) + " of column " + std::to_string(col) +
+		             ", with a 'quoted' part and enough text to be realistic");
+	};
+	auto chunk = MakeChunk(types, make_value);
+	auto names = ColumnNames(types.size());
+	return [chunk = std::shared_ptr<DataChunk>(std::move(chunk)), names]() {
+		return BuildInsertSQL(TABLE, names, *chunk).size();
+	};
+}
+
+// The VALUES entry join uploads fall back to on servers without bulk ingest.
+BenchmarkBody ValuesCTE() {
+	vector<LogicalType> types = {LogicalType::BIGINT, LogicalType::VARCHAR, LogicalType::DOUBLE};
+	auto rows = std::make_shared<ColumnDataCollection>(Allocator::DefaultAllocator(), types);
+	auto make_value = [](idx_t col, idx_t row) {
+		auto n = static_cast<int64_t>(row);
+		return col == 0 ? Value::BIGINT(n) : col == 1 ? Value("k" + std::to_string(n)) : Value::DOUBLE(n * 0.5);
+	};
+	auto chunk = MakeChunk(types, make_value);
+	for (idx_t i = 0; i < 8; i++) {
+		rows->Append(*chunk);
+	}
+	auto names = ColumnNames(types.size());
+	return [rows, names]() {
+		return BuildValuesCTE("upload", names, *rows).size();
+	};
+}
+
+BenchmarkBody FilterHugeIntegerInList() {
+	vector<Value> values;
+	for (int64_t i = 0; i < 100000; i++) {
+		values.push_back(Value::BIGINT(i * 13));
+	}
+	auto filter = std::make_shared<InFilter>(std::move(values));
+	return [filter]() {
+		return FilterToSQL(*filter, "\"user_id\"").size();
+	};
+}
+
+BenchmarkBody FilterHugeStringInList() {
+	vector<Value> values;
+	for (int64_t i = 0; i < 20000; i++) {
+		values.emplace_back("distinct_id_" + std::to_string(i));
+	}
+	auto filter = std::make_shared<InFilter>(std::move(values));
+	return [filter]() {
+		return FilterToSQL(*filter, "\"distinct_id\"").size();
+	};
+}
+
+// An OR of equalities, as DuckDB builds for IN lists it does not turn into an InFilter, under an AND of ranges.
+BenchmarkBody FilterConjunctions() {
+	auto or_filter = make_uniq<ConjunctionOrFilter>();
+	for (int64_t i = 0; i < 2000; i++) {
+		or_filter->child_filters.push_back(make_uniq<ConstantFilter>(ExpressionType::COMPARE_EQUAL, Value::BIGINT(i)));
+	}
+	auto filter = std::make_shared<ConjunctionAndFilter>();
+	filter->child_filters.push_back(
+	    make_uniq<ConstantFilter>(ExpressionType::COMPARE_GREATERTHANOREQUAL, Value::BIGINT(0)));
+	filter->child_filters.push_back(make_uniq<ConstantFilter>(ExpressionType::COMPARE_LESSTHAN, Value::BIGINT(5000)));
+	filter->child_filters.push_back(std::move(or_filter));
+	return [filter]() {
+		return FilterToSQL(*filter, "\"id\"").size();
+	};
+}
+
+// A MERGE over 100 columns with several WHEN clauses.
+BenchmarkBody RewriteLongMerge() {
+	string set_list;
+	string insert_columns;
+	string insert_values;
+	for (idx_t i = 0; i < 100; i++) {
+		auto column = "c" + std::to_string(i);
+		set_list += (i ? ", " : "") + column + " = s." + column;
+		insert_columns += (i ? ", " : "") + column;
+		insert_values += (i ? ", s." : "s.") + column;
+	}
+	auto query = std::make_shared<string>(
+	    "MERGE INTO remote_flight.bench.events AS t USING remote_flight.bench.staging AS s ON t.id = s.id "
+	    "WHEN MATCHED AND s.deleted THEN DELETE "
+	    "WHEN MATCHED AND s.version > t.version THEN UPDATE SET " +
+	    set_list + " WHEN NOT MATCHED BY SOURCE AND t.expires_at < now() THEN DELETE WHEN NOT MATCHED THEN INSERT (" +
+	    insert_columns + ") VALUES (" + insert_values + ")");
+	return [query]() {
+		return RewriteRemoteMergeSQL(*query, "remote_flight", "ducklake").non_returning_sql.size();
+	};
+}
+
+// An UPDATE of 200 columns filtered by a long IN list.
+BenchmarkBody RewriteWideUpdate() {
+	string query = "UPDATE remote_flight.bench.events SET ";
+	for (idx_t i = 0; i < 200; i++) {
+		query += (i ? ", c" : "c") + std::to_string(i) + " = c" + std::to_string(i) + " + 1";
+	}
+	query += " WHERE id IN (";
+	for (idx_t i = 0; i < 5000; i++) {
+		query += (i ? ", " : "") + std::to_string(i * 7);
+	}
+	query += ")";
+	auto shared_query = std::make_shared<string>(std::move(query));
+	return [shared_query]() {
+		return RewriteRemoteUpdateSQL(*shared_query, "remote_flight", "ducklake").non_returning_sql.size();
+	};
+}
+
+BenchmarkBody RewriteDeleteInList() {
+	string query = "DELETE FROM remote_flight.bench.events WHERE distinct_id IN (";
+	for (idx_t i = 0; i < 10000; i++) {
+		query += (i ? ", 'id_" : "'id_") + std::to_string(i) + "'";
+	}
+	query += ")";
+	auto shared_query = std::make_shared<string>(std::move(query));
+	return [shared_query]() {
+		return RewriteRemoteDeleteSQL(*shared_query, "remote_flight", "ducklake").non_returning_sql.size();
+	};
+}
+
+const MicroBenchmark BENCHMARKS[] = {
+    {"insert_sql_wide_chunk", InsertWideChunk},
+    {"insert_sql_nested_chunk", InsertNestedChunk},
+    {"insert_sql_quoted_strings", InsertQuotedStrings},
+    {"values_cte", ValuesCTE},
+    {"filter_sql_integer_in_list", FilterHugeIntegerInList},
+    {"filter_sql_string_in_list", FilterHugeStringInList},
+    {"filter_sql_conjunctions", FilterConjunctions},
+    {"rewrite_long_merge", RewriteLongMerge},
+    {"rewrite_wide_update", RewriteWideUpdate},
+    {"rewrite_delete_in_list", RewriteDeleteInList},
+};
+
+struct Options {
+	std::regex filter {".*"};
+	double min_seconds = 1.0;
+	idx_t max_iterations = 10000;
+	bool json = false;
+};
+
+void Usage(const char *program) {
+	std::fprintf(stderr,
+	             "Usage: %s [--filter <regex>] [--min-seconds <s>] [--max-iterations <n>] [--json]\n"
+	             "Times each benchmark until it ran for min-seconds (default 1) or max-iterations times.\n",
+	             program);
+}
+
+bool ParseOptions(int argc, char **argv, Options &options) {
+	for (int i = 1; i < argc; i++) {
+		auto has_value = i + 1 < argc;
+		if (std::strcmp(argv[i], "--filter") == 0 && has_value) {
+			options.filter = std::regex(argv[++i]);
+		} else if (std::strcmp(argv[i], "--min-seconds") == 0 && has_value) {
+			options.min_seconds = std::stod(argv[++i]);
+		} else if (std::strcmp(argv[i], "--max-iterations") == 0 && has_value) {
+			options.max_iterations = std::max<idx_t>(std::stoull(argv[++i]), 1);
+		} else if (std::strcmp(argv[i], "--json") == 0) {
+			options.json = true;
+		} else {
+			return false;
+		}
+	}
+	return true;
+}
+
+void Run(const MicroBenchmark &benchmark, const Options &options) {
+	auto body = benchmark.setup();
+	// Untimed warm-up, also for the allocator.
+	auto bytes = body();
+
+	vector<double> nanos;
+	auto started = std::chrono::steady_clock::now();
+	while (nanos.size() < options.max_iterations) {
+		auto iteration_started = std::chrono::steady_clock::now();
+		bytes = body();
+		auto now = std::chrono::steady_clock::now();
+		nanos.push_back(std::chrono::duration<double, std::nano>(now - iteration_started).count());
+		if (std::chrono::duration<double>(now - started).count() >= options.min_seconds) {
+			break;
+		}
+	}
+	std::sort(nanos.begin(), nanos.end());
+	auto median = nanos[nanos.size() / 2];
+	auto mb_per_second = median > 0 ? static_cast<double>(bytes) / median * 1e9 / (1024.0 * 1024.0) : 0.0;
+	if (options.json) {
+		std::printf("{\"benchmark\": \"%s\", \"iterations\": %zu, \"min_ns\": %.0f, \"median_ns\": %.0f, "
+		            "\"max_ns\": %.0f, \"bytes\": %zu}\n",
+		            benchmark.name, nanos.size(), nanos.front(), median, nanos.back(), bytes);
+	} else {
+		std::printf("%-28s %10zu %14.3f %14.3f %12zu %10.1f\n", benchmark.name, nanos.size(), nanos.front() / 1e6,
+		            median / 1e6, bytes, mb_per_second);
+	}
+	std::fflush(stdout);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	Options options;
+	if (!ParseOptions(argc, argv, options)) {
+		Usage(argv[0]);
+		return 1;
+	}
+	if (!options.json) {
+		std::printf("%-28s %10s %14s %14s %12s %10s\n", "benchmark", "iters", "min_ms", "median_ms", "sql_bytes",
+		            "MB/s");
+	}
+	for (auto &benchmark : BENCHMARKS) {
+		if (std::regex_search(benchmark.name, options.filter)) {
+			Run(benchmark, options);
+		}
+	}
+	return 0;
+}
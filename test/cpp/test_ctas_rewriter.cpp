@@ -470,3 +470,104 @@ TEST_CASE("CTAS rewriter - does not modify original on_conflict", "[duckhog][dml
 	REQUIRE(info->on_conflict == OnCreateConflict::IGNORE_ON_CONFLICT);
 	REQUIRE(info->catalog == CTAS_ATTACHED);
 }
+
+// --- Server-side CTAS (full statement rewrite) ---
+
+static bool RewriteFullCTAS(const string &query, string &sql) {
+	CreateTableInfo target(CTAS_ATTACHED, "s", "t");
+	return TryRewriteRemoteCreateTableAsSQL(query, target, CTAS_ATTACHED, CTAS_REMOTE, sql);
+}
+
+TEST_CASE("CTAS rewriter - full statement rewrites source and target catalogs", "[duckhog][dml-rewriter][ctas]") {
+	string sql;
+	REQUIRE(RewriteFullCTAS("CREATE TABLE remote_flight.s.t AS SELECT id, count(*) AS n FROM remote_flight.s.events "
+	                        "WHERE id > 10 GROUP BY id",
+	                        sql));
+
+	REQUIRE(sql.find("remote_flight") == string::npos);
+	REQUIRE(sql.find("CREATE TABLE ducklake.s.t AS SELECT") != string::npos);
+	REQUIRE(sql.find("ducklake.s.events") != string::npos);
+	REQUIRE(sql.find("GROUP BY") != string::npos);
+	REQUIRE(sql.back() != ';');
+}
+
+TEST_CASE("CTAS rewriter - full statement pins target to bound schema", "[duckhog][dml-rewriter][ctas]") {
+	string sql;
+	// Unqualified target: the binder resolved it to remote_flight.s.t through the search path.
+	REQUIRE(RewriteFullCTAS("CREATE TABLE t AS SELECT * FROM remote_flight.s.events", sql));
+
+	REQUIRE(sql.find("CREATE TABLE ducklake.s.t AS") != string::npos);
+}
+
+TEST_CASE("CTAS rewriter - full statement keeps OR REPLACE and IF NOT EXISTS", "[duckhog][dml-rewriter][ctas]") {
+	string sql;
+	REQUIRE(RewriteFullCTAS("CREATE OR REPLACE TABLE remote_flight.s.t AS SELECT * FROM remote_flight.s.events", sql));
+	REQUIRE(sql.find("CREATE OR REPLACE TABLE") != string::npos);
+
+	REQUIRE(RewriteFullCTAS("CREATE TABLE IF NOT EXISTS remote_flight.s.t AS SELECT * FROM remote_flight.s.events",
+	                        sql));
+	REQUIRE(sql.find("IF NOT EXISTS") != string::npos);
+}
+
+TEST_CASE("CTAS rewriter - full statement rewrites joins, subqueries and CTEs", "[duckhog][dml-rewriter][ctas]") {
+	string sql;
+	REQUIRE(RewriteFullCTAS("CREATE TABLE remote_flight.s.t AS WITH recent AS (SELECT * FROM remote_flight.s.events "
+	                        "WHERE ts > DATE '2024-01-01') SELECT r.id, p.name FROM recent r JOIN "
+	                        "remote_flight.s.persons p ON r.id = p.id WHERE p.id IN (SELECT id FROM "
+	                        "remote_flight.s.allowed)",
+	                        sql));
+
+	REQUIRE(sql.find("remote_flight") == string::npos);
+	REQUIRE(sql.find("ducklake.s.events") != string::npos);
+	REQUIRE(sql.find("ducklake.s.persons") != string::npos);
+	REQUIRE(sql.find("ducklake.s.allowed") != string::npos);
+}
+
+TEST_CASE("CTAS rewriter - full statement rejects unqualified sources", "[duckhog][dml-rewriter][ctas]") {
+	string sql = "unchanged";
+	REQUIRE_FALSE(RewriteFullCTAS("CREATE TABLE remote_flight.s.t AS SELECT * FROM events", sql));
+	REQUIRE_FALSE(RewriteFullCTAS("CREATE TABLE remote_flight.s.t AS SELECT * FROM s.events", sql));
+	REQUIRE(sql == "unchanged");
+}
+
+TEST_CASE("CTAS rewriter - full statement rejects external catalogs", "[duckhog][dml-rewriter][ctas]") {
+	string sql;
+	REQUIRE_FALSE(RewriteFullCTAS("CREATE TABLE remote_flight.s.t AS SELECT * FROM memory.main.local_table", sql));
+	REQUIRE_FALSE(RewriteFullCTAS("CREATE TABLE other.s.t AS SELECT * FROM remote_flight.s.events", sql));
+}
+
+TEST_CASE("CTAS rewriter - full statement rejects parameters and non-CTAS", "[duckhog][dml-rewriter][ctas]") {
+	string sql;
+	REQUIRE_FALSE(RewriteFullCTAS("CREATE TABLE remote_flight.s.t AS SELECT * FROM remote_flight.s.events WHERE id = $1",
+	                              sql));
+	REQUIRE_FALSE(RewriteFullCTAS("CREATE TABLE remote_flight.s.t (x INTEGER)", sql));
+	REQUIRE_FALSE(RewriteFullCTAS("SELECT 1", sql));
+	REQUIRE_FALSE(RewriteFullCTAS("CREATE TABLE remote_flight.s.t AS SELECT 1; SELECT 2", sql));
+}
+
+TEST_CASE("CTAS rewriter - full statement rejects functions outside the pushdown allowlist",
+          "[duckhog][dml-rewriter][ctas]") {
+	string sql = "unchanged";
+	// Local macros and UDFs do not exist on the server.
+	REQUIRE_FALSE(RewriteFullCTAS("CREATE TABLE remote_flight.s.t AS SELECT add_one(id) FROM remote_flight.s.events",
+	                              sql));
+	REQUIRE_FALSE(RewriteFullCTAS("CREATE TABLE remote_flight.s.t AS SELECT * FROM my_table_macro()", sql));
+	// Session state the local binder folds into constants.
+	REQUIRE_FALSE(RewriteFullCTAS(
+	    "CREATE TABLE remote_flight.s.t AS SELECT current_setting('TimeZone') AS tz FROM remote_flight.s.events", sql));
+	REQUIRE_FALSE(RewriteFullCTAS(
+	    "CREATE TABLE remote_flight.s.t AS SELECT getvariable('x') AS v FROM remote_flight.s.events", sql));
+	REQUIRE_FALSE(RewriteFullCTAS(
+	    "CREATE TABLE remote_flight.s.t AS SELECT current_database() AS db FROM remote_flight.s.events", sql));
+	REQUIRE_FALSE(RewriteFullCTAS("CREATE TABLE remote_flight.s.t AS SELECT id FROM remote_flight.s.events WHERE id IN "
+	                              "(SELECT add_one(id) FROM remote_flight.s.allowed)",
+	                              sql));
+	// Casts that depend on the TimeZone setting.
+	REQUIRE_FALSE(RewriteFullCTAS(
+	    "CREATE TABLE remote_flight.s.t AS SELECT ts::TIMESTAMPTZ AS ts FROM remote_flight.s.events", sql));
+	REQUIRE(sql == "unchanged");
+
+	REQUIRE(RewriteFullCTAS("CREATE TABLE remote_flight.s.t AS SELECT lower(kind) AS k, count(*) AS n, "
+	                        "sum(val + 1) AS s FROM remote_flight.s.events WHERE kind LIKE 'k%' GROUP BY 1",
+	                        sql));
+}
@@ -468,3 +468,18 @@ TEST_CASE("Delete rewriter - TRUNCATE with alias", "[duckhog][dml-rewriter][dele
 	REQUIRE(result.non_returning_sql.find("remote_flight") == string::npos);
 	REQUIRE(result.non_returning_sql.find("ducklake") != string::npos);
 }
+
+// --- Hybrid DML ---
+
+TEST_CASE("Delete rewriter - hybrid USING replaces the local table", "[duckhog][dml-rewriter][delete]") {
+	PostHogHybridDMLSource hybrid;
+	hybrid.temp_table = "__duckhog_upload_1";
+	auto result = RewriteRemoteDeleteSQL("DELETE FROM remote_flight.myschema.t USING local_mem.main.gone "
+	                                     "WHERE t.id = gone.id",
+	                                     DELETE_ATTACHED, DELETE_REMOTE, &hybrid);
+
+	REQUIRE(hybrid.catalog == "local_mem");
+	REQUIRE(hybrid.table == "gone");
+	REQUIRE(result.non_returning_sql.find("local_mem") == string::npos);
+	REQUIRE(result.non_returning_sql.find("__duckhog_upload_1 AS gone") != string::npos);
+}
@@ -264,6 +264,51 @@ TEST_CASE("Insert SQL builder - TIMESTAMP", "[duckhog][insert-sql]") {
 	REQUIRE(sql.find("10:30:00") != string::npos);
 }
 
+TEST_CASE("Insert SQL builder - DECIMAL keeps its scale", "[duckhog][insert-sql]") {
+	DataChunk chunk;
+	InitChunkMultiRow(chunk, {LogicalType::DECIMAL(4, 2), LogicalType::DECIMAL(18, 3)},
+	                  {{Value::DECIMAL(int16_t(-150), 4, 2), Value::DECIMAL(int64_t(1234567), 18, 3)},
+	                   {Value(LogicalType::DECIMAL(4, 2)), Value::DECIMAL(int64_t(5), 18, 3)}});
+	auto sql = BuildInsertSQL(TABLE, {"a", "b"}, chunk);
+	REQUIRE(sql == "INSERT INTO ducklake.myschema.t (a, b) VALUES (-1.50, 1234.567), (NULL, 0.005);");
+}
+
+TEST_CASE("Insert SQL builder - integer extremes and HUGEINT", "[duckhog][insert-sql]") {
+	DataChunk chunk;
+	InitChunk(chunk, {LogicalType::TINYINT, LogicalType::UBIGINT, LogicalType::HUGEINT},
+	          {Value::TINYINT(-128), Value::UBIGINT(18446744073709551615ULL), Value::HUGEINT(hugeint_t(-1))});
+	auto sql = BuildInsertSQL(TABLE, {"a", "b", "c"}, chunk);
+	REQUIRE(sql == "INSERT INTO ducklake.myschema.t (a, b, c) VALUES (-128, 18446744073709551615, -1);");
+}
+
+TEST_CASE("Insert SQL builder - temporal and UUID literals match Value", "[duckhog][insert-sql]") {
+	vector<LogicalType> types {LogicalType::DATE, LogicalType::TIME, LogicalType::TIMESTAMP, LogicalType::UUID};
+	vector<Value> row {Value("2026-01-15").DefaultCastAs(LogicalType::DATE),
+	                   Value("10:30:00").DefaultCastAs(LogicalType::TIME),
+	                   Value("2026-01-15 10:30:00.5").DefaultCastAs(LogicalType::TIMESTAMP),
+	                   Value::UUID("01234567-89ab-cdef-0123-456789abcdef")};
+	DataChunk chunk;
+	InitChunk(chunk, types, row);
+	auto sql = BuildInsertSQL(TABLE, {"d", "t", "ts", "u"}, chunk);
+	REQUIRE(sql == "INSERT INTO ducklake.myschema.t (d, t, ts, u) VALUES (" + row[0].ToSQLString() + ", " +
+	                   row[1].ToSQLString() + ", " + row[2].ToSQLString() + ", " + row[3].ToSQLString() + ");");
+}
+
+TEST_CASE("Insert SQL builder - constant and dictionary vectors", "[duckhog][insert-sql]") {
+	DataChunk chunk;
+	chunk.Initialize(Allocator::DefaultAllocator(), {LogicalType::INTEGER, LogicalType::VARCHAR});
+	chunk.data[0].Reference(Value::INTEGER(7));
+	chunk.SetValue(1, 0, Value("x"));
+	chunk.SetValue(1, 1, Value("y'z"));
+	chunk.SetCardinality(2);
+	SelectionVector reversed(2);
+	reversed.set_index(0, 1);
+	reversed.set_index(1, 0);
+	chunk.data[1].Slice(reversed, 2);
+	auto sql = BuildInsertSQL(TABLE, {"i", "v"}, chunk);
+	REQUIRE(sql == "INSERT INTO ducklake.myschema.t (i, v) VALUES (7, 'y''z'), (7, 'x');");
+}
+
 // ============================================================
 // LIST type coverage
 // ============================================================
@@ -545,3 +590,38 @@ TEST_CASE("Insert SQL builder - quoted table name passthrough", "[duckhog][inser
 	auto sql = BuildInsertSQL("\"my catalog\".\"my schema\".\"my table\"", {"i"}, chunk);
 	REQUIRE(sql.find("\"my catalog\".\"my schema\".\"my table\"") != string::npos);
 }
+
+// ============================================================
+// Parameterized INSERT
+// ============================================================
+
+TEST_CASE("Insert SQL builder - parameterized insert has one placeholder per column", "[duckhog][insert-sql]") {
+	auto sql = BuildParameterizedInsertSQL(TABLE, {"i", "select"});
+	REQUIRE(sql == "INSERT INTO " + TABLE + " (i, \"select\") VALUES (?, ?);");
+}
+
+TEST_CASE("Insert SQL builder - parameterized insert keeps ON CONFLICT clause", "[duckhog][insert-sql]") {
+	auto sql = BuildParameterizedInsertSQL(TABLE, {"i"}, " ON CONFLICT DO NOTHING");
+	REQUIRE(sql == "INSERT INTO " + TABLE + " (i) VALUES (?) ON CONFLICT DO NOTHING;");
+}
+
+// ============================================================
+// VALUES CTE for inlined join inputs
+// ============================================================
+
+TEST_CASE("Insert SQL builder - values CTE casts every value", "[duckhog][insert-sql]") {
+	ColumnDataCollection rows(Allocator::DefaultAllocator(), {LogicalType::BIGINT, LogicalType::VARCHAR});
+	DataChunk chunk;
+	InitChunkMultiRow(chunk, {LogicalType::BIGINT, LogicalType::VARCHAR},
+	                  {{Value::BIGINT(1), Value("it's")}, {Value::BIGINT(2), Value(LogicalType::VARCHAR)}});
+	rows.Append(chunk);
+	auto sql = BuildValuesCTE("__duckhog_upload_1", {"c0", "c1"}, rows);
+	REQUIRE(sql == "__duckhog_upload_1(c0, c1) AS (VALUES (CAST(1 AS BIGINT), CAST('it''s' AS VARCHAR)), "
+	               "(CAST(2 AS BIGINT), CAST(NULL AS VARCHAR)))");
+}
+
+TEST_CASE("Insert SQL builder - values CTE without rows", "[duckhog][insert-sql]") {
+	ColumnDataCollection rows(Allocator::DefaultAllocator(), {LogicalType::DATE});
+	auto sql = BuildValuesCTE("__duckhog_upload_2", {"c0"}, rows);
+	REQUIRE(sql == "__duckhog_upload_2(c0) AS (SELECT CAST(NULL AS DATE) WHERE FALSE)");
+}
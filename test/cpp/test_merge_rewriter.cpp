@@ -276,3 +276,59 @@ TEST_CASE("Merge rewriter - multiple WHEN MATCHED actions", "[duckhog][dml-rewri
 	REQUIRE(result.non_returning_sql.find("DELETE") != string::npos);
 	REQUIRE(result.non_returning_sql.find("INSERT") != string::npos);
 }
+
+// --- Hybrid DML ---
+
+TEST_CASE("Merge rewriter - hybrid source replaces the local table", "[duckhog][dml-rewriter][merge]") {
+	PostHogHybridDMLSource hybrid;
+	hybrid.temp_table = "__duckhog_upload_1";
+	auto result = RewriteRemoteMergeSQL("MERGE INTO remote_flight.s.tgt AS t USING local_mem.main.staging "
+	                                    "ON t.id = staging.id "
+	                                    "WHEN MATCHED THEN UPDATE SET val = staging.val",
+	                                    MERGE_ATTACHED, MERGE_REMOTE, &hybrid);
+
+	REQUIRE(hybrid.Found());
+	REQUIRE(hybrid.catalog == "local_mem");
+	REQUIRE(hybrid.schema == "main");
+	REQUIRE(hybrid.table == "staging");
+	REQUIRE(result.non_returning_sql.find("local_mem") == string::npos);
+	REQUIRE(result.non_returning_sql.find("__duckhog_upload_1 AS staging") != string::npos);
+	REQUIRE(result.non_returning_sql.find("ducklake.s.tgt") != string::npos);
+}
+
+TEST_CASE("Merge rewriter - hybrid source resolves unqualified local tables", "[duckhog][dml-rewriter][merge]") {
+	PostHogHybridDMLSource hybrid;
+	hybrid.temp_table = "__duckhog_upload_2";
+	hybrid.is_local = [](const string &schema, const string &table) {
+		return schema.empty() && table == "staging";
+	};
+	auto result = RewriteRemoteMergeSQL("MERGE INTO remote_flight.s.tgt AS t USING staging AS s ON t.id = s.id "
+	                                    "WHEN NOT MATCHED THEN INSERT VALUES (s.id, s.val)",
+	                                    MERGE_ATTACHED, MERGE_REMOTE, &hybrid);
+
+	REQUIRE(hybrid.table == "staging");
+	REQUIRE(hybrid.catalog.empty());
+	REQUIRE(result.non_returning_sql.find("__duckhog_upload_2 AS s") != string::npos);
+}
+
+TEST_CASE("Merge rewriter - hybrid source keeps remote sources", "[duckhog][dml-rewriter][merge]") {
+	PostHogHybridDMLSource hybrid;
+	hybrid.temp_table = "__duckhog_upload_3";
+	auto result =
+	    RewriteRemoteMergeSQL("MERGE INTO remote_flight.s.tgt AS t USING remote_flight.s.src AS s ON t.id = s.id "
+	                          "WHEN MATCHED THEN DELETE",
+	                          MERGE_ATTACHED, MERGE_REMOTE, &hybrid);
+
+	REQUIRE_FALSE(hybrid.Found());
+	REQUIRE(result.non_returning_sql.find("ducklake.s.src") != string::npos);
+}
+
+TEST_CASE("Merge rewriter - hybrid source rejects a second local table", "[duckhog][dml-rewriter][merge]") {
+	PostHogHybridDMLSource hybrid;
+	hybrid.temp_table = "__duckhog_upload_4";
+	REQUIRE_THROWS_AS(RewriteRemoteMergeSQL("MERGE INTO remote_flight.s.tgt AS t "
+	                                        "USING local_mem.main.a JOIN local_mem.main.b ON a.id = b.id "
+	                                        "ON t.id = a.id WHEN MATCHED THEN DELETE",
+	                                        MERGE_ATTACHED, MERGE_REMOTE, &hybrid),
+	                  NotImplementedException);
+}
@@ -417,3 +417,26 @@ TEST_CASE("Update rewriter - many AND conditions in WHERE", "[duckhog][dml-rewri
 	REQUIRE(result.non_returning_sql.find("ducklake") != string::npos);
 	REQUIRE(result.non_returning_sql.find("c49") != string::npos);
 }
+
+// --- Hybrid DML ---
+
+TEST_CASE("Update rewriter - hybrid FROM replaces the local table", "[duckhog][dml-rewriter][update]") {
+	PostHogHybridDMLSource hybrid;
+	hybrid.temp_table = "__duckhog_upload_1";
+	auto result = RewriteRemoteUpdateSQL(
+	    "UPDATE remote_flight.s.t SET i = o.val FROM local_mem.main.other AS o WHERE t.id = o.id", UPDATE_ATTACHED,
+	    UPDATE_REMOTE, &hybrid);
+
+	REQUIRE(hybrid.table == "other");
+	REQUIRE(result.non_returning_sql.find("local_mem") == string::npos);
+	REQUIRE(result.non_returning_sql.find("__duckhog_upload_1 AS o") != string::npos);
+	REQUIRE(result.non_returning_sql.find("ducklake.s.t") != string::npos);
+}
+
+TEST_CASE("Update rewriter - hybrid FROM still rejects external target", "[duckhog][dml-rewriter][update]") {
+	PostHogHybridDMLSource hybrid;
+	hybrid.temp_table = "__duckhog_upload_2";
+	REQUIRE_THROWS_AS(RewriteRemoteUpdateSQL("UPDATE some_other_catalog.s.t SET i = 1", UPDATE_ATTACHED,
+	                                         UPDATE_REMOTE, &hybrid),
+	                  BinderException);
+}
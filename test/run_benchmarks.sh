@@ -0,0 +1,282 @@
+#!/usr/bin/env bash
+# Run the DuckHog benchmark workloads against the Duckgres integration servers.
+#
+# Every timed run is a fresh DuckDB CLI process: ATTACH and any untimed preparation happen with
+# the timer off, then `.timer on` measures the workload statements only. Per-run timings go to
+# results.jsonl and per-workload statistics to summary.json, both in the output directory.
+
+set -euo pipefail
+
+ROOT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")/.." && pwd)"
+OUTPUT_DIR=""
+START_SERVERS=1
+KEEP_SERVERS=0
+ITERATIONS=5
+WARMUP=1
+ROWS=1000000
+UPDATE_ROWS=10000
+ATTACH_OPTIONS=""
+BASELINE=""
+THRESHOLD=0.2
+WORKLOAD_FILTER=""
+
+usage() {
+    cat <<USAGE
+Usage: test/run_benchmarks.sh [options]
+
+Options:
+  --output-dir <path>     Output directory for results (default: test/integration/benchmarks/<timestamp>)
+  --no-start              Do not start/stop test servers; assume already running
+  --keep-servers          Keep servers running after completion (only with auto-start)
+  --iterations <n>        Timed runs per workload (default: ${ITERATIONS})
+  --warmup <n>            Untimed runs per workload before the timed ones (default: ${WARMUP})
+  --rows <n>              Rows in the scan and ingest fixtures (default: ${ROWS})
+  --update-rows <n>       Rows in the UPDATE ... RETURNING fixture (default: ${UPDATE_ROWS})
+  --attach-options <opts> Extra connection string options, e.g. 'pool_size=4&compression=lz4'
+  --workload <regex>      Only run workloads whose name matches
+  --baseline <file>       summary.json of an earlier run; exit non-zero on regressions
+  --threshold <ratio>     Median slowdown reported as a regression (default: ${THRESHOLD})
+  -h, --help              Show this help
+USAGE
+}
+
+while [[ $# -gt 0 ]]; do
+    case "$1" in
+        --output-dir)
+            OUTPUT_DIR="$2"
+            shift 2
+            ;;
+        --no-start)
+            START_SERVERS=0
+            shift
+            ;;
+        --keep-servers)
+            KEEP_SERVERS=1
+            shift
+            ;;
+        --iterations)
+            ITERATIONS="$2"
+            shift 2
+            ;;
+        --warmup)
+            WARMUP="$2"
+            shift 2
+            ;;
+        --rows)
+            ROWS="$2"
+            shift 2
+            ;;
+        --update-rows)
+            UPDATE_ROWS="$2"
+            shift 2
+            ;;
+        --attach-options)
+            ATTACH_OPTIONS="$2"
+            shift 2
+            ;;
+        --workload)
+            WORKLOAD_FILTER="$2"
+            shift 2
+            ;;
+        --baseline)
+            BASELINE="$2"
+            shift 2
+            ;;
+        --threshold)
+            THRESHOLD="$2"
+            shift 2
+            ;;
+        -h|--help)
+            usage
+            exit 0
+            ;;
+        *)
+            echo "Unknown argument: $1" >&2
+            usage
+            exit 1
+            ;;
+    esac
+done
+
+if [[ "$START_SERVERS" -eq 0 && "$KEEP_SERVERS" -eq 1 ]]; then
+    echo "--keep-servers has no effect with --no-start" >&2
+fi
+
+if [[ -z "$OUTPUT_DIR" ]]; then
+    run_ts="$(date +%Y%m%d_%H%M%S)"
+    OUTPUT_DIR="$ROOT_DIR/test/integration/benchmarks/$run_ts"
+fi
+mkdir -p "$OUTPUT_DIR"
+
+DUCKDB_BIN="$ROOT_DIR/build/release/duckdb"
+EXTENSION_PATH="$ROOT_DIR/build/release/extension/duckhog/duckhog.duckdb_extension"
+if [[ ! -x "$DUCKDB_BIN" ]]; then
+    echo "duckdb binary not found at $DUCKDB_BIN" >&2
+    exit 1
+fi
+if [[ ! -f "$EXTENSION_PATH" ]]; then
+    echo "extension not found at $EXTENSION_PATH" >&2
+    exit 1
+fi
+
+cleanup() {
+    if [[ "$START_SERVERS" -eq 1 && "$KEEP_SERVERS" -eq 0 ]]; then
+        "$ROOT_DIR/scripts/test-servers.sh" stop >/dev/null 2>&1 || true
+    fi
+}
+trap cleanup EXIT
+
+if [[ "$START_SERVERS" -eq 1 ]]; then
+    "$ROOT_DIR/scripts/test-servers.sh" start --background --seed
+fi
+
+eval "$("$ROOT_DIR/scripts/test-servers.sh" env)"
+status_output="$("$ROOT_DIR/scripts/test-servers.sh" status || true)"
+if [[ "$status_output" != *"Duckgres: running"* ]] || [[ "$status_output" != *"DuckLake infra: running"* ]]; then
+    printf '%s\n' "$status_output"
+    echo "Test servers are not fully running. Start them first or omit --no-start." >&2
+    exit 1
+fi
+
+RESULTS="$OUTPUT_DIR/results.jsonl"
+SUMMARY="$OUTPUT_DIR/summary.json"
+METADATA_CACHE_DIR="$OUTPUT_DIR/metadata_cache"
+: > "$RESULTS"
+mkdir -p "$METADATA_CACHE_DIR"
+
+CONNECTION="hog:ducklake?user=${DUCKHOG_USER}&password=${DUCKHOG_PASSWORD}&flight_server=grpc+tls://${FLIGHT_HOST}:${FLIGHT_PORT}&tls_skip_verify=true"
+if [[ -n "$ATTACH_OPTIONS" ]]; then
+    CONNECTION="${CONNECTION}&${ATTACH_OPTIONS}"
+fi
+BENCH_SCHEMA="remote.duckhog_bench"
+
+attach_sql() {
+    local extra="${1:-}"
+    if [[ -n "$extra" ]]; then
+        printf "ATTACH '%s&%s' AS remote;\n" "$CONNECTION" "$extra"
+    else
+        printf "ATTACH '%s' AS remote;\n" "$CONNECTION"
+    fi
+}
+
+# run_duckdb <untimed sql> <timed sql>: prints the summed wall time of the timed statements.
+run_duckdb() {
+    local untimed="$1"
+    local timed="$2"
+    local script output
+    script="$(printf "LOAD '%s';\n%s\n.mode trash\n.timer on\n%s\n.timer off\n" "$EXTENSION_PATH" "$untimed" "$timed")"
+    if ! output="$(printf '%s\n' "$script" | "$DUCKDB_BIN" -unsigned -bail 2>&1)"; then
+        printf '%s\n' "$output" >&2
+        return 1
+    fi
+    printf '%s\n' "$output" | awk '/^Run Time \(s\): real/ { total += $5 } END { printf "%.6f\n", total }'
+}
+
+# run_workload <name> <rows> <untimed sql> <timed sql>
+run_workload() {
+    local name="$1"
+    local rows="$2"
+    local untimed="$3"
+    local timed="$4"
+    if [[ -n "$WORKLOAD_FILTER" && ! "$name" =~ $WORKLOAD_FILTER ]]; then
+        return 0
+    fi
+    echo "[bench] $name"
+    local i seconds
+    for ((i = 0; i < WARMUP; i++)); do
+        run_duckdb "$untimed" "$timed" > /dev/null
+    done
+    for ((i = 1; i <= ITERATIONS; i++)); do
+        seconds="$(run_duckdb "$untimed" "$timed")"
+        printf '{"workload":"%s","iteration":%d,"seconds":%s,"rows":%d}\n' "$name" "$i" "$seconds" "$rows" >> "$RESULTS"
+    done
+}
+
+echo "[bench] creating fixtures (rows=${ROWS}, update_rows=${UPDATE_ROWS})"
+wide_columns=""
+for ((c = 0; c < 8; c++)); do
+    wide_columns+=", i * ${c} AS int_${c}, (i * ${c}) / 7.0 AS dbl_${c}, 'value_' || (i % 977 + ${c}) AS str_${c}"
+done
+run_duckdb "$(attach_sql)
+DROP SCHEMA IF EXISTS ${BENCH_SCHEMA} CASCADE;
+CREATE SCHEMA ${BENCH_SCHEMA};
+CREATE TABLE ${BENCH_SCHEMA}.narrow AS SELECT i AS id, (i % 1000)::INTEGER AS bucket FROM range(${ROWS}) t(i);
+CREATE TABLE ${BENCH_SCHEMA}.wide AS SELECT i AS id, (i % 1000)::INTEGER AS bucket${wide_columns} FROM range(${ROWS}) t(i);
+CREATE TABLE ${BENCH_SCHEMA}.ingest_target (id BIGINT, bucket INTEGER, label VARCHAR);
+CREATE TABLE ${BENCH_SCHEMA}.update_target AS SELECT i AS id, 0 AS counter FROM range(${UPDATE_ROWS}) t(i);" "" > /dev/null
+
+run_workload scan_narrow "$ROWS" "$(attach_sql)" "SELECT * FROM ${BENCH_SCHEMA}.narrow;"
+run_workload scan_wide "$ROWS" "$(attach_sql)" "SELECT * FROM ${BENCH_SCHEMA}.wide;"
+run_workload scan_filtered "$((ROWS / 100))" "$(attach_sql)" "SELECT * FROM ${BENCH_SCHEMA}.wide WHERE bucket < 10;"
+run_workload count_star 1 "$(attach_sql)" "SELECT count(*) FROM ${BENCH_SCHEMA}.narrow;"
+run_workload insert_bulk "$ROWS" "$(attach_sql)
+DELETE FROM ${BENCH_SCHEMA}.ingest_target;" \
+    "INSERT INTO ${BENCH_SCHEMA}.ingest_target SELECT i, (i % 1000)::INTEGER, 'label_' || i FROM range(${ROWS}) t(i);"
+run_workload update_returning "$UPDATE_ROWS" "$(attach_sql)" \
+    "UPDATE ${BENCH_SCHEMA}.update_target SET counter = counter + 1 RETURNING id, counter;"
+# Cold: every process lists the metadata from the server. Warm: the warmup run fills the on-disk
+# metadata cache, and later processes start from it.
+run_workload attach_cold 0 "" "$(attach_sql)
+SHOW ALL TABLES;"
+run_workload attach_warm 0 "" "$(attach_sql "metadata_cache_dir=${METADATA_CACHE_DIR}")
+SHOW ALL TABLES;"
+
+run_duckdb "$(attach_sql)
+DROP SCHEMA IF EXISTS ${BENCH_SCHEMA} CASCADE;" "" > /dev/null
+
+python3 - "$RESULTS" "$SUMMARY" "$BASELINE" "$THRESHOLD" <<'PY'
+import json
+import statistics
+import sys
+from pathlib import Path
+
+results_path, summary_path, baseline_path, threshold = sys.argv[1], sys.argv[2], sys.argv[3], float(sys.argv[4])
+
+runs = {}
+for line in Path(results_path).read_text().splitlines():
+    record = json.loads(line)
+    runs.setdefault(record["workload"], []).append(record)
+
+summary = {}
+for workload, records in runs.items():
+    seconds = [r["seconds"] for r in records]
+    median = statistics.median(seconds)
+    rows = records[0]["rows"]
+    summary[workload] = {
+        "iterations": len(seconds),
+        "rows": rows,
+        "min_seconds": min(seconds),
+        "median_seconds": median,
+        "max_seconds": max(seconds),
+        "mean_seconds": statistics.fmean(seconds),
+        "rows_per_second": rows / median if rows and median > 0 else None,
+    }
+Path(summary_path).write_text(json.dumps(summary, indent=2, sort_keys=True) + "\n")
+
+print(f"{'workload':<20} {'median_s':>10} {'min_s':>10} {'max_s':>10} {'rows/s':>14}")
+for workload, stats in summary.items():
+    rate = f"{stats['rows_per_second']:.0f}" if stats["rows_per_second"] else "-"
+    print(
+        f"{workload:<20} {stats['median_seconds']:>10.3f} {stats['min_seconds']:>10.3f} "
+        f"{stats['max_seconds']:>10.3f} {rate:>14}"
+    )
+
+if baseline_path:
+    baseline = json.loads(Path(baseline_path).read_text())
+    regressions = []
+    for workload, stats in summary.items():
+        before = baseline.get(workload)
+        if not before or before["median_seconds"] <= 0:
+            continue
+        ratio = stats["median_seconds"] / before["median_seconds"]
+        if ratio > 1 + threshold:
+            regressions.append(f"{workload}: {before['median_seconds']:.3f}s -> {stats['median_seconds']:.3f}s")
+    if regressions:
+        print("\nRegressions against baseline:")
+        for item in regressions:
+            print(f"  {item}")
+        sys.exit(2)
+    print("\nNo regressions against baseline.")
+PY
+
+echo "Benchmark run completed. Results written to: $OUTPUT_DIR"